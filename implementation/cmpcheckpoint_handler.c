@@ -0,0 +1,338 @@
+/*!
+ *	Source file, implementing the storing of the progress of the file comparing into a checkpoint file,
+ *	and the resuming of the comparing from it.
+ *
+ *	\file				cmpcheckpoint_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For the nanoseconds of the modification time, and fsync.
+
+
+
+#include "cmpfiles_handler.h"
+#include "cmpcheckpoint_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+
+const long long DEFAULT_CHECKPOINT_INTERVAL = 4LL * 1024 * 1024 * 1024;
+
+
+
+/*!
+ * 	The first line of every checkpoint file, including the version of its format.
+ * */
+static const char* CHECKPOINT_SIGNATURE = "CMPFILES-CHECKPOINT 2";
+
+
+
+/*!
+ * 	The identity of a file, by which it is recognized when resuming.
+ * */
+struct FileIdentity
+{
+	unsigned long long _device;
+	unsigned long long _inode;
+	long long _size;
+	long long _modification_seconds;
+	long long _modification_nanoseconds;
+};
+
+
+
+/*!
+ * 	Fetches the compared region of a file, which has to be the same when resuming, since the block offsets are relative to it.
+ * */
+static void GetFileRegion(const struct FilesToCompare* handler, size_t file_index, long long* region_offset, long long* region_length)
+{
+	*region_offset = (handler->_region_offsets != NULL) ? handler->_region_offsets[file_index] : 0;
+	*region_length = (handler->_region_lengths != NULL) ? handler->_region_lengths[file_index] : -1;
+}
+
+
+
+/* Static functions. */
+
+/*!
+ * 	Fetches the identity of a file. stdin has none, since it can't be read again.
+ * */
+static bool GetFileIdentity(struct FilesToCompare* handler, size_t file_index, struct FileIdentity* identity)
+{
+	struct IoFile* file = handler->_files[file_index];
+	bool is_closed_in_pool = (file == NULL && handler->_pooled_files != NULL && handler->_pooled_files[file_index]);
+
+	if ((file == NULL && !is_closed_in_pool) || (file != NULL && file->_is_stdin)) return false;
+
+	//	A file, that was closed by the pool of open files, is looked up by its path instead.
+	struct stat file_status;
+	if (is_closed_in_pool && stat(handler->_filepaths[file_index], &file_status) != 0) return false;
+	else if (!is_closed_in_pool && fstat(file->_descriptor, &file_status) != 0) return false;
+
+	identity->_device = (unsigned long long)file_status.st_dev;
+	identity->_inode = (unsigned long long)file_status.st_ino;
+	identity->_size = (long long)file_status.st_size;
+	identity->_modification_seconds = (long long)file_status.st_mtime;
+
+	#ifdef __linux__
+	identity->_modification_nanoseconds = (long long)file_status.st_mtim.tv_nsec;
+	#else
+	identity->_modification_nanoseconds = 0;
+	#endif
+
+	return true;
+}
+
+/*!
+ * 	Synchronizes the directory of a file to the disk, so that a rename inside it survives a crash.
+ * */
+static void SynchronizeDirectory(const char* filepath)
+{
+	#ifndef _WIN32
+	const char* last_separator = strrchr(filepath, '/');
+	size_t directory_length = (last_separator == NULL) ? 0 : (size_t)(last_separator - filepath);
+
+	char* directory = malloc(directory_length + 2);
+	if (directory == NULL) return;
+
+	if (last_separator == NULL) strcpy(directory, ".");
+	else if (directory_length == 0) strcpy(directory, "/");
+	else
+	{
+		memcpy(directory, filepath, directory_length);
+		directory[directory_length] = '\0';
+	}
+
+	int directory_descriptor = open(directory, O_RDONLY);
+	if (directory_descriptor >= 0)
+	{
+		fsync(directory_descriptor);
+		close(directory_descriptor);
+	}
+
+	free(directory);
+	#else
+	(void)filepath;
+	#endif
+}
+
+
+
+static bool WriteCheckpointContent(FILE* checkpoint, struct FilesToCompare* handler)
+{
+	long long reference_index = (handler->_reference_index == SIZE_MAX) ? -1 : (long long)handler->_reference_index;
+
+	fprintf(checkpoint, "%s\n", CHECKPOINT_SIGNATURE);
+	fprintf(checkpoint, "files %zu reference %lld offset %lld block %zu\n", handler->_number_of_filestreams, reference_index, handler->_block_offset, handler->_block_number);
+
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		struct FileIdentity identity;
+		long long region_offset, region_length;
+
+		if (!GetFileIdentity(handler, at_index, &identity))
+		{
+			fprintf(stderr, "Error in CmpCheckpoint_Write: Couldn't identify the file %s (stdin can't be checkpointed)!\n", handler->_filepaths[at_index]);
+			return false;
+		}
+
+		GetFileRegion(handler, at_index, &region_offset, &region_length);
+
+		fprintf(checkpoint, "%llu %llu %lld %lld %lld %zu %d %lld %lld %lld\n",
+			identity._device, identity._inode, identity._size, identity._modification_seconds, identity._modification_nanoseconds,
+			handler->_group_ids[at_index], (int)handler->_file_states[at_index], handler->_mismatch_offsets[at_index], region_offset, region_length);
+	}
+
+	fputs("end\n", checkpoint);
+
+	return ferror(checkpoint) == 0;
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+/*!
+ * 	The checkpoint is a small text file, with a line per file, so its writing takes a single write call.
+ * */
+bool CmpCheckpoint_Write(struct FilesToCompare* handler, const char* checkpoint_path)
+{
+	if (handler == NULL || checkpoint_path == NULL) return false;
+
+
+
+	size_t path_length = strlen(checkpoint_path);
+	char* temporary_path = malloc(path_length + sizeof(".tmp"));
+	if (temporary_path == NULL) return false;
+
+	memcpy(temporary_path, checkpoint_path, path_length);
+	memcpy(temporary_path + path_length, ".tmp", sizeof(".tmp"));
+
+	FILE* checkpoint = fopen(temporary_path, "w");
+	if (checkpoint == NULL)
+	{
+		fprintf(stderr, "Error in CmpCheckpoint_Write: Couldn't create the file %s!\n", temporary_path);
+		free(temporary_path);
+		return false;
+	}
+
+
+
+	bool checkpoint_was_written = WriteCheckpointContent(checkpoint, handler) && (fflush(checkpoint) == 0);
+
+	#ifndef _WIN32
+	checkpoint_was_written = checkpoint_was_written && (fsync(fileno(checkpoint)) == 0);
+	#endif
+
+	checkpoint_was_written = (fclose(checkpoint) == 0) && checkpoint_was_written;
+
+	#ifdef _WIN32
+	//	Windows doesn't replace a existing file on rename.
+	if (checkpoint_was_written) remove(checkpoint_path);
+	#endif
+
+	if (checkpoint_was_written && rename(temporary_path, checkpoint_path) == 0)
+	{
+		SynchronizeDirectory(checkpoint_path);
+	}
+	else
+	{
+		remove(temporary_path);
+		checkpoint_was_written = false;
+	}
+
+	free(temporary_path);
+
+	return checkpoint_was_written;
+}
+
+
+
+/*!
+ * 	The whole checkpoint is parsed and checked against the files, before anything of the handler is changed.
+ * 	A file matches its checkpoint, if its device, inode, size and modification time are still the same.
+ * */
+bool CmpCheckpoint_Resume(struct FilesToCompare* handler, const char* checkpoint_path, bool* was_resumed)
+{
+	if (handler == NULL || checkpoint_path == NULL || was_resumed == NULL) return false;
+
+	*was_resumed = false;
+
+	FILE* checkpoint = fopen(checkpoint_path, "r");
+	if (checkpoint == NULL) return errno == ENOENT;
+
+
+
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	size_t* group_ids = malloc(sizeof(size_t) * FILES_AMONG);
+	enum FileState* file_states = malloc(sizeof(enum FileState) * FILES_AMONG);
+	long long* mismatch_offsets = malloc(sizeof(long long) * FILES_AMONG);
+	bool checkpoint_is_valid = false;
+
+	if (group_ids == NULL || file_states == NULL || mismatch_offsets == NULL)
+	{
+		fputs("Error in CmpCheckpoint_Resume: Couldn't allocate the needed resources!\n", stderr);
+		goto __CmpCheckpoint_Resume_FreeRemainingResources;
+	}
+
+	char line[256];
+	size_t number_of_files, block_number;
+	long long reference_index, block_offset;
+	long long expected_reference_index = (handler->_reference_index == SIZE_MAX) ? -1 : (long long)handler->_reference_index;
+
+	if (fgets(line, sizeof(line), checkpoint) == NULL || strncmp(line, CHECKPOINT_SIGNATURE, strlen(CHECKPOINT_SIGNATURE)) != 0) goto __CmpCheckpoint_Resume_Malformed;
+	else if (fgets(line, sizeof(line), checkpoint) == NULL) goto __CmpCheckpoint_Resume_Malformed;
+	else if (sscanf(line, "files %zu reference %lld offset %lld block %zu", &number_of_files, &reference_index, &block_offset, &block_number) != 4) goto __CmpCheckpoint_Resume_Malformed;
+
+	if (number_of_files != FILES_AMONG || reference_index != expected_reference_index)
+	{
+		fputs("Error in CmpCheckpoint_Resume: The checkpoint was written for a different set of files or options!\n", stderr);
+		goto __CmpCheckpoint_Resume_FreeRemainingResources;
+	}
+
+
+
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		struct FileIdentity stored, current;
+		long long stored_region_offset, stored_region_length, region_offset, region_length;
+		int file_state;
+
+		if (fgets(line, sizeof(line), checkpoint) == NULL) goto __CmpCheckpoint_Resume_Malformed;
+		else if (sscanf(line, "%llu %llu %lld %lld %lld %zu %d %lld %lld %lld",
+								&stored._device, &stored._inode, &stored._size, &stored._modification_seconds, &stored._modification_nanoseconds,
+								&group_ids[at_index], &file_state, &mismatch_offsets[at_index], &stored_region_offset, &stored_region_length) != 10) goto __CmpCheckpoint_Resume_Malformed;
+		else if (file_state < FILE_COMPARING || file_state > FILE_ABANDONED || group_ids[at_index] >= FILES_AMONG) goto __CmpCheckpoint_Resume_Malformed;
+
+		file_states[at_index] = (enum FileState)file_state;
+
+		bool file_is_unchanged = GetFileIdentity(handler, at_index, &current) &&
+											(current._device == stored._device) && (current._inode == stored._inode) && (current._size == stored._size) &&
+											(current._modification_seconds == stored._modification_seconds) && (current._modification_nanoseconds == stored._modification_nanoseconds);
+
+		if (!file_is_unchanged)
+		{
+			fprintf(stderr, "Error in CmpCheckpoint_Resume: The file %s has changed since the checkpoint was written!\n", handler->_filepaths[at_index]);
+			goto __CmpCheckpoint_Resume_FreeRemainingResources;
+		}
+
+		GetFileRegion(handler, at_index, &region_offset, &region_length);
+
+		if (region_offset != stored_region_offset || region_length != stored_region_length)
+		{
+			fprintf(stderr, "Error in CmpCheckpoint_Resume: The compared region of the file %s differs from the one in the checkpoint!\n", handler->_filepaths[at_index]);
+			goto __CmpCheckpoint_Resume_FreeRemainingResources;
+		}
+	}
+
+	if (fgets(line, sizeof(line), checkpoint) == NULL || strcmp(line, "end\n") != 0) goto __CmpCheckpoint_Resume_Malformed;
+
+
+
+	memcpy(handler->_group_ids, group_ids, sizeof(size_t) * FILES_AMONG);
+	memcpy(handler->_file_states, file_states, sizeof(enum FileState) * FILES_AMONG);
+	memcpy(handler->_mismatch_offsets, mismatch_offsets, sizeof(long long) * FILES_AMONG);
+
+	checkpoint_is_valid = CmpFiles_RestoreProgress(handler, block_offset, block_number);
+	*was_resumed = checkpoint_is_valid;
+
+	if (!checkpoint_is_valid) fputs("Error in CmpCheckpoint_Resume: Couldn't continue from the checkpoint!\n", stderr);
+
+	goto __CmpCheckpoint_Resume_FreeRemainingResources;
+
+
+
+	__CmpCheckpoint_Resume_Malformed:
+		fprintf(stderr, "Error in CmpCheckpoint_Resume: The checkpoint %s is malformed!\n", checkpoint_path);
+
+	__CmpCheckpoint_Resume_FreeRemainingResources:
+		fclose(checkpoint);
+		free(group_ids);
+		free(file_states);
+		free(mismatch_offsets);
+
+	return checkpoint_is_valid;
+}
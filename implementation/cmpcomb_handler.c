@@ -16,25 +16,69 @@
 
 
 /*!
- * It is calculate by substracting the value of the variable number_of_elements by 1, 
- * and accumulating the result of that into the variable number_of_combinations.
- * 
- * This is done until the variable number_of_elements is zero.
- * 
- * The logic of this function is based on the algorithm used for preparing the combination pairs, 
- * and was created to make the code more clear.
+ * 	The number of combination pairs, that one bitset word holds.
  * */
-size_t CmpComb_NumberOfCombinations(size_t number_of_elements)
+#define COMBINATIONS_PER_WORD	64
+
+
+
+/* Static functions. */
+
+/*!
+ * 	Calculates the integer square root (rounded down) of the value, using Newton's method.
+ * 	The starting guess is a power of two, that is always bigger or equal to the result.
+ *
+ * 	\param	value	The value, whose square root is calculated.
+ * */
+static uint64_t IntegerSquareRoot(uint64_t value)
 {
-	size_t number_of_combinations = 0;
-	
-	while (number_of_elements > 0)
+	if (value < 2) return value;
+
+
+
+	unsigned int number_of_bits = 0;
+	for (uint64_t shifted = value; shifted != 0; shifted >>= 1) number_of_bits += 1;
+
+	uint64_t root = (uint64_t)1 << ((number_of_bits + 1) / 2);
+	uint64_t next_root = (root + value / root) / 2;
+
+	while (next_root < root)
 	{
-		number_of_elements -= 1;
-		number_of_combinations += number_of_elements;
+		root = next_root;
+		next_root = (root + value / root) / 2;
 	}
-	
-	return number_of_combinations;
+
+	return root;
+}
+
+/*!
+ * 	The position of the first combination pair, that has compare_index as its first element.
+ *
+ * 	\param	number_of_elements	The among of elements, that are to be compared with each other.
+ * 	\param	compare_index			The first element of the combination pairs row.
+ * */
+static size_t RowStartPosition(size_t number_of_elements, size_t compare_index)
+{
+	//	Either compare_index or the second factor is even, so the division is always exact.
+	return compare_index * (2 * number_of_elements - compare_index - 1) / 2;
+}
+
+
+
+/*!
+ * The pairs are every unique (compare_index, compare_with_index) combination with compare_index < compare_with_index,
+ * so their number is the triangular number of number_of_elements - 1.
+ *
+ * The multiplication is ordered so that the even factor gets halved first, which keeps the intermediate result from overflowing early.
+ * */
+size_t CmpComb_NumberOfCombinations(size_t number_of_elements)
+{
+	if (number_of_elements < 2) return 0;
+
+
+
+	if (number_of_elements % 2 == 0) return (number_of_elements / 2) * (number_of_elements - 1);
+	else return number_of_elements * ((number_of_elements - 1) / 2);
 }
 
 
@@ -42,7 +86,7 @@ size_t CmpComb_NumberOfCombinations(size_t number_of_elements)
 /*!
  * Free's all the allocated resources inside the struct, and then the struct itself.
  * The resources freeing process is not performed, if handler is set to NULL.
- * 
+ *
  * 	\warning	After this function, you should not use the same handler any further, unless you re-initialize it afterwards!
  * 					Not doing so and re-using it after it gets terminated will result in undefined behavior!
  * */
@@ -50,9 +94,8 @@ void CmpComb_Terminate(struct CompareCombinations* handler)
 {
 	if (handler != NULL)
 	{
-		if (handler->_compare_indexes != NULL) free(handler->_compare_indexes);
-		if (handler->_compare_with_indexes != NULL) free(handler->_compare_with_indexes);
-		if (handler->_match_states != NULL) free(handler->_match_states);
+		if (handler->_decided_states != NULL) free(handler->_decided_states);
+		if (handler->_matched_states != NULL) free(handler->_matched_states);
 		free(handler);
 	}
 }
@@ -61,50 +104,55 @@ void CmpComb_Terminate(struct CompareCombinations* handler)
  *	Validates the provided arguments and results of the memory allocations.
  * 	If everything went well, the fully initialized struct is returned.
  * 	Otherwise, any allocated resources inside the function are freed, and it returns NULL.
- * 	
+ *
+ * 	Only the two match state bitsets are allocated, which take 2 bits per combination pair.
+ *
  * 	\warning	After the handler is returned, don't try re-initialize it in the same pointer variable, unless it had its resources freed.
  * 					Doing so will result in a memory leak!
  * */
 struct CompareCombinations* CmpComb_Initialize(const size_t number_of_elements)
 {
-	if (number_of_elements == 0) return NULL;
-	
-	
-	
+	if (number_of_elements < 2) return NULL;
+
+
+
 	struct CompareCombinations* handler = malloc(sizeof(struct CompareCombinations));
 	if (handler == NULL) return NULL;
-	
-	
-	
+
+
+
 	size_t number_of_combinations = CmpComb_NumberOfCombinations(number_of_elements);
-	
+	size_t number_of_words = (number_of_combinations + COMBINATIONS_PER_WORD - 1) / COMBINATIONS_PER_WORD;
+
 	handler->_among_of_elements = number_of_elements;
 	handler->_among_of_combinations = number_of_combinations;
-	handler->_compare_indexes = malloc(sizeof(size_t) * number_of_combinations);
-	handler->_compare_with_indexes = malloc(sizeof(size_t) * number_of_combinations);
-	handler->_match_states = malloc(sizeof(enum MatchState) * number_of_combinations);
-	
-	if (handler->_compare_indexes == NULL || handler->_compare_with_indexes == NULL || handler->_match_states == NULL)
+	handler->_decided_states = malloc(sizeof(uint64_t) * number_of_words);
+	handler->_matched_states = malloc(sizeof(uint64_t) * number_of_words);
+
+	if (handler->_decided_states == NULL || handler->_matched_states == NULL)
 	{
 		CmpComb_Terminate(handler);
 		return NULL;
 	}
-	
-	
-	
+
+
+
 	CmpComb_PrepareCombinations(handler);
-	
-	
-	
+
+
+
 	return handler;
 }
 
 
 
 /*!
- *	Validates the provided arguments, 
- * 	and afterwards copies the compare combination pair from the handler struct into the values, 
- * 	pointer by compare_index and compare_with_index.
+ *	Validates the provided arguments,
+ * 	and afterwards calculates the compare combination pair from its position.
+ *
+ * 	The position is first mirrored, so that it counts from the last (shortest) row of pairs backwards.
+ * 	The mirrored row can then be found with the inverse of the triangular number formula,
+ * 	and the element indexes follow from the start of that row.
  * */
 bool CmpComb_GetCombination(struct CompareCombinations* handler, const size_t from_position, size_t* compare_index, size_t* compare_with_index)
 {
@@ -114,71 +162,120 @@ bool CmpComb_GetCombination(struct CompareCombinations* handler, const size_t fr
 
 
 
-	*compare_index = handler->_compare_indexes[from_position];
-	*compare_with_index = handler->_compare_with_indexes[from_position];
-	
-	
-	
+	uint64_t mirrored_position = handler->_among_of_combinations - 1 - from_position;
+	uint64_t mirrored_row = (IntegerSquareRoot(8 * mirrored_position + 1) - 1) / 2;
+
+	size_t row = handler->_among_of_elements - 2 - (size_t)mirrored_row;
+
+	*compare_index = row;
+	*compare_with_index = from_position - RowStartPosition(handler->_among_of_elements, row) + row + 1;
+
+
+
 	return true;
 }
 
 /*!
- *	Validates the provided arguments, 
- * 	and afterwards copies the compare_index and compare_with_index values as a compare combination pair into the handler struct.
+ *	Validates the provided arguments,
+ * 	and afterwards calculates the position of the compare combination pair.
+ * 	The order of the two indexes does not matter.
  * */
-bool CmpComb_SetCombination(struct CompareCombinations* handler, const size_t from_position, size_t compare_index, size_t compare_with_index)
+bool CmpComb_GetPosition(struct CompareCombinations* handler, size_t compare_index, size_t compare_with_index, size_t* at_position)
+{
+	if (handler == NULL) return false;
+	else if (at_position == NULL) return false;
+	else if (compare_index == compare_with_index) return false;
+	else if (compare_index >= handler->_among_of_elements || compare_with_index >= handler->_among_of_elements) return false;
+
+
+
+	if (compare_index > compare_with_index)
+	{
+		size_t swapped_index = compare_index;
+		compare_index = compare_with_index;
+		compare_with_index = swapped_index;
+	}
+
+	*at_position = RowStartPosition(handler->_among_of_elements, compare_index) + (compare_with_index - compare_index - 1);
+
+
+
+	return true;
+}
+
+
+
+/*!
+ *	Validates the provided arguments,
+ * 	and afterwards reads the match state from the two bitsets.
+ * */
+enum MatchState CmpComb_GetMatchState(struct CompareCombinations* handler, const size_t from_position)
+{
+	if (handler == NULL) return UNKNOWN;
+	else if (from_position >= handler->_among_of_combinations) return UNKNOWN;
+
+
+
+	size_t word_index = from_position / COMBINATIONS_PER_WORD;
+	uint64_t bit_mask = (uint64_t)1 << (from_position % COMBINATIONS_PER_WORD);
+
+	if ((handler->_decided_states[word_index] & bit_mask) == 0) return UNKNOWN;
+	else if ((handler->_matched_states[word_index] & bit_mask) == 0) return NOT_MATCHED;
+	else return MATCHED;
+}
+
+/*!
+ *	Validates the provided arguments,
+ * 	and afterwards writes the match state into the two bitsets.
+ * */
+bool CmpComb_SetMatchState(struct CompareCombinations* handler, const size_t from_position, enum MatchState match_state)
 {
 	if (handler == NULL) return false;
 	else if (from_position >= handler->_among_of_combinations) return false;
 
 
 
-	handler->_compare_indexes[from_position] = compare_index;
-	handler->_compare_with_indexes[from_position] = compare_with_index;
-	
-	
-	
+	size_t word_index = from_position / COMBINATIONS_PER_WORD;
+	uint64_t bit_mask = (uint64_t)1 << (from_position % COMBINATIONS_PER_WORD);
+
+	if (match_state == UNKNOWN) handler->_decided_states[word_index] &= ~bit_mask;
+	else handler->_decided_states[word_index] |= bit_mask;
+
+	if (match_state == MATCHED) handler->_matched_states[word_index] |= bit_mask;
+	else handler->_matched_states[word_index] &= ~bit_mask;
+
+
+
 	return true;
 }
 
 
 
 /*!
- *	Validates the provided arguments, 
- * 	and afterwards generated the compare_index and compare_with_index values as compare combination pairs,
- * 	which get copied to the handler struct.
- * 
- * 	After this, any previous match results are reset to UNKNOWN.
+ *	Validates the provided arguments,
+ * 	and afterwards resets any previous match results to UNKNOWN.
+ *
+ * 	Since the combination pairs themselves are calculated from their position, there is nothing else to prepare.
  * */
 bool CmpComb_PrepareCombinations(struct CompareCombinations* handler)
 {
 	//	Validate handler argument.
 	if (handler == NULL) return false;
 	else if (handler->_among_of_combinations == 0) return false;
-	else if (handler->_compare_indexes == NULL || handler->_compare_with_indexes == NULL) return false;
+	else if (handler->_decided_states == NULL || handler->_matched_states == NULL) return false;
 
 
 
-	//	Prepare to cache the compare combinations into the struct handler.
-	size_t in_position = 0, incrementer = 1;
-	
-	for (size_t compare_index = 0; compare_index < handler->_among_of_elements; ++compare_index)
+	//	Reset the match states.
+	size_t number_of_words = (handler->_among_of_combinations + COMBINATIONS_PER_WORD - 1) / COMBINATIONS_PER_WORD;
+
+	for (size_t at_index = 0; at_index < number_of_words; at_index += 1)
 	{
-		for (size_t compare_with_index = incrementer; compare_with_index < handler->_among_of_elements; ++compare_with_index)
-		{
-			CmpComb_SetCombination(handler, in_position, compare_index, compare_with_index);
-			in_position += 1;
-		}
-		
-		incrementer += 1;
+		handler->_decided_states[at_index] = 0;
+		handler->_matched_states[at_index] = 0;
 	}
-	
-	
-	
-	//	Reset the match states.
-	for (size_t at_index = 0; at_index < handler->_among_of_combinations; at_index += 1) handler->_match_states[at_index] = UNKNOWN;
-	
-	
-	
+
+
+
 	return true;
 }
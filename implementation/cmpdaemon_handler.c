@@ -0,0 +1,1310 @@
+/*!
+ *	Source file, implementing the resident daemon, that serves file comparing jobs over a Unix domain socket,
+ *	and the client, that sends a job to it.
+ *
+ *	\file				cmpdaemon_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For the socket, thread and memory stream functions.
+
+
+
+#include "cmpfiles_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmpdaemon_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+
+
+const size_t DEFAULT_DAEMON_WORKERS = 4;
+const size_t DEFAULT_DAEMON_QUEUED_JOBS = 64;
+const size_t DEFAULT_DAEMON_CLIENT_JOBS = 2;
+const size_t DEFAULT_DAEMON_JOB_FILES = 64;
+
+
+
+#ifdef __linux__
+
+/*!
+ * 	The longest line of a request, that is accepted. Longer ones close the connection.
+ * */
+#define MAXIMUM_LINE_LENGTH	(PATH_MAX + 64)
+
+/*!
+ * 	The number of bytes, that are received from a client at once.
+ * */
+#define RECEIVE_CHUNK_SIZE	4096
+
+/*!
+ * 	The among of file descriptors, that can be passed along a single received chunk.
+ * */
+#define RECEIVED_DESCRIPTORS_AMONG	64
+
+/*!
+ * 	The longest tag of a job, that is accepted.
+ * */
+#define MAXIMUM_TAG_LENGTH	63
+
+
+
+/*!
+ * 	Set by the signal handler, once the daemon should stop.
+ * */
+static volatile sig_atomic_t serving_is_stopped = 0;
+
+
+
+/*!
+ * 	A received job, waiting for or being compared by a worker.
+ * */
+struct DaemonJob
+{
+	struct DaemonClient* _client;
+	char _tag[MAXIMUM_TAG_LENGTH + 1];
+
+	size_t _number_of_files;
+	/*!
+	 * 	The among of file lines, that were received so far.
+	 * */
+	size_t _received_files;
+	char** _filepaths;
+	/*!
+	 * 	The open filestreams of the passed file descriptors, or NULL, if the daemon opens the filepaths itself.
+	 * */
+	FILE** _filestreams;
+	bool _uses_descriptors;
+
+	enum OutputFormat _output_format;
+	enum OutputLevel _output_level;
+	bool _show_combinations;
+
+	/*!
+	 * 	If set, the job is refused with this message, once all of its lines are received.
+	 * */
+	const char* _refusal;
+
+	struct DaemonJob* _next_job;
+};
+
+/*!
+ * 	A connected client, with its queue of jobs.
+ * 	The queue and the counters are guarded by the lock of the daemon, the rest is only used by the accepting thread.
+ * */
+struct DaemonClient
+{
+	int _socket;
+	/*!
+	 * 	Keeps the replies of the workers and of the accepting thread from interleaving.
+	 * */
+	pthread_mutex_t _write_lock;
+
+	struct DaemonJob* _first_queued_job;
+	struct DaemonJob* _last_queued_job;
+	size_t _among_of_queued_jobs;
+	size_t _among_of_running_jobs;
+	/*!
+	 * 	Once set, no more requests are read, and the client is freed, as soon as none of its jobs is running.
+	 * */
+	bool _is_closed;
+
+	char* _input;
+	size_t _input_length;
+	int* _descriptors;
+	size_t _among_of_descriptors;
+	struct DaemonJob* _pending_job;
+
+	struct DaemonClient* _next_client;
+};
+
+struct DaemonWorker
+{
+	struct Daemon* _daemon;
+	pthread_t _thread;
+	/*!
+	 * 	The buffers, that are lent to the handler of each job, so that they aren't allocated per job.
+	 * */
+	unsigned char** _compare_buffers;
+	bool _is_started;
+};
+
+struct Daemon
+{
+	const struct DaemonSettings* _settings;
+	int _listening_socket;
+	/*!
+	 * 	Written to by the workers, to wake up the accepting thread, once a closed client can be freed.
+	 * */
+	int _wake_pipe[2];
+
+	pthread_mutex_t _lock;
+	pthread_cond_t _job_was_queued;
+	struct DaemonClient* _first_client;
+	/*!
+	 * 	The client, whose jobs are looked at first by the next worker (round robin).
+	 * */
+	struct DaemonClient* _next_served_client;
+	size_t _among_of_queued_jobs;
+	bool _is_stopping;
+
+	struct DaemonWorker* _workers;
+};
+
+#endif
+
+
+
+/* Static functions. */
+
+#ifdef __linux__
+
+static void StopServing(int signal_number)
+{
+	(void)signal_number;
+	serving_is_stopped = 1;
+}
+
+
+
+/*!
+ * 	Sends all bytes, while retrying interrupted and partial sends. A disconnected peer doesn't raise SIGPIPE.
+ * */
+static bool SendAll(int socket_descriptor, const char* data, size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t sent = send(socket_descriptor, data, length, MSG_NOSIGNAL);
+
+		if (sent < 0 && errno == EINTR) continue;
+		else if (sent <= 0) return false;
+
+		data += sent;
+		length -= (size_t)sent;
+	}
+
+	return true;
+}
+
+/*!
+ * 	Sends a single line reply to the client, without interleaving it with the replies of the workers.
+ * */
+static void SendReply(struct DaemonClient* client, const char* reply_type, const char* tag, const char* message)
+{
+	char reply[MAXIMUM_TAG_LENGTH + 256];
+
+	if (message == NULL) snprintf(reply, sizeof(reply), "%s %s\n", reply_type, tag);
+	else snprintf(reply, sizeof(reply), "%s %s %s\n", reply_type, tag, message);
+
+	pthread_mutex_lock(&client->_write_lock);
+	SendAll(client->_socket, reply, strlen(reply));
+	pthread_mutex_unlock(&client->_write_lock);
+}
+
+
+
+static void FreeJob(struct DaemonJob* job)
+{
+	if (job == NULL) return;
+
+	for (size_t at_index = 0; at_index < job->_number_of_files; at_index += 1)
+	{
+		if (job->_filepaths != NULL) free(job->_filepaths[at_index]);
+		if (job->_filestreams != NULL && job->_filestreams[at_index] != NULL) fclose(job->_filestreams[at_index]);
+	}
+
+	free(job->_filepaths);
+	free(job->_filestreams);
+	free(job);
+}
+
+/*!
+ * 	Parses the first line of a job. Unsupported options still create the job, so that its file lines are skipped, but it gets refused.
+ *
+ * 	\return	The new job, or NULL, if the line isn't a job at all.
+ * */
+static struct DaemonJob* ParseJobHeader(const struct DaemonSettings* settings, const char* line)
+{
+	char tag[MAXIMUM_TAG_LENGTH + 1], format[8], level[8], view[8], mode[16];
+	size_t number_of_files;
+	int parsed_length = -1;
+
+	if (sscanf(line, "COMPARE %63s %zu %7s %7s %7s %15s%n", tag, &number_of_files, format, level, view, mode, &parsed_length) != 6) return NULL;
+	else if (line[parsed_length] != '\0') return NULL;
+
+	struct DaemonJob* job = calloc(1, sizeof(struct DaemonJob));
+	if (job == NULL) return NULL;
+
+	strcpy(job->_tag, tag);
+	job->_number_of_files = number_of_files;
+	job->_uses_descriptors = strcmp(mode, "descriptors") == 0;
+	job->_output_level = strcmp(level, "matched") == 0 ? SHOW_ONLY_MATCHED : SHOW_ALL;
+	job->_show_combinations = strcmp(view, "pairs") == 0;
+
+	if (strcmp(format, "json") == 0) job->_output_format = OUTPUT_JSON;
+	else if (strcmp(format, "csv") == 0) job->_output_format = OUTPUT_CSV;
+	else job->_output_format = OUTPUT_TEXT;
+
+	if (number_of_files < 2) job->_refusal = "At least 2 files need to be compared!";
+	else if (number_of_files > settings->_max_job_files) job->_refusal = "The job contains to many files!";
+	else if (strcmp(format, "text") != 0 && strcmp(format, "json") != 0 && strcmp(format, "csv") != 0) job->_refusal = "Unsupported output format!";
+	else if (strcmp(level, "all") != 0 && strcmp(level, "matched") != 0) job->_refusal = "Unsupported output level!";
+	else if (strcmp(view, "groups") != 0 && strcmp(view, "pairs") != 0) job->_refusal = "Unsupported result view!";
+	else if (!job->_uses_descriptors && strcmp(mode, "paths") != 0) job->_refusal = "Unsupported file mode!";
+
+	if (job->_refusal != NULL) return job;
+
+
+
+	job->_filepaths = calloc(number_of_files, sizeof(char*));
+	if (job->_filepaths == NULL) job->_refusal = "Couldn't allocate the job!";
+
+	return job;
+}
+
+/*!
+ * 	Takes the next passed file descriptor of the client, in the order they were received.
+ * */
+static int TakeDescriptor(struct DaemonClient* client)
+{
+	if (client->_among_of_descriptors == 0) return -1;
+
+	int descriptor = client->_descriptors[0];
+	client->_among_of_descriptors -= 1;
+	memmove(client->_descriptors, client->_descriptors + 1, sizeof(int) * client->_among_of_descriptors);
+
+	return descriptor;
+}
+
+
+
+/*!
+ * 	Queues a job, whose lines were all received.
+ * 	A job is refused as busy, if the queue is full, or if its client already fills half of it.
+ * */
+static void QueueJob(struct Daemon* daemon, struct DaemonClient* client, struct DaemonJob* job)
+{
+	const size_t CLIENT_QUEUE_LIMIT = daemon->_settings->_max_queued_jobs / 2 > 0 ? daemon->_settings->_max_queued_jobs / 2 : 1;
+
+	pthread_mutex_lock(&daemon->_lock);
+
+	bool is_busy = daemon->_is_stopping;
+	is_busy = is_busy || daemon->_among_of_queued_jobs >= daemon->_settings->_max_queued_jobs;
+	is_busy = is_busy || client->_among_of_queued_jobs >= CLIENT_QUEUE_LIMIT;
+
+	if (!is_busy)
+	{
+		job->_client = client;
+		if (client->_last_queued_job == NULL) client->_first_queued_job = job;
+		else client->_last_queued_job->_next_job = job;
+		client->_last_queued_job = job;
+
+		client->_among_of_queued_jobs += 1;
+		daemon->_among_of_queued_jobs += 1;
+		pthread_cond_signal(&daemon->_job_was_queued);
+	}
+
+	pthread_mutex_unlock(&daemon->_lock);
+
+
+
+	if (is_busy)
+	{
+		SendReply(client, "BUSY", job->_tag, NULL);
+		FreeJob(job);
+	}
+}
+
+/*!
+ * 	Finishes a job, whose lines were all received: takes its file descriptors, and queues it, or refuses it.
+ *
+ * 	\return	If the client kept to the protocol, returns true.
+ * */
+static bool FinishJob(struct Daemon* daemon, struct DaemonClient* client, struct DaemonJob* job)
+{
+	if (job->_uses_descriptors)
+	{
+		if (client->_among_of_descriptors < job->_number_of_files)
+		{
+			SendReply(client, "ERROR", job->_tag, "Not every file had its file descriptor passed!");
+			FreeJob(job);
+			return false;
+		}
+
+		if (job->_refusal == NULL)
+		{
+			job->_filestreams = calloc(job->_number_of_files, sizeof(FILE*));
+			if (job->_filestreams == NULL) job->_refusal = "Couldn't allocate the job!";
+		}
+
+		for (size_t at_index = 0; at_index < job->_number_of_files; at_index += 1)
+		{
+			int descriptor = TakeDescriptor(client);
+
+			if (job->_refusal != NULL)
+			{
+				close(descriptor);
+				continue;
+			}
+
+			job->_filestreams[at_index] = fdopen(descriptor, "rb");
+
+			if (job->_filestreams[at_index] == NULL)
+			{
+				close(descriptor);
+				job->_refusal = "Couldn't open a passed file descriptor!";
+			}
+			else
+			{
+				setvbuf(job->_filestreams[at_index], NULL, _IONBF, 0);
+			}
+		}
+	}
+
+
+
+	if (job->_refusal != NULL)
+	{
+		SendReply(client, "ERROR", job->_tag, job->_refusal);
+		FreeJob(job);
+		return true;
+	}
+
+	QueueJob(daemon, client, job);
+	return true;
+}
+
+/*!
+ * 	Handles a single received line: either the first line of a new job, or a file line of the pending job.
+ *
+ * 	\return	If the client kept to the protocol, returns true.
+ * */
+static bool HandleLine(struct Daemon* daemon, struct DaemonClient* client, const char* line)
+{
+	if (client->_pending_job == NULL)
+	{
+		client->_pending_job = ParseJobHeader(daemon->_settings, line);
+
+		if (client->_pending_job == NULL)
+		{
+			SendReply(client, "ERROR", "-", "Malformed job!");
+			return false;
+		}
+		else if (client->_pending_job->_number_of_files > 0) return true;
+	}
+	else
+	{
+		struct DaemonJob* job = client->_pending_job;
+
+		if (job->_refusal != NULL)
+		{
+			//	Only counted.
+		}
+		else if (!job->_uses_descriptors && strcmp(line, STDIN_FILEPATH_MARK) == 0)
+		{
+			job->_refusal = "The daemon can't compare its own stdin (pass it as a file descriptor instead)!";
+		}
+		else if ((job->_filepaths[job->_received_files] = strdup(line)) == NULL)
+		{
+			job->_refusal = "Couldn't allocate the job!";
+		}
+
+		job->_received_files += 1;
+		if (job->_received_files < job->_number_of_files) return true;
+	}
+
+
+
+	struct DaemonJob* job = client->_pending_job;
+	client->_pending_job = NULL;
+
+	return FinishJob(daemon, client, job);
+}
+
+/*!
+ * 	Receives the waiting bytes and passed file descriptors of a client, and handles every completed line.
+ *
+ * 	\return	If the client is still connected and kept to the protocol, returns true.
+ * */
+static bool ReceiveRequests(struct Daemon* daemon, struct DaemonClient* client)
+{
+	char control[CMSG_SPACE(sizeof(int) * RECEIVED_DESCRIPTORS_AMONG)];
+	struct iovec chunk = {client->_input + client->_input_length, MAXIMUM_LINE_LENGTH - client->_input_length};
+	struct msghdr message = {0};
+
+	message.msg_iov = &chunk;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	ssize_t received = recvmsg(client->_socket, &message, MSG_CMSG_CLOEXEC);
+	if (received < 0 && errno == EINTR) return true;
+	else if (received <= 0) return false;
+
+
+
+	bool descriptors_were_lost = (message.msg_flags & MSG_CTRUNC) != 0;
+
+	for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header != NULL; header = CMSG_NXTHDR(&message, header))
+	{
+		if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) continue;
+
+		size_t among = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		int* descriptors = realloc(client->_descriptors, sizeof(int) * (client->_among_of_descriptors + among));
+
+		for (size_t at_index = 0; at_index < among; at_index += 1)
+		{
+			int descriptor;
+			memcpy(&descriptor, CMSG_DATA(header) + at_index * sizeof(int), sizeof(int));
+
+			if (descriptors == NULL) close(descriptor);
+			else descriptors[client->_among_of_descriptors++] = descriptor;
+		}
+
+		if (descriptors == NULL) descriptors_were_lost = true;
+		else client->_descriptors = descriptors;
+	}
+
+	if (descriptors_were_lost)
+	{
+		SendReply(client, "ERROR", "-", "Passed file descriptors were lost!");
+		return false;
+	}
+	else if (client->_among_of_descriptors > daemon->_settings->_max_job_files)
+	{
+		SendReply(client, "ERROR", "-", "To many file descriptors were passed!");
+		return false;
+	}
+
+
+
+	client->_input_length += (size_t)received;
+
+	char* line_start = client->_input;
+	char* line_end;
+
+	while ((line_end = memchr(line_start, '\n', client->_input_length - (size_t)(line_start - client->_input))) != NULL)
+	{
+		*line_end = '\0';
+		if (!HandleLine(daemon, client, line_start)) return false;
+		line_start = line_end + 1;
+	}
+
+	client->_input_length -= (size_t)(line_start - client->_input);
+	memmove(client->_input, line_start, client->_input_length);
+
+	if (client->_input_length == MAXIMUM_LINE_LENGTH)
+	{
+		SendReply(client, "ERROR", "-", "The line is to long!");
+		return false;
+	}
+
+	return true;
+}
+
+
+
+static void FreeClient(struct DaemonClient* client)
+{
+	FreeJob(client->_pending_job);
+
+	for (size_t at_index = 0; at_index < client->_among_of_descriptors; at_index += 1) close(client->_descriptors[at_index]);
+
+	close(client->_socket);
+	pthread_mutex_destroy(&client->_write_lock);
+	free(client->_descriptors);
+	free(client->_input);
+	free(client);
+}
+
+static void AcceptClient(struct Daemon* daemon)
+{
+	int client_socket = accept4(daemon->_listening_socket, NULL, NULL, SOCK_CLOEXEC);
+	if (client_socket < 0) return;
+
+	struct DaemonClient* client = calloc(1, sizeof(struct DaemonClient));
+	char* input = malloc(MAXIMUM_LINE_LENGTH);
+
+	if (client == NULL || input == NULL || pthread_mutex_init(&client->_write_lock, NULL) != 0)
+	{
+		fputs("Error in AcceptClient: Couldn't allocate the needed resources!\n", stderr);
+		close(client_socket);
+		free(client);
+		free(input);
+		return;
+	}
+
+	client->_socket = client_socket;
+	client->_input = input;
+
+	pthread_mutex_lock(&daemon->_lock);
+	client->_next_client = daemon->_first_client;
+	daemon->_first_client = client;
+	pthread_mutex_unlock(&daemon->_lock);
+}
+
+/*!
+ * 	Stops reading the requests of a client, and drops its queued jobs.
+ * 	Its running jobs are still finished, before the client is freed.
+ * */
+static void CloseClient(struct Daemon* daemon, struct DaemonClient* client)
+{
+	pthread_mutex_lock(&daemon->_lock);
+
+	struct DaemonJob* job = client->_first_queued_job;
+
+	daemon->_among_of_queued_jobs -= client->_among_of_queued_jobs;
+	client->_first_queued_job = NULL;
+	client->_last_queued_job = NULL;
+	client->_among_of_queued_jobs = 0;
+	client->_is_closed = true;
+
+	pthread_mutex_unlock(&daemon->_lock);
+
+
+
+	while (job != NULL)
+	{
+		struct DaemonJob* next_job = job->_next_job;
+		FreeJob(job);
+		job = next_job;
+	}
+
+	shutdown(client->_socket, SHUT_RD);
+}
+
+/*!
+ * 	Frees the closed clients, that have no running jobs left.
+ * */
+static void FreeClosedClients(struct Daemon* daemon)
+{
+	pthread_mutex_lock(&daemon->_lock);
+
+	struct DaemonClient** link = &daemon->_first_client;
+
+	while (*link != NULL)
+	{
+		struct DaemonClient* client = *link;
+
+		if (!client->_is_closed || client->_among_of_running_jobs > 0)
+		{
+			link = &client->_next_client;
+			continue;
+		}
+
+		*link = client->_next_client;
+		if (daemon->_next_served_client == client) daemon->_next_served_client = client->_next_client;
+
+		FreeClient(client);
+	}
+
+	pthread_mutex_unlock(&daemon->_lock);
+}
+
+
+
+/*!
+ * 	Takes the next job, going round robin over the clients, and skipping the ones, that already have as many running jobs as they can.
+ * 	Has to be called with the lock of the daemon held.
+ * */
+static struct DaemonJob* TakeNextJob(struct Daemon* daemon)
+{
+	if (daemon->_among_of_queued_jobs == 0) return NULL;
+
+	struct DaemonClient* start_client = daemon->_next_served_client != NULL ? daemon->_next_served_client : daemon->_first_client;
+	struct DaemonClient* client = start_client;
+
+	while (client != NULL)
+	{
+		if (client->_first_queued_job != NULL && client->_among_of_running_jobs < daemon->_settings->_max_client_jobs)
+		{
+			struct DaemonJob* job = client->_first_queued_job;
+
+			client->_first_queued_job = job->_next_job;
+			if (client->_first_queued_job == NULL) client->_last_queued_job = NULL;
+
+			client->_among_of_queued_jobs -= 1;
+			client->_among_of_running_jobs += 1;
+			daemon->_among_of_queued_jobs -= 1;
+			daemon->_next_served_client = client->_next_client;
+
+			return job;
+		}
+
+		client = client->_next_client != NULL ? client->_next_client : daemon->_first_client;
+		if (client == start_client) break;
+	}
+
+	return NULL;
+}
+
+/*!
+ * 	Writes the results of a job the same way, as they are shown on the terminal.
+ * */
+static bool WriteResults(FILE* output, struct FilesToCompare* handler, bool all_matched, const struct DaemonJob* job)
+{
+	if (job->_show_combinations && !(all_matched && job->_output_format == OUTPUT_TEXT))
+	{
+		return CmpFiles_ResolveCombinations(handler) && CmpOutput_ShowCombinations(output, handler, job->_output_format, job->_output_level);
+	}
+
+	return CmpOutput_ShowGroups(output, handler, job->_output_format, job->_output_level);
+}
+
+/*!
+ * 	Compares the files of a job with the buffers of the worker, and sends back the results.
+ * */
+static void RunJob(struct DaemonWorker* worker, struct DaemonJob* job)
+{
+	const struct DaemonSettings* settings = worker->_daemon->_settings;
+	struct DaemonClient* client = job->_client;
+
+	//	The handler takes over the filestreams.
+	FILE** filestreams = job->_filestreams;
+	job->_filestreams = NULL;
+
+	struct FilesToCompare* handler = CmpFiles_InitializeWithResources(job->_filepaths, filestreams, job->_number_of_files, settings->_compare_buffer_size, worker->_compare_buffers);
+	free(filestreams);
+
+	if (handler == NULL)
+	{
+		SendReply(client, "ERROR", job->_tag, "Couldn't open the files!");
+		return;
+	}
+	else if (settings->_use_fingerprints && !CmpFiles_EnableFingerprints(handler))
+	{
+		SendReply(client, "ERROR", job->_tag, "Couldn't allocate the fingerprint table!");
+		CmpFiles_Terminate(handler);
+		return;
+	}
+	else if (!CmpFiles_SetThrottle(handler, settings->_throttle))
+	{
+		SendReply(client, "ERROR", job->_tag, "Couldn't allocate the limits of the reading!");
+		CmpFiles_Terminate(handler);
+		return;
+	}
+
+
+
+	bool all_matched = CmpFiles_CompareFiles(handler);
+
+	char* results = NULL;
+	size_t results_length = 0;
+	FILE* output = open_memstream(&results, &results_length);
+	bool results_were_written = output != NULL && WriteResults(output, handler, all_matched, job);
+
+	if (output != NULL) results_were_written = (fclose(output) == 0) && results_were_written;
+
+	CmpFiles_Terminate(handler);
+
+	if (!results_were_written)
+	{
+		SendReply(client, "ERROR", job->_tag, "Couldn't write the results!");
+		free(results);
+		return;
+	}
+
+
+
+	char reply_header[MAXIMUM_TAG_LENGTH + 64];
+	snprintf(reply_header, sizeof(reply_header), "RESULT %s %d %zu\n", job->_tag, all_matched ? 0 : 1, results_length);
+
+	pthread_mutex_lock(&client->_write_lock);
+	if (SendAll(client->_socket, reply_header, strlen(reply_header))) SendAll(client->_socket, results, results_length);
+	pthread_mutex_unlock(&client->_write_lock);
+
+	free(results);
+}
+
+static void* ServeJobs(void* argument)
+{
+	struct DaemonWorker* worker = argument;
+	struct Daemon* daemon = worker->_daemon;
+
+	pthread_mutex_lock(&daemon->_lock);
+
+	while (!daemon->_is_stopping)
+	{
+		struct DaemonJob* job = TakeNextJob(daemon);
+
+		if (job == NULL)
+		{
+			pthread_cond_wait(&daemon->_job_was_queued, &daemon->_lock);
+			continue;
+		}
+
+		pthread_mutex_unlock(&daemon->_lock);
+		RunJob(worker, job);
+		pthread_mutex_lock(&daemon->_lock);
+
+
+
+		struct DaemonClient* client = job->_client;
+		client->_among_of_running_jobs -= 1;
+
+		//	The client may now have room for another job, and a closed one can be freed.
+		pthread_cond_broadcast(&daemon->_job_was_queued);
+		if (client->_is_closed && client->_among_of_running_jobs == 0)
+		{
+			ssize_t written = write(daemon->_wake_pipe[1], "", 1);
+			(void)written;
+		}
+
+		FreeJob(job);
+	}
+
+	pthread_mutex_unlock(&daemon->_lock);
+
+	return NULL;
+}
+
+
+
+/*!
+ * 	Creates the listening socket, which only the current user can connect to.
+ * 	A stale socket (one that nobody listens on) is replaced, a socket of a running daemon is not.
+ * */
+static int ListenOnSocket(const char* socket_path)
+{
+	struct sockaddr_un address = {0};
+	address.sun_family = AF_UNIX;
+
+	if (strlen(socket_path) >= sizeof(address.sun_path))
+	{
+		fputs("Error in ListenOnSocket: The socket filepath is to long!\n", stderr);
+		return -1;
+	}
+
+	strcpy(address.sun_path, socket_path);
+
+
+
+	int listening_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listening_socket < 0) return -1;
+
+	struct stat socket_status;
+	if (lstat(socket_path, &socket_status) == 0 && S_ISSOCK(socket_status.st_mode))
+	{
+		if (connect(listening_socket, (struct sockaddr*)&address, sizeof(address)) == 0)
+		{
+			fputs("Error in ListenOnSocket: Another daemon is already listening on the socket!\n", stderr);
+			close(listening_socket);
+			return -1;
+		}
+
+		unlink(socket_path);
+	}
+
+	mode_t previous_mask = umask(0077);
+	bool is_bound = bind(listening_socket, (struct sockaddr*)&address, sizeof(address)) == 0;
+	umask(previous_mask);
+
+	if (!is_bound || listen(listening_socket, SOMAXCONN) != 0)
+	{
+		fprintf(stderr, "Error in ListenOnSocket: Couldn't listen on the socket (%s)!\n", strerror(errno));
+		if (is_bound) unlink(socket_path);
+		close(listening_socket);
+		return -1;
+	}
+
+	return listening_socket;
+}
+
+/*!
+ * 	Waits for new clients, requests and freeable clients, until the daemon is stopped by a signal.
+ * 	The stopping signals are blocked, except while waiting, so that none of them can be missed.
+ * */
+static void AcceptRequests(struct Daemon* daemon, const sigset_t* waiting_signals)
+{
+	struct pollfd* descriptors = NULL;
+	struct DaemonClient** polled_clients = NULL;
+	size_t descriptors_capacity = 0;
+
+	while (!serving_is_stopped)
+	{
+		size_t among_of_clients = 0;
+		for (struct DaemonClient* client = daemon->_first_client; client != NULL; client = client->_next_client) among_of_clients += 1;
+
+		if (among_of_clients + 2 > descriptors_capacity)
+		{
+			size_t new_capacity = (among_of_clients + 2) * 2;
+			struct pollfd* new_descriptors = realloc(descriptors, sizeof(struct pollfd) * new_capacity);
+			if (new_descriptors != NULL) descriptors = new_descriptors;
+			struct DaemonClient** new_polled_clients = realloc(polled_clients, sizeof(struct DaemonClient*) * new_capacity);
+			if (new_polled_clients != NULL) polled_clients = new_polled_clients;
+
+			if (new_descriptors == NULL || new_polled_clients == NULL)
+			{
+				fputs("Error in AcceptRequests: Couldn't allocate the needed resources!\n", stderr);
+				break;
+			}
+
+			descriptors_capacity = new_capacity;
+		}
+
+
+
+		size_t among_of_descriptors = 2;
+		descriptors[0] = (struct pollfd){daemon->_listening_socket, POLLIN, 0};
+		descriptors[1] = (struct pollfd){daemon->_wake_pipe[0], POLLIN, 0};
+
+		for (struct DaemonClient* client = daemon->_first_client; client != NULL; client = client->_next_client)
+		{
+			if (client->_is_closed) continue;
+
+			polled_clients[among_of_descriptors] = client;
+			descriptors[among_of_descriptors++] = (struct pollfd){client->_socket, POLLIN, 0};
+		}
+
+		int poll_result = ppoll(descriptors, among_of_descriptors, NULL, waiting_signals);
+		if (poll_result < 0 && errno == EINTR) continue;
+		else if (poll_result < 0) break;
+
+
+
+		for (size_t at_index = 2; at_index < among_of_descriptors; at_index += 1)
+		{
+			if (descriptors[at_index].revents == 0) continue;
+
+			if (!ReceiveRequests(daemon, polled_clients[at_index])) CloseClient(daemon, polled_clients[at_index]);
+		}
+
+		if (descriptors[1].revents != 0)
+		{
+			char wake_bytes[64];
+			ssize_t read_bytes = read(daemon->_wake_pipe[0], wake_bytes, sizeof(wake_bytes));
+			(void)read_bytes;
+		}
+
+		FreeClosedClients(daemon);
+
+		if (descriptors[0].revents != 0) AcceptClient(daemon);
+	}
+
+	free(descriptors);
+	free(polled_clients);
+}
+
+
+
+static void FreeWorkers(struct Daemon* daemon)
+{
+	if (daemon->_workers == NULL) return;
+
+	for (size_t at_index = 0; at_index < daemon->_settings->_number_of_workers; at_index += 1)
+	{
+		struct DaemonWorker* worker = &daemon->_workers[at_index];
+
+		if (worker->_is_started) pthread_join(worker->_thread, NULL);
+
+		if (worker->_compare_buffers == NULL) continue;
+
+		for (size_t at_buffer = 0; at_buffer < daemon->_settings->_max_job_files; at_buffer += 1) free(worker->_compare_buffers[at_buffer]);
+		free(worker->_compare_buffers);
+	}
+
+	free(daemon->_workers);
+	daemon->_workers = NULL;
+}
+
+/*!
+ * 	Allocates the buffers of every worker up front, and starts the worker threads.
+ * 	The workers inherit the blocked SIGINT and SIGTERM, so only the accepting thread receives them.
+ * */
+static bool StartWorkers(struct Daemon* daemon)
+{
+	const struct DaemonSettings* settings = daemon->_settings;
+
+	daemon->_workers = calloc(settings->_number_of_workers, sizeof(struct DaemonWorker));
+	if (daemon->_workers == NULL) return false;
+
+	for (size_t at_index = 0; at_index < settings->_number_of_workers; at_index += 1)
+	{
+		struct DaemonWorker* worker = &daemon->_workers[at_index];
+		worker->_daemon = daemon;
+		worker->_compare_buffers = calloc(settings->_max_job_files, sizeof(unsigned char*));
+		if (worker->_compare_buffers == NULL) return false;
+
+		for (size_t at_buffer = 0; at_buffer < settings->_max_job_files; at_buffer += 1)
+		{
+			worker->_compare_buffers[at_buffer] = malloc(settings->_compare_buffer_size);
+			if (worker->_compare_buffers[at_buffer] == NULL) return false;
+		}
+	}
+
+
+
+	bool workers_were_started = true;
+
+	for (size_t at_index = 0; at_index < settings->_number_of_workers && workers_were_started; at_index += 1)
+	{
+		struct DaemonWorker* worker = &daemon->_workers[at_index];
+		worker->_is_started = pthread_create(&worker->_thread, NULL, ServeJobs, worker) == 0;
+		workers_were_started = worker->_is_started;
+	}
+
+	return workers_were_started;
+}
+
+/*!
+ * 	Stops the workers (running jobs are finished, queued ones are dropped), and frees the clients.
+ * */
+static void StopWorkers(struct Daemon* daemon)
+{
+	pthread_mutex_lock(&daemon->_lock);
+	daemon->_is_stopping = true;
+	pthread_cond_broadcast(&daemon->_job_was_queued);
+	pthread_mutex_unlock(&daemon->_lock);
+
+	FreeWorkers(daemon);
+
+
+
+	for (struct DaemonClient* client = daemon->_first_client; client != NULL; client = client->_next_client)
+	{
+		if (!client->_is_closed) CloseClient(daemon, client);
+	}
+
+	FreeClosedClients(daemon);
+}
+
+
+
+/*!
+ * 	Writes a whole line of a request, and passes a file descriptor along it, if it isn't negative.
+ * */
+static bool SendLine(int socket_descriptor, const char* line, int descriptor)
+{
+	if (descriptor < 0) return SendAll(socket_descriptor, line, strlen(line));
+
+
+
+	char control[CMSG_SPACE(sizeof(int))] = {0};
+	struct iovec data = {(void*)line, strlen(line)};
+	struct msghdr message = {0};
+
+	message.msg_iov = &data;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(header), &descriptor, sizeof(int));
+
+	ssize_t sent;
+	do sent = sendmsg(socket_descriptor, &message, MSG_NOSIGNAL);
+	while (sent < 0 && errno == EINTR);
+
+	if (sent < 0) return false;
+
+	//	The file descriptor is passed with the first sent byte, the rest of the line can be sent without it.
+	return SendAll(socket_descriptor, line + sent, strlen(line) - (size_t)sent);
+}
+
+/*!
+ * 	Sends a single file line of a request.
+ * */
+static bool SendFile(int socket_descriptor, const char* filepath, bool send_filepaths)
+{
+	char line[MAXIMUM_LINE_LENGTH];
+
+	if (strchr(filepath, '\n') != NULL)
+	{
+		fprintf(stderr, "Error in CmpDaemon_Request: The filepath %s contains a new line!\n", filepath);
+		return false;
+	}
+	else if (send_filepaths)
+	{
+		char absolute_filepath[PATH_MAX];
+
+		if (strcmp(filepath, STDIN_FILEPATH_MARK) == 0 || realpath(filepath, absolute_filepath) == NULL)
+		{
+			fprintf(stderr, "Error in CmpDaemon_Request: Couldn't resolve the filepath %s (stdin can only be passed as a file descriptor)!\n", filepath);
+			return false;
+		}
+
+		snprintf(line, sizeof(line), "%s\n", absolute_filepath);
+		return SendLine(socket_descriptor, line, -1);
+	}
+
+
+
+	int descriptor = strcmp(filepath, STDIN_FILEPATH_MARK) == 0 ? STDIN_FILENO : open(filepath, O_RDONLY | O_CLOEXEC);
+
+	if (descriptor < 0)
+	{
+		fprintf(stderr, "Error in CmpDaemon_Request: Couldn't open the file %s!\n", filepath);
+		return false;
+	}
+
+	snprintf(line, sizeof(line), "%s\n", filepath);
+	bool line_was_sent = SendLine(socket_descriptor, line, descriptor);
+
+	if (descriptor != STDIN_FILENO) close(descriptor);
+
+	return line_was_sent;
+}
+
+/*!
+ * 	Reads the reply to the job, and copies its results to the output.
+ * */
+static bool ReceiveResults(FILE* output, FILE* replies, const char* tag, bool* all_matched)
+{
+	char line[MAXIMUM_TAG_LENGTH + 256];
+	char reply_type[8], reply_tag[MAXIMUM_TAG_LENGTH + 1];
+	int exit_code, message_start = 0;
+	size_t results_length;
+
+	if (fgets(line, sizeof(line), replies) == NULL)
+	{
+		fputs("Error in CmpDaemon_Request: The daemon closed the connection!\n", stderr);
+		return false;
+	}
+	else if (sscanf(line, "%7s %63s %n", reply_type, reply_tag, &message_start) != 2 || strcmp(reply_tag, tag) != 0)
+	{
+		fputs("Error in CmpDaemon_Request: The daemon sent a malformed reply!\n", stderr);
+		return false;
+	}
+	else if (strcmp(reply_type, "BUSY") == 0)
+	{
+		fputs("Error in CmpDaemon_Request: The daemon is busy, try again later!\n", stderr);
+		return false;
+	}
+	else if (strcmp(reply_type, "RESULT") != 0 || sscanf(line + message_start, "%d %zu", &exit_code, &results_length) != 2)
+	{
+		fprintf(stderr, "Error in CmpDaemon_Request: The daemon couldn't compare the files: %s", line + message_start);
+		return false;
+	}
+
+
+
+	char chunk[RECEIVE_CHUNK_SIZE];
+
+	while (results_length > 0)
+	{
+		size_t chunk_length = results_length < sizeof(chunk) ? results_length : sizeof(chunk);
+
+		if (fread(chunk, 1, chunk_length, replies) != chunk_length)
+		{
+			fputs("Error in CmpDaemon_Request: The daemon closed the connection!\n", stderr);
+			return false;
+		}
+
+		fwrite(chunk, 1, chunk_length, output);
+		results_length -= chunk_length;
+	}
+
+	*all_matched = exit_code == 0;
+
+	return ferror(output) == 0;
+}
+
+#endif
+
+
+
+
+
+
+/* Implemented functions. */
+
+bool CmpDaemon_IsSupported(void)
+{
+	#ifdef __linux__
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+
+
+/*!
+ * 	The accepting thread (the calling one) reads the requests of every client, and queues the completed jobs per client.
+ * 	The workers take the jobs round robin over the clients, each one comparing them with its own, already allocated buffers,
+ * 	and send back the results as soon as they are done. The results of a client can therefore arrive in a different order than its jobs.
+ * */
+bool CmpDaemon_Serve(const char* socket_path, const struct DaemonSettings* settings)
+{
+	#ifdef __linux__
+	if (socket_path == NULL || settings == NULL) return false;
+	else if (settings->_number_of_workers == 0 || settings->_max_queued_jobs == 0) return false;
+	else if (settings->_max_client_jobs == 0 || settings->_max_job_files < 2 || settings->_compare_buffer_size == 0) return false;
+
+
+
+	struct Daemon daemon = {0};
+	daemon._settings = settings;
+	daemon._wake_pipe[0] = daemon._wake_pipe[1] = -1;
+
+	bool serving_failed = true;
+
+	if (pthread_mutex_init(&daemon._lock, NULL) != 0) return false;
+	if (pthread_cond_init(&daemon._job_was_queued, NULL) != 0)
+	{
+		pthread_mutex_destroy(&daemon._lock);
+		return false;
+	}
+
+
+
+	struct sigaction stop_action, previous_interrupt_action, previous_terminate_action;
+	memset(&stop_action, 0, sizeof(stop_action));
+	stop_action.sa_handler = StopServing;
+	sigemptyset(&stop_action.sa_mask);
+
+	sigset_t stop_signals, previous_signals;
+	sigemptyset(&stop_signals);
+	sigaddset(&stop_signals, SIGINT);
+	sigaddset(&stop_signals, SIGTERM);
+
+	serving_is_stopped = 0;
+	pthread_sigmask(SIG_BLOCK, &stop_signals, &previous_signals);
+	sigaction(SIGINT, &stop_action, &previous_interrupt_action);
+	sigaction(SIGTERM, &stop_action, &previous_terminate_action);
+
+	daemon._listening_socket = ListenOnSocket(socket_path);
+	if (daemon._listening_socket < 0) goto __CmpDaemon_Serve_FreeRemainingResources;
+
+	if (pipe2(daemon._wake_pipe, O_CLOEXEC | O_NONBLOCK) != 0) goto __CmpDaemon_Serve_FreeRemainingResources;
+
+	if (!StartWorkers(&daemon))
+	{
+		fputs("Error in CmpDaemon_Serve: Couldn't start the workers!\n", stderr);
+		goto __CmpDaemon_Serve_FreeRemainingResources;
+	}
+
+	AcceptRequests(&daemon, &previous_signals);
+	serving_failed = serving_is_stopped == 0;
+
+
+
+	__CmpDaemon_Serve_FreeRemainingResources:
+		StopWorkers(&daemon);
+
+		if (daemon._listening_socket >= 0)
+		{
+			close(daemon._listening_socket);
+			unlink(socket_path);
+		}
+
+		if (daemon._wake_pipe[0] >= 0) close(daemon._wake_pipe[0]);
+		if (daemon._wake_pipe[1] >= 0) close(daemon._wake_pipe[1]);
+
+		pthread_cond_destroy(&daemon._job_was_queued);
+		pthread_mutex_destroy(&daemon._lock);
+
+		pthread_sigmask(SIG_SETMASK, &previous_signals, NULL);
+		sigaction(SIGINT, &previous_interrupt_action, NULL);
+		sigaction(SIGTERM, &previous_terminate_action, NULL);
+
+	return !serving_failed;
+	#else
+	(void)socket_path;
+	(void)settings;
+	return false;
+	#endif
+}
+
+
+
+/*!
+ * 	The job is tagged by the process identifier, and its first line is sent before the file lines,
+ * 	each of which carries its own file descriptor, unless the filepaths are sent.
+ * */
+bool CmpDaemon_Request(FILE* output, const char* socket_path, char** filepaths, size_t number_of_files, bool send_filepaths, enum OutputFormat output_format, enum OutputLevel output_level, bool show_combinations, bool* all_matched)
+{
+	#ifdef __linux__
+	if (output == NULL || socket_path == NULL || filepaths == NULL || all_matched == NULL) return false;
+
+	struct sockaddr_un address = {0};
+	address.sun_family = AF_UNIX;
+
+	if (strlen(socket_path) >= sizeof(address.sun_path))
+	{
+		fputs("Error in CmpDaemon_Request: The socket filepath is to long!\n", stderr);
+		return false;
+	}
+
+	strcpy(address.sun_path, socket_path);
+
+
+
+	int request_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (request_socket < 0) return false;
+
+	FILE* replies = NULL;
+	bool request_failed = true;
+
+	if (connect(request_socket, (struct sockaddr*)&address, sizeof(address)) != 0)
+	{
+		fprintf(stderr, "Error in CmpDaemon_Request: Couldn't connect to the daemon (%s)!\n", strerror(errno));
+		goto __CmpDaemon_Request_FreeRemainingResources;
+	}
+
+	const char* FORMAT_NAMES[] = {"text", "json", "csv"};
+	char tag[MAXIMUM_TAG_LENGTH + 1], line[MAXIMUM_LINE_LENGTH];
+
+	snprintf(tag, sizeof(tag), "%ld", (long)getpid());
+	snprintf(line, sizeof(line), "COMPARE %s %zu %s %s %s %s\n", tag, number_of_files, FORMAT_NAMES[output_format],
+		output_level == SHOW_ONLY_MATCHED ? "matched" : "all", show_combinations ? "pairs" : "groups", send_filepaths ? "paths" : "descriptors");
+
+	if (!SendLine(request_socket, line, -1)) goto __CmpDaemon_Request_FreeRemainingResources;
+
+	for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+	{
+		if (!SendFile(request_socket, filepaths[at_index], send_filepaths)) goto __CmpDaemon_Request_FreeRemainingResources;
+	}
+
+
+
+	replies = fdopen(request_socket, "rb");
+	if (replies == NULL) goto __CmpDaemon_Request_FreeRemainingResources;
+
+	request_failed = !ReceiveResults(output, replies, tag, all_matched);
+
+
+
+	__CmpDaemon_Request_FreeRemainingResources:
+		if (replies != NULL) fclose(replies);
+		else close(request_socket);
+
+	return !request_failed;
+	#else
+	(void)output;
+	(void)socket_path;
+	(void)filepaths;
+	(void)number_of_files;
+	(void)send_filepaths;
+	(void)output_format;
+	(void)output_level;
+	(void)show_combinations;
+	(void)all_matched;
+	return false;
+	#endif
+}
@@ -0,0 +1,358 @@
+/*!
+ *	Source file, implementing the counting of the differing bytes, blocks and bits of each pair of the compared files.
+ *
+ *	\file				cmpdamage_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For fstat.
+
+
+
+#include "cmpcomb_handler.h"
+#include "cmpfiles_handler.h"
+#include "cmpkernel_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmpdamage_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+
+
+/*!
+ * 	How much the data of a pair of files differs.
+ * */
+struct PairDamage
+{
+	long long _differing_bytes;
+	long long _differing_blocks;
+	unsigned long long _differing_bits;
+
+	/*!
+	 * If set, the counting stopped at the threshold, so the counts are only the lowest, that they can be.
+	 * */
+	bool _reached_threshold;
+};
+
+
+
+/* Static functions. */
+
+/*!
+ * 	Opens a file for reading through the backend, or takes over stdin for its mark.
+ * 	The files are read from their start to their end, so the system is told to read ahead.
+ * */
+static struct IoFile* OpenFile(const struct IoBackend* io_backend, const char* filepath)
+{
+	struct IoFile* file;
+
+	if (strcmp(filepath, STDIN_FILEPATH_MARK) == 0)
+	{
+		#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+		#endif
+
+		file = CmpIo_Adopt(io_backend, stdin);
+	}
+	else
+	{
+		file = CmpIo_Open(io_backend, filepath);
+	}
+
+	if (file != NULL) CmpIo_Advise(file, 0, 0, IO_ADVICE_SEQUENTIAL);
+
+	return file;
+}
+
+/*!
+ * 	A pair is still counted, until it reaches the threshold, or both of its files were read till their end.
+ * */
+static bool IsCounted(const struct PairDamage* damage, const bool* file_ended, size_t compare_index, size_t compare_with_index)
+{
+	return !damage->_reached_threshold && !(file_ended[compare_index] && file_ended[compare_with_index]);
+}
+
+/*!
+ * 	The differing bytes of a pair are only counted in full, if it didn't reach the threshold, so its similarity is otherwise the highest, that it can be.
+ * 	The size of a file is its size in advance, where that is known, and the among of its read bytes otherwise.
+ * */
+static double GetSimilarity(const struct PairDamage* damage, const long long* file_sizes, size_t compare_index, size_t compare_with_index)
+{
+	long long longer_size = (file_sizes[compare_index] > file_sizes[compare_with_index]) ? file_sizes[compare_index] : file_sizes[compare_with_index];
+
+	if (longer_size <= 0 || damage->_differing_bytes >= longer_size) return (damage->_differing_bytes == 0) ? 1.0 : 0.0;
+
+	return 1.0 - (double)damage->_differing_bytes / (double)longer_size;
+}
+
+
+
+static void WritePairAsText(FILE* output, const char* filepath, const char* with_filepath, const struct PairDamage* damage, double similarity, bool count_bits)
+{
+	if (damage->_differing_bytes == 0)
+	{
+		fprintf(output, "%s and %s match!\n", filepath, with_filepath);
+		return;
+	}
+
+	fprintf(output, "%s and %s do not match: %s%lld differing bytes in %lld blocks",
+				filepath, with_filepath, damage->_reached_threshold ? "at least " : "", damage->_differing_bytes, damage->_differing_blocks);
+
+	if (count_bits) fprintf(output, " (%llu differing bits)", damage->_differing_bits);
+
+	fprintf(output, ", %s%.4f%% similar.\n", damage->_reached_threshold ? "at most " : "", similarity * 100.0);
+}
+
+static void WritePairAsJson(FILE* output, const char* filepath, const char* with_filepath, const struct PairDamage* damage, double similarity, bool count_bits)
+{
+	fputs("{\"filepath\":", output);
+	CmpOutput_WriteJsonString(output, filepath);
+	fputs(",\"with_filepath\":", output);
+	CmpOutput_WriteJsonString(output, with_filepath);
+
+	fprintf(output, ",\"state\":\"%s\",\"differing_bytes\":%lld,\"differing_blocks\":%lld",
+				(damage->_differing_bytes == 0) ? "matched" : "not_matched", damage->_differing_bytes, damage->_differing_blocks);
+
+	if (count_bits) fprintf(output, ",\"differing_bits\":%llu", damage->_differing_bits);
+
+	fprintf(output, ",\"similarity\":%.6f,\"reached_threshold\":%s}", similarity, damage->_reached_threshold ? "true" : "false");
+}
+
+/*!
+ * 	The differing bits are left empty, if they weren't counted.
+ * */
+static void WritePairAsCsv(FILE* output, const char* filepath, const char* with_filepath, const struct PairDamage* damage, double similarity, bool count_bits)
+{
+	CmpOutput_WriteCsvField(output, filepath);
+	fputc(',', output);
+	CmpOutput_WriteCsvField(output, with_filepath);
+
+	fprintf(output, ",%s,%lld,%lld,", (damage->_differing_bytes == 0) ? "matched" : "not_matched", damage->_differing_bytes, damage->_differing_blocks);
+
+	if (count_bits) fprintf(output, "%llu", damage->_differing_bits);
+
+	fprintf(output, ",%.6f,%s\n", similarity, damage->_reached_threshold ? "true" : "false");
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+/*!
+ * 	Each pass of the loop reads the next block of every file, that is still in a counted pair, and counts the differences of each counted pair in it.
+ * 	The pairs are stored in the order of the compare combinations (like the upper triangle of a matrix, row by row).
+ * 	The files are read from their current position, so pipes can be counted as well.
+ * */
+bool CmpDamage_CountDifferences(FILE* output, char** filepaths, size_t number_of_files, size_t compare_buffer_size, const struct IoBackend* io_backend, struct IoThrottle* throttle,
+												bool compare_with_first, long long threshold, bool count_bits, enum OutputFormat output_format, bool* all_matched)
+{
+	if (output == NULL || filepaths == NULL || all_matched == NULL) return false;
+	else if (number_of_files < 2 || compare_buffer_size == 0 || threshold < 0) return false;
+
+
+
+	bool differences_were_counted = false;
+	size_t among_of_stdin = 0;
+
+	struct IoFile** files = calloc(number_of_files, sizeof(struct IoFile*));
+	unsigned char** buffers = calloc(number_of_files, sizeof(unsigned char*));
+	size_t* lengths = calloc(number_of_files, sizeof(size_t));
+	long long* file_sizes = calloc(number_of_files, sizeof(long long));
+	bool* size_is_known = calloc(number_of_files, sizeof(bool));
+	bool* file_ended = calloc(number_of_files, sizeof(bool));
+	bool* file_is_needed = calloc(number_of_files, sizeof(bool));
+	unsigned long long* devices = calloc(number_of_files, sizeof(unsigned long long));
+	struct PairDamage* damages = calloc(CmpComb_NumberOfCombinations(number_of_files), sizeof(struct PairDamage));
+
+	if (files == NULL || buffers == NULL || lengths == NULL || file_sizes == NULL || size_is_known == NULL ||
+			file_ended == NULL || file_is_needed == NULL || devices == NULL || damages == NULL)
+	{
+		fputs("Error in CmpDamage_CountDifferences: Couldn't allocate the needed resources!\n", stderr);
+		goto __CmpDamage_CountDifferences_FreeRemainingResources;
+	}
+
+	for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+	{
+		among_of_stdin += (strcmp(filepaths[at_index], STDIN_FILEPATH_MARK) == 0);
+
+		if (among_of_stdin > 1)
+		{
+			fputs("Error in CmpDamage_CountDifferences: Only one of the files can be stdin!\n", stderr);
+			goto __CmpDamage_CountDifferences_FreeRemainingResources;
+		}
+
+		buffers[at_index] = malloc(compare_buffer_size);
+		files[at_index] = OpenFile(io_backend, filepaths[at_index]);
+
+		if (buffers[at_index] == NULL)
+		{
+			fputs("Error in CmpDamage_CountDifferences: Couldn't allocate the needed resources!\n", stderr);
+			goto __CmpDamage_CountDifferences_FreeRemainingResources;
+		}
+		else if (files[at_index] == NULL)
+		{
+			fprintf(stderr, "Error in CmpDamage_CountDifferences: Couldn't open the file %s!\n", filepaths[at_index]);
+			goto __CmpDamage_CountDifferences_FreeRemainingResources;
+		}
+
+		struct stat file_status;
+		if (fstat(files[at_index]->_descriptor, &file_status) == 0) devices[at_index] = (unsigned long long)file_status.st_dev;
+
+		size_is_known[at_index] = !files[at_index]->_is_stdin && CmpIo_SizeHint(files[at_index], &file_sizes[at_index]);
+	}
+
+
+
+	while (true)
+	{
+		size_t at_position = 0;
+		bool any_file_is_needed = false;
+
+		memset(file_is_needed, false, sizeof(bool) * number_of_files);
+
+		for (size_t compare_index = 0; compare_index < number_of_files; compare_index += 1)
+		{
+			for (size_t compare_with_index = compare_index + 1; compare_with_index < number_of_files; compare_with_index += 1, at_position += 1)
+			{
+				if (compare_with_first && compare_index != 0) continue;
+				else if (!IsCounted(&damages[at_position], file_ended, compare_index, compare_with_index)) continue;
+
+				file_is_needed[compare_index] = true;
+				file_is_needed[compare_with_index] = true;
+				any_file_is_needed = true;
+			}
+		}
+
+		if (!any_file_is_needed) break;
+
+		for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+		{
+			lengths[at_index] = 0;
+			if (file_ended[at_index] || !file_is_needed[at_index]) continue;
+
+			if (throttle != NULL) CmpThrottle_Acquire(throttle, devices[at_index], compare_buffer_size);
+			long long among_of_read = CmpIo_ReadAt(files[at_index], buffers[at_index], compare_buffer_size, IO_CURRENT_OFFSET);
+
+			if (among_of_read < 0)
+			{
+				fprintf(stderr, "Error in CmpDamage_CountDifferences: Couldn't read the file %s!\n", filepaths[at_index]);
+				goto __CmpDamage_CountDifferences_FreeRemainingResources;
+			}
+
+			lengths[at_index] = (size_t)among_of_read;
+			file_ended[at_index] = (lengths[at_index] < compare_buffer_size);
+			if (!size_is_known[at_index]) file_sizes[at_index] += among_of_read;
+		}
+
+
+
+		at_position = 0;
+
+		for (size_t compare_index = 0; compare_index < number_of_files; compare_index += 1)
+		{
+			for (size_t compare_with_index = compare_index + 1; compare_with_index < number_of_files; compare_with_index += 1, at_position += 1)
+			{
+				struct PairDamage* damage = &damages[at_position];
+
+				if (compare_with_first && compare_index != 0) continue;
+				else if (damage->_reached_threshold) continue;
+
+				size_t common_length = (lengths[compare_index] < lengths[compare_with_index]) ? lengths[compare_index] : lengths[compare_with_index];
+				size_t longer_length = (lengths[compare_index] > lengths[compare_with_index]) ? lengths[compare_index] : lengths[compare_with_index];
+
+				size_t differing_bytes = CmpKernel_CountDifferences(buffers[compare_index], buffers[compare_with_index], common_length,
+																									count_bits ? &damage->_differing_bits : NULL);
+
+				differing_bytes += longer_length - common_length;
+				if (count_bits) damage->_differing_bits += 8ULL * (longer_length - common_length);
+
+				if (differing_bytes == 0) continue;
+
+				damage->_differing_bytes += (long long)differing_bytes;
+				damage->_differing_blocks += 1;
+				damage->_reached_threshold = (threshold > 0 && damage->_differing_bytes >= threshold);
+			}
+		}
+	}
+
+
+
+	bool is_first_pair = true;
+	size_t at_position = 0;
+	*all_matched = true;
+
+	if (output_format == OUTPUT_JSON) fputs("{\"pairs\":[", output);
+	else if (output_format == OUTPUT_CSV) fputs("filepath,with_filepath,state,differing_bytes,differing_blocks,differing_bits,similarity,reached_threshold\n", output);
+
+	for (size_t compare_index = 0; compare_index < number_of_files; compare_index += 1)
+	{
+		for (size_t compare_with_index = compare_index + 1; compare_with_index < number_of_files; compare_with_index += 1, at_position += 1)
+		{
+			if (compare_with_first && compare_index != 0) continue;
+
+			const struct PairDamage* damage = &damages[at_position];
+			double similarity = GetSimilarity(damage, file_sizes, compare_index, compare_with_index);
+
+			*all_matched = *all_matched && (damage->_differing_bytes == 0);
+
+			if (output_format == OUTPUT_TEXT)
+			{
+				WritePairAsText(output, filepaths[compare_index], filepaths[compare_with_index], damage, similarity, count_bits);
+			}
+			else if (output_format == OUTPUT_JSON)
+			{
+				if (!is_first_pair) fputc(',', output);
+				WritePairAsJson(output, filepaths[compare_index], filepaths[compare_with_index], damage, similarity, count_bits);
+			}
+			else
+			{
+				WritePairAsCsv(output, filepaths[compare_index], filepaths[compare_with_index], damage, similarity, count_bits);
+			}
+
+			is_first_pair = false;
+		}
+	}
+
+	if (output_format == OUTPUT_JSON) fprintf(output, "],\"all_matched\":%s}\n", *all_matched ? "true" : "false");
+
+	differences_were_counted = (ferror(output) == 0);
+
+
+
+	__CmpDamage_CountDifferences_FreeRemainingResources:
+		for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+		{
+			if (files != NULL) CmpIo_Close(files[at_index]);
+			if (buffers != NULL) free(buffers[at_index]);
+		}
+
+		free(files);
+		free(buffers);
+		free(lengths);
+		free(file_sizes);
+		free(size_is_known);
+		free(file_ended);
+		free(file_is_needed);
+		free(devices);
+		free(damages);
+
+	return differences_were_counted;
+}
@@ -0,0 +1,609 @@
+/*!
+ *	Source file, implementing the scheduling of the reads of the compared files by the devices, that they are stored on.
+ *
+ *	\file				cmpdevice_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For pread and the thread functions.
+
+
+
+#include "cmpdevice_handler.h"
+#include "cmptrace_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif
+
+
+
+const size_t DEVICE_BURST_SIZE = 4 * 1024 * 1024;
+const size_t MAXIMUM_BURST_SIZE = 64 * 1024 * 1024;
+
+
+
+#ifdef __linux__
+
+/*!
+ * 	The burst of a single file: a range of the file, that was read ahead.
+ * */
+struct FileBurst
+{
+	int _file_descriptor;
+
+	/*!
+	 * 	The index of the device group, that the file is read by, or SIZE_MAX, if the file isn't scheduled.
+	 * */
+	size_t _device_group;
+
+	unsigned char* _data;
+	size_t _burst_size;
+
+	/*!
+	 * 	The offset of the read range, or -1, if nothing was read yet.
+	 * */
+	long long _burst_offset;
+
+	/*!
+	 * 	The number of bytes, that were read. Less than _burst_size means, that the end of the file was reached.
+	 * */
+	size_t _burst_length;
+
+	/*!
+	 * 	If the last read of the burst failed.
+	 * */
+	bool _read_failed;
+
+	/*!
+	 * 	The offset of the requested block, or -1, if no block was requested.
+	 * */
+	long long _requested_offset;
+
+	/*!
+	 * 	The offset, that no burst reads past (like the end of a compared region of the file), or -1, if it is read till its end.
+	 * */
+	long long _read_end;
+};
+
+/*!
+ * 	The files of a single device, that are read one after another by the same thread.
+ * */
+struct DeviceGroup
+{
+	struct DeviceScheduler* _scheduler;
+	unsigned long long _device;
+	bool _is_rotational;
+	size_t _among_of_files;
+	pthread_t _thread;
+	bool _is_started;
+};
+
+struct DeviceScheduler
+{
+	struct FileBurst* _file_bursts;
+	size_t _number_of_files;
+	size_t _block_size;
+
+	struct DeviceGroup* _device_groups;
+	size_t _among_of_groups;
+
+	struct IoThrottle* _throttle;
+
+	/*!
+	 * 	Guards the fields below. The reader threads of all device groups (except the first one, which is read by the calling thread)
+	 * 	wait for a new generation, read the requested bursts of their files, and count down the pending groups.
+	 * */
+	pthread_mutex_t _lock;
+	pthread_cond_t _work_condition;
+	pthread_cond_t _done_condition;
+	unsigned long long _generation;
+	size_t _among_of_pending_groups;
+	bool _is_stopping;
+};
+
+
+
+/* Static functions. */
+
+/*!
+ * 	Checks the queue of the block device in sysfs. A partition has no queue of its own, so the one of its disk is used.
+ * 	Devices without a queue (like tmpfs or network file systems) aren't rotational.
+ * */
+static bool IsRotational(unsigned long long device)
+{
+	static const char* QUEUE_PATHS[] = {"/sys/dev/block/%u:%u/queue/rotational", "/sys/dev/block/%u:%u/../queue/rotational"};
+
+	for (size_t at_path = 0; at_path < sizeof(QUEUE_PATHS) / sizeof(QUEUE_PATHS[0]); at_path += 1)
+	{
+		char queue_path[96];
+		snprintf(queue_path, sizeof(queue_path), QUEUE_PATHS[at_path], major((dev_t)device), minor((dev_t)device));
+
+		FILE* queue_file = fopen(queue_path, "r");
+		if (queue_file == NULL) continue;
+
+		int is_rotational = fgetc(queue_file);
+		fclose(queue_file);
+
+		return is_rotational == '1';
+	}
+
+	return false;
+}
+
+
+
+/*!
+ * 	Checks, if the burst contains the whole block (or the end of the file, that the block is cut off by).
+ * */
+static bool BurstContains(const struct FileBurst* file_burst, long long offset, size_t block_length)
+{
+	if (file_burst->_burst_offset < 0 || file_burst->_read_failed || offset < file_burst->_burst_offset) return false;
+
+	long long burst_end = file_burst->_burst_offset + (long long)file_burst->_burst_length;
+	bool reached_end_of_file = file_burst->_burst_length < file_burst->_burst_size;
+
+	return (offset + (long long)block_length <= burst_end) || (reached_end_of_file && offset <= burst_end);
+}
+
+/*!
+ * 	A burst, that is cut off by the read end of its file, is shorter, so it counts as one, that reached the end of the file.
+ * */
+static void ReadBurst(struct DeviceScheduler* scheduler, struct FileBurst* file_burst, long long offset)
+{
+	size_t read_size = file_burst->_burst_size;
+
+	if (file_burst->_read_end >= 0 && offset + (long long)read_size > file_burst->_read_end)
+	{
+		read_size = (offset < file_burst->_read_end) ? (size_t)(file_burst->_read_end - offset) : 0;
+	}
+
+	if (scheduler->_throttle != NULL) CmpThrottle_Acquire(scheduler->_throttle, scheduler->_device_groups[file_burst->_device_group]._device, read_size);
+
+	long long trace_time = CmpTrace_Begin();
+	size_t bytes_read = 0;
+	file_burst->_read_failed = false;
+
+	while (bytes_read < read_size)
+	{
+		ssize_t read_result = pread(file_burst->_file_descriptor, file_burst->_data + bytes_read, read_size - bytes_read, offset + (off_t)bytes_read);
+
+		if (read_result < 0 && errno == EINTR) continue;
+		else if (read_result < 0)
+		{
+			file_burst->_read_failed = true;
+			break;
+		}
+		else if (read_result == 0) break;
+
+		bytes_read += (size_t)read_result;
+	}
+
+	file_burst->_burst_offset = offset;
+	file_burst->_burst_length = bytes_read;
+	
+	CmpTrace_End("burst", "io", trace_time, (long long)(file_burst - scheduler->_file_bursts), offset, NULL);
+}
+
+/*!
+ * 	Reads the requested bursts of the files of a device group, one file after another.
+ * */
+static void ReadRequestedBursts(struct DeviceScheduler* scheduler, size_t device_group)
+{
+	for (size_t at_index = 0; at_index < scheduler->_number_of_files; at_index += 1)
+	{
+		struct FileBurst* file_burst = &scheduler->_file_bursts[at_index];
+
+		if (file_burst->_device_group != device_group || file_burst->_requested_offset < 0) continue;
+
+		if (!BurstContains(file_burst, file_burst->_requested_offset, scheduler->_block_size)) ReadBurst(scheduler, file_burst, file_burst->_requested_offset);
+
+		file_burst->_requested_offset = -1;
+	}
+}
+
+static void* ReadDeviceGroup(void* argument)
+{
+	struct DeviceGroup* device_group = argument;
+	struct DeviceScheduler* scheduler = device_group->_scheduler;
+	size_t group_index = (size_t)(device_group - scheduler->_device_groups);
+	unsigned long long handled_generation = 0;
+
+	pthread_mutex_lock(&scheduler->_lock);
+
+	while (true)
+	{
+		while (!scheduler->_is_stopping && scheduler->_generation == handled_generation) pthread_cond_wait(&scheduler->_work_condition, &scheduler->_lock);
+
+		if (scheduler->_is_stopping) break;
+
+		handled_generation = scheduler->_generation;
+		pthread_mutex_unlock(&scheduler->_lock);
+
+		ReadRequestedBursts(scheduler, group_index);
+
+		pthread_mutex_lock(&scheduler->_lock);
+		scheduler->_among_of_pending_groups -= 1;
+		if (scheduler->_among_of_pending_groups == 0) pthread_cond_signal(&scheduler->_done_condition);
+	}
+
+	pthread_mutex_unlock(&scheduler->_lock);
+
+	return NULL;
+}
+
+
+
+/*!
+ * 	Sorts the scheduled files into device groups, and sets the burst sizes by the among of files per device.
+ * */
+static bool GroupByDevices(struct DeviceScheduler* scheduler, const int* file_descriptors)
+{
+	for (size_t at_index = 0; at_index < scheduler->_number_of_files; at_index += 1)
+	{
+		struct FileBurst* file_burst = &scheduler->_file_bursts[at_index];
+		struct stat file_status;
+
+		if (file_descriptors[at_index] < 0 || fstat(file_descriptors[at_index], &file_status) != 0 || !S_ISREG(file_status.st_mode)) continue;
+
+		size_t group_index = 0;
+		while (group_index < scheduler->_among_of_groups && scheduler->_device_groups[group_index]._device != (unsigned long long)file_status.st_dev) group_index += 1;
+
+		if (group_index == scheduler->_among_of_groups)
+		{
+			struct DeviceGroup* device_group = &scheduler->_device_groups[group_index];
+
+			device_group->_scheduler = scheduler;
+			device_group->_device = (unsigned long long)file_status.st_dev;
+			device_group->_is_rotational = IsRotational(device_group->_device);
+			device_group->_among_of_files = 0;
+			device_group->_is_started = false;
+			scheduler->_among_of_groups += 1;
+		}
+
+		file_burst->_file_descriptor = file_descriptors[at_index];
+		file_burst->_device_group = group_index;
+		scheduler->_device_groups[group_index]._among_of_files += 1;
+	}
+
+
+
+	for (size_t at_index = 0; at_index < scheduler->_number_of_files; at_index += 1)
+	{
+		struct FileBurst* file_burst = &scheduler->_file_bursts[at_index];
+		if (file_burst->_device_group == SIZE_MAX) continue;
+
+		const struct DeviceGroup* device_group = &scheduler->_device_groups[file_burst->_device_group];
+		size_t burst_size = scheduler->_block_size;
+
+		//	The burst is kept a multiple of the block size, so that no block is split between two bursts.
+		if (device_group->_is_rotational && device_group->_among_of_files > 1)
+		{
+			size_t wanted_size = DEVICE_BURST_SIZE * device_group->_among_of_files;
+			if (wanted_size > MAXIMUM_BURST_SIZE) wanted_size = MAXIMUM_BURST_SIZE;
+
+			size_t blocks_per_burst = wanted_size / scheduler->_block_size;
+			if (blocks_per_burst > 1) burst_size = blocks_per_burst * scheduler->_block_size;
+		}
+
+		file_burst->_burst_size = burst_size;
+		file_burst->_data = malloc(burst_size);
+		if (file_burst->_data == NULL) return false;
+	}
+
+	return true;
+}
+
+#endif
+
+
+
+
+
+
+/* Implemented functions. */
+
+struct DeviceScheduler* CmpDevice_Initialize(const int* file_descriptors, size_t number_of_files, size_t block_size)
+{
+	#ifdef __linux__
+	if (file_descriptors == NULL || number_of_files == 0 || block_size == 0) return NULL;
+
+
+
+	struct DeviceScheduler* scheduler = malloc(sizeof(struct DeviceScheduler));
+	if (scheduler == NULL) return NULL;
+
+	scheduler->_number_of_files = number_of_files;
+	scheduler->_block_size = block_size;
+	scheduler->_among_of_groups = 0;
+	scheduler->_throttle = NULL;
+	scheduler->_generation = 0;
+	scheduler->_among_of_pending_groups = 0;
+	scheduler->_is_stopping = false;
+	scheduler->_file_bursts = calloc(number_of_files, sizeof(struct FileBurst));
+	scheduler->_device_groups = calloc(number_of_files, sizeof(struct DeviceGroup));
+
+	if (pthread_mutex_init(&scheduler->_lock, NULL) != 0)
+	{
+		free(scheduler->_file_bursts);
+		free(scheduler->_device_groups);
+		free(scheduler);
+		return NULL;
+	}
+
+	pthread_cond_init(&scheduler->_work_condition, NULL);
+	pthread_cond_init(&scheduler->_done_condition, NULL);
+
+	if (scheduler->_file_bursts == NULL || scheduler->_device_groups == NULL) goto __CmpDevice_Initialize_FreeRemainingResources;
+
+	for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+	{
+		scheduler->_file_bursts[at_index]._file_descriptor = -1;
+		scheduler->_file_bursts[at_index]._device_group = SIZE_MAX;
+		scheduler->_file_bursts[at_index]._burst_offset = -1;
+		scheduler->_file_bursts[at_index]._requested_offset = -1;
+		scheduler->_file_bursts[at_index]._read_end = -1;
+	}
+
+	if (!GroupByDevices(scheduler, file_descriptors)) goto __CmpDevice_Initialize_FreeRemainingResources;
+
+
+
+	//	The first device group is read by the calling thread.
+	for (size_t at_group = 1; at_group < scheduler->_among_of_groups; at_group += 1)
+	{
+		struct DeviceGroup* device_group = &scheduler->_device_groups[at_group];
+
+		device_group->_is_started = pthread_create(&device_group->_thread, NULL, ReadDeviceGroup, device_group) == 0;
+		if (!device_group->_is_started) goto __CmpDevice_Initialize_FreeRemainingResources;
+	}
+
+	return scheduler;
+
+
+
+	__CmpDevice_Initialize_FreeRemainingResources:
+		fputs("Error in CmpDevice_Initialize: Couldn't allocate all resources!\n", stderr);
+		CmpDevice_Terminate(scheduler);
+
+	return NULL;
+	#else
+	(void)file_descriptors;
+	(void)number_of_files;
+	(void)block_size;
+	return NULL;
+	#endif
+}
+
+
+
+void CmpDevice_Terminate(struct DeviceScheduler* scheduler)
+{
+	#ifdef __linux__
+	if (scheduler == NULL) return;
+
+	pthread_mutex_lock(&scheduler->_lock);
+	scheduler->_is_stopping = true;
+	pthread_cond_broadcast(&scheduler->_work_condition);
+	pthread_mutex_unlock(&scheduler->_lock);
+
+	for (size_t at_group = 0; at_group < scheduler->_among_of_groups && scheduler->_device_groups != NULL; at_group += 1)
+	{
+		if (scheduler->_device_groups[at_group]._is_started) pthread_join(scheduler->_device_groups[at_group]._thread, NULL);
+	}
+
+	for (size_t at_index = 0; at_index < scheduler->_number_of_files && scheduler->_file_bursts != NULL; at_index += 1)
+	{
+		free(scheduler->_file_bursts[at_index]._data);
+	}
+
+	pthread_cond_destroy(&scheduler->_work_condition);
+	pthread_cond_destroy(&scheduler->_done_condition);
+	pthread_mutex_destroy(&scheduler->_lock);
+	free(scheduler->_file_bursts);
+	free(scheduler->_device_groups);
+	free(scheduler);
+	#else
+	(void)scheduler;
+	#endif
+}
+
+
+
+void CmpDevice_SetThrottle(struct DeviceScheduler* scheduler, struct IoThrottle* throttle)
+{
+	#ifdef __linux__
+	if (scheduler != NULL) scheduler->_throttle = throttle;
+	#else
+	(void)scheduler;
+	(void)throttle;
+	#endif
+}
+
+
+
+bool CmpDevice_IsScheduled(const struct DeviceScheduler* scheduler, size_t file_index)
+{
+	#ifdef __linux__
+	if (scheduler == NULL || file_index >= scheduler->_number_of_files) return false;
+
+	return scheduler->_file_bursts[file_index]._device_group != SIZE_MAX && scheduler->_file_bursts[file_index]._file_descriptor >= 0;
+	#else
+	(void)scheduler;
+	(void)file_index;
+	return false;
+	#endif
+}
+
+
+
+void CmpDevice_RequestBlock(struct DeviceScheduler* scheduler, size_t file_index, long long offset)
+{
+	#ifdef __linux__
+	if (CmpDevice_IsScheduled(scheduler, file_index)) scheduler->_file_bursts[file_index]._requested_offset = offset;
+	#else
+	(void)scheduler;
+	(void)file_index;
+	(void)offset;
+	#endif
+}
+
+
+
+/*!
+ * 	The reader threads are only woken up, if the requested bursts span more than one device.
+ * 	Otherwise, the single device is read by the calling thread, without any synchronization.
+ * */
+void CmpDevice_Prefetch(struct DeviceScheduler* scheduler)
+{
+	#ifdef __linux__
+	if (scheduler == NULL) return;
+
+
+
+	size_t first_group = SIZE_MAX;
+	bool spans_devices = false;
+
+	for (size_t at_index = 0; at_index < scheduler->_number_of_files; at_index += 1)
+	{
+		struct FileBurst* file_burst = &scheduler->_file_bursts[at_index];
+		if (file_burst->_requested_offset < 0) continue;
+
+		if (BurstContains(file_burst, file_burst->_requested_offset, scheduler->_block_size))
+		{
+			file_burst->_requested_offset = -1;
+			continue;
+		}
+
+		if (first_group == SIZE_MAX) first_group = file_burst->_device_group;
+		else if (first_group != file_burst->_device_group) spans_devices = true;
+	}
+
+	if (first_group == SIZE_MAX) return;
+	else if (!spans_devices)
+	{
+		ReadRequestedBursts(scheduler, first_group);
+		return;
+	}
+
+
+
+	pthread_mutex_lock(&scheduler->_lock);
+	scheduler->_generation += 1;
+	scheduler->_among_of_pending_groups = scheduler->_among_of_groups - 1;
+	pthread_cond_broadcast(&scheduler->_work_condition);
+	pthread_mutex_unlock(&scheduler->_lock);
+
+	ReadRequestedBursts(scheduler, 0);
+
+	long long trace_time = CmpTrace_Begin();
+
+	pthread_mutex_lock(&scheduler->_lock);
+	while (scheduler->_among_of_pending_groups > 0) pthread_cond_wait(&scheduler->_done_condition, &scheduler->_lock);
+	pthread_mutex_unlock(&scheduler->_lock);
+
+	CmpTrace_End("wait for devices", "io", trace_time, -1, -1, NULL);
+	#else
+	(void)scheduler;
+	#endif
+}
+
+
+
+bool CmpDevice_ReadBlock(struct DeviceScheduler* scheduler, size_t file_index, long long offset, unsigned char* buffer, size_t block_length, size_t* bytes_read)
+{
+	#ifdef __linux__
+	if (!CmpDevice_IsScheduled(scheduler, file_index) || buffer == NULL || bytes_read == NULL || offset < 0) return false;
+
+
+
+	struct FileBurst* file_burst = &scheduler->_file_bursts[file_index];
+
+	if (!BurstContains(file_burst, offset, block_length)) ReadBurst(scheduler, file_burst, offset);
+	if (file_burst->_read_failed) return false;
+
+	long long burst_end = file_burst->_burst_offset + (long long)file_burst->_burst_length;
+	size_t bytes_left = (size_t)(burst_end - offset);
+
+	*bytes_read = (bytes_left < block_length) ? bytes_left : block_length;
+	memcpy(buffer, file_burst->_data + (offset - file_burst->_burst_offset), *bytes_read);
+
+	return true;
+	#else
+	(void)scheduler;
+	(void)file_index;
+	(void)offset;
+	(void)buffer;
+	(void)block_length;
+	(void)bytes_read;
+	return false;
+	#endif
+}
+
+
+
+void CmpDevice_DiscardBursts(struct DeviceScheduler* scheduler)
+{
+	#ifdef __linux__
+	if (scheduler == NULL) return;
+
+	for (size_t at_index = 0; at_index < scheduler->_number_of_files; at_index += 1)
+	{
+		scheduler->_file_bursts[at_index]._burst_offset = -1;
+		scheduler->_file_bursts[at_index]._requested_offset = -1;
+	}
+	#else
+	(void)scheduler;
+	#endif
+}
+
+
+
+void CmpDevice_LimitFile(struct DeviceScheduler* scheduler, size_t file_index, long long read_end)
+{
+	#ifdef __linux__
+	if (scheduler == NULL || file_index >= scheduler->_number_of_files) return;
+
+	scheduler->_file_bursts[file_index]._read_end = (read_end >= 0) ? read_end : -1;
+	scheduler->_file_bursts[file_index]._burst_offset = -1;
+	scheduler->_file_bursts[file_index]._requested_offset = -1;
+	#else
+	(void)scheduler;
+	(void)file_index;
+	(void)read_end;
+	#endif
+}
+
+
+
+void CmpDevice_ReplaceFile(struct DeviceScheduler* scheduler, size_t file_index, int file_descriptor)
+{
+	#ifdef __linux__
+	if (scheduler == NULL || file_index >= scheduler->_number_of_files) return;
+
+	//	The file stays in its device group, even if it was replaced by one on another device.
+	scheduler->_file_bursts[file_index]._file_descriptor = file_descriptor;
+	scheduler->_file_bursts[file_index]._burst_offset = -1;
+	scheduler->_file_bursts[file_index]._requested_offset = -1;
+	#else
+	(void)scheduler;
+	(void)file_index;
+	(void)file_descriptor;
+	#endif
+}
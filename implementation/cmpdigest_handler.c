@@ -0,0 +1,666 @@
+/*!
+ *	Source file, implementing the writing of a manifest with the digests of the blocks of the compared files,
+ *	by a thread, that digests the blocks, while the next ones are read.
+ *
+ *	\file				cmpdigest_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For the thread functions.
+
+
+
+#include "cmpfiles_handler.h"
+#include "cmpdigest_handler.h"
+#include "cmptrace_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+
+
+/*!
+ * 	The first line of every manifest, including the version of its format.
+ * */
+static const char* MANIFEST_SIGNATURE = "CMPFILES-MANIFEST 1";
+
+/*!
+ * 	The among of blocks, that can wait to be digested, before the comparing waits for the digesting.
+ * */
+#define DIGEST_QUEUE_LENGTH 4
+
+static const uint64_t XXH64_PRIME_1 = 11400714785074694791ULL;
+static const uint64_t XXH64_PRIME_2 = 14029467366897019727ULL;
+static const uint64_t XXH64_PRIME_3 = 1609587929392839161ULL;
+static const uint64_t XXH64_PRIME_4 = 9650029242287828579ULL;
+static const uint64_t XXH64_PRIME_5 = 2870177450012600261ULL;
+
+static const uint32_t SHA256_ROUND_CONSTANTS[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+
+
+/*!
+ * 	A compared block, that waits to be digested and written, with the lines, that have to be written before it.
+ * */
+struct DigestJob
+{
+	long long _block_offset;
+
+	/*!
+	 * 	The range of blocks before this one, that were skipped, since all compared files had holes there, or a zero length.
+	 * */
+	long long _zeros_offset;
+	long long _zeros_length;
+
+	/*!
+	 * 	Per file: the class of the file, if the classes changed with this block (the array is then written before it).
+	 * */
+	size_t* _file_classes;
+	bool _classes_changed;
+
+	/*!
+	 * 	Per class: the block of its representative, one after another, and its length.
+	 * */
+	unsigned char* _blocks;
+	size_t* _block_lengths;
+	size_t _among_of_classes;
+};
+
+struct DigestManifest
+{
+	FILE* _manifest;
+	enum DigestAlgorithm _algorithm;
+	struct FilesToCompare* _handler;
+	size_t _number_of_files;
+	size_t _block_size;
+
+	/*!
+	 * 	Per file: its class in the last written block, or SIZE_MAX, if it wasn't compared in it.
+	 * */
+	size_t* _file_classes;
+	size_t* _group_classes;
+	size_t* _class_representatives;
+
+	/*!
+	 * 	The offset, at which the next block is expected. A block further on means, that the blocks in between were skipped.
+	 * */
+	long long _next_block_offset;
+
+	/*!
+	 * 	Used only by the digesting: the first file of each class, and the next file of the same class per file.
+	 * */
+	size_t* _first_class_files;
+	size_t* _next_class_files;
+
+	struct DigestJob _jobs[DIGEST_QUEUE_LENGTH];
+	size_t _first_queued_job;
+	size_t _among_of_queued_jobs;
+	bool _write_failed;
+
+	#ifdef __linux__
+	/*!
+	 * 	Guards the queue of the jobs. The comparing fills the next free job, and the digesting thread empties the first queued one.
+	 * */
+	pthread_mutex_t _lock;
+	pthread_cond_t _queued_condition;
+	pthread_cond_t _emptied_condition;
+	pthread_t _thread;
+	bool _is_started;
+	bool _is_stopping;
+	#endif
+};
+
+
+
+/* Static functions. */
+
+static uint64_t RotateLeft64(uint64_t value, unsigned int by_bits)
+{
+	return (value << by_bits) | (value >> (64 - by_bits));
+}
+
+static uint32_t RotateRight32(uint32_t value, unsigned int by_bits)
+{
+	return (value >> by_bits) | (value << (32 - by_bits));
+}
+
+static uint64_t LoadLittleEndian(const unsigned char* data, size_t among_of_bytes)
+{
+	uint64_t value = 0;
+	for (size_t at_byte = among_of_bytes; at_byte > 0; at_byte -= 1) value = (value << 8) | data[at_byte - 1];
+	return value;
+}
+
+static uint64_t Xxh64Round(uint64_t lane, uint64_t word)
+{
+	lane += word * XXH64_PRIME_2;
+	lane = RotateLeft64(lane, 31);
+	return lane * XXH64_PRIME_1;
+}
+
+static uint64_t Xxh64MergeLane(uint64_t hash, uint64_t lane)
+{
+	hash ^= Xxh64Round(0, lane);
+	return hash * XXH64_PRIME_1 + XXH64_PRIME_4;
+}
+
+/*!
+ * 	The reference XXH64 algorithm with the seed 0: 4 lanes over 32 byte stripes, merged, followed by the remaining bytes and the avalanche.
+ * */
+static uint64_t Xxh64(const unsigned char* data, size_t length)
+{
+	size_t at_byte = 0;
+	uint64_t hash;
+
+	if (length >= 32)
+	{
+		uint64_t lanes[4] = {XXH64_PRIME_1 + XXH64_PRIME_2, XXH64_PRIME_2, 0, 0 - XXH64_PRIME_1};
+
+		for (; at_byte + 32 <= length; at_byte += 32)
+		{
+			for (size_t at_lane = 0; at_lane < 4; at_lane += 1) lanes[at_lane] = Xxh64Round(lanes[at_lane], LoadLittleEndian(data + at_byte + at_lane * 8, 8));
+		}
+
+		hash = RotateLeft64(lanes[0], 1) + RotateLeft64(lanes[1], 7) + RotateLeft64(lanes[2], 12) + RotateLeft64(lanes[3], 18);
+		for (size_t at_lane = 0; at_lane < 4; at_lane += 1) hash = Xxh64MergeLane(hash, lanes[at_lane]);
+	}
+	else
+	{
+		hash = XXH64_PRIME_5;
+	}
+
+	hash += (uint64_t)length;
+
+	for (; at_byte + 8 <= length; at_byte += 8)
+	{
+		hash ^= Xxh64Round(0, LoadLittleEndian(data + at_byte, 8));
+		hash = RotateLeft64(hash, 27) * XXH64_PRIME_1 + XXH64_PRIME_4;
+	}
+
+	if (at_byte + 4 <= length)
+	{
+		hash ^= LoadLittleEndian(data + at_byte, 4) * XXH64_PRIME_1;
+		hash = RotateLeft64(hash, 23) * XXH64_PRIME_2 + XXH64_PRIME_3;
+		at_byte += 4;
+	}
+
+	for (; at_byte < length; at_byte += 1)
+	{
+		hash ^= data[at_byte] * XXH64_PRIME_5;
+		hash = RotateLeft64(hash, 11) * XXH64_PRIME_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= XXH64_PRIME_2;
+	hash ^= hash >> 29;
+	hash *= XXH64_PRIME_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+
+
+static void Sha256Compress(uint32_t* state, const unsigned char* chunk)
+{
+	uint32_t words[64];
+
+	for (size_t at_word = 0; at_word < 16; at_word += 1)
+	{
+		words[at_word] = ((uint32_t)chunk[at_word * 4] << 24) | ((uint32_t)chunk[at_word * 4 + 1] << 16) | ((uint32_t)chunk[at_word * 4 + 2] << 8) | (uint32_t)chunk[at_word * 4 + 3];
+	}
+
+	for (size_t at_word = 16; at_word < 64; at_word += 1)
+	{
+		uint32_t sigma_0 = RotateRight32(words[at_word - 15], 7) ^ RotateRight32(words[at_word - 15], 18) ^ (words[at_word - 15] >> 3);
+		uint32_t sigma_1 = RotateRight32(words[at_word - 2], 17) ^ RotateRight32(words[at_word - 2], 19) ^ (words[at_word - 2] >> 10);
+		words[at_word] = words[at_word - 16] + sigma_0 + words[at_word - 7] + sigma_1;
+	}
+
+	uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+	for (size_t at_round = 0; at_round < 64; at_round += 1)
+	{
+		uint32_t sum_1 = RotateRight32(e, 6) ^ RotateRight32(e, 11) ^ RotateRight32(e, 25);
+		uint32_t choice = (e & f) ^ (~e & g);
+		uint32_t first_temporary = h + sum_1 + choice + SHA256_ROUND_CONSTANTS[at_round] + words[at_round];
+		uint32_t sum_0 = RotateRight32(a, 2) ^ RotateRight32(a, 13) ^ RotateRight32(a, 22);
+		uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+		uint32_t second_temporary = sum_0 + majority;
+
+		h = g;
+		g = f;
+		f = e;
+		e = d + first_temporary;
+		d = c;
+		c = b;
+		b = a;
+		a = first_temporary + second_temporary;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+/*!
+ * 	The whole 64 byte chunks are compressed straight from the data, and only the last one or two chunks, with the padding and the bit length, are copied.
+ * */
+static void Sha256(const unsigned char* data, size_t length, unsigned char* digest)
+{
+	uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+	size_t at_byte = 0;
+
+	for (; at_byte + 64 <= length; at_byte += 64) Sha256Compress(state, data + at_byte);
+
+
+
+	unsigned char last_chunks[128] = {0};
+	size_t remaining_length = length - at_byte;
+	size_t last_length = (remaining_length < 56) ? 64 : 128;
+	uint64_t bit_length = (uint64_t)length * 8;
+
+	memcpy(last_chunks, data + at_byte, remaining_length);
+	last_chunks[remaining_length] = 0x80;
+	for (size_t at_position = 0; at_position < 8; at_position += 1) last_chunks[last_length - 1 - at_position] = (unsigned char)(bit_length >> (at_position * 8));
+
+	for (size_t at_chunk = 0; at_chunk < last_length; at_chunk += 64) Sha256Compress(state, last_chunks + at_chunk);
+
+	for (size_t at_word = 0; at_word < 8; at_word += 1)
+	{
+		for (size_t at_position = 0; at_position < 4; at_position += 1) digest[at_word * 4 + at_position] = (unsigned char)(state[at_word] >> (24 - at_position * 8));
+	}
+}
+
+
+
+/*!
+ * 	Writes the classes of the files: the classes are separated by spaces, and the indexes of the files in a class by commas.
+ * */
+static void WriteClasses(struct DigestManifest* manifest, const struct DigestJob* job)
+{
+	for (size_t at_class = 0; at_class < job->_among_of_classes; at_class += 1) manifest->_first_class_files[at_class] = SIZE_MAX;
+
+	for (size_t at_index = manifest->_number_of_files; at_index > 0; at_index -= 1)
+	{
+		size_t file_class = job->_file_classes[at_index - 1];
+		if (file_class == SIZE_MAX) continue;
+
+		manifest->_next_class_files[at_index - 1] = manifest->_first_class_files[file_class];
+		manifest->_first_class_files[file_class] = at_index - 1;
+	}
+
+	fputs("classes", manifest->_manifest);
+
+	for (size_t at_class = 0; at_class < job->_among_of_classes; at_class += 1)
+	{
+		for (size_t at_index = manifest->_first_class_files[at_class]; at_index != SIZE_MAX; at_index = manifest->_next_class_files[at_index])
+		{
+			fprintf(manifest->_manifest, "%c%zu", (at_index == manifest->_first_class_files[at_class]) ? ' ' : ',', at_index);
+		}
+	}
+
+	fputc('\n', manifest->_manifest);
+}
+
+/*!
+ * 	Writes the lines of a job: the skipped zeros and the changed classes first, and then the digest of each class
+ * 	(followed by the length of its block, if it is shorter than a whole block).
+ * */
+static void DigestJob(struct DigestManifest* manifest, const struct DigestJob* job)
+{
+	long long trace_time = CmpTrace_Begin();
+
+	if (job->_zeros_length > 0) fprintf(manifest->_manifest, "zeros %lld %lld\n", job->_zeros_offset, job->_zeros_length);
+	if (job->_classes_changed) WriteClasses(manifest, job);
+
+	fprintf(manifest->_manifest, "block %lld", job->_block_offset);
+
+	for (size_t at_class = 0; at_class < job->_among_of_classes; at_class += 1)
+	{
+		char digest_text[65];
+		CmpDigest_Calculate(manifest->_algorithm, job->_blocks + at_class * manifest->_block_size, job->_block_lengths[at_class], digest_text);
+
+		if (job->_block_lengths[at_class] == manifest->_block_size) fprintf(manifest->_manifest, " %s", digest_text);
+		else fprintf(manifest->_manifest, " %s:%zu", digest_text, job->_block_lengths[at_class]);
+	}
+
+	fputc('\n', manifest->_manifest);
+
+	if (ferror(manifest->_manifest) != 0) manifest->_write_failed = true;
+
+	CmpTrace_End("digest", "digest", trace_time, -1, job->_block_offset, NULL);
+}
+
+
+
+#ifdef __linux__
+/*!
+ * 	Digests the queued jobs in their order, till the manifest is finished.
+ * */
+static void* DigestQueuedJobs(void* argument)
+{
+	struct DigestManifest* manifest = argument;
+
+	pthread_mutex_lock(&manifest->_lock);
+
+	while (true)
+	{
+		while (manifest->_among_of_queued_jobs == 0 && !manifest->_is_stopping) pthread_cond_wait(&manifest->_queued_condition, &manifest->_lock);
+
+		if (manifest->_among_of_queued_jobs == 0) break;
+
+		struct DigestJob* job = &manifest->_jobs[manifest->_first_queued_job];
+
+		pthread_mutex_unlock(&manifest->_lock);
+		DigestJob(manifest, job);
+		pthread_mutex_lock(&manifest->_lock);
+
+		manifest->_first_queued_job = (manifest->_first_queued_job + 1) % DIGEST_QUEUE_LENGTH;
+		manifest->_among_of_queued_jobs -= 1;
+		pthread_cond_signal(&manifest->_emptied_condition);
+	}
+
+	pthread_mutex_unlock(&manifest->_lock);
+
+	return NULL;
+}
+#endif
+
+
+
+/*!
+ * 	Called after each compared block. The files, that are still compared, are put into classes by their groups
+ * 	(numbered in the order of their first files), and the block of the first file of each class is copied into the next free job.
+ * 	Blocks in holes aren't in the buffers, so zeros are copied instead.
+ * */
+static void QueueBlock(struct FilesToCompare* handler, void* context)
+{
+	struct DigestManifest* manifest = context;
+
+
+
+	#ifdef __linux__
+	pthread_mutex_lock(&manifest->_lock);
+	while (manifest->_among_of_queued_jobs == DIGEST_QUEUE_LENGTH) pthread_cond_wait(&manifest->_emptied_condition, &manifest->_lock);
+	pthread_mutex_unlock(&manifest->_lock);
+	#endif
+
+	struct DigestJob* job = &manifest->_jobs[(manifest->_first_queued_job + manifest->_among_of_queued_jobs) % DIGEST_QUEUE_LENGTH];
+
+
+
+	size_t among_of_classes = 0;
+
+	for (size_t at_index = 0; at_index < manifest->_number_of_files; at_index += 1)
+	{
+		if (handler->_file_states[at_index] == FILE_COMPARING) manifest->_group_classes[handler->_group_ids[at_index]] = SIZE_MAX;
+	}
+
+	job->_classes_changed = false;
+
+	for (size_t at_index = 0; at_index < manifest->_number_of_files; at_index += 1)
+	{
+		size_t file_class = SIZE_MAX;
+
+		if (handler->_file_states[at_index] == FILE_COMPARING)
+		{
+			size_t group_id = handler->_group_ids[at_index];
+
+			if (manifest->_group_classes[group_id] == SIZE_MAX)
+			{
+				manifest->_group_classes[group_id] = among_of_classes;
+				manifest->_class_representatives[among_of_classes] = at_index;
+				among_of_classes += 1;
+			}
+
+			file_class = manifest->_group_classes[group_id];
+		}
+
+		job->_classes_changed = job->_classes_changed || (file_class != manifest->_file_classes[at_index]);
+		manifest->_file_classes[at_index] = file_class;
+		job->_file_classes[at_index] = file_class;
+	}
+
+	job->_block_offset = handler->_block_offset;
+	job->_zeros_offset = manifest->_next_block_offset;
+	job->_zeros_length = handler->_block_offset - manifest->_next_block_offset;
+	job->_among_of_classes = among_of_classes;
+	manifest->_next_block_offset = handler->_block_offset + (long long)manifest->_block_size;
+
+	for (size_t at_class = 0; at_class < among_of_classes; at_class += 1)
+	{
+		size_t file_index = manifest->_class_representatives[at_class];
+		size_t block_length = handler->_buffers_byte_among[file_index];
+		unsigned char* job_block = job->_blocks + at_class * manifest->_block_size;
+
+		if (handler->_zero_blocks != NULL && handler->_zero_blocks[file_index]) memset(job_block, 0, block_length);
+		else memcpy(job_block, handler->_compare_buffers[file_index], block_length);
+
+		job->_block_lengths[at_class] = block_length;
+	}
+
+
+
+	#ifdef __linux__
+	pthread_mutex_lock(&manifest->_lock);
+	manifest->_among_of_queued_jobs += 1;
+	pthread_cond_signal(&manifest->_queued_condition);
+	pthread_mutex_unlock(&manifest->_lock);
+	#else
+	DigestJob(manifest, job);
+	#endif
+}
+
+
+
+static void FreeManifest(struct DigestManifest* manifest)
+{
+	for (size_t at_job = 0; at_job < DIGEST_QUEUE_LENGTH; at_job += 1)
+	{
+		free(manifest->_jobs[at_job]._file_classes);
+		free(manifest->_jobs[at_job]._blocks);
+		free(manifest->_jobs[at_job]._block_lengths);
+	}
+
+	free(manifest->_file_classes);
+	free(manifest->_group_classes);
+	free(manifest->_class_representatives);
+	free(manifest->_first_class_files);
+	free(manifest->_next_class_files);
+	free(manifest);
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+bool CmpDigest_ParseAlgorithm(const char* name, enum DigestAlgorithm* algorithm)
+{
+	if (name == NULL || algorithm == NULL) return false;
+
+	if (strcmp(name, "xxh64") == 0) *algorithm = DIGEST_XXH64;
+	else if (strcmp(name, "sha256") == 0) *algorithm = DIGEST_SHA256;
+	else return false;
+
+	return true;
+}
+
+
+
+void CmpDigest_Calculate(enum DigestAlgorithm algorithm, const unsigned char* data, size_t length, char* digest_text)
+{
+	if (algorithm == DIGEST_XXH64)
+	{
+		snprintf(digest_text, 17, "%016llx", (unsigned long long)Xxh64(data, length));
+		return;
+	}
+
+	unsigned char digest[32];
+	Sha256(data, length, digest);
+
+	for (size_t at_byte = 0; at_byte < sizeof(digest); at_byte += 1) snprintf(digest_text + at_byte * 2, 3, "%02x", digest[at_byte]);
+}
+
+
+
+/*!
+ * 	A block can have a class per file at most, so each job gets room for a block per file up front.
+ * */
+struct DigestManifest* CmpDigest_Start(const char* manifest_path, enum DigestAlgorithm algorithm, struct FilesToCompare* handler)
+{
+	if (manifest_path == NULL || handler == NULL) return NULL;
+
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	const size_t BLOCK_SIZE = handler->_compare_buffer_size;
+
+	struct DigestManifest* manifest = calloc(1, sizeof(struct DigestManifest));
+	if (manifest == NULL) return NULL;
+
+	manifest->_algorithm = algorithm;
+	manifest->_handler = handler;
+	manifest->_number_of_files = FILES_AMONG;
+	manifest->_block_size = BLOCK_SIZE;
+	manifest->_next_block_offset = handler->_block_offset;
+
+	manifest->_file_classes = malloc(sizeof(size_t) * FILES_AMONG);
+	manifest->_group_classes = malloc(sizeof(size_t) * FILES_AMONG);
+	manifest->_class_representatives = malloc(sizeof(size_t) * FILES_AMONG);
+	manifest->_first_class_files = malloc(sizeof(size_t) * FILES_AMONG);
+	manifest->_next_class_files = malloc(sizeof(size_t) * FILES_AMONG);
+	bool is_allocated = manifest->_file_classes != NULL && manifest->_group_classes != NULL && manifest->_class_representatives != NULL &&
+								manifest->_first_class_files != NULL && manifest->_next_class_files != NULL;
+
+	for (size_t at_job = 0; at_job < DIGEST_QUEUE_LENGTH && is_allocated; at_job += 1)
+	{
+		struct DigestJob* job = &manifest->_jobs[at_job];
+		job->_file_classes = malloc(sizeof(size_t) * FILES_AMONG);
+		job->_blocks = (BLOCK_SIZE <= SIZE_MAX / FILES_AMONG) ? malloc(BLOCK_SIZE * FILES_AMONG) : NULL;
+		job->_block_lengths = malloc(sizeof(size_t) * FILES_AMONG);
+		is_allocated = job->_file_classes != NULL && job->_blocks != NULL && job->_block_lengths != NULL;
+	}
+
+	if (!is_allocated)
+	{
+		fputs("Error in CmpDigest_Start: Couldn't allocate the needed resources!\n", stderr);
+		FreeManifest(manifest);
+		return NULL;
+	}
+
+	//	Since no file is in a class yet, the classes are written before the first block.
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1) manifest->_file_classes[at_index] = SIZE_MAX - 1;
+
+
+
+	manifest->_manifest = fopen(manifest_path, "w");
+	if (manifest->_manifest == NULL)
+	{
+		fprintf(stderr, "Error in CmpDigest_Start: Couldn't create the manifest %s!\n", manifest_path);
+		FreeManifest(manifest);
+		return NULL;
+	}
+
+	fprintf(manifest->_manifest, "%s\nalgorithm %s\nblock-size %zu\n", MANIFEST_SIGNATURE, (algorithm == DIGEST_XXH64) ? "xxh64" : "sha256", BLOCK_SIZE);
+
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		long long region_offset = (handler->_region_offsets != NULL) ? handler->_region_offsets[at_index] : 0;
+		fprintf(manifest->_manifest, "file %zu %lld %s\n", at_index, region_offset, handler->_filepaths[at_index]);
+	}
+
+	if (!CmpFiles_SetBlockCallback(handler, QueueBlock, manifest))
+	{
+		fputs("Error in CmpDigest_Start: The blocks of the files can't be followed (the files share their buffers)!\n", stderr);
+		fclose(manifest->_manifest);
+		FreeManifest(manifest);
+		return NULL;
+	}
+
+
+
+	#ifdef __linux__
+	pthread_mutex_init(&manifest->_lock, NULL);
+	pthread_cond_init(&manifest->_queued_condition, NULL);
+	pthread_cond_init(&manifest->_emptied_condition, NULL);
+
+	manifest->_is_started = (pthread_create(&manifest->_thread, NULL, DigestQueuedJobs, manifest) == 0);
+
+	if (!manifest->_is_started)
+	{
+		fputs("Error in CmpDigest_Start: Couldn't start the digesting thread!\n", stderr);
+		CmpFiles_SetBlockCallback(handler, NULL, NULL);
+		pthread_mutex_destroy(&manifest->_lock);
+		pthread_cond_destroy(&manifest->_queued_condition);
+		pthread_cond_destroy(&manifest->_emptied_condition);
+		fclose(manifest->_manifest);
+		FreeManifest(manifest);
+		return NULL;
+	}
+	#endif
+
+	return manifest;
+}
+
+
+
+bool CmpDigest_Finish(struct DigestManifest* manifest)
+{
+	if (manifest == NULL) return false;
+
+	CmpFiles_SetBlockCallback(manifest->_handler, NULL, NULL);
+
+
+
+	#ifdef __linux__
+	pthread_mutex_lock(&manifest->_lock);
+	manifest->_is_stopping = true;
+	pthread_cond_signal(&manifest->_queued_condition);
+	pthread_mutex_unlock(&manifest->_lock);
+
+	pthread_join(manifest->_thread, NULL);
+
+	pthread_mutex_destroy(&manifest->_lock);
+	pthread_cond_destroy(&manifest->_queued_condition);
+	pthread_cond_destroy(&manifest->_emptied_condition);
+	#endif
+
+	fputs("end\n", manifest->_manifest);
+
+	bool manifest_was_written = !manifest->_write_failed && (ferror(manifest->_manifest) == 0);
+	manifest_was_written = (fclose(manifest->_manifest) == 0) && manifest_was_written;
+
+	FreeManifest(manifest);
+
+	return manifest_was_written;
+}
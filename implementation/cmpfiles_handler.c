@@ -11,23 +11,54 @@
 
 
 
+#define _GNU_SOURCE	//	For SEEK_DATA and SEEK_HOLE.
+
+
+
 #include "cmpcomb_handler.h"
 #include "cmpfiles_handler.h"
+#include "cmpkernel_handler.h"
+#include "cmpio_handler.h"
+#include "cmptrace_handler.h"
 
 
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
 #ifdef _WIN32
 #include <fcntl.h>
 #include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 
 
 const char* STDIN_FILEPATH_MARK = "stdin";
+const size_t MINIMUM_BUFFER_SIZE = 4096;
+
+/*!
+ * 	Marks, that no file index is set (for example, that a group has no representative yet).
+ * */
+static const size_t NO_FILE_INDEX = SIZE_MAX;
+
+/*!
+ * 	The fewest shared buffers, that the files can be compared with: one for the compared file, 
+ * 	one for the group representative it is compared with, and one for the reference file.
+ * */
+static const size_t MINIMUM_SLOTS = 3;
+
+/*!
+ * 	The fewest bytes of a block, that a compare thread checks as one part of a pair, so that splitting a block doesn't cost more, than it saves.
+ * */
+static const size_t MINIMUM_PART_SIZE = 64 * 1024;
 
 
 
@@ -121,86 +152,94 @@ static char** AllocateAndCopyFilepaths(char** filepaths, size_t among)
  * 	Validates the arguments, and if they are fine,
  * 	free's all allocated IO and memory resources.
  * 	
- * 	\param	filestreams	The open filestreams, that need to be closed.
- * 	\param	among			The number of filestreams.
+ * 	\param	files		The open files, that need to be closed (stdin stays open).
+ * 	\param	among	The number of files.
  * */
-static void CloseFilestreams(FILE** filestreams, size_t among)
+static void CloseFiles(struct IoFile** files, size_t among)
 {
-	if (filestreams == NULL) return;
+	if (files == NULL) return;
 	
 	
 	
-	for (size_t at_index = 0; at_index < among; at_index += 1) 
-	{
-		if (filestreams[at_index] == stdin)
-		{
-			continue;
-		}
-		else if (filestreams[at_index] != NULL) 
-		{
-			fclose(filestreams[at_index]);
-		}
-	}
+	for (size_t at_index = 0; at_index < among; at_index += 1) CmpIo_Close(files[at_index]);
 	
-	free(filestreams);
+	free(files);
 }
 
 
 
 /*!
+ * 	Opens a file for reading through the backend, or takes over stdin for its mark.
+ * 	The files are read from their start to their end, so the system is told to read ahead.
  * 
- * 	\param	filepaths	Contains the filepath strings of each filestream.
- * 	\param	among		The number of filepath string.
+ * 	\return	The open file, or NULL, if the file couldn't be opened.
+ * */
+static struct IoFile* OpenFile(const struct IoBackend* io_backend, const char* filepath)
+{
+	struct IoFile* file;
+	
+	if (strcmp(filepath, STDIN_FILEPATH_MARK) == 0)
+	{
+		#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+		#endif
+		
+		file = CmpIo_Adopt(io_backend, stdin);
+	}
+	else
+	{
+		file = CmpIo_Open(io_backend, filepath);
+	}
+	
+	if (file != NULL) CmpIo_Advise(file, 0, 0, IO_ADVICE_SEQUENTIAL);
+	
+	return file;
+}
+
+/*!
+ * 
+ * 	\param	io_backend	The backend, that the files are opened through.
+ * 	\param	filepaths		Contains the filepath strings of each file.
+ * 	\param	among			The number of filepath string.
  * */
-static FILE** OpenFilestreams(char** filepaths, size_t among)
+static struct IoFile** OpenFiles(const struct IoBackend* io_backend, char** filepaths, size_t among)
 {
-	FILE** filestreams = malloc(sizeof(FILE**) * among);
-	if (filestreams == NULL) return NULL;
+	struct IoFile** files = malloc(sizeof(struct IoFile*) * among);
+	if (files == NULL) return NULL;
 	
 	
 	
-	//	Incase IO resource allocation fails for one or several filestreams, so that their resources can be safely released.
-	for (size_t at_index = 0; at_index < among; at_index += 1) filestreams[at_index] = NULL;
+	//	Incase IO resource allocation fails for one or several files, so that their resources can be safely released.
+	for (size_t at_index = 0; at_index < among; at_index += 1) files[at_index] = NULL;
 	
 	
 	
 	bool is_stdin_used = false;
 	for (size_t at_index = 0; at_index < among; at_index += 1)
 	{
-		FILE* new_filestream;
+		long long trace_time = CmpTrace_Begin();
 		
 		if (strcmp(filepaths[at_index], STDIN_FILEPATH_MARK) == 0)
 		{
-			if (is_stdin_used) goto __OpenFilestreams_FreeRemainingResources;
-			
-			#ifdef _WIN32
-			_setmode(_fileno(stdin), _O_BINARY);
-			#endif
-			
-			new_filestream = stdin;
-			
+			if (is_stdin_used) goto __OpenFiles_FreeRemainingResources;
 			is_stdin_used = true;
 		}
-		else
-		{
-			new_filestream = fopen(filepaths[at_index], "rb");
-			if (new_filestream == NULL) goto __OpenFilestreams_FreeRemainingResources;
-			bool filestream_not_configured = setvbuf(new_filestream, NULL, _IONBF, 0) != 0;
-			if (filestream_not_configured) goto __OpenFilestreams_FreeRemainingResources;
-		}
 		
-		filestreams[at_index] = new_filestream;
+		files[at_index] = OpenFile(io_backend, filepaths[at_index]);
+		if (files[at_index] == NULL) goto __OpenFiles_FreeRemainingResources;
+		
+		CmpTrace_End("open", "setup", trace_time, (long long)at_index, -1, filepaths[at_index]);
 	}
 	
 	
 	
-	return filestreams;
+	return files;
 
 
 
-	__OpenFilestreams_FreeRemainingResources:
-		fputs("Error in OpenFilestreams: Couldn't allocate all resources!\n", stderr);
-		CloseFilestreams(filestreams, among);
+	__OpenFiles_FreeRemainingResources:
+		fputs("Error in OpenFiles: Couldn't allocate all resources!\n", stderr);
+		CloseFiles(files, among);
 		
 	return NULL;
 }
@@ -230,6 +269,22 @@ static void FreeBuffers(unsigned char** compare_buffers, size_t among)
 
 
 
+/*!
+ * 	The buffers start at a page, so that the system copies the read blocks (from the page cache, or a pipe) into them with whole pages.
+ * 	The buffer is freed with free, like any other.
+ * */
+static unsigned char* AllocatePageAligned(size_t size)
+{
+	#ifndef _WIN32
+	long page_size = sysconf(_SC_PAGESIZE);
+	void* buffer = NULL;
+	
+	if (page_size > 0 && posix_memalign(&buffer, (size_t)page_size, size) == 0) return buffer;
+	#endif
+	
+	return malloc(sizeof(unsigned char) * size);
+}
+
 static unsigned char** AllocateBuffers(size_t among, size_t size)
 {
 	unsigned char** compare_buffers = malloc(sizeof(unsigned char**) * among);
@@ -244,7 +299,7 @@ static unsigned char** AllocateBuffers(size_t among, size_t size)
 	
 	for (size_t at_index = 0; at_index < among; at_index += 1)
 	{
-		compare_buffers[at_index] = malloc(sizeof(unsigned char) * size);
+		compare_buffers[at_index] = AllocatePageAligned(size);
 		
 		if (compare_buffers[at_index] == NULL) goto __AllocateBuffers_FreeRemainingResources;
 	}
@@ -300,170 +355,2457 @@ static size_t* AllocateBuffersByteAmong(size_t number_of_buffers)
 
 
 
+/*!
+ * 	Validates the arguments, and if they are fine,
+ * 	free's all allocated memory resources.
+ * */
+static void FreeIndexArray(size_t* index_array)
+{
+	if (index_array == NULL) return;
+	
+	
+	
+	free(index_array);
+}
 
 
 
-/* Implemented functions. */
-
-void CmpFiles_Terminate(struct FilesToCompare* handler)
+static size_t* AllocateIndexArray(size_t among)
 {
-	if (handler != NULL)
+	if (among == 0) return NULL;
+	
+	
+	
+	size_t* index_array = malloc(sizeof(size_t) * among);
+	
+	if (index_array == NULL) 
 	{
-		CloseFilestreams(handler->_filestreams, handler->_number_of_filestreams);
-		FreeFilepaths(handler->_filepaths, handler->_number_of_filestreams);
-		FreeBuffers(handler->_compare_buffers, handler->_number_of_filestreams);
-		FreeBuffersByteAmong(handler->_buffers_byte_among);
-		CmpComb_Terminate(handler->_combinations_handler);
-		free(handler);
+		fputs("Error in AllocateIndexArray: Couldn't allocate the needed resources!\n", stderr);
+		return NULL;
 	}
+	
+	
+	
+	for (size_t at_index = 0; at_index < among; at_index += 1) index_array[at_index] = NO_FILE_INDEX;
+	
+	return index_array;
 }
 
 
 
-struct FilesToCompare* CmpFiles_Initialize(char** filepaths, size_t number_of_files, size_t compare_buffer_size)
+/*!
+ * 	Fetches the device of a file, that the limits of its reads are looked up by.
+ * 	A file, that isn't open, gets device 0, since it won't be read. A closed pooled file keeps the device, that it was opened on.
+ * */
+static void UpdateFileDevice(struct FilesToCompare* handler, size_t file_index)
 {
-	if (filepaths == NULL) return NULL;
-	else if (number_of_files == 0) return NULL;
-	else if (compare_buffer_size == 0) return NULL;
+	struct stat file_status;
+	struct IoFile* file = handler->_files[file_index];
+	
+	if (file == NULL && handler->_pooled_files != NULL && handler->_pooled_files[file_index]) return;
+	else if (file != NULL && fstat(file->_descriptor, &file_status) == 0) handler->_file_devices[file_index] = (unsigned long long)file_status.st_dev;
+	else handler->_file_devices[file_index] = 0;
+}
+
+
+
+/*!
+ * 	Closes the next open pooled file (other than the kept one) after the pool hand, so that the files are closed in turn.
+ * 	Since the files are read in the order of their indexes, that is the one, which was used the longest ago.
+ * */
+static void ClosePooledFile(struct FilesToCompare* handler, size_t kept_index)
+{
+	for (size_t at_step = 0; at_step < handler->_number_of_filestreams; at_step += 1)
+	{
+		size_t at_index = handler->_pool_hand;
+		handler->_pool_hand = (at_index + 1) % handler->_number_of_filestreams;
+		
+		if (at_index == kept_index || !handler->_pooled_files[at_index] || handler->_files[at_index] == NULL) continue;
+		
+		CmpIo_Close(handler->_files[at_index]);
+		handler->_files[at_index] = NULL;
+		handler->_among_of_open_files -= 1;
+		return;
+	}
+}
+
+/*!
+ * 	Makes sure, that a file is open, and opens a closed pooled file again (closing another one, if the pool is full).
+ * 	The reopened file has to be the same one as before (by its device and inode), since its comparing continues where it stopped.
+ * 
+ * 	\return	If the file is open, returns true.
+ * */
+static bool OpenPooledFile(struct FilesToCompare* handler, size_t file_index)
+{
+	if (handler->_files[file_index] != NULL) return true;
+	else if (handler->_pooled_files == NULL || !handler->_pooled_files[file_index]) return false;
 	
 	
 	
-	struct FilesToCompare* handler = malloc(sizeof(struct FilesToCompare));
-	if (handler == NULL) return NULL;
+	if (handler->_among_of_open_files >= handler->_max_open_files) ClosePooledFile(handler, file_index);
 	
+	long long trace_time = CmpTrace_Begin();
 	
+	struct IoFile* file = OpenFile(handler->_io_backend, handler->_filepaths[file_index]);
+	if (file == NULL) return false;
 	
-	handler->_filepaths = NULL;
-	handler->_filestreams = NULL;
-	handler->_compare_buffers = NULL;
-	handler->_buffers_byte_among = NULL;
-	handler->_combinations_handler = NULL;
+	struct stat file_status;
+	bool is_same_file = 	(fstat(file->_descriptor, &file_status) == 0) && 
+									((unsigned long long)file_status.st_dev == handler->_file_devices[file_index]) && 
+									((unsigned long long)file_status.st_ino == handler->_file_inodes[file_index]);
 	
-	handler->_number_of_filestreams = number_of_files;
-	handler->_compare_buffer_size = compare_buffer_size;
+	if (!is_same_file)
+	{
+		fprintf(stderr, "Error in OpenPooledFile: The file %s was replaced, while it was compared!\n", handler->_filepaths[file_index]);
+		CmpIo_Close(file);
+		return false;
+	}
 	
+	handler->_files[file_index] = file;
+	handler->_among_of_open_files += 1;
 	
+	CmpTrace_End("open", "setup", trace_time, (long long)file_index, -1, handler->_filepaths[file_index]);
 	
-	handler->_filestreams = OpenFilestreams(filepaths, number_of_files);
-	if (handler->_filestreams == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	return true;
+}
+
+
+
+/*!
+ * 	Fetches, where the compared region of a file starts. Block offsets are relative to it.
+ * 	Regions of stdin start at its position, since it can be redirected from the middle of a file (a file, that is closed in the pool, is never stdin).
+ * */
+static long long GetRegionOffset(const struct FilesToCompare* handler, size_t file_index)
+{
+	long long region_offset = (handler->_region_offsets != NULL) ? handler->_region_offsets[file_index] : 0;
 	
+	return (handler->_files[file_index] != NULL) ? handler->_files[file_index]->_start_offset + region_offset : region_offset;
+}
+
+/*!
+ * 	Fetches the number of bytes, that are read for the current block of a file:
+ * 	a whole block, unless the compared region of the file ends before that.
+ * */
+static size_t GetReadSize(const struct FilesToCompare* handler, size_t file_index)
+{
+	if (handler->_region_lengths == NULL || handler->_region_lengths[file_index] < 0) return handler->_compare_buffer_size;
 	
+	long long bytes_left = handler->_region_lengths[file_index] - handler->_block_offset;
 	
-	handler->_filepaths = AllocateAndCopyFilepaths(filepaths, number_of_files);
-	if (handler->_filepaths == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	if (bytes_left <= 0) return 0;
+	else if (bytes_left < (long long)handler->_compare_buffer_size) return (size_t)bytes_left;
+	else return handler->_compare_buffer_size;
+}
+
+
+
+/*!
+ * 	Fetches the size of a file, and checks, if it can have its data and hole regions queried.
+ * 	That is only possible for regular files, on systems that support SEEK_DATA and SEEK_HOLE.
+ * 	If a region of the file is compared, only the part of the file inside it counts as its size.
+ * */
+static void DetectExtents(struct FilesToCompare* handler, size_t file_index)
+{
+	struct FileExtents* file_extents = &handler->_file_extents[file_index];
 	
+	file_extents->_file_size = -1;
+	file_extents->_can_seek_holes = false;
+	file_extents->_next_data_offset = -1;
+	file_extents->_next_hole_offset = -1;
 	
+	if (!OpenPooledFile(handler, file_index)) return;
+	else if (!CmpIo_SizeHint(handler->_files[file_index], &file_extents->_file_size)) 
+	{
+		file_extents->_file_size = -1;
+		return;
+	}
 	
-	handler->_compare_buffers = AllocateBuffers(number_of_files, compare_buffer_size);
-	if (handler->_compare_buffers == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	if (handler->_region_offsets != NULL || handler->_files[file_index]->_start_offset > 0)
+	{
+		//	A region, that starts past the end of the file, is empty.
+		long long region_size = file_extents->_file_size - GetRegionOffset(handler, file_index);
+		if (region_size < 0) region_size = 0;
+		
+		if (handler->_region_lengths != NULL && handler->_region_lengths[file_index] >= 0 && handler->_region_lengths[file_index] < region_size) region_size = handler->_region_lengths[file_index];
+		
+		file_extents->_file_size = region_size;
+	}
 	
 	
 	
-	handler->_buffers_byte_among = AllocateBuffersByteAmong(number_of_files);
-	if (handler->_buffers_byte_among == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+	//	ENXIO means, that there is no data at or after the offset, which is fine (the file is empty or a single hole).
+	off_t data_offset = lseek(handler->_files[file_index]->_descriptor, 0, SEEK_DATA);
+	file_extents->_can_seek_holes = (data_offset >= 0) || (errno == ENXIO);
+	#endif
+}
+
+
+
+/*!
+ * 	Opens a file for the first time, while the open files are limited, and fetches its extents.
+ * 	Files, that can be opened again (read at explicit offsets, and not stdin), are remembered by their identity, and count towards the limit:
+ * 	once it is reached, another pooled file is closed first.
+ * 
+ * 	\return	If the file was opened, returns true.
+ * */
+static bool OpenIntoPool(struct FilesToCompare* handler, size_t file_index)
+{
+	if (handler->_among_of_open_files >= handler->_max_open_files) ClosePooledFile(handler, file_index);
 	
+	long long trace_time = CmpTrace_Begin();
 	
+	handler->_files[file_index] = OpenFile(handler->_io_backend, handler->_filepaths[file_index]);
+	if (handler->_files[file_index] == NULL)
+	{
+		fprintf(stderr, "Error in OpenIntoPool: Couldn't open the file %s!\n", handler->_filepaths[file_index]);
+		return false;
+	}
 	
-	handler->_combinations_handler = CmpComb_Initialize(number_of_files);
-	if (handler->_combinations_handler == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	CmpTrace_End("open", "setup", trace_time, (long long)file_index, -1, handler->_filepaths[file_index]);
 	
+	DetectExtents(handler, file_index);
 	
 	
-	return handler;
 	
+	struct stat file_status;
 	
+	if (handler->_files[file_index]->_is_stdin || !handler->_file_extents[file_index]._can_seek_holes) return true;
+	else if (fstat(handler->_files[file_index]->_descriptor, &file_status) != 0) return true;
 	
-	__CmpFiles_Initialize_FreeRemainingResources:
-		fputs("Error in CmpFiles_Initialize: Couldn't allocate all resources!\n", stderr);
-		CmpFiles_Terminate(handler);
-		
-	return NULL;
+	handler->_pooled_files[file_index] = true;
+	handler->_file_devices[file_index] = (unsigned long long)file_status.st_dev;
+	handler->_file_inodes[file_index] = (unsigned long long)file_status.st_ino;
+	handler->_among_of_open_files += 1;
+	
+	return true;
+}
+
+/*!
+ * 	Decides the size of the buffers, and how many of them the files share, so that they fit into the memory budget.
+ * 	The buffers are shrunk first (to a multiple of MINIMUM_BUFFER_SIZE, since they are read from disks), 
+ * 	and only once they can't be shrunk any further, the files share as many of them as fit.
+ * 
+ * 	\param	number_of_files		The among of compared files.
+ * 	\param	max_memory			The most bytes, that the buffers use together.
+ * 	\param	buffer_size			The wanted size of a buffer, which is replaced by the decided one.
+ * 	\param	among_of_slots		Where the number of shared buffers is stored (0, if every file gets a buffer of its own).
+ * 
+ * 	\return	If at least MINIMUM_SLOTS buffers fit, returns true.
+ * */
+static bool FitIntoMemory(size_t number_of_files, size_t max_memory, size_t* buffer_size, size_t* among_of_slots)
+{
+	size_t memory_per_file = max_memory / number_of_files;
+	
+	*among_of_slots = 0;
+	
+	if (memory_per_file >= *buffer_size) return true;
+	else if (memory_per_file >= MINIMUM_BUFFER_SIZE)
+	{
+		*buffer_size = memory_per_file - memory_per_file % MINIMUM_BUFFER_SIZE;
+		return true;
+	}
+	
+	if (*buffer_size > MINIMUM_BUFFER_SIZE) *buffer_size = MINIMUM_BUFFER_SIZE;
+	*among_of_slots = max_memory / *buffer_size;
+	
+	return *among_of_slots >= MINIMUM_SLOTS;
 }
 
 
 
-bool CmpFiles_CompareFiles(struct FilesToCompare* handler)
+/*!
+ * 	A file size, paired with the index of its file.
+ * 	Only used for seeding the groups.
+ * */
+struct SizedFile
 {
-	if (handler == NULL) return false;
-	else if (handler->_number_of_filestreams < 2) return false;
+	long long _file_size;
+	size_t _file_index;
+};
+
+static int CompareSizedFiles(const void* first, const void* second)
+{
+	const struct SizedFile* first_file = first;
+	const struct SizedFile* second_file = second;
 	
-	const size_t COMBINATIONS_AMONG = handler->_combinations_handler->_among_of_combinations;
-	size_t skipped_combinations = 0, finished_combinations = 0;
+	if (first_file->_file_size != second_file->_file_size) return first_file->_file_size < second_file->_file_size ? -1 : 1;
+	else if (first_file->_file_index != second_file->_file_index) return first_file->_file_index < second_file->_file_index ? -1 : 1;
+	else return 0;
+}
+
+static int CompareFileSizes(const void* first, const void* second)
+{
+	long long first_size = *(const long long*)first;
+	long long second_size = *(const long long*)second;
 	
-	do
+	return (first_size > second_size) - (first_size < second_size);
+}
+
+/*!
+ * 	Passes a decision about the file (its new state, or a mismatch, while it is still compared) to the decision callback, if there is one.
+ * */
+static void ReportDecision(struct FilesToCompare* handler, size_t file_index, long long offset)
+{
+	if (handler->_on_decision != NULL) handler->_on_decision(handler, file_index, offset, handler->_decision_context);
+}
+
+/*!
+ * 	A file is finished in the block, that it ends in, so it ends at the start of that block (right after it is compared), plus the bytes read into it.
+ * */
+static long long GetFinishedOffset(struct FilesToCompare* handler, size_t file_index)
+{
+	return handler->_block_offset - (long long)handler->_compare_buffer_size + (long long)handler->_buffers_byte_among[file_index];
+}
+
+/*!
+ * 	A file is left alone right after the block, in which it stopped matching the others, is compared, 
+ * 	so it is decided at the start of that block (which is never past its end, or its first differing byte).
+ * */
+static long long GetLeftAloneOffset(struct FilesToCompare* handler)
+{
+	return handler->_block_offset - (long long)handler->_compare_buffer_size;
+}
+
+
+
+/*!
+ * 	Seeds new groups for the files, that are about to be compared, by their sizes, 
+ * 	since files with differing sizes can never have matched data.
+ * 	If the size of any of those files is unknown (like from a pipe), they are all put into one group instead.
+ * 	The groups of the other files are left as they are.
+ * 	
+ * 	Files, that are left alone in their group, are marked as unique, and will never be read.
+ * 	
+ * 	\param	handler	Holds the necessary data for performing comparing of data with variable amongs of files.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a memory allocation error happing, false is returned instead.
+ * */
+static bool SeedGroups(struct FilesToCompare* handler)
+{
+	size_t seeded_among = 0;
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] == FILE_COMPARING) seeded_among += 1;
+	}
+	
+	if (seeded_among == 0) return true;
+	
+	
+	
+	struct SizedFile* sized_files = malloc(sizeof(struct SizedFile) * seeded_among);
+	if (sized_files == NULL) return false;
+	
+	bool all_sizes_known = true;
+	
+	for (size_t at_index = 0, at_seeded = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		sized_files[at_seeded]._file_index = at_index;
+		sized_files[at_seeded]._file_size = handler->_file_extents[at_index]._file_size;
+		
+		//	A single file with a unknown size could match any other, so they all stay in one group.
+		if (sized_files[at_seeded]._file_size < 0) all_sizes_known = false;
+		
+		at_seeded += 1;
+	}
+	
+	if (all_sizes_known) qsort(sized_files, seeded_among, sizeof(struct SizedFile), CompareSizedFiles);
+	
+	
+	
+	for (size_t at_seeded = 0; at_seeded < seeded_among; at_seeded += 1)
 	{
-		//	Read the files contents into their respective buffers.
-		for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+		bool starts_new_group = (at_seeded == 0) || (all_sizes_known && (sized_files[at_seeded]._file_size != sized_files[at_seeded - 1]._file_size));
+		
+		if (starts_new_group)
 		{
-			//	Note:	When a filestream is no longer used, it gets closed and is replaced with NULL, so that the deed gets indicated.
-			//	Note:	Creating a way to determine, when the filestream is redudant...otherwise, this will cause unnecessary IO calls, which slow down the whole process.
-			handler->_buffers_byte_among[at_index] = fread(handler->_compare_buffers[at_index], sizeof(unsigned char), handler->_compare_buffer_size, handler->_filestreams[at_index]);
+			handler->_group_sizes[handler->_number_of_groups] = 0;
+			handler->_number_of_groups += 1;
 		}
 		
-		skipped_combinations = 0;
-		finished_combinations = 0;
+		size_t group_id = handler->_number_of_groups - 1;
+		handler->_group_ids[sized_files[at_seeded]._file_index] = group_id;
+		handler->_group_sizes[group_id] += 1;
+	}
+	
+	
+	
+	for (size_t at_seeded = 0; at_seeded < seeded_among; at_seeded += 1)
+	{
+		size_t file_index = sized_files[at_seeded]._file_index;
 		
-		for (size_t at_index = 0; at_index < COMBINATIONS_AMONG; at_index += 1)
-		{
-			size_t compare_index = handler->_combinations_handler->_compare_indexes[at_index];
-			size_t compare_with_index = handler->_combinations_handler->_compare_with_indexes[at_index];
-			
+		if (handler->_group_sizes[handler->_group_ids[file_index]] == 1) handler->_file_states[file_index] = FILE_UNIQUE;
+	}
+	
+	free(sized_files);
+	
+	return true;
+}
 
 
-			//	If a index combination was marked as eliminated (files not the same), then skip it.
-			if (handler->_combinations_handler->_match_states[at_index] == NOT_MATCHED)
-			{
-				skipped_combinations += 1;
-				continue;
-			}
-			else if (ferror(handler->_filestreams[compare_index]) != 0)
-			{
-				handler->_combinations_handler->_match_states[at_index] = NOT_MATCHED;
-				continue;
-			}
-			else if (ferror(handler->_filestreams[compare_with_index]) != 0)
-			{
-				handler->_combinations_handler->_match_states[at_index] = NOT_MATCHED;
-				continue;
-			}
-			
-			
-			
-			//	Validate the length state of the files, that are to be compared.
-			if (feof(handler->_filestreams[compare_index]) != feof(handler->_filestreams[compare_with_index]))
-			{
-				handler->_combinations_handler->_match_states[at_index] = NOT_MATCHED;
-				continue;
-			}
-			else if (handler->_buffers_byte_among[compare_index] != handler->_buffers_byte_among[compare_with_index])
-			{
-				handler->_combinations_handler->_match_states[at_index] = NOT_MATCHED;
-				continue;
-			}
-			
-			//	Last validation: Even if they are the same length, doesn't mean, that their binary content is the same. So, that is checked, and if its matched, that block of data is the same of the files.
-			size_t bytes_to_check = handler->_buffers_byte_among[compare_index];
-			if (bytes_to_check > 0)
-			{
-				bool are_not_same = memcmp(handler->_compare_buffers[compare_index], handler->_compare_buffers[compare_with_index], bytes_to_check) != 0;
-				
-				if (are_not_same)
-				{
-					handler->_combinations_handler->_match_states[at_index] = NOT_MATCHED;
-				}
-			}
-			else if ((feof(handler->_filestreams[compare_index]) != 0) && (feof(handler->_filestreams[compare_with_index]) != 0))
-			{
-				handler->_combinations_handler->_match_states[at_index] = MATCHED;
-				finished_combinations += 1;
-			}
-			else
+
+/*!
+ * 	Moves a file into a different group, and keeps the group sizes up to date.
+ * */
+static void MoveToGroup(struct FilesToCompare* handler, size_t file_index, size_t group_id)
+{
+	size_t previous_group_id = handler->_group_ids[file_index];
+	if (previous_group_id == group_id) return;
+	
+	handler->_group_sizes[previous_group_id] -= 1;
+	handler->_group_sizes[group_id] += 1;
+	handler->_group_ids[file_index] = group_id;
+}
+
+/*!
+ * 	Moves a file into a new group, of which it is the only member.
+ * 	Since groups never become empty, there are never more groups than files.
+ * */
+static void MoveToNewGroup(struct FilesToCompare* handler, size_t file_index)
+{
+	size_t new_group_id = handler->_number_of_groups;
+	handler->_number_of_groups += 1;
+	handler->_group_sizes[new_group_id] = 0;
+	
+	MoveToGroup(handler, file_index, new_group_id);
+}
+
+/*!
+ * 	Marks the file as failed, and moves it out of its group (unless it already is alone in it).
+ * */
+static void MarkAsFailed(struct FilesToCompare* handler, size_t file_index)
+{
+	CmpTrace_Mark("failed", "decision", (long long)file_index, handler->_block_offset);
+	
+	if (handler->_group_sizes[handler->_group_ids[file_index]] > 1) MoveToNewGroup(handler, file_index);
+	
+	handler->_file_states[file_index] = FILE_FAILED;
+	ReportDecision(handler, file_index, handler->_block_offset);
+}
+
+/*!
+ * 	Remembers the byte of the current block, in which the file stopped matching the rest of its group.
+ * */
+static void RecordMismatch(struct FilesToCompare* handler, size_t file_index, size_t difference_offset)
+{
+	if (handler->_mismatch_offsets[file_index] < 0) handler->_mismatch_offsets[file_index] = handler->_block_offset + (long long)difference_offset;
+	
+	CmpTrace_Mark("mismatch", "decision", (long long)file_index, handler->_block_offset);
+	ReportDecision(handler, file_index, handler->_block_offset + (long long)difference_offset);
+}
+
+
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+/*!
+ * 	Updates the next data and hole region of the file, if the current block has moved past the known data region.
+ * 	
+ * 	\return	If the regions could be queried, returns true.
+ * */
+static bool UpdateExtents(struct FilesToCompare* handler, size_t file_index)
+{
+	struct FileExtents* file_extents = &handler->_file_extents[file_index];
+	
+	if ((file_extents->_next_data_offset >= 0) && (handler->_block_offset < file_extents->_next_hole_offset)) return true;
+	else if (!OpenPooledFile(handler, file_index)) return false;
+	
+	
+	
+	int file_descriptor = handler->_files[file_index]->_descriptor;
+	long long region_offset = GetRegionOffset(handler, file_index);
+	
+	off_t data_offset = lseek(file_descriptor, region_offset + handler->_block_offset, SEEK_DATA);
+	if (data_offset < 0)
+	{
+		if (errno != ENXIO) return false;
+		
+		//	No more data till the end of the file, so the rest is one hole.
+		file_extents->_next_data_offset = file_extents->_file_size;
+		file_extents->_next_hole_offset = file_extents->_file_size;
+		return true;
+	}
+	
+	off_t hole_offset = lseek(file_descriptor, data_offset, SEEK_HOLE);
+	if (hole_offset < 0) return false;
+	
+	file_extents->_next_data_offset = data_offset - region_offset;
+	file_extents->_next_hole_offset = hole_offset - region_offset;
+	
+	return true;
+}
+
+/*!
+ * 	Reads the current block of a file, that can have its data and hole regions queried.
+ * 	If the block lies completely in a hole, it isn't read at all, but is marked as a block of zeros.
+ * 	Otherwise, it is read at its explicit offset, so that skipped blocks don't need any seeking.
+ * 	
+ * 	\return	If no IO error occured, returns true.
+ * */
+static bool ReadSparseBlock(struct FilesToCompare* handler, size_t file_index)
+{
+	struct FileExtents* file_extents = &handler->_file_extents[file_index];
+	
+	if (!UpdateExtents(handler, file_index)) return false;
+	
+	
+	
+	long long bytes_left = file_extents->_file_size - handler->_block_offset;
+	size_t block_length = (bytes_left < (long long)handler->_compare_buffer_size) ? (size_t)(bytes_left > 0 ? bytes_left : 0) : handler->_compare_buffer_size;
+	
+	if (handler->_block_offset + (long long)block_length <= file_extents->_next_data_offset)
+	{
+		handler->_zero_blocks[file_index] = true;
+		handler->_buffers_byte_among[file_index] = block_length;
+		return true;
+	}
+	
+	
+	
+	size_t bytes_read = 0;
+	size_t read_size = GetReadSize(handler, file_index);
+	long long file_offset = GetRegionOffset(handler, file_index) + handler->_block_offset;
+	
+	if (CmpDevice_IsScheduled(handler->_device_scheduler, file_index))
+	{
+		if (!CmpDevice_ReadBlock(handler->_device_scheduler, file_index, file_offset, handler->_compare_buffers[file_index], read_size, &bytes_read)) return false;
+		
+		handler->_buffers_byte_among[file_index] = bytes_read;
+		return true;
+	}
+	
+	if (!OpenPooledFile(handler, file_index)) return false;
+	else if (handler->_throttle != NULL) CmpThrottle_Acquire(handler->_throttle, handler->_file_devices[file_index], read_size);
+	
+	long long read_result = CmpIo_ReadAt(handler->_files[file_index], handler->_compare_buffers[file_index], read_size, file_offset);
+	if (read_result < 0) return false;
+	
+	handler->_buffers_byte_among[file_index] = (size_t)read_result;
+	
+	return true;
+}
+
+/*!
+ * 	Requests the current blocks of the scheduled files from the device scheduler, so that the ones on different devices are read at the same time.
+ * 	Blocks, that lie completely in a hole, aren't requested, since they won't be read.
+ * */
+static void PrefetchBlocks(struct FilesToCompare* handler)
+{
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		else if (!handler->_file_extents[at_index]._can_seek_holes || !CmpDevice_IsScheduled(handler->_device_scheduler, at_index)) continue;
+		else if (!UpdateExtents(handler, at_index)) continue;
+		
+		if (handler->_block_offset + (long long)handler->_compare_buffer_size > handler->_file_extents[at_index]._next_data_offset)
+		{
+			CmpDevice_RequestBlock(handler->_device_scheduler, at_index, GetRegionOffset(handler, at_index) + handler->_block_offset);
+		}
+	}
+	
+	CmpDevice_Prefetch(handler->_device_scheduler);
+}
+#endif
+
+
+
+/*!
+ * 	Frees the slot of a file, so that another file can use it.
+ * */
+static void ReleaseSlot(struct FilesToCompare* handler, size_t file_index)
+{
+	if (handler->_among_of_slots == 0 || handler->_file_slots[file_index] == NO_FILE_INDEX) return;
+	
+	size_t slot = handler->_file_slots[file_index];
+	
+	handler->_slot_files[slot] = NO_FILE_INDEX;
+	handler->_file_slots[file_index] = NO_FILE_INDEX;
+	handler->_compare_buffers[file_index] = NULL;
+	handler->_free_slots[handler->_among_of_free_slots] = slot;
+	handler->_among_of_free_slots += 1;
+}
+
+/*!
+ * 	Gives a file a slot for its current block: a free one, or else the next one in turn, whose block can be read again.
+ * 	The blocks of the pinned file, of the reference file, and of files that are read sequentially (so they can't be read again) are never taken over.
+ * 
+ * 	\return	If the file has a slot, returns true.
+ * */
+static bool AcquireSlot(struct FilesToCompare* handler, size_t file_index, size_t pinned_index)
+{
+	if (handler->_among_of_slots == 0 || handler->_file_slots[file_index] != NO_FILE_INDEX) return true;
+	
+	
+	
+	size_t slot = NO_FILE_INDEX;
+	
+	if (handler->_among_of_free_slots > 0)
+	{
+		handler->_among_of_free_slots -= 1;
+		slot = handler->_free_slots[handler->_among_of_free_slots];
+	}
+	
+	for (size_t at_step = 0; at_step < handler->_among_of_slots && slot == NO_FILE_INDEX; at_step += 1)
+	{
+		size_t at_slot = handler->_slot_hand;
+		size_t owner = handler->_slot_files[at_slot];
+		handler->_slot_hand = (at_slot + 1) % handler->_among_of_slots;
+		
+		if (owner == pinned_index || owner == handler->_reference_index || !handler->_file_extents[owner]._can_seek_holes) continue;
+		
+		handler->_file_slots[owner] = NO_FILE_INDEX;
+		handler->_compare_buffers[owner] = NULL;
+		slot = at_slot;
+	}
+	
+	if (slot == NO_FILE_INDEX) return false;
+	
+	
+	
+	handler->_slot_files[slot] = file_index;
+	handler->_file_slots[file_index] = slot;
+	handler->_compare_buffers[file_index] = handler->_slot_buffers[slot];
+	
+	return true;
+}
+
+
+
+/*!
+ * 	Checks, if a file can continue at a block offset in its compared region.
+ * 	Files, that can seek, are read at explicit offsets, so they don't need to be moved.
+ * 	
+ * 	\return	If the file can continue there, returns true. A file, that can't seek (like a pipe), can only continue where it is.
+ * */
+static bool MoveToBlock(struct FilesToCompare* handler, size_t file_index, long long block_offset)
+{
+	struct IoFile* file = handler->_files[file_index];
+	
+	(void)block_offset;
+	
+	return file == NULL || (file->_capabilities & IO_SEEKABLE) != 0;
+}
+
+/*!
+ * 	Reads and throws away the bytes before the compared region of a file, that can't seek.
+ * 	A file, that ends before its region, is left at its end.
+ * 	
+ * 	\return	If no IO error occured, returns true.
+ * */
+static bool DiscardBytes(struct FilesToCompare* handler, size_t file_index, long long among_of_bytes)
+{
+	bool bytes_were_read = true;
+	
+	if (!AcquireSlot(handler, file_index, NO_FILE_INDEX)) return false;
+	
+	while (among_of_bytes > 0)
+	{
+		size_t wanted_bytes = (among_of_bytes < (long long)handler->_compare_buffer_size) ? (size_t)among_of_bytes : handler->_compare_buffer_size;
+		
+		if (handler->_throttle != NULL) CmpThrottle_Acquire(handler->_throttle, handler->_file_devices[file_index], wanted_bytes);
+		
+		long long discarded_bytes = CmpIo_ReadAt(handler->_files[file_index], handler->_compare_buffers[file_index], wanted_bytes, IO_CURRENT_OFFSET);
+		bytes_were_read = discarded_bytes >= 0;
+		
+		if (discarded_bytes < (long long)wanted_bytes) break;
+		
+		among_of_bytes -= discarded_bytes;
+	}
+	
+	ReleaseSlot(handler, file_index);
+	
+	return bytes_were_read;
+}
+
+
+
+/*!
+ * 	Reads the current block of the file into its buffer (and gives it a slot first, if the files share the buffers).
+ * 	
+ * 	\return	If no IO error occured, returns true.
+ * */
+static bool ReadBlock(struct FilesToCompare* handler, size_t file_index)
+{
+	if (!AcquireSlot(handler, file_index, NO_FILE_INDEX)) return false;
+	
+	long long trace_time = CmpTrace_Begin();
+	bool block_was_read;
+	
+	handler->_zero_blocks[file_index] = false;
+	
+	#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+	if (handler->_file_extents[file_index]._can_seek_holes) 
+	{
+		block_was_read = ReadSparseBlock(handler, file_index);
+		CmpTrace_End("read", "io", trace_time, (long long)file_index, handler->_block_offset, NULL);
+		return block_was_read;
+	}
+	#endif
+	
+	size_t read_size = GetReadSize(handler, file_index);
+	struct IoFile* file = handler->_files[file_index];
+	
+	if (handler->_throttle != NULL) CmpThrottle_Acquire(handler->_throttle, handler->_file_devices[file_index], read_size);
+	
+	//	Files, that can seek, are read at the offset of the block, and the others (like pipes) from where they are.
+	long long file_offset = (file != NULL && (file->_capabilities & IO_SEEKABLE) != 0) ? GetRegionOffset(handler, file_index) + handler->_block_offset : IO_CURRENT_OFFSET;
+	long long read_result = CmpIo_ReadAt(file, handler->_compare_buffers[file_index], read_size, file_offset);
+	
+	handler->_buffers_byte_among[file_index] = (read_result > 0) ? (size_t)read_result : 0;
+	block_was_read = read_result >= 0;
+	
+	CmpTrace_End("read", "io", trace_time, (long long)file_index, handler->_block_offset, NULL);
+	
+	return block_was_read;
+}
+
+/*!
+ * 	Makes sure, that the current block of a file is in a slot, and reads it again, if its slot was taken over.
+ * 	Blocks of zeros from a hole aren't stored in the buffer, so they don't need a slot.
+ * 
+ * 	\return	If the block is in a slot (or doesn't need one), returns true.
+ * */
+static bool LoadBlock(struct FilesToCompare* handler, size_t file_index, size_t pinned_index)
+{
+	if (handler->_among_of_slots == 0 || handler->_file_slots[file_index] != NO_FILE_INDEX || handler->_zero_blocks[file_index]) return true;
+	
+	return AcquireSlot(handler, file_index, pinned_index) && ReadBlock(handler, file_index);
+}
+
+/*!
+ * 	Checks, if the current blocks of both files are matched.
+ * 	Since a short read only happens at the end of a file, blocks of the same length also end both files at the same time.
+ * 	
+ * 	A block of zeros from a hole is matched with another one without any comparing,
+ * 	and with a read block by scanning it for non-zero bytes.
+ * */
+static bool BlocksMatch(struct FilesToCompare* handler, size_t file_index, size_t with_file_index)
+{
+	size_t bytes_to_check = handler->_buffers_byte_among[file_index];
+	
+	if (bytes_to_check != handler->_buffers_byte_among[with_file_index]) return false;
+	else if (bytes_to_check == 0) return true;
+	else if (!LoadBlock(handler, file_index, with_file_index) || !LoadBlock(handler, with_file_index, file_index)) return false;
+	
+	
+	
+	bool is_zero_block = handler->_zero_blocks[file_index];
+	bool with_is_zero_block = handler->_zero_blocks[with_file_index];
+	
+	if (is_zero_block && with_is_zero_block) return true;
+	else if (is_zero_block) return CmpKernel_IsZero(handler->_compare_buffers[with_file_index], bytes_to_check);
+	else if (with_is_zero_block) return CmpKernel_IsZero(handler->_compare_buffers[file_index], bytes_to_check);
+	
+	return memcmp(handler->_compare_buffers[file_index], handler->_compare_buffers[with_file_index], bytes_to_check) == 0;
+}
+
+/*!
+ * 	Finds the first byte of the current block, in which a file differs from another one.
+ * 	Blocks from holes are compared as the zero buffer, and blocks in slots are read again, if their slot was taken over.
+ * 	Only if a block can't get a slot (or be read again), the difference is put at the start of the block.
+ * */
+static size_t FindDifferenceInBlock(struct FilesToCompare* handler, size_t file_index, size_t with_file_index)
+{
+	size_t common_length = handler->_buffers_byte_among[file_index];
+	if (handler->_buffers_byte_among[with_file_index] < common_length) common_length = handler->_buffers_byte_among[with_file_index];
+	
+	if (!LoadBlock(handler, file_index, with_file_index) || !LoadBlock(handler, with_file_index, file_index)) return 0;
+	
+	const unsigned char* block = handler->_zero_blocks[file_index] ? handler->_zero_buffer : handler->_compare_buffers[file_index];
+	const unsigned char* with_block = handler->_zero_blocks[with_file_index] ? handler->_zero_buffer : handler->_compare_buffers[with_file_index];
+	
+	return CmpKernel_FindDifference(block, with_block, common_length);
+}
+
+/*!
+ * 	Calculates the fingerprint of the current block of a file.
+ * 	Blocks of zeros use the zero buffer instead, and a whole block of zeros uses the cached fingerprint.
+ * */
+static uint64_t BlockFingerprint(struct FilesToCompare* handler, size_t file_index)
+{
+	size_t block_length = handler->_buffers_byte_among[file_index];
+	
+	if (!handler->_zero_blocks[file_index]) return CmpKernel_Fingerprint(handler->_compare_buffers[file_index], block_length);
+	else if (block_length == handler->_compare_buffer_size) return handler->_zero_fingerprint;
+	else return CmpKernel_Fingerprint(handler->_zero_buffer, block_length);
+}
+
+/*!
+ * 	Skips the blocks, in which every file that is still compared has a hole, since they would all be matched anyway.
+ * 	Only whole blocks are skipped, so that the files stay aligned to the block size.
+ * 	Nothing is skipped, if any of the compared files can't have its hole regions queried.
+ * */
+static void SkipCommonHoles(struct FilesToCompare* handler)
+{
+	#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+	long long common_hole_end = -1;
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		else if (!handler->_file_extents[at_index]._can_seek_holes) return;
+		else if (!UpdateExtents(handler, at_index)) return;
+		
+		long long hole_end = handler->_file_extents[at_index]._next_data_offset;
+		if (common_hole_end < 0 || hole_end < common_hole_end) common_hole_end = hole_end;
+	}
+	
+	if (common_hole_end < 0) return;
+	
+	
+	
+	long long skipped_blocks = (common_hole_end - handler->_block_offset) / (long long)handler->_compare_buffer_size;
+	if (skipped_blocks > 0) handler->_block_offset += skipped_blocks * (long long)handler->_compare_buffer_size;
+	#else
+	(void)handler;
+	#endif
+}
+
+
+
+/*!
+ * 	Compares the current block of a file with the representatives of the groups, 
+ * 	which were split off from its group in the current block, and moves it into the first one that matches.
+ * 	If none matches, the file becomes the representative of a new group.
+ * 
+ * 	The first file of a group, that gets compared, keeps the groups identifier.
+ * 
+ * 	\return	If the file became a representative (so its block is still needed), returns true.
+ * */
+static bool SortIntoGroup(struct FilesToCompare* handler, size_t file_index)
+{
+	size_t group_id = handler->_group_ids[file_index];
+	size_t representative = handler->_block_representatives[group_id];
+	
+	handler->_next_representatives[file_index] = NO_FILE_INDEX;
+	
+	if (representative == NO_FILE_INDEX)
+	{
+		handler->_block_representatives[group_id] = file_index;
+		return true;
+	}
+	
+	
+	
+	while (true)
+	{
+		if (BlocksMatch(handler, representative, file_index))
+		{
+			MoveToGroup(handler, file_index, handler->_group_ids[representative]);
+			return false;
+		}
+		else if (handler->_next_representatives[representative] == NO_FILE_INDEX)
+		{
+			RecordMismatch(handler, file_index, FindDifferenceInBlock(handler, handler->_block_representatives[group_id], file_index));
+			MoveToNewGroup(handler, file_index);
+			handler->_next_representatives[representative] = file_index;
+			return true;
+		}
+		
+		representative = handler->_next_representatives[representative];
+	}
+}
+
+/*!
+ * 	Routes the current block of a file to the representative of a group, that was split off from its group in the current block,
+ * 	by looking up the blocks fingerprint in the fingerprint table.
+ * 	The file is moved into the representatives group only if their blocks are matched byte by byte,
+ * 	so a fingerprint collision only costs one extra comparing.
+ * 	If none matches, the file becomes the representative of a new group, and is put into the table.
+ * 
+ * 	The first file of a group, that gets compared, keeps the groups identifier.
+ * 
+ * 	\return	If the file became a representative (so its block is still needed), returns true.
+ * */
+static bool SortIntoGroupByFingerprint(struct FilesToCompare* handler, size_t file_index)
+{
+	size_t group_id = handler->_group_ids[file_index];
+	uint64_t fingerprint = handler->_block_fingerprints[file_index];
+	
+	const size_t BUCKET_MASK = handler->_number_of_buckets - 1;
+	size_t at_bucket = (size_t)((fingerprint ^ ((uint64_t)group_id * 0x9E3779B97F4A7C15ULL)) & BUCKET_MASK);
+	
+	
+	
+	//	Linear probing: the table has at least twice as many buckets as there are files, so a empty bucket is always found.
+	while (handler->_bucket_blocks[at_bucket] == handler->_block_number)
+	{
+		size_t representative = handler->_bucket_representatives[at_bucket];
+		
+		bool is_candidate = 	(handler->_bucket_group_ids[at_bucket] == group_id) && 
+										(handler->_block_fingerprints[representative] == fingerprint);
+		
+		if (is_candidate && BlocksMatch(handler, representative, file_index))
+		{
+			MoveToGroup(handler, file_index, handler->_group_ids[representative]);
+			return false;
+		}
+		
+		at_bucket = (at_bucket + 1) & BUCKET_MASK;
+	}
+	
+	
+	
+	if (handler->_block_representatives[group_id] == NO_FILE_INDEX)
+	{
+		handler->_block_representatives[group_id] = file_index;
+	}
+	else
+	{
+		RecordMismatch(handler, file_index, FindDifferenceInBlock(handler, handler->_block_representatives[group_id], file_index));
+		MoveToNewGroup(handler, file_index);
+	}
+	
+	handler->_bucket_blocks[at_bucket] = handler->_block_number;
+	handler->_bucket_representatives[at_bucket] = file_index;
+	handler->_bucket_group_ids[at_bucket] = group_id;
+	
+	return true;
+}
+
+
+
+
+
+
+/*!
+ * 	Moves a file, that can't match the reference file, out of its group, so that it gets marked as unique.
+ * */
+static void DetachFromReference(struct FilesToCompare* handler, size_t file_index)
+{
+	if (handler->_group_sizes[handler->_group_ids[file_index]] > 1) MoveToNewGroup(handler, file_index);
+}
+
+/*!
+ * 	Checks the parts of the pairs from first_part to last_part (excluding), for CmpPool_Run.
+ * */
+static void CheckPairParts(void* context, size_t first_part, size_t last_part)
+{
+	struct FilesToCompare* handler = context;
+	
+	for (size_t at_part = first_part; at_part < last_part; at_part += 1)
+	{
+		size_t pair_index = at_part % handler->_among_of_pairs;
+		size_t first_file = handler->_pair_firsts[pair_index];
+		size_t second_file = handler->_pair_seconds[pair_index];
+		size_t block_length = handler->_buffers_byte_among[first_file];
+		size_t part_start = (at_part / handler->_among_of_pairs) * handler->_part_size;
+		
+		if (part_start >= block_length)
+		{
+			handler->_part_matches[at_part] = true;
+			continue;
+		}
+		
+		size_t part_length = (block_length - part_start < handler->_part_size) ? block_length - part_start : handler->_part_size;
+		handler->_part_matches[at_part] = memcmp(handler->_compare_buffers[first_file] + part_start, handler->_compare_buffers[second_file] + part_start, part_length) == 0;
+	}
+}
+
+/*!
+ * 	Checks the blocks of every pair in _pair_firsts and _pair_seconds (set up to _among_of_pairs) with the compare threads.
+ * 	Few pairs have their blocks split into more parts, so that every thread gets some of them.
+ * 	Afterwards, the first _among_of_pairs entries of _part_matches hold, if the blocks of each pair match.
+ * */
+static void CheckPairs(struct FilesToCompare* handler)
+{
+	const size_t AMONG_OF_THREADS = CmpPool_GetThreads(handler->_compare_pool);
+	const size_t MOST_PARTS = (handler->_compare_buffer_size > MINIMUM_PART_SIZE) ? handler->_compare_buffer_size / MINIMUM_PART_SIZE : 1;
+	
+	if (handler->_among_of_pairs == 0) return;
+	
+	handler->_parts_per_pair = (AMONG_OF_THREADS + handler->_among_of_pairs - 1) / handler->_among_of_pairs;
+	if (handler->_parts_per_pair > MOST_PARTS) handler->_parts_per_pair = MOST_PARTS;
+	
+	handler->_part_size = (handler->_compare_buffer_size + handler->_parts_per_pair - 1) / handler->_parts_per_pair;
+	
+	CmpPool_Run(handler->_compare_pool, CheckPairParts, handler, handler->_among_of_pairs * handler->_parts_per_pair);
+	
+	
+	
+	for (size_t at_part = handler->_among_of_pairs; at_part < handler->_among_of_pairs * handler->_parts_per_pair; at_part += 1)
+	{
+		size_t pair_index = at_part % handler->_among_of_pairs;
+		handler->_part_matches[pair_index] = handler->_part_matches[pair_index] && handler->_part_matches[at_part];
+	}
+}
+
+/*!
+ * 	Calculates the fingerprints of the current blocks of the compared files from first_file to last_file (excluding), for CmpPool_Run.
+ * */
+static void FingerprintBlocks(void* context, size_t first_file, size_t last_file)
+{
+	struct FilesToCompare* handler = context;
+	
+	for (size_t at_index = first_file; at_index < last_file; at_index += 1)
+	{
+		if (handler->_file_states[at_index] == FILE_COMPARING) handler->_block_fingerprints[at_index] = BlockFingerprint(handler, at_index);
+	}
+}
+
+
+
+/*!
+ * 	Detaches the compared files, that aren't in the group of the reference file (or all of them, if the reference file isn't compared),
+ * 	since they can't match it anymore.
+ * */
+static void DetachMismatchedFiles(struct FilesToCompare* handler)
+{
+	const size_t REFERENCE_INDEX = handler->_reference_index;
+	bool reference_is_compared = handler->_file_states[REFERENCE_INDEX] == FILE_COMPARING;
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (at_index == REFERENCE_INDEX || handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		if (!reference_is_compared || handler->_group_ids[at_index] != handler->_group_ids[REFERENCE_INDEX]) DetachFromReference(handler, at_index);
+	}
+}
+
+/*!
+ * 	Compares the current block of every file, that still matches the reference file, with the block of the reference file,
+ * 	and detaches the files, that don't match it.
+ * 	Blocks from holes, and blocks of differing lengths, are compared one by one, the rest with the tiled kernel at once.
+ * */
+static void CompareWithReference(struct FilesToCompare* handler)
+{
+	const size_t REFERENCE_INDEX = handler->_reference_index;
+	
+	DetachMismatchedFiles(handler);
+	if (handler->_file_states[REFERENCE_INDEX] != FILE_COMPARING) return;
+	
+	
+	
+	size_t among_of_candidates = 0;
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (at_index == REFERENCE_INDEX || handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		bool is_plain_block = 	!handler->_zero_blocks[at_index] && !handler->_zero_blocks[REFERENCE_INDEX] &&
+										(handler->_buffers_byte_among[at_index] == handler->_buffers_byte_among[REFERENCE_INDEX]);
+		
+		if (is_plain_block)
+		{
+			handler->_reference_candidates[among_of_candidates++] = at_index;
+		}
+		else if (!BlocksMatch(handler, REFERENCE_INDEX, at_index))
+		{
+			RecordMismatch(handler, at_index, FindDifferenceInBlock(handler, REFERENCE_INDEX, at_index));
+			DetachFromReference(handler, at_index);
+		}
+	}
+	
+	if (among_of_candidates == 0) return;
+	
+	
+	
+	size_t matched_among = 0;
+	
+	if (handler->_compare_pool != NULL)
+	{
+		for (size_t at_candidate = 0; at_candidate < among_of_candidates; at_candidate += 1)
+		{
+			handler->_pair_firsts[at_candidate] = REFERENCE_INDEX;
+			handler->_pair_seconds[at_candidate] = handler->_reference_candidates[at_candidate];
+		}
+		
+		handler->_among_of_pairs = among_of_candidates;
+		CheckPairs(handler);
+		
+		for (size_t at_candidate = 0; at_candidate < among_of_candidates; at_candidate += 1)
+		{
+			handler->_candidate_matches[at_candidate] = handler->_part_matches[at_candidate];
+			matched_among += handler->_candidate_matches[at_candidate];
+		}
+	}
+	else
+	{
+		matched_among = CmpKernel_MatchReference(handler->_compare_buffers[REFERENCE_INDEX], handler->_buffers_byte_among[REFERENCE_INDEX], 
+																	handler->_compare_buffers, handler->_reference_candidates, among_of_candidates, handler->_candidate_matches);
+	}
+	
+	if (matched_among == among_of_candidates) return;
+	
+	for (size_t at_candidate = 0; at_candidate < among_of_candidates; at_candidate += 1)
+	{
+		if (handler->_candidate_matches[at_candidate]) continue;
+		
+		RecordMismatch(handler, handler->_reference_candidates[at_candidate], FindDifferenceInBlock(handler, REFERENCE_INDEX, handler->_reference_candidates[at_candidate]));
+		DetachFromReference(handler, handler->_reference_candidates[at_candidate]);
+	}
+}
+
+
+
+/*!
+ * 	Checks the current block of every file, that was set up for splitting, against the first file of its group with the compare threads,
+ * 	and leaves only the files of the groups, that have a file, which didn't match. The files stay in their order.
+ * 
+ * 	\return	The among of files, that are left.
+ * */
+static size_t NarrowToSplitGroups(struct FilesToCompare* handler, size_t among_of_files)
+{
+	handler->_among_of_pairs = 0;
+	
+	for (size_t at_file = 0; at_file < among_of_files; at_file += 1)
+	{
+		size_t file_index = handler->_split_files[at_file];
+		size_t representative = handler->_split_representatives[file_index];
+		
+		handler->_split_groups[handler->_group_ids[file_index]] = false;
+		
+		if (representative == file_index) continue;
+		else if (handler->_buffers_byte_among[file_index] != handler->_buffers_byte_among[representative]) continue;
+		
+		handler->_pair_firsts[handler->_among_of_pairs] = representative;
+		handler->_pair_seconds[handler->_among_of_pairs] = file_index;
+		handler->_among_of_pairs += 1;
+	}
+	
+	CheckPairs(handler);
+	
+	
+	
+	size_t at_pair = 0;
+	
+	for (size_t at_file = 0; at_file < among_of_files; at_file += 1)
+	{
+		size_t file_index = handler->_split_files[at_file];
+		size_t representative = handler->_split_representatives[file_index];
+		
+		if (representative == file_index) continue;
+		else if (handler->_buffers_byte_among[file_index] != handler->_buffers_byte_among[representative]) handler->_split_groups[handler->_group_ids[file_index]] = true;
+		else if (!handler->_part_matches[at_pair++]) handler->_split_groups[handler->_group_ids[file_index]] = true;
+	}
+	
+	size_t among_of_left_files = 0;
+	
+	for (size_t at_file = 0; at_file < among_of_files; at_file += 1)
+	{
+		size_t file_index = handler->_split_files[at_file];
+		if (handler->_split_groups[handler->_group_ids[file_index]]) handler->_split_files[among_of_left_files++] = file_index;
+	}
+	
+	return among_of_left_files;
+}
+
+/*!
+ * 	Splits the groups by the current blocks of all compared files at once, with the tiled kernel,
+ * 	and then moves the files into their groups in their order, the same way as sorting them one by one would.
+ * 	The first file of each group is the representative of the class, that keeps the groups identifier.
+ * */
+static void SplitGroupsByTiles(struct FilesToCompare* handler)
+{
+	size_t among_of_files = 0;
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		size_t group_id = handler->_group_ids[at_index];
+		if (handler->_block_representatives[group_id] == NO_FILE_INDEX) handler->_block_representatives[group_id] = at_index;
+		
+		handler->_split_representatives[at_index] = handler->_block_representatives[group_id];
+		handler->_split_files[among_of_files++] = at_index;
+	}
+	
+	//	With the compare threads, only the groups, that have a file, which doesn't match, are split.
+	if (handler->_compare_pool != NULL) among_of_files = NarrowToSplitGroups(handler, among_of_files);
+	
+	size_t among_of_classes = CmpKernel_SplitClasses(handler->_compare_buffers, handler->_buffers_byte_among, handler->_split_files, among_of_files, 
+																		handler->_split_representatives, handler->_split_offsets, handler->_split_scratch);
+	
+	if (among_of_classes == 0) return;
+	
+	
+	
+	for (size_t at_file = 0; at_file < among_of_files; at_file += 1)
+	{
+		size_t file_index = handler->_split_files[at_file];
+		size_t representative = handler->_split_representatives[file_index];
+		
+		if (representative != file_index)
+		{
+			MoveToGroup(handler, file_index, handler->_group_ids[representative]);
+		}
+		else if (handler->_block_representatives[handler->_group_ids[file_index]] != file_index)
+		{
+			RecordMismatch(handler, file_index, handler->_split_offsets[file_index]);
+			MoveToNewGroup(handler, file_index);
+		}
+	}
+}
+
+/*!
+ * 	Reads the current block of every compared file into its buffer, and splits the groups by them (or compares them with the reference file).
+ * 	Unless the fingerprints are used, the groups are split by the tiled kernel, 
+ * 	and only blocks with holes have their files compared with the representatives one by one.
+ * */
+static void CompareBlockInBuffers(struct FilesToCompare* handler)
+{
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	const bool USES_REFERENCE = handler->_reference_index != NO_FILE_INDEX;
+	bool has_zero_blocks = false;
+	
+	//	Read the files contents into their respective buffers.
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		if (!ReadBlock(handler, at_index)) MarkAsFailed(handler, at_index);
+		else if (handler->_use_fingerprints && handler->_compare_pool == NULL) handler->_block_fingerprints[at_index] = BlockFingerprint(handler, at_index);
+		
+		has_zero_blocks = has_zero_blocks || (handler->_file_states[at_index] == FILE_COMPARING && handler->_zero_blocks[at_index]);
+	}
+	
+	if (handler->_use_fingerprints && handler->_compare_pool != NULL) CmpPool_Run(handler->_compare_pool, FingerprintBlocks, handler, FILES_AMONG);
+	
+	
+	
+	//	Split the groups by the contents of their current blocks.
+	long long trace_time = CmpTrace_Begin();
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG && !USES_REFERENCE; at_index += 1)
+	{
+		if (handler->_file_states[at_index] == FILE_COMPARING) handler->_block_representatives[handler->_group_ids[at_index]] = NO_FILE_INDEX;
+	}
+	
+	if (!USES_REFERENCE && !handler->_use_fingerprints && !has_zero_blocks) SplitGroupsByTiles(handler);
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG && !USES_REFERENCE && (handler->_use_fingerprints || has_zero_blocks); at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		if (handler->_use_fingerprints) SortIntoGroupByFingerprint(handler, at_index);
+		else SortIntoGroup(handler, at_index);
+	}
+	
+	if (USES_REFERENCE) CompareWithReference(handler);
+	
+	CmpTrace_End("compare", "compare", trace_time, -1, handler->_block_offset, NULL);
+}
+
+/*!
+ * 	Reads and compares the current block of the compared files one after another, when they share a few buffers (slots).
+ * 	A file keeps its slot only while it is a representative of a group (or the reference file), the slots of the others are freed right after their comparing.
+ * 	Representatives, whose slot was taken over, have their block read again, once they are compared with.
+ * */
+static void CompareBlockInSlots(struct FilesToCompare* handler)
+{
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	const size_t REFERENCE_INDEX = handler->_reference_index;
+	const bool USES_REFERENCE = REFERENCE_INDEX != NO_FILE_INDEX;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG && !USES_REFERENCE; at_index += 1)
+	{
+		if (handler->_file_states[at_index] == FILE_COMPARING) handler->_block_representatives[handler->_group_ids[at_index]] = NO_FILE_INDEX;
+	}
+	
+	if (USES_REFERENCE && handler->_file_states[REFERENCE_INDEX] == FILE_COMPARING && !ReadBlock(handler, REFERENCE_INDEX))
+	{
+		MarkAsFailed(handler, REFERENCE_INDEX);
+		DetachMismatchedFiles(handler);
+	}
+	
+	
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING || at_index == REFERENCE_INDEX) continue;
+		else if (USES_REFERENCE && handler->_group_ids[at_index] != handler->_group_ids[REFERENCE_INDEX]) continue;
+		
+		if (!ReadBlock(handler, at_index))
+		{
+			MarkAsFailed(handler, at_index);
+			ReleaseSlot(handler, at_index);
+			continue;
+		}
+		
+		long long trace_time = CmpTrace_Begin();
+		bool keeps_block = false;
+		
+		if (USES_REFERENCE && !BlocksMatch(handler, REFERENCE_INDEX, at_index))
+		{
+			RecordMismatch(handler, at_index, FindDifferenceInBlock(handler, REFERENCE_INDEX, at_index));
+			DetachFromReference(handler, at_index);
+		}
+		else if (!USES_REFERENCE && handler->_use_fingerprints)
+		{
+			handler->_block_fingerprints[at_index] = BlockFingerprint(handler, at_index);
+			keeps_block = SortIntoGroupByFingerprint(handler, at_index);
+		}
+		else if (!USES_REFERENCE)
+		{
+			keeps_block = SortIntoGroup(handler, at_index);
+		}
+		
+		CmpTrace_End("compare", "compare", trace_time, (long long)at_index, handler->_block_offset, NULL);
+		
+		if (!keeps_block) ReleaseSlot(handler, at_index);
+	}
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1) ReleaseSlot(handler, at_index);
+}
+
+
+
+/*!
+ * 	Checks, if a group of at least the quorum size was read till its end.
+ * */
+static bool QuorumIsReached(struct FilesToCompare* handler)
+{
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] == FILE_FINISHED && handler->_group_sizes[handler->_group_ids[at_index]] >= handler->_quorum) return true;
+	}
+	
+	return false;
+}
+
+/*!
+ * 	Abandons the compared files, whose group is smaller than the quorum, or all of them, once the quorum is reached.
+ * 	Groups only get smaller, so an abandoned file couldn't have been in a group of the quorum size anyway.
+ * 
+ * 	\return	The among of files, that are still compared.
+ * */
+static size_t AbandonOutliers(struct FilesToCompare* handler)
+{
+	bool quorum_is_reached = QuorumIsReached(handler);
+	size_t compared_files = 0;
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		if (quorum_is_reached || handler->_group_sizes[handler->_group_ids[at_index]] < handler->_quorum)
+		{
+			handler->_file_states[at_index] = FILE_ABANDONED;
+			CmpTrace_Mark("abandoned", "decision", (long long)at_index, handler->_block_offset);
+			ReportDecision(handler, at_index, handler->_block_offset);
+		}
+		else
+		{
+			compared_files += 1;
+		}
+	}
+	
+	return compared_files;
+}
+
+/*!
+ * 	Compares the files, that are marked as FILE_COMPARING, block by block from the current block offset,
+ * 	until each of them is either left alone in its group, or read till its end.
+ * 	If a reference file is set, the files are only compared with it, instead of being sorted into groups.
+ * 	With a quorum, the files, that can't be in a group of its size, are abandoned first (like the files, whose size no group of its size has).
+ * */
+static void CompareActiveFiles(struct FilesToCompare* handler)
+{
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	const bool USES_REFERENCE = handler->_reference_index != NO_FILE_INDEX;
+	size_t compared_files = 0;
+	
+	if (handler->_quorum > 0 && AbandonOutliers(handler) == 0) return;
+	
+	do
+	{
+		if (USES_REFERENCE) DetachMismatchedFiles(handler);
+		
+		
+		SkipCommonHoles(handler);
+		
+		#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+		if (handler->_device_scheduler != NULL) PrefetchBlocks(handler);
+		#endif
+		
+		
+		
+		if (handler->_among_of_slots > 0) CompareBlockInSlots(handler);
+		else CompareBlockInBuffers(handler);
+		
+		if (handler->_on_block != NULL) handler->_on_block(handler, handler->_block_context);
+		
+		handler->_block_number += 1;
+		handler->_block_offset += (long long)handler->_compare_buffer_size;
+		
+		
+		
+		//	Files, that were left alone, or that were read till their end, are no longer read.
+		compared_files = 0;
+		
+		for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+		{
+			if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+			
+			if (handler->_group_sizes[handler->_group_ids[at_index]] == 1)
+			{
+				handler->_file_states[at_index] = FILE_UNIQUE;
+				CmpTrace_Mark("unique", "decision", (long long)at_index, handler->_block_offset);
+				ReportDecision(handler, at_index, GetLeftAloneOffset(handler));
+			}
+			else if (handler->_buffers_byte_among[at_index] < handler->_compare_buffer_size)
+			{
+				handler->_file_states[at_index] = FILE_FINISHED;
+				CmpTrace_Mark("finished", "decision", (long long)at_index, handler->_block_offset);
+				ReportDecision(handler, at_index, GetFinishedOffset(handler, at_index));
+			}
+			else
+			{
+				compared_files += 1;
+			}
+		}
+		
+		if (handler->_quorum > 0) compared_files = AbandonOutliers(handler);
+		
+		if (handler->_on_progress != NULL && compared_files > 0 && handler->_block_offset >= handler->_next_progress_offset)
+		{
+			handler->_next_progress_offset = handler->_block_offset + handler->_progress_interval;
+			handler->_on_progress(handler, handler->_progress_context);
+		}
+	}
+	while (compared_files > 0);
+}
+
+/*!
+ * 	Compares exactly two files with each other, without going through the groups block by block,
+ * 	and stops at the first block, in which they differ. Leaves the same states, groups and mismatch offsets as CompareActiveFiles.
+ * */
+static void ComparePair(struct FilesToCompare* handler)
+{
+	while (true)
+	{
+		SkipCommonHoles(handler);
+		
+		bool first_was_read = ReadBlock(handler, 0);
+		bool second_was_read = ReadBlock(handler, 1);
+		
+		if (!first_was_read) MarkAsFailed(handler, 0);
+		if (!second_was_read) MarkAsFailed(handler, 1);
+		
+		long long trace_time = CmpTrace_Begin();
+		bool blocks_match = first_was_read && second_was_read && BlocksMatch(handler, 0, 1);
+		CmpTrace_End("compare", "compare", trace_time, -1, handler->_block_offset, NULL);
+		
+		if (first_was_read && second_was_read && !blocks_match)
+		{
+			RecordMismatch(handler, 1, FindDifferenceInBlock(handler, 0, 1));
+			MoveToNewGroup(handler, 1);
+		}
+		
+		handler->_block_number += 1;
+		handler->_block_offset += (long long)handler->_compare_buffer_size;
+		
+		
+		
+		//	A file, that wasn't matched, leaves the other one alone.
+		if (!blocks_match)
+		{
+			CmpTrace_Mark("unique", "decision", -1, handler->_block_offset);
+			
+			for (size_t at_index = 0; at_index < 2; at_index += 1)
+			{
+				if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+				
+				handler->_file_states[at_index] = FILE_UNIQUE;
+				ReportDecision(handler, at_index, GetLeftAloneOffset(handler));
+			}
+			
+			return;
+		}
+		else if (handler->_buffers_byte_among[0] < handler->_compare_buffer_size)
+		{
+			handler->_file_states[0] = FILE_FINISHED;
+			handler->_file_states[1] = FILE_FINISHED;
+			CmpTrace_Mark("finished", "decision", -1, handler->_block_offset);
+			ReportDecision(handler, 0, GetFinishedOffset(handler, 0));
+			ReportDecision(handler, 1, GetFinishedOffset(handler, 1));
+			return;
+		}
+	}
+}
+
+/*!
+ * 	Checks, if the two files can be compared by ComparePair: both of them are still compared, 
+ * 	and nothing, that is done between the blocks (like following the progress or the blocks, or reading ahead by devices), is needed.
+ * 	With the compare threads (or a quorum), the pair is compared block by block as well.
+ * 	The files also need a buffer each, since both blocks are read before they are compared.
+ * */
+static bool CanComparePair(struct FilesToCompare* handler)
+{
+	return (handler->_number_of_filestreams == 2) && (handler->_file_states[0] == FILE_COMPARING) && (handler->_file_states[1] == FILE_COMPARING) 
+				&& (handler->_reference_index == NO_FILE_INDEX) && (handler->_on_progress == NULL) && (handler->_on_block == NULL) && (handler->_device_scheduler == NULL) && (handler->_among_of_slots == 0)
+				&& (handler->_compare_pool == NULL) && (handler->_quorum == 0);
+}
+
+/*!
+ * 	Checks, if all files are in one group, and were read till their end.
+ * */
+static bool AllFilesMatched(struct FilesToCompare* handler)
+{
+	return (handler->_group_sizes[handler->_group_ids[0]] == handler->_number_of_filestreams) && (handler->_file_states[0] == FILE_FINISHED);
+}
+
+
+
+/*!
+ * 	Allocates and initializes the handler for all of the public initializers.
+ * 	The limits of the open files and the memory only apply, if neither the filestreams, nor the buffers are provided.
+ * */
+static struct FilesToCompare* InitializeHandler(char** filepaths, FILE** filestreams, size_t number_of_files, size_t compare_buffer_size, unsigned char** compare_buffers, 
+																size_t max_open_files, size_t max_memory, const struct IoBackend* io_backend)
+{
+	if (filepaths == NULL) return NULL;
+	else if (number_of_files == 0) return NULL;
+	else if (compare_buffer_size == 0) return NULL;
+	
+	
+	
+	size_t among_of_slots = 0;
+	
+	if (filestreams != NULL || compare_buffers != NULL)
+	{
+		max_open_files = 0;
+	}
+	else if (max_memory > 0 && !FitIntoMemory(number_of_files, max_memory, &compare_buffer_size, &among_of_slots))
+	{
+		fputs("Error in CmpFiles_Initialize: The memory budget is too small for comparing the files!\n", stderr);
+		return NULL;
+	}
+	
+	long long trace_time = CmpTrace_Begin();
+	
+	struct FilesToCompare* handler = malloc(sizeof(struct FilesToCompare));
+	if (handler == NULL) return NULL;
+	
+	
+	
+	handler->_filepaths = NULL;
+	handler->_files = NULL;
+	handler->_io_backend = (io_backend != NULL) ? io_backend : CmpIo_FindBackend(NULL);
+	handler->_compare_buffers = NULL;
+	handler->_buffers_byte_among = NULL;
+	handler->_group_ids = NULL;
+	handler->_group_sizes = NULL;
+	handler->_file_states = NULL;
+	handler->_block_representatives = NULL;
+	handler->_next_representatives = NULL;
+	handler->_split_files = NULL;
+	handler->_split_representatives = NULL;
+	handler->_split_offsets = NULL;
+	handler->_split_scratch = NULL;
+	handler->_combinations_handler = NULL;
+	handler->_number_of_groups = 0;
+	handler->_use_fingerprints = false;
+	handler->_block_fingerprints = NULL;
+	handler->_bucket_representatives = NULL;
+	handler->_bucket_group_ids = NULL;
+	handler->_bucket_blocks = NULL;
+	handler->_number_of_buckets = 0;
+	handler->_block_number = 0;
+	handler->_zero_buffer = NULL;
+	handler->_zero_fingerprint = 0;
+	handler->_zero_blocks = NULL;
+	handler->_file_extents = NULL;
+	handler->_block_offset = 0;
+	handler->_buffers_are_borrowed = false;
+	handler->_reference_index = NO_FILE_INDEX;
+	handler->_quorum = 0;
+	handler->_reference_candidates = NULL;
+	handler->_candidate_matches = NULL;
+	handler->_mismatch_offsets = NULL;
+	handler->_on_progress = NULL;
+	handler->_progress_context = NULL;
+	handler->_progress_interval = 0;
+	handler->_next_progress_offset = 0;
+	handler->_on_block = NULL;
+	handler->_block_context = NULL;
+	handler->_on_decision = NULL;
+	handler->_decision_context = NULL;
+	handler->_throttle = NULL;
+	handler->_file_devices = NULL;
+	handler->_device_scheduler = NULL;
+	handler->_compare_pool = NULL;
+	handler->_pair_firsts = NULL;
+	handler->_pair_seconds = NULL;
+	handler->_among_of_pairs = 0;
+	handler->_part_matches = NULL;
+	handler->_parts_per_pair = 1;
+	handler->_part_size = compare_buffer_size;
+	handler->_split_groups = NULL;
+	handler->_region_offsets = NULL;
+	handler->_region_lengths = NULL;
+	handler->_max_open_files = max_open_files;
+	handler->_among_of_open_files = 0;
+	handler->_pooled_files = NULL;
+	handler->_file_inodes = NULL;
+	handler->_pool_hand = 0;
+	handler->_among_of_slots = among_of_slots;
+	handler->_slot_buffers = NULL;
+	handler->_slot_files = NULL;
+	handler->_file_slots = NULL;
+	handler->_free_slots = NULL;
+	handler->_among_of_free_slots = 0;
+	handler->_slot_hand = 0;
+	
+	handler->_number_of_filestreams = number_of_files;
+	handler->_compare_buffer_size = compare_buffer_size;
+	
+	
+	
+	if (filestreams == NULL && max_open_files > 0)
+	{
+		//	The files are opened one by one later (after the rest is allocated), so that the pooled ones can be closed in between.
+		handler->_files = calloc(number_of_files, sizeof(struct IoFile*));
+		handler->_pooled_files = calloc(number_of_files, sizeof(bool));
+		handler->_file_devices = calloc(number_of_files, sizeof(unsigned long long));
+		handler->_file_inodes = calloc(number_of_files, sizeof(unsigned long long));
+		if (handler->_files == NULL || handler->_pooled_files == NULL || handler->_file_devices == NULL || handler->_file_inodes == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+		
+		size_t among_of_stdin = 0;
+		for (size_t at_index = 0; at_index < number_of_files; at_index += 1) among_of_stdin += (strcmp(filepaths[at_index], STDIN_FILEPATH_MARK) == 0);
+		if (among_of_stdin > 1) goto __CmpFiles_Initialize_FreeRemainingResources;
+	}
+	else if (filestreams == NULL)
+	{
+		handler->_files = OpenFiles(handler->_io_backend, filepaths, number_of_files);
+		if (handler->_files == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	}
+	else
+	{
+		handler->_files = malloc(sizeof(struct IoFile*) * number_of_files);
+		if (handler->_files == NULL)
+		{
+			for (size_t at_index = 0; at_index < number_of_files; at_index += 1) 
+			{
+				if (filestreams[at_index] != NULL && filestreams[at_index] != stdin) fclose(filestreams[at_index]);
+			}
+			
+			goto __CmpFiles_Initialize_FreeRemainingResources;
+		}
+		
+		//	A filestream, that couldn't be taken over (or wasn't opened), is left as NULL, and fails while it is compared.
+		for (size_t at_index = 0; at_index < number_of_files; at_index += 1) handler->_files[at_index] = CmpIo_Adopt(handler->_io_backend, filestreams[at_index]);
+	}
+	
+	
+	
+	handler->_filepaths = AllocateAndCopyFilepaths(filepaths, number_of_files);
+	if (handler->_filepaths == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	
+	
+	
+	if (among_of_slots > 0)
+	{
+		handler->_compare_buffers = calloc(number_of_files, sizeof(unsigned char*));
+		handler->_slot_buffers = AllocateBuffers(among_of_slots, compare_buffer_size);
+		handler->_slot_files = AllocateIndexArray(among_of_slots);
+		handler->_file_slots = AllocateIndexArray(number_of_files);
+		handler->_free_slots = AllocateIndexArray(among_of_slots);
+		if (handler->_compare_buffers == NULL || handler->_slot_buffers == NULL || handler->_slot_files == NULL || handler->_file_slots == NULL || handler->_free_slots == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+		
+		//	Stacked in reverse, so that the first slot is used first.
+		for (size_t at_slot = 0; at_slot < among_of_slots; at_slot += 1) handler->_free_slots[at_slot] = among_of_slots - 1 - at_slot;
+		handler->_among_of_free_slots = among_of_slots;
+	}
+	else if (compare_buffers == NULL)
+	{
+		handler->_compare_buffers = AllocateBuffers(number_of_files, compare_buffer_size);
+		if (handler->_compare_buffers == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	}
+	else
+	{
+		handler->_compare_buffers = malloc(sizeof(unsigned char**) * number_of_files);
+		if (handler->_compare_buffers == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+		
+		memcpy(handler->_compare_buffers, compare_buffers, sizeof(unsigned char**) * number_of_files);
+		handler->_buffers_are_borrowed = true;
+	}
+	
+	
+	
+	handler->_buffers_byte_among = AllocateBuffersByteAmong(number_of_files);
+	if (handler->_buffers_byte_among == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	
+	
+	
+	handler->_group_ids = AllocateIndexArray(number_of_files);
+	handler->_group_sizes = AllocateIndexArray(number_of_files);
+	handler->_block_representatives = AllocateIndexArray(number_of_files);
+	handler->_next_representatives = AllocateIndexArray(number_of_files);
+	handler->_file_states = malloc(sizeof(enum FileState) * number_of_files);
+	if (handler->_group_ids == NULL || handler->_group_sizes == NULL || handler->_block_representatives == NULL || handler->_next_representatives == NULL || handler->_file_states == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	
+	handler->_split_files = AllocateIndexArray(number_of_files);
+	handler->_split_representatives = AllocateIndexArray(number_of_files);
+	handler->_split_offsets = AllocateIndexArray(number_of_files);
+	handler->_split_scratch = (number_of_files <= SIZE_MAX / 3) ? AllocateIndexArray(number_of_files * 3) : NULL;
+	if (handler->_split_files == NULL || handler->_split_representatives == NULL || handler->_split_offsets == NULL || handler->_split_scratch == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	
+	
+	
+	handler->_zero_blocks = calloc(number_of_files, sizeof(bool));
+	handler->_zero_buffer = calloc(compare_buffer_size, sizeof(unsigned char));
+	handler->_file_extents = malloc(sizeof(struct FileExtents) * number_of_files);
+	handler->_mismatch_offsets = malloc(sizeof(long long) * number_of_files);
+	if (handler->_zero_blocks == NULL || handler->_zero_buffer == NULL || handler->_file_extents == NULL || handler->_mismatch_offsets == NULL) goto __CmpFiles_Initialize_FreeRemainingResources;
+	
+	
+	
+	size_t among_of_sequential = 0;
+	
+	for (size_t at_index = 0; at_index < number_of_files; at_index += 1) 
+	{
+		if (handler->_pooled_files == NULL) DetectExtents(handler, at_index);
+		else if (!OpenIntoPool(handler, at_index)) goto __CmpFiles_Initialize_FreeRemainingResources;
+		
+		handler->_file_states[at_index] = FILE_COMPARING;
+		handler->_mismatch_offsets[at_index] = -1;
+		
+		if (!handler->_file_extents[at_index]._can_seek_holes) among_of_sequential += 1;
+	}
+	
+	//	The blocks of files, that are read sequentially, can't be read again, so they can't give up their slots.
+	if (among_of_slots > 0 && among_of_slots < among_of_sequential + MINIMUM_SLOTS)
+	{
+		fputs("Error in CmpFiles_Initialize: The memory budget is too small for the files, that can't be read at explicit offsets (like pipes)!\n", stderr);
+		CmpFiles_Terminate(handler);
+		return NULL;
+	}
+	
+	if (!SeedGroups(handler)) goto __CmpFiles_Initialize_FreeRemainingResources;
+	
+	CmpTrace_End("initialize", "setup", trace_time, -1, -1, NULL);
+	
+	
+	
+	return handler;
+	
+	
+	
+	__CmpFiles_Initialize_FreeRemainingResources:
+		fputs("Error in CmpFiles_Initialize: Couldn't allocate all resources!\n", stderr);
+		CmpFiles_Terminate(handler);
+		
+	return NULL;
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+void CmpFiles_Terminate(struct FilesToCompare* handler)
+{
+	if (handler != NULL)
+	{
+		CloseFiles(handler->_files, handler->_number_of_filestreams);
+		FreeFilepaths(handler->_filepaths, handler->_number_of_filestreams);
+		if (handler->_buffers_are_borrowed || handler->_among_of_slots > 0) free(handler->_compare_buffers);
+		else FreeBuffers(handler->_compare_buffers, handler->_number_of_filestreams);
+		FreeBuffers(handler->_slot_buffers, handler->_among_of_slots);
+		FreeIndexArray(handler->_slot_files);
+		FreeIndexArray(handler->_file_slots);
+		FreeIndexArray(handler->_free_slots);
+		FreeBuffersByteAmong(handler->_buffers_byte_among);
+		FreeIndexArray(handler->_group_ids);
+		FreeIndexArray(handler->_group_sizes);
+		FreeIndexArray(handler->_block_representatives);
+		FreeIndexArray(handler->_next_representatives);
+		FreeIndexArray(handler->_split_files);
+		FreeIndexArray(handler->_split_representatives);
+		FreeIndexArray(handler->_split_offsets);
+		FreeIndexArray(handler->_split_scratch);
+		FreeIndexArray(handler->_bucket_representatives);
+		FreeIndexArray(handler->_bucket_group_ids);
+		FreeIndexArray(handler->_bucket_blocks);
+		if (handler->_block_fingerprints != NULL) free(handler->_block_fingerprints);
+		FreeIndexArray(handler->_reference_candidates);
+		if (handler->_candidate_matches != NULL) free(handler->_candidate_matches);
+		if (handler->_mismatch_offsets != NULL) free(handler->_mismatch_offsets);
+		if (handler->_file_devices != NULL) free(handler->_file_devices);
+		if (handler->_file_inodes != NULL) free(handler->_file_inodes);
+		if (handler->_pooled_files != NULL) free(handler->_pooled_files);
+		if (handler->_region_offsets != NULL) free(handler->_region_offsets);
+		if (handler->_region_lengths != NULL) free(handler->_region_lengths);
+		CmpDevice_Terminate(handler->_device_scheduler);
+		CmpPool_Terminate(handler->_compare_pool);
+		FreeIndexArray(handler->_pair_firsts);
+		FreeIndexArray(handler->_pair_seconds);
+		if (handler->_part_matches != NULL) free(handler->_part_matches);
+		if (handler->_split_groups != NULL) free(handler->_split_groups);
+		if (handler->_zero_buffer != NULL) free(handler->_zero_buffer);
+		if (handler->_zero_blocks != NULL) free(handler->_zero_blocks);
+		if (handler->_file_extents != NULL) free(handler->_file_extents);
+		if (handler->_file_states != NULL) free(handler->_file_states);
+		CmpComb_Terminate(handler->_combinations_handler);
+		free(handler);
+	}
+}
+
+
+struct FilesToCompare* CmpFiles_Initialize(char** filepaths, size_t number_of_files, size_t compare_buffer_size)
+{
+	return InitializeHandler(filepaths, NULL, number_of_files, compare_buffer_size, NULL, 0, 0, NULL);
+}
+
+
+
+/*!
+ * 	The provided filestreams are owned by the handler from here on, even if the initialization fails, 
+ * 	while the provided buffers stay owned by the caller.
+ * */
+struct FilesToCompare* CmpFiles_InitializeWithResources(char** filepaths, FILE** filestreams, size_t number_of_files, size_t compare_buffer_size, unsigned char** compare_buffers)
+{
+	return InitializeHandler(filepaths, filestreams, number_of_files, compare_buffer_size, compare_buffers, 0, 0, NULL);
+}
+
+
+
+/*!
+ * 	Files, that can be read at explicit offsets, are put into a pool, and closed (and reopened later), once the limit of the open files is reached.
+ * 	If the memory budget is too small for a buffer per file, the buffers are shrunk, and if that isn't enough,
+ * 	the files share a smaller among of buffers (slots), and the blocks, whose slots were taken over, are read again.
+ * */
+struct FilesToCompare* CmpFiles_InitializeWithLimits(char** filepaths, size_t number_of_files, size_t compare_buffer_size, size_t max_open_files, size_t max_memory, 
+																	const struct IoBackend* io_backend)
+{
+	return InitializeHandler(filepaths, NULL, number_of_files, compare_buffer_size, NULL, max_open_files, max_memory, io_backend);
+}
+
+
+
+/*!
+ * 	The fingerprint table gets at least twice as many buckets as there are files,
+ * 	so that it never fills up, and the probe sequences stay short.
+ * */
+bool CmpFiles_EnableFingerprints(struct FilesToCompare* handler)
+{
+	if (handler == NULL) return false;
+	else if (handler->_use_fingerprints) return true;
+	
+	
+	
+	size_t number_of_buckets = 1;
+	while (number_of_buckets < 2 * handler->_number_of_filestreams) number_of_buckets *= 2;
+	
+	handler->_block_fingerprints = malloc(sizeof(uint64_t) * handler->_number_of_filestreams);
+	handler->_bucket_representatives = AllocateIndexArray(number_of_buckets);
+	handler->_bucket_group_ids = AllocateIndexArray(number_of_buckets);
+	handler->_bucket_blocks = AllocateIndexArray(number_of_buckets);
+	
+	if (handler->_block_fingerprints == NULL || handler->_bucket_representatives == NULL || handler->_bucket_group_ids == NULL || handler->_bucket_blocks == NULL)
+	{
+		fputs("Error in CmpFiles_EnableFingerprints: Couldn't allocate the needed resources!\n", stderr);
+		return false;
+	}
+	
+	handler->_number_of_buckets = number_of_buckets;
+	handler->_zero_fingerprint = CmpKernel_Fingerprint(handler->_zero_buffer, handler->_compare_buffer_size);
+	handler->_use_fingerprints = true;
+	
+	return true;
+}
+
+
+
+bool CmpFiles_SetReference(struct FilesToCompare* handler, size_t file_index)
+{
+	if (handler == NULL) return false;
+	else if (file_index >= handler->_number_of_filestreams) return false;
+	
+	
+	
+	if (handler->_reference_candidates == NULL) handler->_reference_candidates = AllocateIndexArray(handler->_number_of_filestreams);
+	if (handler->_candidate_matches == NULL) handler->_candidate_matches = malloc(sizeof(bool) * handler->_number_of_filestreams);
+	
+	if (handler->_reference_candidates == NULL || handler->_candidate_matches == NULL)
+	{
+		fputs("Error in CmpFiles_SetReference: Couldn't allocate the needed resources!\n", stderr);
+		return false;
+	}
+	
+	handler->_reference_index = file_index;
+	
+	return true;
+}
+
+
+
+bool CmpFiles_SetQuorum(struct FilesToCompare* handler, size_t quorum)
+{
+	if (handler == NULL) return false;
+	else if (quorum == 1 || quorum > handler->_number_of_filestreams) return false;
+	
+	handler->_quorum = quorum;
+	
+	return true;
+}
+
+
+
+bool CmpFiles_SetProgressCallback(struct FilesToCompare* handler, long long interval_bytes, void (*on_progress)(struct FilesToCompare* handler, void* context), void* context)
+{
+	if (handler == NULL) return false;
+	else if (on_progress != NULL && interval_bytes <= 0) return false;
+	
+	handler->_on_progress = on_progress;
+	handler->_progress_context = context;
+	handler->_progress_interval = interval_bytes;
+	handler->_next_progress_offset = handler->_block_offset + interval_bytes;
+	
+	return true;
+}
+
+
+
+bool CmpFiles_SetBlockCallback(struct FilesToCompare* handler, void (*on_block)(struct FilesToCompare* handler, void* context), void* context)
+{
+	if (handler == NULL) return false;
+	else if (on_block != NULL && handler->_among_of_slots > 0) return false;
+	
+	handler->_on_block = on_block;
+	handler->_block_context = context;
+	
+	return true;
+}
+
+
+
+bool CmpFiles_SetDecisionCallback(struct FilesToCompare* handler, void (*on_decision)(struct FilesToCompare* handler, size_t file_index, long long offset, void* context), void* context)
+{
+	if (handler == NULL) return false;
+	
+	handler->_on_decision = on_decision;
+	handler->_decision_context = context;
+	
+	return true;
+}
+
+
+
+bool CmpFiles_SetThrottle(struct FilesToCompare* handler, struct IoThrottle* throttle)
+{
+	if (handler == NULL) return false;
+	
+	if (throttle != NULL && handler->_file_devices == NULL)
+	{
+		handler->_file_devices = malloc(sizeof(unsigned long long) * handler->_number_of_filestreams);
+		if (handler->_file_devices == NULL) return false;
+		
+		for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1) UpdateFileDevice(handler, at_index);
+	}
+	
+	handler->_throttle = throttle;
+	CmpDevice_SetThrottle(handler->_device_scheduler, throttle);
+	
+	return true;
+}
+
+
+
+/*!
+ * 	Only files, that are read at explicit offsets, are passed to the scheduler.
+ * */
+bool CmpFiles_EnableDeviceScheduling(struct FilesToCompare* handler)
+{
+	if (handler == NULL) return false;
+	else if (handler->_device_scheduler != NULL) return true;
+	else if (handler->_pooled_files != NULL || handler->_among_of_slots > 0) return false;
+	
+	int* file_descriptors = malloc(sizeof(int) * handler->_number_of_filestreams);
+	if (file_descriptors == NULL) return false;
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		bool is_read_at_offsets = handler->_files[at_index] != NULL && handler->_file_extents[at_index]._can_seek_holes;
+		file_descriptors[at_index] = is_read_at_offsets ? handler->_files[at_index]->_descriptor : -1;
+	}
+	
+	handler->_device_scheduler = CmpDevice_Initialize(file_descriptors, handler->_number_of_filestreams, handler->_compare_buffer_size);
+	free(file_descriptors);
+	
+	if (handler->_device_scheduler == NULL) return false;
+	
+	CmpDevice_SetThrottle(handler->_device_scheduler, handler->_throttle);
+	
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams && handler->_region_lengths != NULL; at_index += 1)
+	{
+		if (handler->_region_lengths[at_index] >= 0) CmpDevice_LimitFile(handler->_device_scheduler, at_index, GetRegionOffset(handler, at_index) + handler->_region_lengths[at_index]);
+	}
+	
+	return true;
+}
+
+
+
+/*!
+ * 	Each part of a pair is at least MINIMUM_PART_SIZE bytes, so there are never more parts per pair than threads.
+ * */
+bool CmpFiles_EnableCompareThreads(struct FilesToCompare* handler, size_t number_of_threads)
+{
+	if (handler == NULL) return false;
+	else if (number_of_threads < 2) return false;
+	else if (handler->_compare_pool != NULL) return true;
+	
+	handler->_pair_firsts = AllocateIndexArray(handler->_number_of_filestreams);
+	handler->_pair_seconds = AllocateIndexArray(handler->_number_of_filestreams);
+	handler->_part_matches = malloc(sizeof(bool) * handler->_number_of_filestreams * number_of_threads);
+	handler->_split_groups = calloc(handler->_number_of_filestreams, sizeof(bool));
+	
+	if (handler->_pair_firsts == NULL || handler->_pair_seconds == NULL || handler->_part_matches == NULL || handler->_split_groups == NULL) goto __CmpFiles_EnableCompareThreads_FreeRemainingResources;
+	
+	handler->_compare_pool = CmpPool_Initialize(number_of_threads);
+	if (handler->_compare_pool == NULL) goto __CmpFiles_EnableCompareThreads_FreeRemainingResources;
+	
+	return true;
+	
+	
+	
+	__CmpFiles_EnableCompareThreads_FreeRemainingResources:
+		FreeIndexArray(handler->_pair_firsts);
+		FreeIndexArray(handler->_pair_seconds);
+		if (handler->_part_matches != NULL) free(handler->_part_matches);
+		if (handler->_split_groups != NULL) free(handler->_split_groups);
+		handler->_pair_firsts = NULL;
+		handler->_pair_seconds = NULL;
+		handler->_part_matches = NULL;
+		handler->_split_groups = NULL;
+	
+	return false;
+}
+
+
+
+/*!
+ * 	The sizes of the files are fetched again (as the sizes of their regions), and the groups are seeded from scratch by them.
+ * 	Files, that can't seek, have the bytes before their region read and discarded.
+ * */
+bool CmpFiles_SetRegions(struct FilesToCompare* handler, const long long* region_offsets, const long long* region_lengths)
+{
+	if (handler == NULL || region_offsets == NULL || region_lengths == NULL) return false;
+	else if (handler->_block_offset != 0 || handler->_block_number != 0) return false;
+	
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		if (region_offsets[at_index] < 0 || region_lengths[at_index] < -1) return false;
+		else if (region_lengths[at_index] > LLONG_MAX - region_offsets[at_index]) return false;
+	}
+	
+	
+	
+	if (handler->_region_offsets == NULL) handler->_region_offsets = malloc(sizeof(long long) * FILES_AMONG);
+	if (handler->_region_lengths == NULL) handler->_region_lengths = malloc(sizeof(long long) * FILES_AMONG);
+	
+	if (handler->_region_offsets == NULL || handler->_region_lengths == NULL)
+	{
+		fputs("Error in CmpFiles_SetRegions: Couldn't allocate the needed resources!\n", stderr);
+		return false;
+	}
+	
+	memcpy(handler->_region_offsets, region_offsets, sizeof(long long) * FILES_AMONG);
+	memcpy(handler->_region_lengths, region_lengths, sizeof(long long) * FILES_AMONG);
+	
+	
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		DetectExtents(handler, at_index);
+		CmpDevice_LimitFile(handler->_device_scheduler, at_index, (region_lengths[at_index] >= 0) ? GetRegionOffset(handler, at_index) + region_lengths[at_index] : -1);
+		
+		if (handler->_files[at_index] == NULL || region_offsets[at_index] == 0) continue;
+		else if (MoveToBlock(handler, at_index, 0)) continue;
+		
+		if (!DiscardBytes(handler, at_index, region_offsets[at_index]))
+		{
+			fprintf(stderr, "Error in CmpFiles_SetRegions: Couldn't move the file %s to its region!\n", handler->_filepaths[at_index]);
+			return false;
+		}
+	}
+	
+	//	The groups were seeded by the sizes of the whole files.
+	handler->_number_of_groups = 0;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1) handler->_file_states[at_index] = FILE_COMPARING;
+	
+	return SeedGroups(handler);
+}
+
+
+
+/*!
+ * 	The restored group identifiers are validated, before anything else is changed.
+ * 	Files, that are read at explicit offsets, only need the block offset. The others are moved with a seek.
+ * */
+bool CmpFiles_RestoreProgress(struct FilesToCompare* handler, long long block_offset, size_t block_number)
+{
+	if (handler == NULL || block_offset < 0) return false;
+	
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		if (handler->_group_ids[at_index] >= FILES_AMONG) return false;
+		else if (handler->_file_states[at_index] == FILE_COMPARING && handler->_files[at_index] != NULL && handler->_files[at_index]->_is_stdin) return false;
+	}
+	
+	
+	
+	handler->_number_of_groups = 0;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1) handler->_group_sizes[at_index] = 0;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		size_t group_id = handler->_group_ids[at_index];
+		
+		handler->_group_sizes[group_id] += 1;
+		if (group_id >= handler->_number_of_groups) handler->_number_of_groups = group_id + 1;
+	}
+	
+	
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) continue;
+		
+		handler->_file_extents[at_index]._next_data_offset = -1;
+		handler->_file_extents[at_index]._next_hole_offset = -1;
+		
+		if (!MoveToBlock(handler, at_index, block_offset)) return false;
+	}
+	
+	handler->_block_offset = block_offset;
+	handler->_block_number = block_number;
+	handler->_next_progress_offset = block_offset + handler->_progress_interval;
+	
+	return true;
+}
+
+
+
+bool CmpFiles_CompareFiles(struct FilesToCompare* handler)
+{
+	if (handler == NULL) return false;
+	else if (handler->_number_of_filestreams < 2) return false;
+	
+	
+	
+	//	The files, that were decided before the comparing (by their sizes, or by a restored checkpoint), are reported first.
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_file_states[at_index] != FILE_COMPARING) ReportDecision(handler, at_index, handler->_block_offset);
+	}
+	
+	if (CanComparePair(handler)) ComparePair(handler);
+	else CompareActiveFiles(handler);
+	
+	return (handler->_quorum > 0) ? QuorumIsReached(handler) : AllFilesMatched(handler);
+}
+
+
+
+/*!
+ * 	The old filestream is closed first (unless it is stdin, which can't be reopened).
+ * 	If the file can't be opened, its filestream is left as NULL, and it will fail when it gets recompared.
+ * 	A pooled file is taken out of the pool in that case, and otherwise remembers its new device and inode.
+ * */
+bool CmpFiles_ReopenFile(struct FilesToCompare* handler, size_t file_index)
+{
+	if (handler == NULL) return false;
+	else if (file_index >= handler->_number_of_filestreams) return false;
+	else if (handler->_files[file_index] != NULL && handler->_files[file_index]->_is_stdin) return false;
+	
+	
+	
+	bool is_pooled = (handler->_pooled_files != NULL && handler->_pooled_files[file_index]);
+	
+	if (handler->_files[file_index] != NULL)
+	{
+		CmpIo_Close(handler->_files[file_index]);
+		handler->_files[file_index] = NULL;
+		if (is_pooled) handler->_among_of_open_files -= 1;
+	}
+	
+	CmpDevice_ReplaceFile(handler->_device_scheduler, file_index, -1);
+	
+	if (is_pooled && handler->_among_of_open_files >= handler->_max_open_files) ClosePooledFile(handler, file_index);
+	
+	handler->_files[file_index] = CmpIo_Open(handler->_io_backend, handler->_filepaths[file_index]);
+	
+	if (handler->_files[file_index] == NULL)
+	{
+		if (is_pooled) handler->_pooled_files[file_index] = false;
+		return false;
+	}
+	
+	if (is_pooled)
+	{
+		struct stat file_status;
+		
+		handler->_among_of_open_files += 1;
+		
+		if (fstat(handler->_files[file_index]->_descriptor, &file_status) == 0)
+		{
+			handler->_file_devices[file_index] = (unsigned long long)file_status.st_dev;
+			handler->_file_inodes[file_index] = (unsigned long long)file_status.st_ino;
+		}
+	}
+	else if (handler->_file_devices != NULL) UpdateFileDevice(handler, file_index);
+	CmpDevice_ReplaceFile(handler->_device_scheduler, file_index, handler->_files[file_index]->_descriptor);
+	
+	return true;
+}
+
+
+
+/*!
+ * 	Files, whose data didn't change, were already compared till their end with the rest of their group,
+ * 	so only one of them (the keeper) needs to be read again per group: the others follow it into its new group afterwards.
+ * 	A group is affected, if it contains a changed file, or if it has the same size as a changed file (so that a changed file can join it).
+ * 	
+ * 	The identifiers of the unaffected groups are compacted first, so that there are still never more groups than files.
+ * 	The changed files and the keepers then get new groups by their sizes, and are compared from the start.
+ * 	An unchanged reference file is always the keeper of its group, since the other files are only compared with it.
+ * */
+bool CmpFiles_RecompareFiles(struct FilesToCompare* handler, const bool* changed_files)
+{
+	if (handler == NULL || changed_files == NULL) return false;
+	else if (handler->_number_of_filestreams < 2) return false;
+	
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+	const size_t GROUPS_AMONG = handler->_number_of_groups;
+	
+	//	The bursts, that were read ahead, could contain the old data of the changed files.
+	CmpDevice_DiscardBursts(handler->_device_scheduler);
+	
+	
+	
+	bool* affected_groups = calloc(GROUPS_AMONG, sizeof(bool));
+	size_t* compacted_ids = AllocateIndexArray(GROUPS_AMONG);
+	size_t* followed_files = AllocateIndexArray(FILES_AMONG);
+	size_t* orphaned_groups = AllocateIndexArray(FILES_AMONG);
+	long long* changed_sizes = malloc(sizeof(long long) * FILES_AMONG);
+	
+	if (affected_groups == NULL || compacted_ids == NULL || followed_files == NULL || orphaned_groups == NULL || changed_sizes == NULL)
+	{
+		fputs("Error in CmpFiles_RecompareFiles: Couldn't allocate the needed resources!\n", stderr);
+		free(affected_groups);
+		FreeIndexArray(compacted_ids);
+		FreeIndexArray(followed_files);
+		FreeIndexArray(orphaned_groups);
+		free(changed_sizes);
+		return false;
+	}
+	
+	
+	
+	//	Find the affected groups. The keepers are temporarily stored in orphaned_groups, indexed by the group identifier.
+	size_t changed_among = 0;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		if (!changed_files[at_index]) continue;
+		
+		DetectExtents(handler, at_index);
+		affected_groups[handler->_group_ids[at_index]] = true;
+		changed_sizes[changed_among++] = handler->_file_extents[at_index]._file_size;
+	}
+	
+	//	The sizes of the changed files are sorted, so that each unchanged file only needs a single lookup.
+	qsort(changed_sizes, changed_among, sizeof(long long), CompareFileSizes);
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG && changed_among > 0; at_index += 1)
+	{
+		if (changed_files[at_index] || handler->_file_extents[at_index]._file_size < 0) continue;
+		
+		if (bsearch(&handler->_file_extents[at_index]._file_size, changed_sizes, changed_among, sizeof(long long), CompareFileSizes) != NULL) 
+		{
+			affected_groups[handler->_group_ids[at_index]] = true;
+		}
+	}
+	
+	const size_t REFERENCE_INDEX = handler->_reference_index;
+	
+	if (REFERENCE_INDEX != NO_FILE_INDEX && !changed_files[REFERENCE_INDEX] && affected_groups[handler->_group_ids[REFERENCE_INDEX]])
+	{
+		orphaned_groups[handler->_group_ids[REFERENCE_INDEX]] = REFERENCE_INDEX;
+	}
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		size_t group_id = handler->_group_ids[at_index];
+		if (changed_files[at_index] || !affected_groups[group_id] || at_index == REFERENCE_INDEX) continue;
+		
+		if (orphaned_groups[group_id] == NO_FILE_INDEX) orphaned_groups[group_id] = at_index;
+		else if (handler->_file_states[at_index] == FILE_FINISHED) followed_files[at_index] = orphaned_groups[group_id];
+	}
+	
+	
+	
+	//	Compact the unaffected groups, and prepare the changed files and keepers for comparing.
+	handler->_number_of_groups = 0;
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		size_t group_id = handler->_group_ids[at_index];
+		
+		if (!affected_groups[group_id])
+		{
+			if (compacted_ids[group_id] == NO_FILE_INDEX)
+			{
+				compacted_ids[group_id] = handler->_number_of_groups;
+				handler->_group_sizes[handler->_number_of_groups] = 0;
+				handler->_number_of_groups += 1;
+			}
+			
+			handler->_group_ids[at_index] = compacted_ids[group_id];
+			handler->_group_sizes[compacted_ids[group_id]] += 1;
+		}
+		else if (followed_files[at_index] != NO_FILE_INDEX)
+		{
+			handler->_group_ids[at_index] = NO_FILE_INDEX;
+		}
+		else
+		{
+			handler->_file_states[at_index] = FILE_COMPARING;
+		}
+	}
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		orphaned_groups[at_index] = NO_FILE_INDEX;
+		
+		if (handler->_file_states[at_index] != FILE_COMPARING || followed_files[at_index] != NO_FILE_INDEX) continue;
+		
+		if (!OpenPooledFile(handler, at_index))
+		{
+			handler->_group_ids[at_index] = handler->_number_of_groups;
+			handler->_group_sizes[handler->_number_of_groups] = 1;
+			handler->_number_of_groups += 1;
+			handler->_file_states[at_index] = FILE_FAILED;
+			continue;
+		}
+		
+		DetectExtents(handler, at_index);
+		handler->_mismatch_offsets[at_index] = -1;
+		
+		MoveToBlock(handler, at_index, 0);
+	}
+	
+	free(affected_groups);
+	free(changed_sizes);
+	FreeIndexArray(compacted_ids);
+	
+	
+	
+	bool groups_were_seeded = SeedGroups(handler);
+	
+	if (groups_were_seeded)
+	{
+		handler->_block_offset = 0;
+		
+		if (CanComparePair(handler)) ComparePair(handler);
+		else CompareActiveFiles(handler);
+	}
+	
+	
+	
+	//	The followers join the new group of their keeper. If the keeper failed, they form a group of their own.
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		size_t keeper = followed_files[at_index];
+		if (keeper == NO_FILE_INDEX) continue;
+		
+		if (handler->_file_states[keeper] == FILE_FAILED)
+		{
+			if (orphaned_groups[keeper] == NO_FILE_INDEX)
 			{
-				handler->_combinations_handler->_match_states[at_index] = NOT_MATCHED;
+				orphaned_groups[keeper] = handler->_number_of_groups;
+				handler->_group_sizes[handler->_number_of_groups] = 0;
+				handler->_number_of_groups += 1;
 			}
+			
+			handler->_group_ids[at_index] = orphaned_groups[keeper];
+		}
+		else
+		{
+			handler->_group_ids[at_index] = handler->_group_ids[keeper];
+			if (handler->_file_states[keeper] == FILE_UNIQUE) handler->_file_states[keeper] = FILE_FINISHED;
+		}
+		
+		handler->_mismatch_offsets[at_index] = handler->_mismatch_offsets[keeper];
+		
+		handler->_group_sizes[handler->_group_ids[at_index]] += 1;
+		handler->_file_states[at_index] = FILE_FINISHED;
+	}
+	
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		if (followed_files[at_index] != NO_FILE_INDEX && handler->_group_sizes[handler->_group_ids[at_index]] == 1) handler->_file_states[at_index] = FILE_UNIQUE;
+	}
+	
+	//	Files, that don't match the reference file, are left alone, even if a follower still matches its keeper.
+	for (size_t at_index = 0; at_index < FILES_AMONG && REFERENCE_INDEX != NO_FILE_INDEX; at_index += 1)
+	{
+		if (at_index == REFERENCE_INDEX || handler->_file_states[at_index] == FILE_FAILED) continue;
+		else if (handler->_group_ids[at_index] == handler->_group_ids[REFERENCE_INDEX] && handler->_file_states[REFERENCE_INDEX] == FILE_FINISHED) continue;
+		
+		DetachFromReference(handler, at_index);
+		handler->_file_states[at_index] = FILE_UNIQUE;
+	}
+	
+	FreeIndexArray(followed_files);
+	FreeIndexArray(orphaned_groups);
+	
+	return groups_were_seeded && AllFilesMatched(handler);
+}
+
+
+
+/*!
+ * 	The combination pairs are walked row by row, so that their positions don't need to be calculated.
+ * 	Pairs, that are in the same group but weren't both read till their end, are marked as NOT_MATCHED.
+ * */
+bool CmpFiles_ResolveCombinations(struct FilesToCompare* handler)
+{
+	if (handler == NULL) return false;
+	else if (handler->_number_of_filestreams < 2) return false;
+	
+	
+	
+	if (handler->_combinations_handler == NULL)
+	{
+		handler->_combinations_handler = CmpComb_Initialize(handler->_number_of_filestreams);
+		if (handler->_combinations_handler == NULL) return false;
+	}
+	else
+	{
+		CmpComb_PrepareCombinations(handler->_combinations_handler);
+	}
+	
+	
+	
+	size_t at_position = 0;
+	
+	for (size_t compare_index = 0; compare_index < handler->_number_of_filestreams; compare_index += 1)
+	{
+		for (size_t compare_with_index = compare_index + 1; compare_with_index < handler->_number_of_filestreams; compare_with_index += 1)
+		{
+			bool are_matched = 	(handler->_group_ids[compare_index] == handler->_group_ids[compare_with_index]) &&
+											(handler->_file_states[compare_index] == FILE_FINISHED) &&
+											(handler->_file_states[compare_with_index] == FILE_FINISHED);
+			
+			CmpComb_SetMatchState(handler->_combinations_handler, at_position, are_matched ? MATCHED : NOT_MATCHED);
+			at_position += 1;
 		}
 	}
-	while ((finished_combinations + skipped_combinations) != COMBINATIONS_AMONG);
 	
-	return skipped_combinations == 0;
+	return true;
 }
@@ -0,0 +1,401 @@
+/*!
+ *	Source file, implementing the backends, through which the compared files are opened and read.
+ *
+ *	\file				cmpio_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For pread, posix_fadvise, O_DIRECT and F_SETPIPE_SZ.
+
+
+
+#include "cmpio_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+
+const long long IO_CURRENT_OFFSET = -1;
+
+
+
+/*!
+ * 	The size, that the buffers of the pipes are enlarged to (the default limit for unprivileged processes on Linux),
+ * 	so that a writer can get ahead by several blocks, and each block is read with fewer system calls.
+ * */
+#define PIPE_BUFFER_SIZE	(1024 * 1024)
+
+
+
+/* Static functions. */
+
+/*!
+ * 	The capabilities only depend on the kind of the file: a regular file can be mapped (and on Linux opened for direct IO),
+ * 	and anything, that can seek, can be read at explicit offsets.
+ * */
+static void DetectCapabilities(struct IoFile* file, bool can_map)
+{
+	file->_capabilities = 0;
+
+	#ifdef _WIN32
+	(void)can_map;
+	if (_lseeki64(file->_descriptor, 0, SEEK_CUR) >= 0) file->_capabilities |= IO_SEEKABLE;
+	#else
+	struct stat file_status;
+
+	if (lseek(file->_descriptor, 0, SEEK_CUR) >= 0) file->_capabilities |= IO_SEEKABLE;
+	if (!can_map || fstat(file->_descriptor, &file_status) != 0 || !S_ISREG(file_status.st_mode)) return;
+
+	file->_capabilities |= IO_MAPPABLE;
+
+	#if defined(__linux__) && defined(O_DIRECT)
+	file->_capabilities |= IO_DIRECT;
+	#endif
+	#endif
+}
+
+/*!
+ * 	Only a hint, since a pipe works with its default buffer as well (and the size can be over the limit of the user).
+ * */
+static void EnlargePipe(struct IoFile* file)
+{
+	#if defined(__linux__) && defined(F_SETPIPE_SZ)
+	struct stat file_status;
+
+	if (fstat(file->_descriptor, &file_status) == 0 && S_ISFIFO(file_status.st_mode)) fcntl(file->_descriptor, F_SETPIPE_SZ, PIPE_BUFFER_SIZE);
+	#else
+	(void)file;
+	#endif
+}
+
+/*!
+ * 	The start is only remembered for files, that are read at explicit offsets. The others are read from where they are anyway.
+ * */
+static long long GetCurrentOffset(struct IoFile* file)
+{
+	if ((file->_capabilities & IO_SEEKABLE) == 0) return 0;
+
+	#ifdef _WIN32
+	long long current_offset = _lseeki64(file->_descriptor, 0, SEEK_CUR);
+	#else
+	long long current_offset = (long long)lseek(file->_descriptor, 0, SEEK_CUR);
+	#endif
+
+	return (current_offset > 0) ? current_offset : 0;
+}
+
+static bool GetRegularFileSize(struct IoFile* file, long long* file_size)
+{
+	#ifdef _WIN32
+	struct __stat64 file_status;
+	if (_fstat64(file->_descriptor, &file_status) != 0) return false;
+	if ((file_status.st_mode & _S_IFMT) != _S_IFREG) return false;
+	#else
+	struct stat file_status;
+	if (fstat(file->_descriptor, &file_status) != 0) return false;
+	if (!S_ISREG(file_status.st_mode)) return false;
+	#endif
+
+	*file_size = (long long)file_status.st_size;
+
+	return true;
+}
+
+static void CloseFilestream(struct IoFile* file)
+{
+	if (file->_filestream != NULL && file->_filestream != stdin) fclose(file->_filestream);
+}
+
+
+
+/*!
+ * 	The blocks are read whole anyway, so the filestreams aren't buffered.
+ * */
+static bool StdioOpen(struct IoFile* file, const char* filepath)
+{
+	file->_filestream = fopen(filepath, "rb");
+	if (file->_filestream == NULL) return false;
+
+	if (setvbuf(file->_filestream, NULL, _IONBF, 0) != 0)
+	{
+		fclose(file->_filestream);
+		return false;
+	}
+
+	#ifdef _WIN32
+	file->_descriptor = _fileno(file->_filestream);
+	#else
+	file->_descriptor = fileno(file->_filestream);
+	#endif
+
+	return true;
+}
+
+static bool StdioAdopt(struct IoFile* file, FILE* filestream)
+{
+	file->_filestream = filestream;
+
+	#ifdef _WIN32
+	file->_descriptor = _fileno(filestream);
+	#else
+	file->_descriptor = fileno(filestream);
+	#endif
+
+	return true;
+}
+
+/*!
+ * 	A read at a explicit offset seeks first. fread already retries short reads by itself.
+ * */
+static long long StdioReadAt(struct IoFile* file, unsigned char* buffer, size_t length, long long offset)
+{
+	clearerr(file->_filestream);
+
+	#ifdef _WIN32
+	if (offset != IO_CURRENT_OFFSET && _fseeki64(file->_filestream, offset, SEEK_SET) != 0) return -1;
+	#else
+	if (offset != IO_CURRENT_OFFSET && fseeko(file->_filestream, (off_t)offset, SEEK_SET) != 0) return -1;
+	#endif
+
+	size_t bytes_read = fread(buffer, sizeof(unsigned char), length, file->_filestream);
+
+	return (ferror(file->_filestream) == 0) ? (long long)bytes_read : -1;
+}
+
+static void StdioAdvise(struct IoFile* file, long long offset, long long length, enum IoAdvice advice)
+{
+	(void)file;
+	(void)offset;
+	(void)length;
+	(void)advice;
+}
+
+static void StdioClose(struct IoFile* file)
+{
+	CloseFilestream(file);
+}
+
+static const struct IoBackend STDIO_BACKEND = {"stdio", StdioOpen, StdioAdopt, StdioReadAt, GetRegularFileSize, StdioAdvise, StdioClose};
+
+
+
+#ifndef _WIN32
+static bool PosixOpen(struct IoFile* file, const char* filepath)
+{
+	file->_descriptor = open(filepath, O_RDONLY);
+
+	return file->_descriptor >= 0;
+}
+
+/*!
+ * 	Only the descriptor of the filestream is read from, and the filestream is kept, so that it is closed with the file.
+ * */
+static bool PosixAdopt(struct IoFile* file, FILE* filestream)
+{
+	file->_filestream = filestream;
+	file->_descriptor = fileno(filestream);
+
+	return true;
+}
+
+static long long PosixReadAt(struct IoFile* file, unsigned char* buffer, size_t length, long long offset)
+{
+	size_t bytes_read = 0;
+
+	while (bytes_read < length)
+	{
+		ssize_t read_result = (offset == IO_CURRENT_OFFSET) ? read(file->_descriptor, buffer + bytes_read, length - bytes_read) :
+																					pread(file->_descriptor, buffer + bytes_read, length - bytes_read, (off_t)offset + (off_t)bytes_read);
+
+		if (read_result < 0 && errno == EINTR) continue;
+		else if (read_result < 0) return -1;
+		else if (read_result == 0) break;
+
+		bytes_read += (size_t)read_result;
+	}
+
+	return (long long)bytes_read;
+}
+
+static void PosixAdvise(struct IoFile* file, long long offset, long long length, enum IoAdvice advice)
+{
+	#ifdef POSIX_FADV_SEQUENTIAL
+	int system_advice = POSIX_FADV_SEQUENTIAL;
+
+	if (advice == IO_ADVICE_WILL_NEED) system_advice = POSIX_FADV_WILLNEED;
+	else if (advice == IO_ADVICE_DONT_NEED) system_advice = POSIX_FADV_DONTNEED;
+
+	posix_fadvise(file->_descriptor, (off_t)offset, (off_t)length, system_advice);
+	#else
+	(void)file;
+	(void)offset;
+	(void)length;
+	(void)advice;
+	#endif
+}
+
+static void PosixClose(struct IoFile* file)
+{
+	if (file->_filestream != NULL) CloseFilestream(file);
+	else close(file->_descriptor);
+}
+
+static const struct IoBackend POSIX_BACKEND = {"posix", PosixOpen, PosixAdopt, PosixReadAt, GetRegularFileSize, PosixAdvise, PosixClose};
+#endif
+
+
+
+/*!
+ * 	Without a POSIX system, the files are read through unbuffered filestreams.
+ * */
+static const struct IoBackend* GetDefaultBackend(void)
+{
+	#ifdef _WIN32
+	return &STDIO_BACKEND;
+	#else
+	return &POSIX_BACKEND;
+	#endif
+}
+
+static struct IoFile* AllocateFile(const struct IoBackend* backend)
+{
+	struct IoFile* file = malloc(sizeof(struct IoFile));
+	if (file == NULL) return NULL;
+
+	file->_backend = (backend != NULL) ? backend : GetDefaultBackend();
+	file->_descriptor = -1;
+	file->_filestream = NULL;
+	file->_capabilities = 0;
+	file->_is_stdin = false;
+	file->_start_offset = 0;
+
+	return file;
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+const struct IoBackend* CmpIo_FindBackend(const char* name)
+{
+	if (name == NULL) return GetDefaultBackend();
+	else if (strcmp(name, STDIO_BACKEND._name) == 0) return &STDIO_BACKEND;
+
+	#ifndef _WIN32
+	if (strcmp(name, POSIX_BACKEND._name) == 0) return &POSIX_BACKEND;
+	#endif
+
+	return NULL;
+}
+
+
+
+struct IoFile* CmpIo_Open(const struct IoBackend* backend, const char* filepath)
+{
+	if (filepath == NULL) return NULL;
+
+	struct IoFile* file = AllocateFile(backend);
+	if (file == NULL) return NULL;
+
+	if (!file->_backend->_open(file, filepath))
+	{
+		free(file);
+		return NULL;
+	}
+
+	DetectCapabilities(file, true);
+	EnlargePipe(file);
+
+	return file;
+}
+
+
+
+/*!
+ * 	stdin, that is redirected from a regular file, gets the same capabilities as a opened regular file (except for direct IO, since it can't be opened again),
+ * 	and its offsets start at its position. stdin, that is a pipe, gets a bigger pipe buffer.
+ * */
+struct IoFile* CmpIo_Adopt(const struct IoBackend* backend, FILE* filestream)
+{
+	if (filestream == NULL) return NULL;
+
+	struct IoFile* file = AllocateFile(backend);
+
+	if (file == NULL || !file->_backend->_adopt(file, filestream))
+	{
+		if (filestream != stdin) fclose(filestream);
+		free(file);
+		return NULL;
+	}
+
+	file->_is_stdin = (filestream == stdin);
+	DetectCapabilities(file, true);
+	EnlargePipe(file);
+
+	if (file->_is_stdin) file->_capabilities &= ~(unsigned int)IO_DIRECT;
+
+	file->_start_offset = GetCurrentOffset(file);
+
+	return file;
+}
+
+
+
+long long CmpIo_ReadAt(struct IoFile* file, unsigned char* buffer, size_t length, long long offset)
+{
+	if (file == NULL || (buffer == NULL && length > 0)) return -1;
+	else if (offset != IO_CURRENT_OFFSET && (offset < 0 || (file->_capabilities & IO_SEEKABLE) == 0)) return -1;
+	else if (length == 0) return 0;
+
+	return file->_backend->_read_at(file, buffer, length, offset);
+}
+
+
+
+bool CmpIo_SizeHint(struct IoFile* file, long long* file_size)
+{
+	if (file == NULL || file_size == NULL) return false;
+
+	return file->_backend->_size_hint(file, file_size);
+}
+
+
+
+void CmpIo_Advise(struct IoFile* file, long long offset, long long length, enum IoAdvice advice)
+{
+	if (file == NULL || offset < 0 || length < 0) return;
+
+	file->_backend->_advise(file, offset, length, advice);
+}
+
+
+
+void CmpIo_Close(struct IoFile* file)
+{
+	if (file == NULL) return;
+
+	file->_backend->_close(file);
+	free(file);
+}
@@ -0,0 +1,517 @@
+/*!
+ *	Source file, implementing the kernels that work on the data blocks of the compared files.
+ *
+ *	\file				cmpkernel_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#include "cmpkernel_handler.h"
+
+
+
+#include <string.h>
+
+
+
+/*!
+ * 	Odd 64-bit constants, used for mixing the fingerprint (the same ones as in the XXH64 hash).
+ * */
+#define FINGERPRINT_PRIME_1	0x9E3779B185EBCA87ULL
+#define FINGERPRINT_PRIME_2	0xC2B2AE3D27D4EB4FULL
+#define FINGERPRINT_PRIME_3	0x165667B19E3779F9ULL
+
+/*!
+ * 	The number of independent lanes, that the fingerprint is calculated with.
+ * */
+#define FINGERPRINT_LANES	4
+
+/*!
+ * 	The number of bytes, that the zero scan checks before deciding, if it can stop early.
+ * */
+#define ZERO_SCAN_CHUNK	64
+
+/*!
+ * 	The number of bytes of the reference block, that are compared with every candidate, before moving on (fits into the L1 cache).
+ * */
+#define REFERENCE_TILE_SIZE	4096
+
+/*!
+ * 	The number of bytes of each block, that are compared with the representative of its class, before moving on.
+ * */
+#define CLASS_TILE_SIZE	4096
+
+/*!
+ * 	Marks the end of a list of split off representatives.
+ * */
+#define NO_SPLIT	SIZE_MAX
+
+/*!
+ * 	Marks a member, that didn't differ from its representative yet.
+ * */
+#define NO_DIFFERENCE	SIZE_MAX
+
+/*!
+ * 	In the portable build (with CMPKERNEL_DISPATCH defined), the hot kernels are compiled for several instruction sets
+ * 	(baseline x86-64, x86-64-v3 with AVX2 and x86-64-v4 with AVX-512), and the best variant, that the processor supports,
+ * 	is picked once, when the program is loaded (by a resolver, that checks CPUID).
+ * 	The static functions, that they call, are inlined into each variant. Other builds are compiled for a single instruction set.
+ * */
+#if defined(CMPKERNEL_DISPATCH) && defined(__x86_64__) && defined(__GNUC__) && defined(__ELF__)
+#define KERNEL_VARIANTS	__attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+#else
+#define KERNEL_VARIANTS
+#endif
+
+
+
+/* Static functions. */
+
+static uint64_t RotateLeft(uint64_t value, unsigned int by_bits)
+{
+	return (value << by_bits) | (value >> (64 - by_bits));
+}
+
+/*!
+ * 	Loads 8 bytes from a unaligned address (memcpy gets compiled into a single load).
+ * */
+static uint64_t LoadWord(const unsigned char* data)
+{
+	uint64_t word;
+	memcpy(&word, data, sizeof(word));
+	return word;
+}
+
+/*!
+ * 	Counts the set bits of a word (GCC and Clang turn the builtin into a single instruction, where the processor has one).
+ * */
+static unsigned int PopCount(uint64_t word)
+{
+	#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned int)__builtin_popcountll(word);
+	#else
+	word -= (word >> 1) & 0x5555555555555555ULL;
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (unsigned int)((word * 0x0101010101010101ULL) >> 56);
+	#endif
+}
+
+/*!
+ * 	Counts the bytes of a word, that aren't zero, by folding the bits of each byte into its lowest bit.
+ * */
+static unsigned int CountNonZeroBytes(uint64_t word)
+{
+	word |= word >> 4;
+	word |= word >> 2;
+	word |= word >> 1;
+	return PopCount(word & 0x0101010101010101ULL);
+}
+
+static uint64_t MixWord(uint64_t lane, uint64_t word)
+{
+	lane += word * FINGERPRINT_PRIME_2;
+	lane = RotateLeft(lane, 31);
+	return lane * FINGERPRINT_PRIME_1;
+}
+
+
+
+/*!
+ * 	Compares the tile of a member, that starts at the provided byte, with the same tile of a representative.
+ * 	Blocks of differing lengths never match, and their difference is searched for in the whole block.
+ * 
+ * 	\return	If the tiles match, returns true. Otherwise the offset of the first differing byte is stored.
+ * */
+static bool TileMatches(unsigned char* const* blocks, const size_t* lengths, size_t representative, size_t member, size_t at_byte, size_t* difference_offset)
+{
+	size_t length = lengths[member];
+	
+	if (length != lengths[representative])
+	{
+		size_t common_length = (length < lengths[representative]) ? length : lengths[representative];
+		*difference_offset = CmpKernel_FindDifference(blocks[representative], blocks[member], common_length);
+		return false;
+	}
+	else if (at_byte >= length)
+	{
+		return true;
+	}
+	
+	size_t tile_length = (length - at_byte < CLASS_TILE_SIZE) ? length - at_byte : CLASS_TILE_SIZE;
+	if (memcmp(blocks[representative] + at_byte, blocks[member] + at_byte, tile_length) == 0) return true;
+	
+	*difference_offset = at_byte + CmpKernel_FindDifference(blocks[representative] + at_byte, blocks[member] + at_byte, tile_length);
+	return false;
+}
+
+
+
+/*!
+ * 	Votes on a single byte: the candidate is found in one pass (by the Boyer-Moore majority vote), and its votes are counted in another.
+ * 	Only if it doesn't get enough of them, every value is counted, to find the one with the most votes.
+ * 
+ * 	\return	If the byte got enough votes, returns true.
+ * */
+static bool VoteByte(const unsigned char* const* blocks, size_t among, size_t at_byte, size_t needed_votes, unsigned char* voted_byte)
+{
+	unsigned char candidate = blocks[0][at_byte];
+	size_t balance = 0, votes = 0;
+	
+	for (size_t at_block = 0; at_block < among; at_block += 1)
+	{
+		if (balance == 0) candidate = blocks[at_block][at_byte];
+		balance = (blocks[at_block][at_byte] == candidate) ? balance + 1 : balance - 1;
+	}
+	
+	for (size_t at_block = 0; at_block < among; at_block += 1) votes += (blocks[at_block][at_byte] == candidate);
+	
+	*voted_byte = candidate;
+	if (votes >= needed_votes) return true;
+	
+	
+	
+	size_t most_votes = 0;
+	
+	for (size_t at_block = 0; at_block < among; at_block += 1)
+	{
+		unsigned char value = blocks[at_block][at_byte];
+		bool was_counted = false;
+		votes = 0;
+		
+		for (size_t at_earlier = 0; at_earlier < at_block && !was_counted; at_earlier += 1) was_counted = (blocks[at_earlier][at_byte] == value);
+		if (was_counted) continue;
+		
+		for (size_t at_later = at_block; at_later < among; at_later += 1) votes += (blocks[at_later][at_byte] == value);
+		
+		if (votes > most_votes)
+		{
+			most_votes = votes;
+			*voted_byte = value;
+		}
+	}
+	
+	return false;
+}
+
+
+
+/* Implemented functions. */
+
+/*!
+ * 	The block is consumed 32 bytes at a time by 4 independent lanes, so that the multiplications can overlap.
+ * 	The lanes are then merged, the remaining bytes mixed in, and the result is avalanched,
+ * 	so that a single flipped bit changes about half of the fingerprint.
+ * */
+KERNEL_VARIANTS uint64_t CmpKernel_Fingerprint(const unsigned char* data, size_t length)
+{
+	uint64_t lanes[FINGERPRINT_LANES] = {FINGERPRINT_PRIME_1 + FINGERPRINT_PRIME_2, FINGERPRINT_PRIME_2, 0, 0 - FINGERPRINT_PRIME_1};
+	size_t at_byte = 0;
+
+	for (; at_byte + FINGERPRINT_LANES * sizeof(uint64_t) <= length; at_byte += FINGERPRINT_LANES * sizeof(uint64_t))
+	{
+		for (size_t at_lane = 0; at_lane < FINGERPRINT_LANES; at_lane += 1)
+		{
+			lanes[at_lane] = MixWord(lanes[at_lane], LoadWord(data + at_byte + at_lane * sizeof(uint64_t)));
+		}
+	}
+
+
+
+	uint64_t fingerprint = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+	fingerprint += (uint64_t)length;
+
+	for (; at_byte + sizeof(uint64_t) <= length; at_byte += sizeof(uint64_t))
+	{
+		fingerprint ^= MixWord(0, LoadWord(data + at_byte));
+		fingerprint = RotateLeft(fingerprint, 27) * FINGERPRINT_PRIME_1 + FINGERPRINT_PRIME_3;
+	}
+
+	for (; at_byte < length; at_byte += 1)
+	{
+		fingerprint ^= data[at_byte] * FINGERPRINT_PRIME_3;
+		fingerprint = RotateLeft(fingerprint, 11) * FINGERPRINT_PRIME_1;
+	}
+
+
+
+	fingerprint ^= fingerprint >> 33;
+	fingerprint *= FINGERPRINT_PRIME_2;
+	fingerprint ^= fingerprint >> 29;
+	fingerprint *= FINGERPRINT_PRIME_3;
+	fingerprint ^= fingerprint >> 32;
+
+	return fingerprint;
+}
+
+
+
+/*!
+ * 	The block is scanned in chunks of 64 bytes, whose words are OR-ed together without branches (which vectorizes well),
+ * 	and the scan stops after the first chunk, that contains a non-zero byte.
+ * */
+KERNEL_VARIANTS bool CmpKernel_IsZero(const unsigned char* data, size_t length)
+{
+	size_t at_byte = 0;
+
+	for (; at_byte + ZERO_SCAN_CHUNK <= length; at_byte += ZERO_SCAN_CHUNK)
+	{
+		uint64_t accumulated = 0;
+
+		for (size_t at_word = 0; at_word < ZERO_SCAN_CHUNK; at_word += sizeof(uint64_t)) accumulated |= LoadWord(data + at_byte + at_word);
+
+		if (accumulated != 0) return false;
+	}
+
+	for (; at_byte < length; at_byte += 1)
+	{
+		if (data[at_byte] != 0) return false;
+	}
+
+	return true;
+}
+
+
+
+/*!
+ * 	Candidates, that stopped matching, are left out of the following tiles,
+ * 	and the comparing stops early, once none of them matches anymore.
+ * */
+size_t CmpKernel_MatchReference(const unsigned char* reference, size_t length, unsigned char* const* blocks, const size_t* candidate_indexes, size_t among, bool* matches)
+{
+	size_t matched_among = among;
+
+	for (size_t at_candidate = 0; at_candidate < among; at_candidate += 1) matches[at_candidate] = true;
+
+	for (size_t at_byte = 0; at_byte < length && matched_among > 0; at_byte += REFERENCE_TILE_SIZE)
+	{
+		size_t tile_length = (length - at_byte < REFERENCE_TILE_SIZE) ? length - at_byte : REFERENCE_TILE_SIZE;
+
+		for (size_t at_candidate = 0; at_candidate < among; at_candidate += 1)
+		{
+			if (!matches[at_candidate]) continue;
+			else if (memcmp(reference + at_byte, blocks[candidate_indexes[at_candidate]] + at_byte, tile_length) == 0) continue;
+
+			matches[at_candidate] = false;
+			matched_among -= 1;
+		}
+	}
+
+	return matched_among;
+}
+
+
+
+/*!
+ * 	The blocks are checked in chunks of 64 bytes, whose words are XOR-ed and OR-ed together without branches,
+ * 	and only the first chunk, that differs, is searched byte by byte.
+ * */
+KERNEL_VARIANTS size_t CmpKernel_FindDifference(const unsigned char* first, const unsigned char* second, size_t length)
+{
+	size_t at_byte = 0;
+
+	for (; at_byte + ZERO_SCAN_CHUNK <= length; at_byte += ZERO_SCAN_CHUNK)
+	{
+		uint64_t accumulated = 0;
+
+		for (size_t at_word = 0; at_word < ZERO_SCAN_CHUNK; at_word += sizeof(uint64_t)) accumulated |= LoadWord(first + at_byte + at_word) ^ LoadWord(second + at_byte + at_word);
+
+		if (accumulated != 0) break;
+	}
+
+	for (; at_byte < length; at_byte += 1)
+	{
+		if (first[at_byte] != second[at_byte]) return at_byte;
+	}
+
+	return length;
+}
+
+
+
+/*!
+ * 	A member, that matched its representative till the current tile, also matches the representatives, 
+ * 	that were split off from it in the same tile, till there, so only the current tile is compared with them.
+ * 	They are kept in a list per representative (in the scratch: the tile, in which a representative was split off,
+ * 	the first representative split off from it, and the next one, split off from the same one), which is restarted in each tile.
+ * 	Since the representatives are never compared, and the members are compared in their order, the first member of a class is its representative.
+ * */
+KERNEL_VARIANTS size_t CmpKernel_SplitClasses(unsigned char* const* blocks, const size_t* lengths, const size_t* members, size_t among, 
+												size_t* representatives, size_t* difference_offsets, size_t* scratch)
+{
+	size_t longest_length = 0;
+	size_t among_of_classes = 0;
+
+	for (size_t at_member = 0; at_member < among; at_member += 1)
+	{
+		size_t member = members[at_member];
+
+		if (lengths[member] > longest_length) longest_length = lengths[member];
+		scratch[member * 3 + 1] = NO_SPLIT;
+		difference_offsets[member] = NO_DIFFERENCE;
+	}
+
+
+
+	for (size_t at_byte = 0; at_byte == 0 || at_byte < longest_length; at_byte += CLASS_TILE_SIZE)
+	{
+		for (size_t at_member = 0; at_member < among; at_member += 1)
+		{
+			size_t member = members[at_member];
+			size_t representative = representatives[member];
+			size_t difference_offset = 0;
+
+			if (representative == member) continue;
+			else if (TileMatches(blocks, lengths, representative, member, at_byte, &difference_offset)) continue;
+
+			//	Only the first difference is against the representative of the class, that the member started in.
+			if (difference_offsets[member] == NO_DIFFERENCE) difference_offsets[member] = difference_offset;
+
+
+
+			size_t split = scratch[representative * 3 + 1];
+			size_t last_split = NO_SPLIT;
+
+			if (split != NO_SPLIT && scratch[split * 3] != at_byte) split = NO_SPLIT;
+
+			for (; split != NO_SPLIT; split = scratch[split * 3 + 2])
+			{
+				size_t ignored_offset;
+				if (TileMatches(blocks, lengths, split, member, at_byte, &ignored_offset)) break;
+
+				last_split = split;
+			}
+
+			if (split != NO_SPLIT)
+			{
+				representatives[member] = split;
+				continue;
+			}
+
+
+
+			representatives[member] = member;
+			scratch[member * 3] = at_byte;
+			scratch[member * 3 + 1] = NO_SPLIT;
+			scratch[member * 3 + 2] = NO_SPLIT;
+
+			if (last_split == NO_SPLIT) scratch[representative * 3 + 1] = member;
+			else scratch[last_split * 3 + 2] = member;
+
+			among_of_classes += 1;
+		}
+	}
+
+	return among_of_classes;
+}
+
+
+
+/*!
+ * 	Most words are the same in all blocks, so the votes for the word of the first block are counted first, which is a single pass of comparisons.
+ * 	Only if it doesn't get enough votes, a candidate word is found by the Boyer-Moore majority vote, and if that one doesn't get enough either,
+ * 	the bytes of the word are voted on one by one (a word, that got enough votes, has each of its bytes decided by them).
+ * */
+KERNEL_VARIANTS size_t CmpKernel_VoteMajority(const unsigned char* const* blocks, size_t among, size_t length, size_t needed_votes, unsigned char* output, bool* undecided)
+{
+	size_t among_of_undecided = 0;
+	size_t at_byte = 0;
+	
+	if (among == 0)
+	{
+		memset(output, 0, length);
+		memset(undecided, true, length);
+		return length;
+	}
+	
+	for (; at_byte + sizeof(uint64_t) <= length; at_byte += sizeof(uint64_t))
+	{
+		uint64_t candidate = LoadWord(blocks[0] + at_byte);
+		size_t votes = 0;
+		
+		for (size_t at_block = 0; at_block < among; at_block += 1) votes += (LoadWord(blocks[at_block] + at_byte) == candidate);
+		
+		if (votes < needed_votes)
+		{
+			size_t balance = 0;
+			votes = 0;
+			
+			for (size_t at_block = 0; at_block < among; at_block += 1)
+			{
+				uint64_t word = LoadWord(blocks[at_block] + at_byte);
+				
+				if (balance == 0) candidate = word;
+				balance = (word == candidate) ? balance + 1 : balance - 1;
+			}
+			
+			for (size_t at_block = 0; at_block < among; at_block += 1) votes += (LoadWord(blocks[at_block] + at_byte) == candidate);
+		}
+		
+		if (votes >= needed_votes)
+		{
+			memcpy(output + at_byte, &candidate, sizeof(candidate));
+			memset(undecided + at_byte, false, sizeof(candidate));
+			continue;
+		}
+		
+		for (size_t at_word_byte = at_byte; at_word_byte < at_byte + sizeof(uint64_t); at_word_byte += 1)
+		{
+			undecided[at_word_byte] = !VoteByte(blocks, among, at_word_byte, needed_votes, output + at_word_byte);
+			among_of_undecided += undecided[at_word_byte];
+		}
+	}
+	
+	for (; at_byte < length; at_byte += 1)
+	{
+		undecided[at_byte] = !VoteByte(blocks, among, at_byte, needed_votes, output + at_byte);
+		among_of_undecided += undecided[at_byte];
+	}
+	
+	return among_of_undecided;
+}
+
+
+
+/*!
+ * 	The blocks are checked in chunks of 64 bytes, like by CmpKernel_FindDifference, so that matching chunks are skipped quickly.
+ * 	In a differing chunk, the XOR of each pair of words is counted by its non-zero bytes and its set bits.
+ * */
+KERNEL_VARIANTS size_t CmpKernel_CountDifferences(const unsigned char* first, const unsigned char* second, size_t length, unsigned long long* differing_bits)
+{
+	size_t among_of_bytes = 0;
+	unsigned long long among_of_bits = 0;
+	size_t at_byte = 0;
+	
+	for (; at_byte + ZERO_SCAN_CHUNK <= length; at_byte += ZERO_SCAN_CHUNK)
+	{
+		uint64_t accumulated = 0;
+		
+		for (size_t at_word = 0; at_word < ZERO_SCAN_CHUNK; at_word += sizeof(uint64_t)) accumulated |= LoadWord(first + at_byte + at_word) ^ LoadWord(second + at_byte + at_word);
+		
+		if (accumulated == 0) continue;
+		
+		for (size_t at_word = 0; at_word < ZERO_SCAN_CHUNK; at_word += sizeof(uint64_t))
+		{
+			uint64_t difference = LoadWord(first + at_byte + at_word) ^ LoadWord(second + at_byte + at_word);
+			
+			among_of_bytes += CountNonZeroBytes(difference);
+			among_of_bits += PopCount(difference);
+		}
+	}
+	
+	for (; at_byte < length; at_byte += 1)
+	{
+		unsigned char difference = first[at_byte] ^ second[at_byte];
+		
+		among_of_bytes += (difference != 0);
+		among_of_bits += PopCount(difference);
+	}
+	
+	if (differing_bits != NULL) *differing_bits += among_of_bits;
+	
+	return among_of_bytes;
+}
@@ -0,0 +1,515 @@
+/*!
+ *	Source file, implementing the functionality for showing the results of the file comparing,
+ *	either as groups of matched files, or pair by pair.
+ *
+ *	\file				cmpoutput_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#include "cmpcomb_handler.h"
+#include "cmpfiles_handler.h"
+#include "cmpoutput_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+
+
+/* Static functions. */
+
+/*!
+ * 	Writes a string as a JSON string, with the needed characters escaped.
+ * */
+static void WriteJsonString(FILE* output, const char* text)
+{
+	fputc('"', output);
+
+	for (const unsigned char* character = (const unsigned char*)text; *character != '\0'; character += 1)
+	{
+		if (*character == '"' || *character == '\\')
+		{
+			fputc('\\', output);
+			fputc(*character, output);
+		}
+		else if (*character < 0x20)
+		{
+			fprintf(output, "\\u%04x", (unsigned int)*character);
+		}
+		else
+		{
+			fputc(*character, output);
+		}
+	}
+
+	fputc('"', output);
+}
+
+/*!
+ * 	Writes a string as a CSV field. It only gets quoted, if it contains any characters, that would break the line.
+ * */
+static void WriteCsvField(FILE* output, const char* text)
+{
+	if (strpbrk(text, ",\"\r\n") == NULL)
+	{
+		fputs(text, output);
+		return;
+	}
+
+
+
+	fputc('"', output);
+
+	for (const char* character = text; *character != '\0'; character += 1)
+	{
+		if (*character == '"') fputc('"', output);
+		fputc(*character, output);
+	}
+
+	fputc('"', output);
+}
+
+static const char* MatchStateName(enum MatchState match_state)
+{
+	if (match_state == MATCHED) return "matched";
+	else if (match_state == NOT_MATCHED) return "not_matched";
+	else return "unknown";
+}
+
+static const char* FileStateName(enum FileState file_state)
+{
+	if (file_state == FILE_FINISHED) return "matched";
+	else if (file_state == FILE_FAILED) return "failed";
+	else if (file_state == FILE_UNIQUE) return "not_matched";
+	else if (file_state == FILE_ABANDONED) return "outlier";
+	else return "unknown";
+}
+
+
+
+/*!
+ * 	Checks, if the group, which starts with this file, has matched data.
+ * */
+static bool IsMatchedGroup(const struct GroupListing* listing, size_t file_index)
+{
+	return (listing->_group_sizes[listing->_group_ids[file_index]] > 1) && (listing->_file_states[file_index] == FILE_FINISHED);
+}
+
+/*!
+ * 	Finds the first matched group (by its number, from 1 on), that reached the quorum.
+ * 
+ * 	\return	The number of the group, or 0, if the quorum wasn't reached.
+ * */
+static size_t FindQuorumGroup(const struct GroupListing* listing, const size_t* first_members)
+{
+	size_t group_number = 0;
+
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+	{
+		if (first_members[listing->_group_ids[at_index]] != at_index) continue;
+		else if (!IsMatchedGroup(listing, at_index)) continue;
+
+		group_number += 1;
+		if (listing->_group_sizes[listing->_group_ids[at_index]] >= listing->_quorum) return group_number;
+	}
+
+	return 0;
+}
+
+/*!
+ * 	Finds the identifier of the first matched group, that reached the quorum.
+ * 
+ * 	\return	The identifier of the group, or SIZE_MAX, if the quorum wasn't reached (or no quorum was set).
+ * */
+static size_t FindQuorumGroupId(const struct GroupListing* listing)
+{
+	if (listing->_quorum == 0) return SIZE_MAX;
+
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+	{
+		if (IsMatchedGroup(listing, at_index) && listing->_group_sizes[listing->_group_ids[at_index]] >= listing->_quorum) return listing->_group_ids[at_index];
+	}
+
+	return SIZE_MAX;
+}
+
+/*!
+ * 	Decides, under which state a file is shown. With a quorum, every file outside of the group, that reached it 
+ * 	(not matched, abandoned, or in a smaller group), is shown as a outlier, and only the files, that couldn't be read, keep their state.
+ * */
+static enum FileState ShownState(const struct GroupListing* listing, size_t quorum_group_id, size_t file_index)
+{
+	enum FileState file_state = listing->_file_states[file_index];
+
+	if (listing->_quorum > 0 && file_state != FILE_FAILED && listing->_group_ids[file_index] != quorum_group_id) return FILE_ABANDONED;
+	else return file_state;
+}
+
+/*!
+ * 	Links the files of each group together, in the order of their indexes.
+ * 	The first file of a group is the one, whose index is written in first_members.
+ *
+ * 	\param	first_members	Per group identifier: the index of the first file of the group.
+ * 	\param	next_members		Per file: the index of the next file in the same group, or SIZE_MAX at the end.
+ * */
+static void LinkGroupMembers(const struct GroupListing* listing, size_t* first_members, size_t* next_members)
+{
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1) first_members[at_index] = SIZE_MAX;
+
+	for (size_t at_index = listing->_number_of_files; at_index > 0; at_index -= 1)
+	{
+		size_t file_index = at_index - 1;
+		size_t group_id = listing->_group_ids[file_index];
+
+		next_members[file_index] = first_members[group_id];
+		first_members[group_id] = file_index;
+	}
+}
+
+
+
+static void ShowGroupsAsText(FILE* output, const struct GroupListing* listing, const size_t* first_members, const size_t* next_members, enum OutputLevel output_level)
+{
+	size_t group_number = 0;
+
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+	{
+		if (first_members[listing->_group_ids[at_index]] != at_index) continue;
+		else if (!IsMatchedGroup(listing, at_index)) continue;
+
+		group_number += 1;
+		fprintf(output, "Matched group %zu:\n", group_number);
+
+		for (size_t member = at_index; member != SIZE_MAX; member = next_members[member]) fprintf(output, "\t%s\n", listing->_filepaths[member]);
+	}
+
+	if (group_number == 0) fputs("No files have matched data!\n", output);
+
+	if (listing->_quorum > 0)
+	{
+		size_t quorum_group = FindQuorumGroup(listing, first_members);
+
+		if (quorum_group > 0) fprintf(output, "The quorum of %zu files was reached by matched group %zu.\n", listing->_quorum, quorum_group);
+		else fprintf(output, "The quorum of %zu files wasn't reached!\n", listing->_quorum);
+	}
+
+	if (output_level == SHOW_ONLY_MATCHED) return;
+
+
+
+	const enum FileState SHOWN_STATES[] = {FILE_UNIQUE, FILE_FAILED, FILE_ABANDONED};
+	const char* SECTION_TITLES[] = {"Not matched with any other file:", "Couldn't be read till the end:", "Outliers of the quorum:"};
+	size_t quorum_group_id = FindQuorumGroupId(listing);
+
+	for (size_t at_section = 0; at_section < sizeof(SHOWN_STATES) / sizeof(SHOWN_STATES[0]); at_section += 1)
+	{
+		bool title_was_shown = false;
+
+		for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+		{
+			if (ShownState(listing, quorum_group_id, at_index) != SHOWN_STATES[at_section]) continue;
+
+			if (!title_was_shown) fprintf(output, "%s\n", SECTION_TITLES[at_section]);
+			title_was_shown = true;
+
+			fprintf(output, "\t%s\n", listing->_filepaths[at_index]);
+		}
+	}
+}
+
+static void ShowGroupsAsJson(FILE* output, const struct GroupListing* listing, const size_t* first_members, const size_t* next_members, enum OutputLevel output_level, bool all_matched)
+{
+	fprintf(output, "{\"all_matched\":%s,", all_matched ? "true" : "false");
+
+	if (listing->_quorum > 0) fprintf(output, "\"quorum\":%zu,\"quorum_reached\":%s,", listing->_quorum, (FindQuorumGroup(listing, first_members) > 0) ? "true" : "false");
+
+	fputs("\"groups\":[", output);
+
+	bool is_first_group = true;
+
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+	{
+		if (first_members[listing->_group_ids[at_index]] != at_index) continue;
+		else if (!IsMatchedGroup(listing, at_index)) continue;
+
+		if (!is_first_group) fputc(',', output);
+		is_first_group = false;
+
+		fputc('[', output);
+		for (size_t member = at_index; member != SIZE_MAX; member = next_members[member])
+		{
+			if (member != at_index) fputc(',', output);
+			WriteJsonString(output, listing->_filepaths[member]);
+		}
+		fputc(']', output);
+	}
+
+	fputc(']', output);
+
+
+
+	if (output_level != SHOW_ONLY_MATCHED)
+	{
+		const enum FileState SHOWN_STATES[] = {FILE_UNIQUE, FILE_FAILED, FILE_ABANDONED};
+		const char* SECTION_NAMES[] = {"not_matched", "failed", "outliers"};
+		size_t quorum_group_id = FindQuorumGroupId(listing);
+
+		//	The outliers are only listed with a quorum.
+		for (size_t at_section = 0; at_section < sizeof(SHOWN_STATES) / sizeof(SHOWN_STATES[0]); at_section += 1)
+		{
+			if (SHOWN_STATES[at_section] == FILE_ABANDONED && listing->_quorum == 0) continue;
+
+			fprintf(output, ",\"%s\":[", SECTION_NAMES[at_section]);
+
+			bool is_first_file = true;
+
+			for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+			{
+				if (ShownState(listing, quorum_group_id, at_index) != SHOWN_STATES[at_section]) continue;
+
+				if (!is_first_file) fputc(',', output);
+				is_first_file = false;
+
+				WriteJsonString(output, listing->_filepaths[at_index]);
+			}
+
+			fputc(']', output);
+		}
+	}
+
+	fputs("}\n", output);
+}
+
+static void ShowGroupsAsCsv(FILE* output, const struct GroupListing* listing, const size_t* first_members, const size_t* next_members, enum OutputLevel output_level)
+{
+	fputs("group,state,filepath\n", output);
+
+	size_t group_number = 0;
+	size_t quorum_group_id = FindQuorumGroupId(listing);
+
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+	{
+		if (first_members[listing->_group_ids[at_index]] != at_index) continue;
+		else if (!IsMatchedGroup(listing, at_index)) continue;
+
+		group_number += 1;
+
+		for (size_t member = at_index; member != SIZE_MAX; member = next_members[member])
+		{
+			fprintf(output, "%zu,%s,", group_number, FileStateName(ShownState(listing, quorum_group_id, member)));
+			WriteCsvField(output, listing->_filepaths[member]);
+			fputc('\n', output);
+		}
+	}
+
+	if (output_level == SHOW_ONLY_MATCHED) return;
+
+
+
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+	{
+		if (IsMatchedGroup(listing, at_index)) continue;
+
+		fprintf(output, ",%s,", FileStateName(ShownState(listing, quorum_group_id, at_index)));
+		WriteCsvField(output, listing->_filepaths[at_index]);
+		fputc('\n', output);
+	}
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+void CmpOutput_WriteJsonString(FILE* output, const char* text)
+{
+	WriteJsonString(output, text);
+}
+
+
+
+void CmpOutput_WriteCsvField(FILE* output, const char* text)
+{
+	WriteCsvField(output, text);
+}
+
+
+
+/*!
+ * 	The groups are listed in the order of their first files index, and so are the files inside each group.
+ * 	Only groups with two or more files that were read till their end are matched groups,
+ * 	the rest of the files are listed by their state.
+ * */
+bool CmpOutput_ShowGroups(FILE* output, struct FilesToCompare* handler, enum OutputFormat output_format, enum OutputLevel output_level)
+{
+	if (output == NULL || handler == NULL) return false;
+	else if (handler->_group_ids == NULL || handler->_file_states == NULL) return false;
+
+
+
+	struct GroupListing listing = {handler->_number_of_filestreams, handler->_filepaths, handler->_group_ids, handler->_group_sizes, handler->_file_states, handler->_quorum};
+
+	return CmpOutput_ShowListing(output, &listing, output_format, output_level);
+}
+
+
+
+bool CmpOutput_ShowListing(FILE* output, const struct GroupListing* listing, enum OutputFormat output_format, enum OutputLevel output_level)
+{
+	if (output == NULL || listing == NULL) return false;
+	else if (listing->_number_of_files == 0) return false;
+
+
+
+	const size_t FILES_AMONG = listing->_number_of_files;
+	bool all_matched = (listing->_group_sizes[listing->_group_ids[0]] == FILES_AMONG) && (listing->_file_states[0] == FILE_FINISHED);
+
+	if (all_matched && output_format == OUTPUT_TEXT)
+	{
+		fputs("All files data content is matched, byte by byte!\n", output);
+		return ferror(output) == 0;
+	}
+
+
+
+	size_t* first_members = malloc(sizeof(size_t) * FILES_AMONG);
+	size_t* next_members = malloc(sizeof(size_t) * FILES_AMONG);
+
+	if (first_members == NULL || next_members == NULL)
+	{
+		fputs("Error in CmpOutput_ShowListing: Couldn't allocate the needed resources!\n", stderr);
+		free(first_members);
+		free(next_members);
+		return false;
+	}
+
+	LinkGroupMembers(listing, first_members, next_members);
+
+
+
+	switch (output_format)
+	{
+		case OUTPUT_JSON:	ShowGroupsAsJson(output, listing, first_members, next_members, output_level, all_matched);	break;
+		case OUTPUT_CSV:		ShowGroupsAsCsv(output, listing, first_members, next_members, output_level);						break;
+		default:						ShowGroupsAsText(output, listing, first_members, next_members, output_level);						break;
+	}
+
+	free(first_members);
+	free(next_members);
+
+	return ferror(output) == 0;
+}
+
+
+
+/*!
+ * 	The combination pairs are walked row by row, in the same order as they are stored in the combinations handler.
+ * 	Pairs that are not matched are skipped, if only the matched files are to be shown.
+ * 	If a reference file is set, only the pairs with the reference file are shown, since the other files weren't compared with each other.
+ * */
+bool CmpOutput_ShowCombinations(FILE* output, struct FilesToCompare* handler, enum OutputFormat output_format, enum OutputLevel output_level)
+{
+	if (output == NULL || handler == NULL) return false;
+	else if (handler->_combinations_handler == NULL) return false;
+
+
+
+	struct CompareCombinations* combinations = handler->_combinations_handler;
+	size_t at_position = 0;
+	bool is_first_pair = true;
+
+	if (output_format == OUTPUT_JSON) fputs("{\"pairs\":[", output);
+	else if (output_format == OUTPUT_CSV) fputs("filepath,with_filepath,state\n", output);
+
+	for (size_t compare_index = 0; compare_index < combinations->_among_of_elements; compare_index += 1)
+	{
+		for (size_t compare_with_index = compare_index + 1; compare_with_index < combinations->_among_of_elements; compare_with_index += 1, at_position += 1)
+		{
+			enum MatchState match_state = CmpComb_GetMatchState(combinations, at_position);
+			if (match_state == NOT_MATCHED && output_level == SHOW_ONLY_MATCHED) continue;
+			else if (handler->_reference_index != SIZE_MAX && compare_index != handler->_reference_index && compare_with_index != handler->_reference_index) continue;
+
+			const char* filepath = handler->_filepaths[compare_index];
+			const char* with_filepath = handler->_filepaths[compare_with_index];
+
+			if (output_format == OUTPUT_JSON)
+			{
+				if (!is_first_pair) fputc(',', output);
+
+				fputc('[', output);
+				WriteJsonString(output, filepath);
+				fputc(',', output);
+				WriteJsonString(output, with_filepath);
+				fprintf(output, ",\"%s\"]", MatchStateName(match_state));
+			}
+			else if (output_format == OUTPUT_CSV)
+			{
+				WriteCsvField(output, filepath);
+				fputc(',', output);
+				WriteCsvField(output, with_filepath);
+				fprintf(output, ",%s\n", MatchStateName(match_state));
+			}
+			else if (match_state == MATCHED)
+			{
+				fprintf(output, "%s and %s match!\n", filepath, with_filepath);
+			}
+			else if (match_state == NOT_MATCHED)
+			{
+				fprintf(output, "%s and %s do not match!\n", filepath, with_filepath);
+			}
+			else
+			{
+				fprintf(output, "%s and %s matching state is unknown!\n", filepath, with_filepath);
+			}
+
+			is_first_pair = false;
+		}
+	}
+
+	if (output_format == OUTPUT_JSON) fputs("]}\n", output);
+
+	return ferror(output) == 0;
+}
+
+
+
+/*!
+ * 	A matched file is written with the identifier and the size of its group, instead of the other files of it,
+ * 	so that each line stays as short, as it is for any other decision (the files of a group are listed once, by the results).
+ * */
+bool CmpOutput_WriteDecision(FILE* output, struct FilesToCompare* handler, size_t file_index, long long offset, double elapsed_time)
+{
+	if (output == NULL || handler == NULL) return false;
+	else if (file_index >= handler->_number_of_filestreams) return false;
+
+
+
+	enum FileState file_state = handler->_file_states[file_index];
+	const char* decision_name = (file_state == FILE_COMPARING) ? "mismatch" : FileStateName(file_state);
+
+	fprintf(output, "{\"time\":%.6f,\"decision\":\"%s\",\"file\":", elapsed_time, decision_name);
+	WriteJsonString(output, handler->_filepaths[file_index]);
+	fprintf(output, ",\"index\":%zu,\"offset\":%lld", file_index, offset);
+
+	if (file_state == FILE_FINISHED)
+	{
+		size_t group_id = handler->_group_ids[file_index];
+		fprintf(output, ",\"group\":%zu,\"group_size\":%zu", group_id, handler->_group_sizes[group_id]);
+	}
+
+	fputs("}\n", output);
+	fflush(output);
+
+	return ferror(output) == 0;
+}
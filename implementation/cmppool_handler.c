@@ -0,0 +1,246 @@
+/*!
+ *	Source file, implementing the pool of compare threads, that work on the disjoint parts of a block at the same time.
+ *
+ *	\file				cmppool_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#include "cmppool_handler.h"
+#include "cmptrace_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+
+
+#ifndef _WIN32
+
+/*!
+ * 	A single compare thread, started by the pool.
+ * */
+struct CompareThread
+{
+	struct ComparePool* _pool;
+	pthread_t _thread;
+	bool _is_started;
+};
+
+struct ComparePool
+{
+	struct CompareThread* _threads;
+	size_t _number_of_threads;
+
+	/*!
+	 * 	The work of the current epoch.
+	 * */
+	void (*_task)(void* context, size_t first_item, size_t last_item);
+	void* _context;
+	size_t _among_of_items;
+
+	/*!
+	 * 	Guards the fields below. Each block is handed over as a new epoch, that the started threads wait for,
+	 * 	handle their range of it, and count down the pending threads.
+	 * */
+	pthread_mutex_t _lock;
+	pthread_cond_t _work_condition;
+	pthread_cond_t _done_condition;
+	unsigned long long _epoch;
+	size_t _among_of_pending_threads;
+	bool _is_stopping;
+};
+
+
+
+/* Static functions. */
+
+/*!
+ * 	Handles the range of the items, that belongs to the compare thread. The ranges differ in size by at most a single item.
+ * */
+static void RunRange(struct ComparePool* pool, size_t thread_index)
+{
+	size_t first_item = pool->_among_of_items * thread_index / pool->_number_of_threads;
+	size_t last_item = pool->_among_of_items * (thread_index + 1) / pool->_number_of_threads;
+
+	if (first_item < last_item) pool->_task(pool->_context, first_item, last_item);
+}
+
+/*!
+ * 	The loop of a started compare thread: waits for each new epoch, and handles its range of it.
+ * */
+static void* RunCompareThread(void* argument)
+{
+	struct CompareThread* compare_thread = argument;
+	struct ComparePool* pool = compare_thread->_pool;
+	size_t thread_index = (size_t)(compare_thread - pool->_threads);
+	unsigned long long handled_epoch = 0;
+
+	pthread_mutex_lock(&pool->_lock);
+
+	while (true)
+	{
+		while (!pool->_is_stopping && pool->_epoch == handled_epoch) pthread_cond_wait(&pool->_work_condition, &pool->_lock);
+
+		if (pool->_is_stopping) break;
+
+		handled_epoch = pool->_epoch;
+		pthread_mutex_unlock(&pool->_lock);
+
+		RunRange(pool, thread_index);
+
+		pthread_mutex_lock(&pool->_lock);
+		pool->_among_of_pending_threads -= 1;
+		if (pool->_among_of_pending_threads == 0) pthread_cond_signal(&pool->_done_condition);
+	}
+
+	pthread_mutex_unlock(&pool->_lock);
+
+	return NULL;
+}
+
+#endif
+
+
+
+/* Implemented functions. */
+
+struct ComparePool* CmpPool_Initialize(size_t number_of_threads)
+{
+	#ifndef _WIN32
+	if (number_of_threads < 2) return NULL;
+
+	struct ComparePool* pool = malloc(sizeof(struct ComparePool));
+	if (pool == NULL) return NULL;
+
+	pool->_number_of_threads = number_of_threads;
+	pool->_task = NULL;
+	pool->_context = NULL;
+	pool->_among_of_items = 0;
+	pool->_epoch = 0;
+	pool->_among_of_pending_threads = 0;
+	pool->_is_stopping = false;
+	pool->_threads = calloc(number_of_threads, sizeof(struct CompareThread));
+
+	if (pthread_mutex_init(&pool->_lock, NULL) != 0)
+	{
+		free(pool->_threads);
+		free(pool);
+		return NULL;
+	}
+
+	pthread_cond_init(&pool->_work_condition, NULL);
+	pthread_cond_init(&pool->_done_condition, NULL);
+
+	if (pool->_threads == NULL) goto __CmpPool_Initialize_FreeRemainingResources;
+
+
+
+	//	The first range is handled by the calling thread.
+	for (size_t at_thread = 1; at_thread < number_of_threads; at_thread += 1)
+	{
+		struct CompareThread* compare_thread = &pool->_threads[at_thread];
+
+		compare_thread->_pool = pool;
+		compare_thread->_is_started = pthread_create(&compare_thread->_thread, NULL, RunCompareThread, compare_thread) == 0;
+		if (!compare_thread->_is_started) goto __CmpPool_Initialize_FreeRemainingResources;
+	}
+
+	return pool;
+
+
+
+	__CmpPool_Initialize_FreeRemainingResources:
+		fputs("Error in CmpPool_Initialize: Couldn't allocate all resources!\n", stderr);
+		CmpPool_Terminate(pool);
+
+	return NULL;
+	#else
+	(void)number_of_threads;
+	return NULL;
+	#endif
+}
+
+
+
+void CmpPool_Terminate(struct ComparePool* pool)
+{
+	#ifndef _WIN32
+	if (pool == NULL) return;
+
+	pthread_mutex_lock(&pool->_lock);
+	pool->_is_stopping = true;
+	pthread_cond_broadcast(&pool->_work_condition);
+	pthread_mutex_unlock(&pool->_lock);
+
+	for (size_t at_thread = 1; at_thread < pool->_number_of_threads && pool->_threads != NULL; at_thread += 1)
+	{
+		if (pool->_threads[at_thread]._is_started) pthread_join(pool->_threads[at_thread]._thread, NULL);
+	}
+
+	pthread_cond_destroy(&pool->_work_condition);
+	pthread_cond_destroy(&pool->_done_condition);
+	pthread_mutex_destroy(&pool->_lock);
+	free(pool->_threads);
+	free(pool);
+	#else
+	(void)pool;
+	#endif
+}
+
+
+
+size_t CmpPool_GetThreads(const struct ComparePool* pool)
+{
+	#ifndef _WIN32
+	return (pool != NULL) ? pool->_number_of_threads : 1;
+	#else
+	(void)pool;
+	return 1;
+	#endif
+}
+
+
+
+void CmpPool_Run(struct ComparePool* pool, void (*task)(void* context, size_t first_item, size_t last_item), void* context, size_t among_of_items)
+{
+	if (task == NULL || among_of_items == 0) return;
+
+	#ifndef _WIN32
+	if (pool != NULL && among_of_items > 1)
+	{
+		pthread_mutex_lock(&pool->_lock);
+		pool->_task = task;
+		pool->_context = context;
+		pool->_among_of_items = among_of_items;
+		pool->_epoch += 1;
+		pool->_among_of_pending_threads = pool->_number_of_threads - 1;
+		pthread_cond_broadcast(&pool->_work_condition);
+		pthread_mutex_unlock(&pool->_lock);
+
+		RunRange(pool, 0);
+
+		long long trace_time = CmpTrace_Begin();
+
+		pthread_mutex_lock(&pool->_lock);
+		while (pool->_among_of_pending_threads > 0) pthread_cond_wait(&pool->_done_condition, &pool->_lock);
+		pthread_mutex_unlock(&pool->_lock);
+
+		CmpTrace_End("compare wait", "compare", trace_time, -1, -1, NULL);
+		return;
+	}
+	#else
+	(void)pool;
+	#endif
+
+	task(context, 0, among_of_items);
+}
@@ -0,0 +1,388 @@
+/*!
+ *	Source file, implementing the repairing of damaged replicas by a majority vote on each of their bytes.
+ *
+ *	\file				cmprepair_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For fstat.
+
+
+
+#include "cmpfiles_handler.h"
+#include "cmpkernel_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmprepair_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+
+
+/*!
+ * 	The written results, and the region of undecided bytes, that is still growing (it is empty, while its length is 0).
+ * */
+struct RepairResults
+{
+	FILE* _output;
+	enum OutputFormat _output_format;
+
+	long long _region_offset;
+	long long _region_length;
+
+	size_t _among_of_regions;
+	long long _among_of_undecided;
+};
+
+
+
+/* Static functions. */
+
+/*!
+ * 	Opens a replica for reading through the backend, or takes over stdin for its mark.
+ * 	The replicas are read from their start to their end, so the system is told to read ahead.
+ * */
+static struct IoFile* OpenReplica(const struct IoBackend* io_backend, const char* filepath)
+{
+	struct IoFile* file;
+
+	if (strcmp(filepath, STDIN_FILEPATH_MARK) == 0)
+	{
+		#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+		#endif
+
+		file = CmpIo_Adopt(io_backend, stdin);
+	}
+	else
+	{
+		file = CmpIo_Open(io_backend, filepath);
+	}
+
+	if (file != NULL) CmpIo_Advise(file, 0, 0, IO_ADVICE_SEQUENTIAL);
+
+	return file;
+}
+
+/*!
+ * 	Checks, if the repaired file would replace one of the replicas (by its identity, or where that isn't known, by its filepath).
+ * */
+static bool IsReplica(const char* repaired_path, char** filepaths, struct IoFile** files, size_t among)
+{
+	struct stat repaired_status, replica_status;
+	bool repaired_file_exists = (stat(repaired_path, &repaired_status) == 0);
+
+	for (size_t at_index = 0; at_index < among; at_index += 1)
+	{
+		if (strcmp(repaired_path, filepaths[at_index]) == 0) return true;
+
+		#ifndef _WIN32
+		if (!repaired_file_exists || fstat(files[at_index]->_descriptor, &replica_status) != 0) continue;
+		else if (repaired_status.st_dev == replica_status.st_dev && repaired_status.st_ino == replica_status.st_ino) return true;
+		#else
+		(void)repaired_file_exists;
+		(void)replica_status;
+		#endif
+	}
+
+	return false;
+}
+
+
+
+/*!
+ * 	Writes the region of undecided bytes, if there is one, and starts over with a empty one.
+ * */
+static void WriteRegion(struct RepairResults* results)
+{
+	if (results->_region_length == 0) return;
+
+	if (results->_output_format == OUTPUT_TEXT)
+	{
+		if (results->_among_of_regions == 0) fputs("Without a clear majority:\n", results->_output);
+		fprintf(results->_output, "\t%lld bytes at the offset %lld\n", results->_region_length, results->_region_offset);
+	}
+	else if (results->_output_format == OUTPUT_JSON)
+	{
+		if (results->_among_of_regions > 0) fputc(',', results->_output);
+		fprintf(results->_output, "{\"offset\":%lld,\"length\":%lld}", results->_region_offset, results->_region_length);
+	}
+	else
+	{
+		fprintf(results->_output, "%lld,%lld\n", results->_region_offset, results->_region_length);
+	}
+
+	results->_among_of_regions += 1;
+	results->_among_of_undecided += results->_region_length;
+	results->_region_length = 0;
+}
+
+/*!
+ * 	Grows the region of undecided bytes by the undecided bytes of a block, and writes it, once a decided byte ends it.
+ * 	A region, that reaches the end of a block, continues into the next one.
+ * */
+static void AddUndecidedBytes(struct RepairResults* results, const bool* undecided, size_t length, long long block_offset)
+{
+	for (size_t at_byte = 0; at_byte < length; at_byte += 1)
+	{
+		if (!undecided[at_byte])
+		{
+			WriteRegion(results);
+			continue;
+		}
+
+		long long byte_offset = block_offset + (long long)at_byte;
+
+		if (results->_region_length == 0) results->_region_offset = byte_offset;
+		results->_region_length += 1;
+	}
+}
+
+
+
+static int CompareLengthsDescending(const void* first, const void* second)
+{
+	size_t first_length = *(const size_t*)first;
+	size_t second_length = *(const size_t*)second;
+
+	return (first_length < second_length) - (first_length > second_length);
+}
+
+/*!
+ * 	A block of the repaired file is as long, as enough replicas are, so its length is the one of the replica,
+ * 	that is the needed_votes-th longest.
+ * */
+static size_t VoteLength(const size_t* lengths, size_t among, size_t needed_votes, size_t* sorted_lengths)
+{
+	memcpy(sorted_lengths, lengths, sizeof(size_t) * among);
+	qsort(sorted_lengths, among, sizeof(size_t), CompareLengthsDescending);
+
+	return sorted_lengths[needed_votes - 1];
+}
+
+/*!
+ * 	The voted range of the blocks is split into parts at the ends of the replicas, which ended inside of it,
+ * 	so that each part is voted on by the replicas, that reach its end.
+ *
+ * 	\return	The among of undecided bytes.
+ * */
+static size_t VoteBlock(unsigned char** buffers, const size_t* lengths, size_t among, size_t voted_length, size_t needed_votes,
+								const unsigned char** voters, unsigned char* repaired_block, bool* undecided)
+{
+	size_t among_of_undecided = 0;
+	size_t part_start = 0;
+
+	while (part_start < voted_length)
+	{
+		size_t part_end = voted_length;
+		size_t among_of_voters = 0;
+
+		for (size_t at_index = 0; at_index < among; at_index += 1)
+		{
+			if (lengths[at_index] > part_start && lengths[at_index] < part_end) part_end = lengths[at_index];
+		}
+
+		for (size_t at_index = 0; at_index < among; at_index += 1)
+		{
+			if (lengths[at_index] >= part_end) voters[among_of_voters++] = buffers[at_index] + part_start;
+		}
+
+		among_of_undecided += CmpKernel_VoteMajority(voters, among_of_voters, part_end - part_start, needed_votes, repaired_block + part_start, undecided + part_start);
+		part_start = part_end;
+	}
+
+	return among_of_undecided;
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+/*!
+ * 	Each pass of the loop reads the next block of every replica, that didn't end yet, votes on it, and appends the voted block to the repaired file.
+ * 	The replicas are read from their current position, so pipes can be repaired from as well.
+ * 	The loop ends with the first block, that is shorter than the others, since after it, not enough replicas are left to vote.
+ * */
+bool CmpRepair_RepairFiles(FILE* output, const char* repaired_path, char** filepaths, size_t number_of_files, size_t compare_buffer_size,
+										const struct IoBackend* io_backend, struct IoThrottle* throttle, enum OutputFormat output_format, bool* all_decided)
+{
+	if (output == NULL || repaired_path == NULL || filepaths == NULL || all_decided == NULL) return false;
+	else if (number_of_files < 3 || compare_buffer_size == 0) return false;
+
+
+
+	const size_t NEEDED_VOTES = number_of_files / 2 + 1;
+	bool files_were_repaired = false;
+	struct RepairResults results = {output, output_format, 0, 0, 0, 0};
+	long long repaired_size = 0;
+	size_t among_of_stdin = 0;
+	FILE* repaired_file = NULL;
+
+	struct IoFile** files = calloc(number_of_files, sizeof(struct IoFile*));
+	unsigned char** buffers = calloc(number_of_files, sizeof(unsigned char*));
+	size_t* lengths = malloc(sizeof(size_t) * number_of_files);
+	size_t* sorted_lengths = malloc(sizeof(size_t) * number_of_files);
+	bool* replica_ended = calloc(number_of_files, sizeof(bool));
+	unsigned long long* devices = calloc(number_of_files, sizeof(unsigned long long));
+	const unsigned char** voters = malloc(sizeof(const unsigned char*) * number_of_files);
+	unsigned char* repaired_block = malloc(compare_buffer_size);
+	bool* undecided = malloc(sizeof(bool) * compare_buffer_size);
+
+	if (files == NULL || buffers == NULL || lengths == NULL || sorted_lengths == NULL || replica_ended == NULL ||
+			devices == NULL || voters == NULL || repaired_block == NULL || undecided == NULL)
+	{
+		fputs("Error in CmpRepair_RepairFiles: Couldn't allocate the needed resources!\n", stderr);
+		goto __CmpRepair_RepairFiles_FreeRemainingResources;
+	}
+
+	for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+	{
+		among_of_stdin += (strcmp(filepaths[at_index], STDIN_FILEPATH_MARK) == 0);
+
+		if (among_of_stdin > 1)
+		{
+			fputs("Error in CmpRepair_RepairFiles: Only one of the replicas can be stdin!\n", stderr);
+			goto __CmpRepair_RepairFiles_FreeRemainingResources;
+		}
+
+		buffers[at_index] = malloc(compare_buffer_size);
+		files[at_index] = OpenReplica(io_backend, filepaths[at_index]);
+
+		if (buffers[at_index] == NULL)
+		{
+			fputs("Error in CmpRepair_RepairFiles: Couldn't allocate the needed resources!\n", stderr);
+			goto __CmpRepair_RepairFiles_FreeRemainingResources;
+		}
+		else if (files[at_index] == NULL)
+		{
+			fprintf(stderr, "Error in CmpRepair_RepairFiles: Couldn't open the replica %s!\n", filepaths[at_index]);
+			goto __CmpRepair_RepairFiles_FreeRemainingResources;
+		}
+
+		struct stat file_status;
+		if (fstat(files[at_index]->_descriptor, &file_status) == 0) devices[at_index] = (unsigned long long)file_status.st_dev;
+	}
+
+	if (IsReplica(repaired_path, filepaths, files, number_of_files))
+	{
+		fprintf(stderr, "Error in CmpRepair_RepairFiles: The repaired file %s can't replace one of the replicas!\n", repaired_path);
+		goto __CmpRepair_RepairFiles_FreeRemainingResources;
+	}
+
+	//	The blocks are written whole anyway, so the repaired file isn't buffered.
+	repaired_file = fopen(repaired_path, "wb");
+
+	if (repaired_file == NULL || setvbuf(repaired_file, NULL, _IONBF, 0) != 0)
+	{
+		fprintf(stderr, "Error in CmpRepair_RepairFiles: Couldn't create the repaired file %s!\n", repaired_path);
+		goto __CmpRepair_RepairFiles_FreeRemainingResources;
+	}
+
+
+
+	if (output_format == OUTPUT_JSON) fputs("{\"undecided\":[", output);
+	else if (output_format == OUTPUT_CSV) fputs("offset,length\n", output);
+
+	size_t voted_length = compare_buffer_size;
+
+	while (voted_length == compare_buffer_size)
+	{
+		for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+		{
+			lengths[at_index] = 0;
+			if (replica_ended[at_index]) continue;
+
+			if (throttle != NULL) CmpThrottle_Acquire(throttle, devices[at_index], compare_buffer_size);
+			long long among_of_read = CmpIo_ReadAt(files[at_index], buffers[at_index], compare_buffer_size, IO_CURRENT_OFFSET);
+
+			if (among_of_read < 0)
+			{
+				fprintf(stderr, "Error in CmpRepair_RepairFiles: Couldn't read the replica %s!\n", filepaths[at_index]);
+				goto __CmpRepair_RepairFiles_FreeRemainingResources;
+			}
+
+			lengths[at_index] = (size_t)among_of_read;
+			replica_ended[at_index] = (lengths[at_index] < compare_buffer_size);
+		}
+
+		voted_length = VoteLength(lengths, number_of_files, NEEDED_VOTES, sorted_lengths);
+		size_t among_of_undecided = VoteBlock(buffers, lengths, number_of_files, voted_length, NEEDED_VOTES, voters, repaired_block, undecided);
+
+		if (among_of_undecided > 0) AddUndecidedBytes(&results, undecided, voted_length, repaired_size);
+		else if (voted_length > 0) WriteRegion(&results);
+
+		if (fwrite(repaired_block, sizeof(unsigned char), voted_length, repaired_file) != voted_length)
+		{
+			fprintf(stderr, "Error in CmpRepair_RepairFiles: Couldn't write the repaired file %s!\n", repaired_path);
+			goto __CmpRepair_RepairFiles_FreeRemainingResources;
+		}
+
+		repaired_size += (long long)voted_length;
+	}
+
+	WriteRegion(&results);
+	*all_decided = (results._among_of_regions == 0);
+
+	if (output_format == OUTPUT_JSON)
+	{
+		fputs("],\"repaired\":", output);
+		CmpOutput_WriteJsonString(output, repaired_path);
+		fprintf(output, ",\"size\":%lld,\"undecided_bytes\":%lld,\"all_decided\":%s}\n", repaired_size, results._among_of_undecided, *all_decided ? "true" : "false");
+	}
+	else if (output_format == OUTPUT_TEXT)
+	{
+		fprintf(output, "Repaired %lld bytes from %zu replicas into %s, with %lld bytes in %zu regions without a clear majority.\n",
+					repaired_size, number_of_files, repaired_path, results._among_of_undecided, results._among_of_regions);
+	}
+
+	bool repaired_file_was_closed = (fclose(repaired_file) == 0);
+	repaired_file = NULL;
+
+	if (!repaired_file_was_closed)
+	{
+		fprintf(stderr, "Error in CmpRepair_RepairFiles: Couldn't write the repaired file %s!\n", repaired_path);
+		goto __CmpRepair_RepairFiles_FreeRemainingResources;
+	}
+
+	files_were_repaired = (ferror(output) == 0);
+
+
+
+	__CmpRepair_RepairFiles_FreeRemainingResources:
+		if (repaired_file != NULL) fclose(repaired_file);
+
+		for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+		{
+			if (files != NULL) CmpIo_Close(files[at_index]);
+			if (buffers != NULL) free(buffers[at_index]);
+		}
+
+		free(files);
+		free(buffers);
+		free(lengths);
+		free(sorted_lengths);
+		free(replica_ended);
+		free(devices);
+		free(voters);
+		free(repaired_block);
+		free(undecided);
+
+	return files_were_repaired;
+}
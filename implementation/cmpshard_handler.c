@@ -0,0 +1,541 @@
+/*!
+ *	Source file, implementing the splitting of a large comparing job deterministically among several independent processes (shards),
+ *	and the merging of their partial results into the final groups.
+ *
+ *	\file				cmpshard_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For fsync.
+
+
+
+#include "cmpfiles_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmpshard_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+
+
+/*!
+ * 	The first line of every file with partial results, including the version of its format.
+ * */
+static const char* PARTIAL_SIGNATURE = "CMPFILES-SHARD 1";
+
+
+
+/* Static functions. */
+
+/*!
+ * 	The stream is read in growing chunks, since stdin and pipes have no size up front.
+ * 	A terminating null character is put after the content.
+ * */
+static char* ReadWholeStream(FILE* stream, size_t* length)
+{
+	size_t capacity = 65536;
+	char* content = malloc(capacity);
+	if (content == NULL) return NULL;
+
+	*length = 0;
+
+	while (true)
+	{
+		if (capacity - *length < 2)
+		{
+			char* grown_content = realloc(content, capacity * 2);
+			if (grown_content == NULL) break;
+
+			content = grown_content;
+			capacity *= 2;
+		}
+
+		size_t bytes_read = fread(content + *length, sizeof(char), capacity - *length - 1, stream);
+		*length += bytes_read;
+
+		if (bytes_read == 0)
+		{
+			if (ferror(stream) != 0) break;
+
+			content[*length] = '\0';
+			return content;
+		}
+	}
+
+	free(content);
+	return NULL;
+}
+
+static char* ReadWholeFile(const char* filepath, size_t* length)
+{
+	if (strcmp(filepath, STDIN_FILEPATH_MARK) == 0) return ReadWholeStream(stdin, length);
+
+	FILE* stream = fopen(filepath, "rb");
+	if (stream == NULL) return NULL;
+
+	char* content = ReadWholeStream(stream, length);
+	fclose(stream);
+
+	return content;
+}
+
+/*!
+ * 	Cuts the content into lines, by replacing their ends with null characters (together with a carriage return before them).
+ *
+ * 	\return	The among of lines, that aren't empty.
+ * */
+static size_t CutIntoLines(char* content, size_t length)
+{
+	size_t among_of_lines = 0;
+	size_t line_length = 0;
+
+	for (size_t at_position = 0; at_position <= length; at_position += 1)
+	{
+		if (at_position < length && content[at_position] != '\n')
+		{
+			line_length += 1;
+			continue;
+		}
+
+		if (line_length > 0 && content[at_position - 1] == '\r')
+		{
+			content[at_position - 1] = '\0';
+			line_length -= 1;
+		}
+
+		content[at_position] = '\0';
+		among_of_lines += (line_length > 0);
+		line_length = 0;
+	}
+
+	return among_of_lines;
+}
+
+/*!
+ * 	Moves to the next line of a content, that was cut with CutIntoLines, skipping the empty ones.
+ *
+ * 	\return	The next line, or NULL at the end of the content.
+ * */
+static char* NextLine(char** at_content, const char* content_end)
+{
+	while (*at_content < content_end)
+	{
+		char* line = *at_content;
+		*at_content += strlen(line) + 1;
+
+		if (*line != '\0') return line;
+	}
+
+	return NULL;
+}
+
+
+
+/*!
+ * 	The finalizer of SplitMix64, so that sizes, which are close together, still end up in different shards.
+ * */
+static uint64_t HashSize(uint64_t size)
+{
+	size = (size ^ (size >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	size = (size ^ (size >> 27)) * 0x94d049bb133111ebULL;
+
+	return size ^ (size >> 31);
+}
+
+static bool GetRegularFileSize(const char* filepath, unsigned long long* file_size)
+{
+	if (strcmp(filepath, STDIN_FILEPATH_MARK) == 0) return false;
+
+	#ifdef _WIN32
+	struct __stat64 file_status;
+	if (_stat64(filepath, &file_status) != 0) return false;
+	if ((file_status.st_mode & _S_IFMT) != _S_IFREG) return false;
+	#else
+	struct stat file_status;
+	if (stat(filepath, &file_status) != 0) return false;
+	if (!S_ISREG(file_status.st_mode)) return false;
+	#endif
+
+	*file_size = (unsigned long long)file_status.st_size;
+
+	return true;
+}
+
+
+
+static bool WritePartialContent(FILE* partial, struct FilesToCompare* handler, const size_t* selected_indexes, size_t number_of_listed_files, size_t shard_index, size_t shard_count)
+{
+	fprintf(partial, "%s\n", PARTIAL_SIGNATURE);
+	fprintf(partial, "shard %zu/%zu files %zu\n", shard_index + 1, shard_count, number_of_listed_files);
+
+	const size_t FILES_AMONG = (handler != NULL) ? handler->_number_of_filestreams : 0;
+	size_t* first_members = malloc(sizeof(size_t) * (FILES_AMONG + 1));
+
+	if (first_members == NULL)
+	{
+		fputs("Error in CmpShard_WritePartial: Couldn't allocate the needed resources!\n", stderr);
+		return false;
+	}
+
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1) first_members[at_index] = SIZE_MAX;
+
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		size_t group_id = handler->_group_ids[at_index];
+		if (first_members[group_id] == SIZE_MAX) first_members[group_id] = at_index;
+
+		fprintf(partial, "file %zu %d %zu %s\n", selected_indexes[at_index], (int)handler->_file_states[at_index],
+					selected_indexes[first_members[group_id]], handler->_filepaths[at_index]);
+	}
+
+	fputs("end\n", partial);
+	free(first_members);
+
+	return ferror(partial) == 0;
+}
+
+/*!
+ * 	Parses the partial results of a single shard into the merged listing.
+ * 	The first shard decides the among of shards and files, which every other shard needs to have as well.
+ * */
+static bool MergePartial(char* content, size_t length, const char* partial_path, struct GroupListing* listing, bool** merged_shards, size_t* shard_count)
+{
+	char* at_content = content;
+	const char* content_end = content + length;
+	size_t shard_index, partial_shard_count, number_of_files;
+
+	CutIntoLines(content, length);
+	char* line = NextLine(&at_content, content_end);
+
+	if (line == NULL || strcmp(line, PARTIAL_SIGNATURE) != 0) goto __MergePartial_Malformed;
+	else if ((line = NextLine(&at_content, content_end)) == NULL) goto __MergePartial_Malformed;
+	else if (sscanf(line, "shard %zu/%zu files %zu", &shard_index, &partial_shard_count, &number_of_files) != 3) goto __MergePartial_Malformed;
+	else if (shard_index == 0 || shard_index > partial_shard_count || number_of_files == 0) goto __MergePartial_Malformed;
+
+	shard_index -= 1;
+
+	if (*merged_shards == NULL)
+	{
+		*merged_shards = calloc(partial_shard_count, sizeof(bool));
+		listing->_filepaths = malloc(sizeof(char*) * number_of_files);
+		listing->_group_ids = malloc(sizeof(size_t) * number_of_files);
+		listing->_group_sizes = calloc(number_of_files, sizeof(size_t));
+		listing->_file_states = malloc(sizeof(enum FileState) * number_of_files);
+
+		if (*merged_shards == NULL || listing->_filepaths == NULL || listing->_group_ids == NULL || listing->_group_sizes == NULL || listing->_file_states == NULL)
+		{
+			fputs("Error in CmpShard_MergePartials: Couldn't allocate the needed resources!\n", stderr);
+			return false;
+		}
+
+		for (size_t at_index = 0; at_index < number_of_files; at_index += 1) listing->_group_ids[at_index] = SIZE_MAX;
+
+		listing->_number_of_files = number_of_files;
+		*shard_count = partial_shard_count;
+	}
+	else if (partial_shard_count != *shard_count || number_of_files != listing->_number_of_files)
+	{
+		fprintf(stderr, "Error in CmpShard_MergePartials: The partial results %s come from a different job!\n", partial_path);
+		return false;
+	}
+
+	if ((*merged_shards)[shard_index])
+	{
+		fprintf(stderr, "Error in CmpShard_MergePartials: The shard %zu/%zu was given more than once!\n", shard_index + 1, *shard_count);
+		return false;
+	}
+
+	(*merged_shards)[shard_index] = true;
+
+
+
+	while ((line = NextLine(&at_content, content_end)) != NULL && strcmp(line, "end") != 0)
+	{
+		size_t file_index, group_index;
+		int file_state, path_start = 0;
+
+		if (sscanf(line, "file %zu %d %zu %n", &file_index, &file_state, &group_index, &path_start) != 3 || path_start == 0) goto __MergePartial_Malformed;
+		else if (file_index >= number_of_files || group_index >= number_of_files || line[path_start] == '\0') goto __MergePartial_Malformed;
+		else if (file_state < FILE_FINISHED || file_state > FILE_FAILED) goto __MergePartial_Malformed;
+
+		if (listing->_group_ids[file_index] != SIZE_MAX)
+		{
+			fprintf(stderr, "Error in CmpShard_MergePartials: The file %s is in more than one shard!\n", line + path_start);
+			return false;
+		}
+
+		listing->_filepaths[file_index] = line + path_start;
+		listing->_group_ids[file_index] = group_index;
+		listing->_file_states[file_index] = (enum FileState)file_state;
+	}
+
+	if (line == NULL || NextLine(&at_content, content_end) != NULL) goto __MergePartial_Malformed;
+
+	return true;
+
+
+
+	__MergePartial_Malformed:
+		fprintf(stderr, "Error in CmpShard_MergePartials: The partial results %s are malformed (or weren't written till the end)!\n", partial_path);
+
+	return false;
+}
+
+/*!
+ * 	Checks, that every shard and every file was merged, and that each group starts with a file of its own, and counts the files of the groups.
+ * */
+static bool CompleteListing(struct GroupListing* listing, const bool* merged_shards, size_t shard_count)
+{
+	for (size_t at_shard = 0; at_shard < shard_count; at_shard += 1)
+	{
+		if (merged_shards[at_shard]) continue;
+
+		fprintf(stderr, "Error in CmpShard_MergePartials: The partial results of the shard %zu/%zu are missing!\n", at_shard + 1, shard_count);
+		return false;
+	}
+
+	for (size_t at_index = 0; at_index < listing->_number_of_files; at_index += 1)
+	{
+		size_t group_id = listing->_group_ids[at_index];
+
+		if (group_id == SIZE_MAX || listing->_group_ids[group_id] != group_id || group_id > at_index)
+		{
+			fprintf(stderr, "Error in CmpShard_MergePartials: The partial results don't cover the file %zu of the list consistently!\n", at_index + 1);
+			return false;
+		}
+
+		listing->_group_sizes[group_id] += 1;
+	}
+
+	return true;
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+/*!
+ * 	The pointers to the filepaths are stored in front of the lines themselves, in the same allocation.
+ * */
+char** CmpShard_ReadFileList(const char* list_path, size_t* number_of_files)
+{
+	if (list_path == NULL || number_of_files == NULL) return NULL;
+
+
+
+	size_t length;
+	char* content = ReadWholeFile(list_path, &length);
+
+	if (content == NULL)
+	{
+		fprintf(stderr, "Error in CmpShard_ReadFileList: Couldn't read the list %s!\n", list_path);
+		return NULL;
+	}
+
+	size_t among_of_lines = CutIntoLines(content, length);
+	char** filepaths = (among_of_lines > 0) ? malloc(sizeof(char*) * among_of_lines + length + 1) : NULL;
+
+	if (filepaths == NULL)
+	{
+		fprintf(stderr, "Error in CmpShard_ReadFileList: The list %s is empty, or couldn't be stored!\n", list_path);
+		free(content);
+		return NULL;
+	}
+
+	char* lines = (char*)(filepaths + among_of_lines);
+	memcpy(lines, content, length + 1);
+	free(content);
+
+	char* at_lines = lines;
+	for (size_t at_index = 0; at_index < among_of_lines; at_index += 1) filepaths[at_index] = NextLine(&at_lines, lines + length + 1);
+
+	*number_of_files = among_of_lines;
+
+	return filepaths;
+}
+
+
+
+bool CmpShard_ParseShard(const char* text, size_t* shard_index, size_t* shard_count)
+{
+	if (text == NULL || shard_index == NULL || shard_count == NULL) return false;
+
+
+
+	char* value_end;
+
+	if (*text < '1' || *text > '9') return false;
+
+	unsigned long long index = strtoull(text, &value_end, 10);
+	if (*value_end != '/' || value_end[1] < '1' || value_end[1] > '9') return false;
+
+	unsigned long long count = strtoull(value_end + 1, &value_end, 10);
+	if (*value_end != '\0' || index > count || count > SIZE_MAX / 2) return false;
+
+	*shard_index = (size_t)index - 1;
+	*shard_count = (size_t)count;
+
+	return true;
+}
+
+
+
+bool CmpShard_SelectFiles(char** filepaths, size_t number_of_files, size_t shard_index, size_t shard_count, size_t* selected_indexes, size_t* number_of_selected)
+{
+	if (filepaths == NULL || selected_indexes == NULL || number_of_selected == NULL) return false;
+	else if (shard_index >= shard_count) return false;
+
+
+
+	*number_of_selected = 0;
+
+	for (size_t at_index = 0; at_index < number_of_files; at_index += 1)
+	{
+		unsigned long long file_size;
+
+		if (!GetRegularFileSize(filepaths[at_index], &file_size))
+		{
+			fprintf(stderr, "Error in CmpShard_SelectFiles: The file %s doesn't exist, or isn't a regular file, so it can't be sharded!\n", filepaths[at_index]);
+			return false;
+		}
+
+		if (HashSize(file_size) % shard_count != shard_index) continue;
+
+		selected_indexes[*number_of_selected] = at_index;
+		*number_of_selected += 1;
+	}
+
+	return true;
+}
+
+
+
+/*!
+ * 	Like a checkpoint, the partial results are written into a temporary file first, and renamed over the previous ones,
+ * 	so that a merge never sees the results of a shard, that was interrupted.
+ * */
+bool CmpShard_WritePartial(const char* partial_path, struct FilesToCompare* handler, const size_t* selected_indexes, size_t number_of_listed_files, size_t shard_index, size_t shard_count)
+{
+	if (partial_path == NULL || (handler != NULL && selected_indexes == NULL)) return false;
+	else if (shard_index >= shard_count || number_of_listed_files == 0) return false;
+
+
+
+	size_t path_length = strlen(partial_path);
+	char* temporary_path = malloc(path_length + sizeof(".tmp"));
+	if (temporary_path == NULL) return false;
+
+	memcpy(temporary_path, partial_path, path_length);
+	memcpy(temporary_path + path_length, ".tmp", sizeof(".tmp"));
+
+	FILE* partial = fopen(temporary_path, "w");
+	if (partial == NULL)
+	{
+		fprintf(stderr, "Error in CmpShard_WritePartial: Couldn't create the file %s!\n", temporary_path);
+		free(temporary_path);
+		return false;
+	}
+
+
+
+	bool partial_was_written = WritePartialContent(partial, handler, selected_indexes, number_of_listed_files, shard_index, shard_count) && (fflush(partial) == 0);
+
+	#ifndef _WIN32
+	partial_was_written = partial_was_written && (fsync(fileno(partial)) == 0);
+	#endif
+
+	partial_was_written = (fclose(partial) == 0) && partial_was_written;
+
+	#ifdef _WIN32
+	//	Windows doesn't replace a existing file on rename.
+	if (partial_was_written) remove(partial_path);
+	#endif
+
+	if (!partial_was_written || rename(temporary_path, partial_path) != 0)
+	{
+		remove(temporary_path);
+		partial_was_written = false;
+	}
+
+	free(temporary_path);
+
+	return partial_was_written;
+}
+
+
+
+/*!
+ * 	The filepaths of the listing point into the contents of the partial results, so those are kept till the results are written.
+ * */
+bool CmpShard_MergePartials(FILE* output, char** partial_paths, size_t number_of_partials, enum OutputFormat output_format, enum OutputLevel output_level, bool* all_matched)
+{
+	if (output == NULL || partial_paths == NULL || all_matched == NULL) return false;
+	else if (number_of_partials == 0) return false;
+
+
+
+	struct GroupListing listing = {0, NULL, NULL, NULL, NULL, 0};
+	char** contents = calloc(number_of_partials, sizeof(char*));
+	bool* merged_shards = NULL;
+	size_t shard_count = 0;
+	bool results_were_merged = false;
+
+	if (contents == NULL)
+	{
+		fputs("Error in CmpShard_MergePartials: Couldn't allocate the needed resources!\n", stderr);
+		return false;
+	}
+
+	for (size_t at_partial = 0; at_partial < number_of_partials; at_partial += 1)
+	{
+		size_t length;
+		contents[at_partial] = ReadWholeFile(partial_paths[at_partial], &length);
+
+		if (contents[at_partial] == NULL)
+		{
+			fprintf(stderr, "Error in CmpShard_MergePartials: Couldn't read the partial results %s!\n", partial_paths[at_partial]);
+			goto __CmpShard_MergePartials_FreeRemainingResources;
+		}
+		else if (!MergePartial(contents[at_partial], length, partial_paths[at_partial], &listing, &merged_shards, &shard_count))
+		{
+			goto __CmpShard_MergePartials_FreeRemainingResources;
+		}
+	}
+
+	if (!CompleteListing(&listing, merged_shards, shard_count)) goto __CmpShard_MergePartials_FreeRemainingResources;
+
+	*all_matched = (listing._group_sizes[listing._group_ids[0]] == listing._number_of_files) && (listing._file_states[0] == FILE_FINISHED);
+	results_were_merged = CmpOutput_ShowListing(output, &listing, output_format, output_level);
+
+
+
+	__CmpShard_MergePartials_FreeRemainingResources:
+		for (size_t at_partial = 0; at_partial < number_of_partials; at_partial += 1) free(contents[at_partial]);
+
+		free(contents);
+		free(merged_shards);
+		free(listing._filepaths);
+		free(listing._group_ids);
+		free(listing._group_sizes);
+		free(listing._file_states);
+
+	return results_were_merged;
+}
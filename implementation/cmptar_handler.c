@@ -0,0 +1,961 @@
+/*!
+ *	Source file, implementing the listing of the members of tar archives (and the files of unpacked trees),
+ *	and the comparing of their data directly from the byte ranges inside the archives.
+ *
+ *	\file				cmptar_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For fseeko, lstat and the entries of directories.
+
+
+
+#include "cmpfiles_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmptar_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+
+
+/*!
+ * 	The size of a header, and the unit, by which the data of the members is padded.
+ * */
+static const long long TAR_BLOCK_SIZE = 512;
+
+static const size_t INITIAL_MEMBER_CAPACITY = 64;
+
+/*!
+ * 	The biggest long name or pax header, that is read. Bigger ones can only come from a damaged archive.
+ * */
+static const long long MAXIMUM_EXTENDED_HEADER_SIZE = 1024 * 1024;
+
+
+
+/* Static functions. */
+
+static char* CopyText(const char* text, size_t length)
+{
+	char* copy = malloc(length + 1);
+	if (copy == NULL) return NULL;
+
+	memcpy(copy, text, length);
+	copy[length] = '\0';
+
+	return copy;
+}
+
+/*!
+ * 	Joins a directory and a relative path with a single separator.
+ * */
+static char* JoinPath(const char* directory_path, const char* relative_path)
+{
+	size_t directory_length = strlen(directory_path);
+	size_t relative_length = strlen(relative_path);
+	bool has_separator = (directory_length > 0 && directory_path[directory_length - 1] == '/');
+
+	char* joined_path = malloc(directory_length + 1 + relative_length + 1);
+	if (joined_path == NULL) return NULL;
+
+	memcpy(joined_path, directory_path, directory_length);
+	if (!has_separator) joined_path[directory_length++] = '/';
+	memcpy(joined_path + directory_length, relative_path, relative_length + 1);
+
+	return joined_path;
+}
+
+
+
+/*!
+ * 	Adds a member to the list, with its path stripped of any leading "./" and "/", so that the paths of archives and trees match.
+ * 	Members, whose path is empty after that (like "./"), are skipped.
+ * */
+static bool AddMember(struct MemberList* member_list, const char* path, size_t path_length, long long data_offset, long long size)
+{
+	while (path_length > 0 && (path[0] == '/' || (path_length > 1 && path[0] == '.' && path[1] == '/')))
+	{
+		size_t skipped_length = (path[0] == '/') ? 1 : 2;
+		path += skipped_length;
+		path_length -= skipped_length;
+	}
+
+	if (path_length == 0) return true;
+
+
+
+	if (member_list->_among_of_members == member_list->_capacity)
+	{
+		size_t new_capacity = (member_list->_capacity == 0) ? INITIAL_MEMBER_CAPACITY : member_list->_capacity * 2;
+		struct TarMember* new_members = realloc(member_list->_members, sizeof(struct TarMember) * new_capacity);
+		if (new_members == NULL) return false;
+
+		member_list->_members = new_members;
+		member_list->_capacity = new_capacity;
+	}
+
+	struct TarMember* member = &member_list->_members[member_list->_among_of_members];
+
+	member->_path = CopyText(path, path_length);
+	if (member->_path == NULL) return false;
+
+	member->_data_offset = data_offset;
+	member->_size = size;
+	member_list->_among_of_members += 1;
+
+	return true;
+}
+
+/*!
+ * 	Orders the members by their paths, and the members with the same path by their offsets.
+ * */
+static int CompareMembers(const void* first, const void* second)
+{
+	const struct TarMember* first_member = first;
+	const struct TarMember* second_member = second;
+
+	int path_order = strcmp(first_member->_path, second_member->_path);
+	if (path_order != 0) return path_order;
+
+	return (first_member->_data_offset > second_member->_data_offset) - (first_member->_data_offset < second_member->_data_offset);
+}
+
+/*!
+ * 	Sorts the members by their paths, and keeps only the last one of the members with the same path.
+ * */
+static void SortMembers(struct MemberList* member_list)
+{
+	if (member_list->_among_of_members == 0) return;
+
+	qsort(member_list->_members, member_list->_among_of_members, sizeof(struct TarMember), CompareMembers);
+
+	size_t among_of_kept = 0;
+
+	for (size_t at_index = 0; at_index < member_list->_among_of_members; at_index += 1)
+	{
+		struct TarMember* member = &member_list->_members[at_index];
+		bool is_replaced = (at_index + 1 < member_list->_among_of_members) && (strcmp(member->_path, member_list->_members[at_index + 1]._path) == 0);
+
+		if (is_replaced) free(member->_path);
+		else member_list->_members[among_of_kept++] = *member;
+	}
+
+	member_list->_among_of_members = among_of_kept;
+}
+
+
+
+/*!
+ * 	Parses a octal number field of a header, which can be padded with spaces and ended with a NUL or a space.
+ * */
+static bool ParseOctal(const unsigned char* field, size_t field_length, long long* value)
+{
+	size_t at_position = 0;
+	long long parsed_value = 0;
+
+	while (at_position < field_length && field[at_position] == ' ') at_position += 1;
+
+	size_t digits_start = at_position;
+
+	for (; at_position < field_length && field[at_position] >= '0' && field[at_position] <= '7'; at_position += 1)
+	{
+		if (parsed_value > (LLONG_MAX >> 3)) return false;
+		parsed_value = (parsed_value << 3) | (field[at_position] - '0');
+	}
+
+	if (at_position == digits_start) return false;
+	else if (at_position < field_length && field[at_position] != '\0' && field[at_position] != ' ') return false;
+
+	*value = parsed_value;
+	return true;
+}
+
+/*!
+ * 	Parses the size field of a header: octal, or a big-endian base-256 number (marked by the highest bit), which GNU tar uses for sizes of 8 GiB and more.
+ * */
+static bool ParseSize(const unsigned char* field, size_t field_length, long long* size)
+{
+	if ((field[0] & 0x80) == 0) return ParseOctal(field, field_length, size);
+	else if ((field[0] & 0x40) != 0) return false;
+
+	long long parsed_size = field[0] & 0x3F;
+
+	for (size_t at_position = 1; at_position < field_length; at_position += 1)
+	{
+		if (parsed_size > (LLONG_MAX >> 8)) return false;
+		parsed_size = (parsed_size << 8) | field[at_position];
+	}
+
+	*size = parsed_size;
+	return true;
+}
+
+/*!
+ * 	Checks the checksum of a header, which is the sum of its bytes, with the checksum field counted as spaces.
+ * */
+static bool HeaderIsValid(const unsigned char* header)
+{
+	long long stored_checksum;
+	if (!ParseOctal(header + 148, 8, &stored_checksum)) return false;
+
+	long long checksum = 0;
+	for (size_t at_position = 0; at_position < (size_t)TAR_BLOCK_SIZE; at_position += 1) checksum += (at_position >= 148 && at_position < 156) ? ' ' : header[at_position];
+
+	return checksum == stored_checksum;
+}
+
+static bool IsZeroBlock(const unsigned char* header)
+{
+	for (size_t at_position = 0; at_position < (size_t)TAR_BLOCK_SIZE; at_position += 1)
+	{
+		if (header[at_position] != 0) return false;
+	}
+
+	return true;
+}
+
+/*!
+ * 	Builds the path of a member from its header: the name, preceded by the prefix in POSIX ustar headers.
+ * 	The GNU format uses the place of the prefix for other fields, so it is only used with the POSIX magic.
+ * */
+static char* HeaderPath(const unsigned char* header)
+{
+	const char* name = (const char*)header;
+	const char* prefix = (const char*)header + 345;
+	size_t name_length = strnlen(name, 100);
+	size_t prefix_length = (memcmp(header + 257, "ustar\0", 6) == 0) ? strnlen(prefix, 155) : 0;
+
+	char* path = malloc(prefix_length + 1 + name_length + 1);
+	if (path == NULL) return NULL;
+
+	size_t path_length = 0;
+
+	if (prefix_length > 0)
+	{
+		memcpy(path, prefix, prefix_length);
+		path[prefix_length] = '/';
+		path_length = prefix_length + 1;
+	}
+
+	memcpy(path + path_length, name, name_length);
+	path[path_length + name_length] = '\0';
+
+	return path;
+}
+
+/*!
+ * 	Parses the records of a pax header ("LENGTH KEY=VALUE\n"), and takes the path and the size of the next member from them.
+ * 	The path replaces the one, that was already set (like by a GNU long name).
+ * */
+static bool ParsePaxHeader(const char* records, long long records_length, char** path, long long* size)
+{
+	long long at_position = 0;
+
+	while (at_position < records_length && records[at_position] != '\0')
+	{
+		long long record_length = 0;
+		long long at_character = at_position;
+
+		for (; at_character < records_length && records[at_character] >= '0' && records[at_character] <= '9'; at_character += 1)
+		{
+			if (record_length > records_length) return false;
+			record_length = record_length * 10 + (records[at_character] - '0');
+		}
+
+		if (at_character >= records_length || records[at_character] != ' ' || record_length <= at_character - at_position + 1) return false;
+		else if (at_position + record_length > records_length || records[at_position + record_length - 1] != '\n') return false;
+
+		const char* key = records + at_character + 1;
+		const char* record_end = records + at_position + record_length - 1;
+		const char* separator = memchr(key, '=', (size_t)(record_end - key));
+		if (separator == NULL) return false;
+
+		size_t key_length = (size_t)(separator - key);
+		const char* value = separator + 1;
+		size_t value_length = (size_t)(record_end - value);
+
+		if (key_length == 4 && memcmp(key, "path", 4) == 0)
+		{
+			char* new_path = CopyText(value, value_length);
+			if (new_path == NULL) return false;
+
+			free(*path);
+			*path = new_path;
+		}
+		else if (key_length == 4 && memcmp(key, "size", 4) == 0)
+		{
+			char* end_of_value;
+			char* size_text = CopyText(value, value_length);
+			if (size_text == NULL) return false;
+
+			*size = strtoll(size_text, &end_of_value, 10);
+			bool size_is_valid = (end_of_value != size_text && *end_of_value == '\0' && *size >= 0);
+			free(size_text);
+
+			if (!size_is_valid) return false;
+		}
+
+		at_position += record_length;
+	}
+
+	return true;
+}
+
+static bool SeekArchive(FILE* archive, long long offset)
+{
+	#ifdef _WIN32
+	return _fseeki64(archive, offset, SEEK_SET) == 0;
+	#else
+	return fseeko(archive, (off_t)offset, SEEK_SET) == 0;
+	#endif
+}
+
+
+
+/*!
+ * 	Walks the headers of a archive, and skips the data of its members by seeking.
+ * 	The extended headers (GNU long names and pax headers) apply to the next member, and are reset after it.
+ * 	A archive, that ends without the two zero blocks, is accepted, as long as it ends after a whole member.
+ * */
+static bool ReadArchive(struct MemberList* member_list, FILE* archive)
+{
+	unsigned char header[512];
+	long long header_offset = 0;
+	char* extended_path = NULL;
+	long long extended_size = -1;
+	bool is_read = false;
+
+
+
+	while (true)
+	{
+		size_t among_of_read = fread(header, 1, sizeof(header), archive);
+
+		if (among_of_read == 0 && feof(archive) && header_offset > 0)
+		{
+			is_read = true;
+			break;
+		}
+		else if (among_of_read != sizeof(header))
+		{
+			fprintf(stderr, "Error in CmpTar_ListMembers: The file %s isn't a tar archive, or is truncated!\n", member_list->_input_path);
+			break;
+		}
+		else if (IsZeroBlock(header))
+		{
+			is_read = true;
+			break;
+		}
+
+		long long size;
+
+		if (!HeaderIsValid(header) || !ParseSize(header + 124, 12, &size))
+		{
+			fprintf(stderr, "Error in CmpTar_ListMembers: The header at offset %lld of the archive %s is damaged (or it isn't a tar archive)!\n", header_offset, member_list->_input_path);
+			break;
+		}
+
+		char type = (char)header[156];
+		bool is_extended_header = (type == 'L' || type == 'x');
+		long long data_offset = header_offset + TAR_BLOCK_SIZE;
+
+		if (!is_extended_header && extended_size >= 0) size = extended_size;
+
+
+
+		if (is_extended_header)
+		{
+			char* records = (size <= MAXIMUM_EXTENDED_HEADER_SIZE) ? malloc((size_t)size + 1) : NULL;
+			bool header_was_parsed = (records != NULL) && (fread(records, 1, (size_t)size, archive) == (size_t)size);
+
+			if (header_was_parsed && type == 'L')
+			{
+				records[size] = '\0';
+				free(extended_path);
+				extended_path = CopyText(records, strlen(records));
+				header_was_parsed = (extended_path != NULL);
+			}
+			else if (header_was_parsed)
+			{
+				header_was_parsed = ParsePaxHeader(records, size, &extended_path, &extended_size);
+			}
+
+			free(records);
+
+			if (!header_was_parsed)
+			{
+				fprintf(stderr, "Error in CmpTar_ListMembers: The extended header at offset %lld of the archive %s couldn't be read!\n", header_offset, member_list->_input_path);
+				break;
+			}
+		}
+		else
+		{
+			//	Regular files ('0', the old '\0', and contiguous files '7') are listed, other members only have their data skipped.
+			if (type == '0' || type == '\0' || type == '7')
+			{
+				char* path = (extended_path != NULL) ? extended_path : HeaderPath(header);
+				bool member_was_added = (path != NULL) && AddMember(member_list, path, strlen(path), data_offset, size);
+
+				if (path != extended_path) free(path);
+
+				if (!member_was_added)
+				{
+					fputs("Error in CmpTar_ListMembers: Couldn't allocate the needed resources!\n", stderr);
+					break;
+				}
+			}
+
+			free(extended_path);
+			extended_path = NULL;
+			extended_size = -1;
+		}
+
+
+
+		long long padded_size = (size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+		if (padded_size > LLONG_MAX - data_offset) break;
+
+		header_offset = data_offset + padded_size;
+
+		if (!SeekArchive(archive, header_offset))
+		{
+			fprintf(stderr, "Error in CmpTar_ListMembers: Couldn't seek inside the archive %s!\n", member_list->_input_path);
+			break;
+		}
+	}
+
+	free(extended_path);
+
+	return is_read;
+}
+
+
+
+#ifndef _WIN32
+/*!
+ * 	Lists the regular files of a directory and of its subdirectories, with their paths relative to the root of the tree.
+ * */
+static bool ListDirectory(struct MemberList* member_list, const char* directory_path, const char* relative_path)
+{
+	DIR* directory = opendir(directory_path);
+
+	if (directory == NULL)
+	{
+		fprintf(stderr, "Error in CmpTar_ListMembers: Couldn't open the directory %s!\n", directory_path);
+		return false;
+	}
+
+
+
+	bool is_listed = true;
+	struct dirent* entry;
+
+	while (is_listed && (entry = readdir(directory)) != NULL)
+	{
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+		char* entry_path = JoinPath(directory_path, entry->d_name);
+		char* entry_relative_path = (relative_path[0] == '\0') ? CopyText(entry->d_name, strlen(entry->d_name)) : JoinPath(relative_path, entry->d_name);
+		struct stat entry_status;
+
+		if (entry_path == NULL || entry_relative_path == NULL)
+		{
+			fputs("Error in CmpTar_ListMembers: Couldn't allocate the needed resources!\n", stderr);
+			is_listed = false;
+		}
+		else if (lstat(entry_path, &entry_status) != 0)
+		{
+			fprintf(stderr, "Error in CmpTar_ListMembers: Couldn't read the status of %s!\n", entry_path);
+			is_listed = false;
+		}
+		else if (S_ISDIR(entry_status.st_mode))
+		{
+			is_listed = ListDirectory(member_list, entry_path, entry_relative_path);
+		}
+		else if (S_ISREG(entry_status.st_mode))
+		{
+			is_listed = AddMember(member_list, entry_relative_path, strlen(entry_relative_path), 0, (long long)entry_status.st_size);
+		}
+
+		free(entry_path);
+		free(entry_relative_path);
+	}
+
+	closedir(directory);
+
+	return is_listed;
+}
+#endif
+
+
+
+/*!
+ * 	The result of a member in one input.
+ * */
+struct InputResult
+{
+	/*!
+	 * "matched", "not_matched", "failed" or "missing".
+	 * */
+	const char* _state;
+	/*!
+	 * The number of the matched group (starting with 1), or 0, if the input isn't in one.
+	 * */
+	size_t _group_number;
+};
+
+/*!
+ * 	Compares the data of a member in the inputs, that contain it, each read from its byte range as a region of the file.
+ * 	The opened files are handed over to the file comparing handler, while the buffers are shared by all members.
+ *
+ * 	\param	present_inputs		Per compared file: the index of its input.
+ * */
+static bool CompareMember(char** filepaths, long long* region_offsets, long long* region_lengths, size_t among_of_files, const size_t* present_inputs,
+										size_t compare_buffer_size, unsigned char** compare_buffers, struct IoThrottle* throttle, FILE** filestreams, struct InputResult* input_results)
+{
+	//	A file, that can't be opened, is left as NULL, and fails while it is compared.
+	for (size_t at_index = 0; at_index < among_of_files; at_index += 1)
+	{
+		filestreams[at_index] = fopen(filepaths[at_index], "rb");
+		if (filestreams[at_index] != NULL) setvbuf(filestreams[at_index], NULL, _IONBF, 0);
+	}
+
+	struct FilesToCompare* handler = CmpFiles_InitializeWithResources(filepaths, filestreams, among_of_files, compare_buffer_size, compare_buffers);
+	if (handler == NULL) return false;
+
+	if (!CmpFiles_SetThrottle(handler, throttle) || !CmpFiles_SetRegions(handler, region_offsets, region_lengths))
+	{
+		CmpFiles_Terminate(handler);
+		return false;
+	}
+
+	CmpFiles_CompareFiles(handler);
+
+
+
+	size_t group_number = 0;
+
+	for (size_t at_index = 0; at_index < among_of_files; at_index += 1)
+	{
+		struct InputResult* input_result = &input_results[present_inputs[at_index]];
+		size_t group_id = handler->_group_ids[at_index];
+
+		if (handler->_file_states[at_index] == FILE_FAILED)
+		{
+			input_result->_state = "failed";
+			continue;
+		}
+		else if (handler->_file_states[at_index] != FILE_FINISHED || handler->_group_sizes[group_id] < 2)
+		{
+			input_result->_state = "not_matched";
+			continue;
+		}
+
+		//	The groups are numbered in the order of their first inputs.
+		size_t first_index = 0;
+		while (handler->_group_ids[first_index] != group_id) first_index += 1;
+
+		input_result->_state = "matched";
+		input_result->_group_number = (first_index == at_index) ? ++group_number : input_results[present_inputs[first_index]]._group_number;
+	}
+
+	CmpFiles_Terminate(handler);
+
+	return true;
+}
+
+
+
+static void WriteMemberAsText(FILE* output, const char* member_path, bool member_matched, char** input_paths, size_t number_of_inputs, const struct InputResult* input_results)
+{
+	if (member_matched)
+	{
+		fprintf(output, "Matched member: %s\n", member_path);
+		return;
+	}
+
+	fprintf(output, "Differing member: %s\n", member_path);
+
+	for (size_t group_number = 1; true; group_number += 1)
+	{
+		bool group_was_shown = false;
+
+		for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+		{
+			if (input_results[at_input]._group_number != group_number) continue;
+
+			if (!group_was_shown) fprintf(output, "\tMatched group %zu:\n", group_number);
+			group_was_shown = true;
+
+			fprintf(output, "\t\t%s\n", input_paths[at_input]);
+		}
+
+		if (!group_was_shown) break;
+	}
+
+
+
+	const char* SHOWN_STATES[] = {"not_matched", "failed", "missing"};
+	const char* SECTION_TITLES[] = {"Not matched with any other input:", "Couldn't be read till the end:", "Missing from:"};
+
+	for (size_t at_section = 0; at_section < sizeof(SHOWN_STATES) / sizeof(SHOWN_STATES[0]); at_section += 1)
+	{
+		bool title_was_shown = false;
+
+		for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+		{
+			if (strcmp(input_results[at_input]._state, SHOWN_STATES[at_section]) != 0) continue;
+
+			if (!title_was_shown) fprintf(output, "\t%s\n", SECTION_TITLES[at_section]);
+			title_was_shown = true;
+
+			fprintf(output, "\t\t%s\n", input_paths[at_input]);
+		}
+	}
+}
+
+static void WriteMemberAsJson(FILE* output, const char* member_path, bool member_matched, char** input_paths, size_t number_of_inputs, const struct InputResult* input_results)
+{
+	fputs("{\"member\":", output);
+	CmpOutput_WriteJsonString(output, member_path);
+	fprintf(output, ",\"matched\":%s,\"groups\":[", member_matched ? "true" : "false");
+
+	for (size_t group_number = 1; true; group_number += 1)
+	{
+		bool group_was_shown = false;
+
+		for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+		{
+			if (input_results[at_input]._group_number != group_number) continue;
+
+			fputs(group_was_shown ? "," : (group_number > 1 ? ",[" : "["), output);
+			group_was_shown = true;
+
+			CmpOutput_WriteJsonString(output, input_paths[at_input]);
+		}
+
+		if (!group_was_shown) break;
+		fputc(']', output);
+	}
+
+	fputc(']', output);
+
+
+
+	const char* SHOWN_STATES[] = {"not_matched", "failed", "missing"};
+
+	for (size_t at_section = 0; at_section < sizeof(SHOWN_STATES) / sizeof(SHOWN_STATES[0]); at_section += 1)
+	{
+		fprintf(output, ",\"%s\":[", SHOWN_STATES[at_section]);
+
+		bool is_first_input = true;
+
+		for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+		{
+			if (strcmp(input_results[at_input]._state, SHOWN_STATES[at_section]) != 0) continue;
+
+			if (!is_first_input) fputc(',', output);
+			is_first_input = false;
+
+			CmpOutput_WriteJsonString(output, input_paths[at_input]);
+		}
+
+		fputc(']', output);
+	}
+
+	fputc('}', output);
+}
+
+static void WriteMemberAsCsv(FILE* output, const char* member_path, char** input_paths, size_t number_of_inputs, const struct InputResult* input_results, enum OutputLevel output_level)
+{
+	for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+	{
+		if (output_level == SHOW_ONLY_MATCHED && input_results[at_input]._group_number == 0) continue;
+
+		CmpOutput_WriteCsvField(output, member_path);
+
+		if (input_results[at_input]._group_number > 0) fprintf(output, ",%zu,", input_results[at_input]._group_number);
+		else fputs(",,", output);
+
+		fprintf(output, "%s,", input_results[at_input]._state);
+		CmpOutput_WriteCsvField(output, input_paths[at_input]);
+		fputc('\n', output);
+	}
+}
+
+
+
+
+
+
+/* Implemented functions. */
+
+struct MemberList* CmpTar_ListMembers(const char* input_path)
+{
+	if (input_path == NULL) return NULL;
+
+
+
+	struct stat input_status;
+	bool is_stdin = (strcmp(input_path, STDIN_FILEPATH_MARK) == 0);
+
+	if (!is_stdin && stat(input_path, &input_status) != 0)
+	{
+		fprintf(stderr, "Error in CmpTar_ListMembers: Couldn't read the status of %s!\n", input_path);
+		return NULL;
+	}
+	else if (is_stdin || (!S_ISDIR(input_status.st_mode) && !S_ISREG(input_status.st_mode)))
+	{
+		fprintf(stderr, "Error in CmpTar_ListMembers: The archive %s has to be a regular file (it is read at the offsets of its members)!\n", input_path);
+		return NULL;
+	}
+
+	struct MemberList* member_list = malloc(sizeof(struct MemberList));
+	if (member_list == NULL) return NULL;
+
+	member_list->_input_path = CopyText(input_path, strlen(input_path));
+	member_list->_is_directory = S_ISDIR(input_status.st_mode);
+	member_list->_members = NULL;
+	member_list->_among_of_members = 0;
+	member_list->_capacity = 0;
+
+	if (member_list->_input_path == NULL) goto __CmpTar_ListMembers_FreeRemainingResources;
+
+
+
+	if (member_list->_is_directory)
+	{
+		#ifndef _WIN32
+		if (!ListDirectory(member_list, input_path, "")) goto __CmpTar_ListMembers_FreeRemainingResources;
+		#else
+		fprintf(stderr, "Error in CmpTar_ListMembers: Comparing with the directory %s isn't supported on this system!\n", input_path);
+		goto __CmpTar_ListMembers_FreeRemainingResources;
+		#endif
+	}
+	else
+	{
+		FILE* archive = fopen(input_path, "rb");
+
+		if (archive == NULL)
+		{
+			fprintf(stderr, "Error in CmpTar_ListMembers: Couldn't open the archive %s!\n", input_path);
+			goto __CmpTar_ListMembers_FreeRemainingResources;
+		}
+
+		bool archive_was_read = ReadArchive(member_list, archive);
+		fclose(archive);
+
+		if (!archive_was_read) goto __CmpTar_ListMembers_FreeRemainingResources;
+	}
+
+	SortMembers(member_list);
+
+
+
+	return member_list;
+
+
+
+	__CmpTar_ListMembers_FreeRemainingResources:
+		CmpTar_Terminate(member_list);
+
+	return NULL;
+}
+
+
+
+void CmpTar_Terminate(struct MemberList* member_list)
+{
+	if (member_list == NULL) return;
+
+	for (size_t at_index = 0; at_index < member_list->_among_of_members; at_index += 1) free(member_list->_members[at_index]._path);
+
+	free(member_list->_members);
+	free(member_list->_input_path);
+	free(member_list);
+}
+
+
+
+/*!
+ * 	The member lists are sorted by their paths, so they are merged like sorted sequences: each step takes the smallest path, that any input is at,
+ * 	compares it in the inputs, that contain it, and moves those inputs to their next member.
+ * 	The files of the trees are compared whole, while the archives are compared at the byte ranges of their members.
+ * */
+bool CmpTar_CompareMembers(FILE* output, char** input_paths, size_t number_of_inputs, size_t compare_buffer_size, struct IoThrottle* throttle,
+											enum OutputFormat output_format, enum OutputLevel output_level, bool* all_matched)
+{
+	if (output == NULL || input_paths == NULL || all_matched == NULL) return false;
+	else if (number_of_inputs < 2 || compare_buffer_size == 0) return false;
+
+
+
+	bool members_were_compared = false;
+	size_t among_of_members = 0, among_of_matched = 0;
+
+	struct MemberList** member_lists = calloc(number_of_inputs, sizeof(struct MemberList*));
+	size_t* member_cursors = calloc(number_of_inputs, sizeof(size_t));
+	size_t* present_inputs = malloc(sizeof(size_t) * number_of_inputs);
+	char** filepaths = calloc(number_of_inputs, sizeof(char*));
+	FILE** filestreams = malloc(sizeof(FILE*) * number_of_inputs);
+	long long* region_offsets = malloc(sizeof(long long) * number_of_inputs);
+	long long* region_lengths = malloc(sizeof(long long) * number_of_inputs);
+	struct InputResult* input_results = malloc(sizeof(struct InputResult) * number_of_inputs);
+	unsigned char** compare_buffers = calloc(number_of_inputs, sizeof(unsigned char*));
+
+	if (member_lists == NULL || member_cursors == NULL || present_inputs == NULL || filepaths == NULL || filestreams == NULL ||
+			region_offsets == NULL || region_lengths == NULL || input_results == NULL || compare_buffers == NULL)
+	{
+		fputs("Error in CmpTar_CompareMembers: Couldn't allocate the needed resources!\n", stderr);
+		goto __CmpTar_CompareMembers_FreeRemainingResources;
+	}
+
+	for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+	{
+		compare_buffers[at_input] = malloc(compare_buffer_size);
+		member_lists[at_input] = CmpTar_ListMembers(input_paths[at_input]);
+
+		if (compare_buffers[at_input] == NULL || member_lists[at_input] == NULL) goto __CmpTar_CompareMembers_FreeRemainingResources;
+	}
+
+
+
+	*all_matched = true;
+	bool is_first_member = true;
+
+	if (output_format == OUTPUT_JSON) fputs("{\"members\":[", output);
+	else if (output_format == OUTPUT_CSV) fputs("member,group,state,input\n", output);
+
+	while (true)
+	{
+		const char* member_path = NULL;
+
+		for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+		{
+			const struct MemberList* member_list = member_lists[at_input];
+			if (member_cursors[at_input] >= member_list->_among_of_members) continue;
+
+			const char* input_member_path = member_list->_members[member_cursors[at_input]]._path;
+			if (member_path == NULL || strcmp(input_member_path, member_path) < 0) member_path = input_member_path;
+		}
+
+		if (member_path == NULL) break;
+
+
+
+		size_t among_of_present = 0;
+
+		for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+		{
+			const struct MemberList* member_list = member_lists[at_input];
+
+			input_results[at_input]._state = "missing";
+			input_results[at_input]._group_number = 0;
+
+			if (member_cursors[at_input] >= member_list->_among_of_members) continue;
+
+			const struct TarMember* member = &member_list->_members[member_cursors[at_input]];
+			if (strcmp(member->_path, member_path) != 0) continue;
+
+			filepaths[among_of_present] = member_list->_is_directory ? JoinPath(member_list->_input_path, member->_path) : member_list->_input_path;
+			region_offsets[among_of_present] = member->_data_offset;
+			region_lengths[among_of_present] = member_list->_is_directory ? -1 : member->_size;
+			present_inputs[among_of_present] = at_input;
+			input_results[at_input]._state = "not_matched";
+			among_of_present += 1;
+
+			if (filepaths[among_of_present - 1] == NULL) goto __CmpTar_CompareMembers_FreeRemainingResources;
+		}
+
+		bool member_was_compared = (among_of_present < 2) || CompareMember(filepaths, region_offsets, region_lengths, among_of_present, present_inputs,
+																												compare_buffer_size, compare_buffers, throttle, filestreams, input_results);
+
+		bool member_matched = member_was_compared && (among_of_present == number_of_inputs);
+		for (size_t at_input = 0; at_input < number_of_inputs && member_matched; at_input += 1) member_matched = (input_results[at_input]._group_number == 1);
+
+		among_of_members += 1;
+		among_of_matched += member_matched;
+		*all_matched = *all_matched && member_matched;
+
+
+
+		if (output_format == OUTPUT_TEXT && (member_matched || output_level == SHOW_ALL))
+		{
+			WriteMemberAsText(output, member_path, member_matched, input_paths, number_of_inputs, input_results);
+		}
+		else if (output_format == OUTPUT_JSON && (member_matched || output_level == SHOW_ALL))
+		{
+			if (!is_first_member) fputc(',', output);
+			is_first_member = false;
+
+			WriteMemberAsJson(output, member_path, member_matched, input_paths, number_of_inputs, input_results);
+		}
+		else if (output_format == OUTPUT_CSV)
+		{
+			WriteMemberAsCsv(output, member_path, input_paths, number_of_inputs, input_results, output_level);
+		}
+
+		//	The member path belongs to one of the lists, so the inputs are only moved on, once it isn't needed anymore.
+		for (size_t at_present = 0; at_present < among_of_present; at_present += 1)
+		{
+			size_t at_input = present_inputs[at_present];
+
+			if (member_lists[at_input]->_is_directory) free(filepaths[at_present]);
+			filepaths[at_present] = NULL;
+			member_cursors[at_input] += 1;
+		}
+
+		if (!member_was_compared)
+		{
+			fprintf(stderr, "Error in CmpTar_CompareMembers: Couldn't compare the member %s!\n", member_path);
+			goto __CmpTar_CompareMembers_FreeRemainingResources;
+		}
+	}
+
+	if (output_format == OUTPUT_JSON) fprintf(output, "],\"all_matched\":%s}\n", *all_matched ? "true" : "false");
+	else if (output_format == OUTPUT_TEXT) fprintf(output, "%zu of %zu members matched.\n", among_of_matched, among_of_members);
+
+	members_were_compared = (ferror(output) == 0);
+
+
+
+	__CmpTar_CompareMembers_FreeRemainingResources:
+		//	The joined paths of the trees, that were left over by a failure, are owned here (the paths of the archives belong to their lists).
+		for (size_t at_present = 0; at_present < number_of_inputs && filepaths != NULL && present_inputs != NULL; at_present += 1)
+		{
+			if (filepaths[at_present] != NULL && member_lists[present_inputs[at_present]]->_is_directory) free(filepaths[at_present]);
+		}
+
+		for (size_t at_input = 0; at_input < number_of_inputs; at_input += 1)
+		{
+			if (member_lists != NULL) CmpTar_Terminate(member_lists[at_input]);
+			if (compare_buffers != NULL) free(compare_buffers[at_input]);
+		}
+
+		free(member_lists);
+		free(member_cursors);
+		free(present_inputs);
+		free(filepaths);
+		free(filestreams);
+		free(region_offsets);
+		free(region_lengths);
+		free(input_results);
+		free(compare_buffers);
+
+	return members_were_compared;
+}
@@ -0,0 +1,562 @@
+/*!
+ *	Source file, implementing the limiting of the bandwidth and the IO operations of the file reading,
+ *	with token buckets for all devices together and for single devices.
+ *
+ *	\file				cmpthrottle_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For the signal handling functions and syscall.
+
+
+
+#include "cmpthrottle_handler.h"
+#include "cmptrace_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#ifdef __linux__
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+
+
+#ifdef __linux__
+
+/*!
+ * 	For how many seconds the limit can be exceeded by a burst of reads, after the reading was idle.
+ * */
+#define BURST_SECONDS	0.1
+
+/*!
+ * 	The values for the ioprio_set system call (from linux/ioprio.h, which isn't always installed).
+ * */
+#define IOPRIO_WHO_PROCESS		1
+#define IOPRIO_CLASS_SHIFT		13
+#define IOPRIO_CLASS_REALTIME	1
+#define IOPRIO_CLASS_BEST_EFFORT	2
+#define IOPRIO_CLASS_IDLE			3
+#define IOPRIO_DEFAULT_LEVEL		4
+#define IOPRIO_LOWEST_LEVEL		7
+
+
+
+/*!
+ * 	A limit of some among per second. The tokens can go below zero,
+ * 	so that a read of any size is allowed, and the next one waits until the debt is paid off.
+ * */
+struct TokenBucket
+{
+	/*!
+	 * 	The among per second, or 0 for no limit.
+	 * */
+	double _rate;
+
+	/*!
+	 * 	The among, that can be taken without waiting.
+	 * */
+	double _tokens;
+};
+
+/*!
+ * 	The limits of a single device.
+ * */
+struct DeviceLimits
+{
+	unsigned long long _device;
+	struct TokenBucket _bandwidth;
+	struct TokenBucket _operations;
+};
+
+struct IoThrottle
+{
+	/*!
+	 * 	Guards everything below, since the daemon workers share the limits.
+	 * */
+	pthread_mutex_t _lock;
+
+	/*!
+	 * 	The limits of all devices together, as they were initialized (a control file overrides them).
+	 * */
+	unsigned long long _initial_bytes_per_second;
+	unsigned long long _initial_operations_per_second;
+
+	struct TokenBucket _bandwidth;
+	struct TokenBucket _operations;
+
+	struct DeviceLimits* _device_limits;
+	size_t _among_of_devices;
+
+	/*!
+	 * 	When the token buckets were last filled, in seconds.
+	 * */
+	double _last_refill;
+
+	/*!
+	 * 	The filepath of the control file, or NULL, if there isn't one.
+	 * */
+	char* _control_path;
+
+	/*!
+	 * 	The value of reload_generation, when the control file was last loaded.
+	 * */
+	sig_atomic_t _loaded_generation;
+};
+
+
+
+/*!
+ * 	Increased on each SIGHUP, so that every throttle with a control file loads it again before its next read.
+ * */
+static volatile sig_atomic_t reload_generation = 0;
+
+
+
+/* Static functions. */
+
+static void RequestReload(int signal_number)
+{
+	(void)signal_number;
+	reload_generation += 1;
+}
+
+
+
+static double MonotonicSeconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+
+
+static void SetBucketRate(struct TokenBucket* bucket, unsigned long long rate)
+{
+	bucket->_rate = (double)rate;
+	bucket->_tokens = bucket->_rate * BURST_SECONDS;
+}
+
+static void RefillBucket(struct TokenBucket* bucket, double elapsed_seconds)
+{
+	if (bucket->_rate == 0) return;
+
+	double capacity = bucket->_rate * BURST_SECONDS;
+	bucket->_tokens += bucket->_rate * elapsed_seconds;
+	if (bucket->_tokens > capacity) bucket->_tokens = capacity;
+}
+
+/*!
+ * 	Takes the among from the bucket.
+ *
+ * 	\return	How many seconds need to pass, until the taken among is within the limit.
+ * */
+static double TakeFromBucket(struct TokenBucket* bucket, double among)
+{
+	if (bucket->_rate == 0) return 0;
+
+	bucket->_tokens -= among;
+
+	return (bucket->_tokens < 0) ? -bucket->_tokens / bucket->_rate : 0;
+}
+
+
+
+/*!
+ * 	Finds the device of a block device, or of the device, that contains the file.
+ * */
+static bool GetDevice(const char* device_path, unsigned long long* device)
+{
+	struct stat device_status;
+	if (stat(device_path, &device_status) != 0) return false;
+
+	*device = S_ISBLK(device_status.st_mode) ? (unsigned long long)device_status.st_rdev : (unsigned long long)device_status.st_dev;
+
+	return true;
+}
+
+
+
+/*!
+ * 	Parses the control file, without changing any limits.
+ * 	The limits of all devices together are left untouched, if the control file doesn't contain them.
+ *
+ * 	\return	If the control file is valid, returns true.
+ * */
+static bool ParseControlFile(const char* control_path, unsigned long long* bytes_per_second, unsigned long long* operations_per_second, struct DeviceLimits** device_limits, size_t* among_of_devices)
+{
+	FILE* control_file = fopen(control_path, "r");
+	if (control_file == NULL)
+	{
+		fprintf(stderr, "Error in CmpThrottle_UseControlFile: Couldn't open the control file %s!\n", control_path);
+		return false;
+	}
+
+	*device_limits = NULL;
+	*among_of_devices = 0;
+
+	char line[PATH_MAX + 128];
+	size_t line_number = 0;
+	bool control_file_is_valid = true;
+
+	while (control_file_is_valid && fgets(line, sizeof(line), control_file) != NULL)
+	{
+		line_number += 1;
+
+		char* comment = strchr(line, '#');
+		if (comment != NULL) *comment = '\0';
+
+		char* parse_position = NULL;
+		char* keyword = strtok_r(line, " \t\r\n", &parse_position);
+
+		if (keyword == NULL) continue;
+		else if (strcmp(keyword, "bandwidth") == 0 || strcmp(keyword, "iops") == 0)
+		{
+			char* value = strtok_r(NULL, " \t\r\n", &parse_position);
+			unsigned long long* limit = (keyword[0] == 'b') ? bytes_per_second : operations_per_second;
+
+			control_file_is_valid = value != NULL && CmpThrottle_ParseRate(value, limit) && strtok_r(NULL, " \t\r\n", &parse_position) == NULL;
+		}
+		else if (strcmp(keyword, "device") == 0)
+		{
+			char* device_path = strtok_r(NULL, " \t\r\n", &parse_position);
+			struct DeviceLimits* resized_limits = realloc(*device_limits, sizeof(struct DeviceLimits) * (*among_of_devices + 1));
+
+			if (resized_limits == NULL)
+			{
+				fputs("Error in CmpThrottle_UseControlFile: Couldn't allocate the device limits!\n", stderr);
+				control_file_is_valid = false;
+				break;
+			}
+
+			*device_limits = resized_limits;
+			struct DeviceLimits* limits = &resized_limits[*among_of_devices];
+			unsigned long long device_bytes = 0, device_operations = 0;
+
+			if (device_path == NULL || !GetDevice(device_path, &limits->_device))
+			{
+				fprintf(stderr, "Error in CmpThrottle_UseControlFile: The device in line %zu of %s doesn't exist!\n", line_number, control_path);
+				control_file_is_valid = false;
+				break;
+			}
+
+			for (char* option = strtok_r(NULL, " \t\r\n", &parse_position); option != NULL && control_file_is_valid; option = strtok_r(NULL, " \t\r\n", &parse_position))
+			{
+				char* value = strtok_r(NULL, " \t\r\n", &parse_position);
+
+				if (strcmp(option, "bandwidth") == 0) control_file_is_valid = value != NULL && CmpThrottle_ParseRate(value, &device_bytes);
+				else if (strcmp(option, "iops") == 0) control_file_is_valid = value != NULL && CmpThrottle_ParseRate(value, &device_operations);
+				else control_file_is_valid = false;
+			}
+
+			SetBucketRate(&limits->_bandwidth, device_bytes);
+			SetBucketRate(&limits->_operations, device_operations);
+			*among_of_devices += 1;
+		}
+		else control_file_is_valid = false;
+
+		if (!control_file_is_valid) fprintf(stderr, "Error in CmpThrottle_UseControlFile: Line %zu of %s is malformed!\n", line_number, control_path);
+	}
+
+	fclose(control_file);
+
+	if (!control_file_is_valid)
+	{
+		free(*device_limits);
+		*device_limits = NULL;
+		*among_of_devices = 0;
+	}
+
+	return control_file_is_valid;
+}
+
+
+
+/*!
+ * 	The new limits replace the old ones at once, so every read is either limited by the old or by the new ones.
+ * */
+static bool LoadControlFile(struct IoThrottle* throttle)
+{
+	unsigned long long bytes_per_second = throttle->_initial_bytes_per_second;
+	unsigned long long operations_per_second = throttle->_initial_operations_per_second;
+	struct DeviceLimits* device_limits;
+	size_t among_of_devices;
+
+	if (!ParseControlFile(throttle->_control_path, &bytes_per_second, &operations_per_second, &device_limits, &among_of_devices)) return false;
+
+	pthread_mutex_lock(&throttle->_lock);
+
+	SetBucketRate(&throttle->_bandwidth, bytes_per_second);
+	SetBucketRate(&throttle->_operations, operations_per_second);
+	free(throttle->_device_limits);
+	throttle->_device_limits = device_limits;
+	throttle->_among_of_devices = among_of_devices;
+
+	pthread_mutex_unlock(&throttle->_lock);
+
+	return true;
+}
+
+#endif
+
+
+
+
+
+
+/* Implemented functions. */
+
+bool CmpThrottle_IsSupported(void)
+{
+	#ifdef __linux__
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+
+
+bool CmpThrottle_ParseRate(const char* text, unsigned long long* rate)
+{
+	if (text == NULL || rate == NULL) return false;
+	else if (text[0] < '0' || text[0] > '9') return false;
+
+	char* value_end;
+	unsigned long long parsed_rate = strtoull(text, &value_end, 10);
+	unsigned long long multiplier = 1;
+
+	switch (*value_end)
+	{
+		case 'k': case 'K': multiplier = 1024ULL; value_end += 1; break;
+		case 'm': case 'M': multiplier = 1024ULL * 1024; value_end += 1; break;
+		case 'g': case 'G': multiplier = 1024ULL * 1024 * 1024; value_end += 1; break;
+		default: break;
+	}
+
+	if (*value_end != '\0' || parsed_rate == 0 || parsed_rate > ULLONG_MAX / multiplier) return false;
+
+	*rate = parsed_rate * multiplier;
+	return true;
+}
+
+
+
+struct IoThrottle* CmpThrottle_Initialize(unsigned long long bytes_per_second, unsigned long long operations_per_second)
+{
+	#ifdef __linux__
+	struct IoThrottle* throttle = malloc(sizeof(struct IoThrottle));
+	if (throttle == NULL) return NULL;
+
+	if (pthread_mutex_init(&throttle->_lock, NULL) != 0)
+	{
+		free(throttle);
+		return NULL;
+	}
+
+	throttle->_initial_bytes_per_second = bytes_per_second;
+	throttle->_initial_operations_per_second = operations_per_second;
+	SetBucketRate(&throttle->_bandwidth, bytes_per_second);
+	SetBucketRate(&throttle->_operations, operations_per_second);
+	throttle->_device_limits = NULL;
+	throttle->_among_of_devices = 0;
+	throttle->_last_refill = MonotonicSeconds();
+	throttle->_control_path = NULL;
+	throttle->_loaded_generation = 0;
+
+	return throttle;
+	#else
+	(void)bytes_per_second;
+	(void)operations_per_second;
+	return NULL;
+	#endif
+}
+
+
+
+void CmpThrottle_Terminate(struct IoThrottle* throttle)
+{
+	#ifdef __linux__
+	if (throttle != NULL)
+	{
+		pthread_mutex_destroy(&throttle->_lock);
+		free(throttle->_device_limits);
+		free(throttle->_control_path);
+		free(throttle);
+	}
+	#else
+	(void)throttle;
+	#endif
+}
+
+
+
+/*!
+ * 	SIGHUP is caught with SA_RESTART, so that it doesn't interrupt any reads.
+ * */
+bool CmpThrottle_UseControlFile(struct IoThrottle* throttle, const char* control_path)
+{
+	#ifdef __linux__
+	if (throttle == NULL || control_path == NULL) return false;
+
+	free(throttle->_control_path);
+	throttle->_control_path = strdup(control_path);
+	if (throttle->_control_path == NULL) return false;
+
+	throttle->_loaded_generation = reload_generation;
+	if (!LoadControlFile(throttle)) return false;
+
+	struct sigaction reload_action;
+	memset(&reload_action, 0, sizeof(reload_action));
+	reload_action.sa_handler = RequestReload;
+	reload_action.sa_flags = SA_RESTART;
+	sigemptyset(&reload_action.sa_mask);
+
+	return sigaction(SIGHUP, &reload_action, NULL) == 0;
+	#else
+	(void)throttle;
+	(void)control_path;
+	return false;
+	#endif
+}
+
+
+
+/*!
+ * 	The read is taken from every bucket, that limits it, and waits for the slowest one.
+ * 	The waiting happens outside of the lock, since the taken tokens already keep the following reads waiting.
+ * */
+void CmpThrottle_Acquire(struct IoThrottle* throttle, unsigned long long device, size_t among_bytes)
+{
+	#ifdef __linux__
+	if (throttle == NULL) return;
+
+
+
+	pthread_mutex_lock(&throttle->_lock);
+
+	bool needs_reload = throttle->_control_path != NULL && throttle->_loaded_generation != reload_generation;
+	if (needs_reload) throttle->_loaded_generation = reload_generation;
+
+	pthread_mutex_unlock(&throttle->_lock);
+
+	if (needs_reload && !LoadControlFile(throttle))
+	{
+		fprintf(stderr, "Error in CmpThrottle_Acquire: Couldn't load the control file %s again, so the previous limits stay in place!\n", throttle->_control_path);
+	}
+
+
+
+	pthread_mutex_lock(&throttle->_lock);
+
+	double now = MonotonicSeconds();
+	double elapsed_seconds = now - throttle->_last_refill;
+	throttle->_last_refill = now;
+
+	RefillBucket(&throttle->_bandwidth, elapsed_seconds);
+	RefillBucket(&throttle->_operations, elapsed_seconds);
+
+	double wait_seconds = TakeFromBucket(&throttle->_bandwidth, (double)among_bytes);
+	double operation_wait_seconds = TakeFromBucket(&throttle->_operations, 1);
+	if (operation_wait_seconds > wait_seconds) wait_seconds = operation_wait_seconds;
+
+	for (size_t at_index = 0; at_index < throttle->_among_of_devices; at_index += 1)
+	{
+		struct DeviceLimits* limits = &throttle->_device_limits[at_index];
+
+		RefillBucket(&limits->_bandwidth, elapsed_seconds);
+		RefillBucket(&limits->_operations, elapsed_seconds);
+
+		if (limits->_device != device) continue;
+
+		double device_wait_seconds = TakeFromBucket(&limits->_bandwidth, (double)among_bytes);
+		if (device_wait_seconds > wait_seconds) wait_seconds = device_wait_seconds;
+
+		device_wait_seconds = TakeFromBucket(&limits->_operations, 1);
+		if (device_wait_seconds > wait_seconds) wait_seconds = device_wait_seconds;
+	}
+
+	pthread_mutex_unlock(&throttle->_lock);
+
+
+
+	if (wait_seconds > 0)
+	{
+		long long trace_time = CmpTrace_Begin();
+		struct timespec wait_time;
+		wait_time.tv_sec = (time_t)wait_seconds;
+		wait_time.tv_nsec = (long)((wait_seconds - (double)wait_time.tv_sec) * 1e9);
+
+		while (nanosleep(&wait_time, &wait_time) != 0 && errno == EINTR);
+
+		CmpTrace_End("throttle", "io", trace_time, -1, -1, NULL);
+	}
+	#else
+	(void)throttle;
+	(void)device;
+	(void)among_bytes;
+	#endif
+}
+
+
+
+bool CmpThrottle_SetIoPriority(const char* priority)
+{
+	#ifdef __linux__
+	if (priority == NULL) return false;
+
+
+
+	const char* level_start = strchr(priority, ':');
+	size_t class_length = (level_start == NULL) ? strlen(priority) : (size_t)(level_start - priority);
+	int priority_class, priority_level = IOPRIO_DEFAULT_LEVEL;
+
+	if (class_length == strlen("idle") && strncmp(priority, "idle", class_length) == 0) priority_class = IOPRIO_CLASS_IDLE;
+	else if (class_length == strlen("best-effort") && strncmp(priority, "best-effort", class_length) == 0) priority_class = IOPRIO_CLASS_BEST_EFFORT;
+	else if (class_length == strlen("realtime") && strncmp(priority, "realtime", class_length) == 0) priority_class = IOPRIO_CLASS_REALTIME;
+	else return false;
+
+	if (level_start != NULL)
+	{
+		char* level_end;
+		long parsed_level = strtol(level_start + 1, &level_end, 10);
+
+		if (priority_class == IOPRIO_CLASS_IDLE || *level_end != '\0' || level_end == level_start + 1 || parsed_level < 0 || parsed_level > IOPRIO_LOWEST_LEVEL) return false;
+
+		priority_level = (int)parsed_level;
+	}
+
+	if (priority_class == IOPRIO_CLASS_IDLE) priority_level = 0;
+
+
+
+	//	With 0 as the process, the priority of the calling thread is set, which the threads created by it inherit.
+	if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, (priority_class << IOPRIO_CLASS_SHIFT) | priority_level) != 0)
+	{
+		fprintf(stderr, "Error in CmpThrottle_SetIoPriority: Couldn't set the IO priority %s (%s)!\n", priority, strerror(errno));
+		return false;
+	}
+
+	return true;
+	#else
+	(void)priority;
+	return false;
+	#endif
+}
@@ -0,0 +1,343 @@
+/*!
+ *	Source file, implementing the recording of a timeline of the opening, reading and comparing of the files,
+ *	into a ring buffer per thread, and its writing as a Chrome trace.
+ *
+ *	\file				cmptrace_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For clock_gettime and the thread functions.
+
+
+
+#include "cmpoutput_handler.h"
+#include "cmptrace_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <time.h>
+#endif
+
+
+
+const size_t DEFAULT_TRACE_EVENTS = 256 * 1024;
+
+
+
+#ifdef __linux__
+
+/*!
+ * 	A recorded span, or a single point in time, if its duration is negative.
+ * */
+struct TraceEvent
+{
+	const char* _name;
+	const char* _category;
+	const char* _detail;
+	long long _begin_time;
+	long long _duration;
+	long long _file_index;
+	long long _block_offset;
+};
+
+/*!
+ * 	The events of a single thread. Only that thread writes into it, while recording.
+ * */
+struct TraceRing
+{
+	struct TraceEvent* _events;
+	size_t _capacity;
+
+	/*!
+	 * 	The among of events, that were ever recorded. The newest one is at (_among_of_recorded - 1) % _capacity.
+	 * */
+	size_t _among_of_recorded;
+
+	size_t _thread_number;
+	unsigned long long _recording_number;
+	struct TraceRing* _next_ring;
+};
+
+
+
+/*!
+ * 	Guards the list of rings. It is only locked, when a thread records its first event, and when the trace is written.
+ * */
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct TraceRing* first_ring = NULL;
+static size_t among_of_rings = 0;
+
+static bool is_recording = false;
+static size_t ring_capacity = 0;
+static long long recording_start_time = 0;
+
+/*!
+ * 	Increased with each started recording, so that a thread doesn't keep using its ring from an earlier one.
+ * */
+static unsigned long long recording_number = 0;
+
+static __thread struct TraceRing* thread_ring = NULL;
+
+
+
+/* Static functions. */
+
+static long long CurrentTime(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (long long)now.tv_sec * 1000000000LL + (long long)now.tv_nsec;
+}
+
+
+
+/*!
+ * 	Fetches the ring of the calling thread, and creates it on its first event.
+ *
+ * 	\return	The ring, or NULL, if it couldn't be allocated (the events of the thread are then dropped).
+ * */
+static struct TraceRing* GetThreadRing(void)
+{
+	if (thread_ring != NULL && thread_ring->_recording_number == recording_number) return thread_ring;
+
+	struct TraceRing* ring = malloc(sizeof(struct TraceRing));
+	if (ring == NULL) return NULL;
+
+	ring->_events = malloc(sizeof(struct TraceEvent) * ring_capacity);
+	if (ring->_events == NULL)
+	{
+		free(ring);
+		return NULL;
+	}
+
+	ring->_capacity = ring_capacity;
+	ring->_among_of_recorded = 0;
+	ring->_recording_number = recording_number;
+
+	pthread_mutex_lock(&rings_lock);
+	among_of_rings += 1;
+	ring->_thread_number = among_of_rings;
+	ring->_next_ring = first_ring;
+	first_ring = ring;
+	pthread_mutex_unlock(&rings_lock);
+
+	thread_ring = ring;
+
+	return ring;
+}
+
+static void RecordEvent(const char* name, const char* category, const char* detail, long long begin_time, long long duration, long long file_index, long long block_offset)
+{
+	struct TraceRing* ring = GetThreadRing();
+	if (ring == NULL) return;
+
+	struct TraceEvent* trace_event = &ring->_events[ring->_among_of_recorded % ring->_capacity];
+	ring->_among_of_recorded += 1;
+
+	trace_event->_name = name;
+	trace_event->_category = category;
+	trace_event->_detail = detail;
+	trace_event->_begin_time = begin_time;
+	trace_event->_duration = duration;
+	trace_event->_file_index = file_index;
+	trace_event->_block_offset = block_offset;
+}
+
+
+
+/*!
+ * 	Writes a event in the Chrome trace event format: a complete event ("X") for a span, and a instant event ("i") for a single point in time.
+ * 	The times are written in microseconds, relative to the start of the recording.
+ * */
+static void WriteEvent(FILE* trace, const struct TraceRing* ring, const struct TraceEvent* trace_event)
+{
+	fputs("{\"name\":", trace);
+	CmpOutput_WriteJsonString(trace, trace_event->_name);
+	fputs(",\"cat\":", trace);
+	CmpOutput_WriteJsonString(trace, trace_event->_category);
+
+	if (trace_event->_duration >= 0) fprintf(trace, ",\"ph\":\"X\",\"dur\":%.3f", (double)trace_event->_duration / 1000.0);
+	else fputs(",\"ph\":\"i\",\"s\":\"t\"", trace);
+
+	fprintf(trace, ",\"ts\":%.3f,\"pid\":1,\"tid\":%zu,\"args\":{", (double)(trace_event->_begin_time - recording_start_time) / 1000.0, ring->_thread_number);
+
+	bool has_arguments = false;
+
+	if (trace_event->_file_index >= 0)
+	{
+		fprintf(trace, "\"file\":%lld", trace_event->_file_index);
+		has_arguments = true;
+	}
+
+	if (trace_event->_block_offset >= 0)
+	{
+		fprintf(trace, "%s\"offset\":%lld", has_arguments ? "," : "", trace_event->_block_offset);
+		has_arguments = true;
+	}
+
+	if (trace_event->_detail != NULL)
+	{
+		fprintf(trace, "%s\"detail\":", has_arguments ? "," : "");
+		CmpOutput_WriteJsonString(trace, trace_event->_detail);
+	}
+
+	fputs("}}", trace);
+}
+
+#endif
+
+
+
+
+
+
+/* Implemented functions. */
+
+bool CmpTrace_Start(size_t events_per_thread)
+{
+	#ifdef __linux__
+	if (events_per_thread == 0 || is_recording) return false;
+
+	ring_capacity = events_per_thread;
+	recording_number += 1;
+	recording_start_time = CurrentTime();
+	is_recording = true;
+
+	return true;
+	#else
+	(void)events_per_thread;
+	return false;
+	#endif
+}
+
+
+
+long long CmpTrace_Begin(void)
+{
+	#ifdef __linux__
+	return is_recording ? CurrentTime() : -1;
+	#else
+	return -1;
+	#endif
+}
+
+
+
+void CmpTrace_End(const char* name, const char* category, long long begin_time, long long file_index, long long block_offset, const char* detail)
+{
+	#ifdef __linux__
+	if (begin_time < 0 || !is_recording) return;
+
+	RecordEvent(name, category, detail, begin_time, CurrentTime() - begin_time, file_index, block_offset);
+	#else
+	(void)name;
+	(void)category;
+	(void)begin_time;
+	(void)file_index;
+	(void)block_offset;
+	(void)detail;
+	#endif
+}
+
+
+
+void CmpTrace_Mark(const char* name, const char* category, long long file_index, long long block_offset)
+{
+	#ifdef __linux__
+	if (!is_recording) return;
+
+	RecordEvent(name, category, NULL, CurrentTime(), -1, file_index, block_offset);
+	#else
+	(void)name;
+	(void)category;
+	(void)file_index;
+	(void)block_offset;
+	#endif
+}
+
+
+
+/*!
+ * 	The events of each thread are written from the oldest kept one to the newest one.
+ * 	The among of overwritten events is stored in the metadata of the trace.
+ * */
+bool CmpTrace_Finish(const char* trace_path)
+{
+	#ifdef __linux__
+	if (trace_path == NULL || !is_recording) return false;
+
+	is_recording = false;
+
+
+
+	pthread_mutex_lock(&rings_lock);
+
+	struct TraceRing* rings = first_ring;
+	first_ring = NULL;
+	among_of_rings = 0;
+
+	pthread_mutex_unlock(&rings_lock);
+
+
+
+	FILE* trace = fopen(trace_path, "w");
+	if (trace == NULL) fprintf(stderr, "Error in CmpTrace_Finish: Couldn't create the file %s!\n", trace_path);
+
+	unsigned long long dropped_events = 0;
+	bool is_first_event = true;
+
+	if (trace != NULL) fputs("{\"traceEvents\":[\n", trace);
+
+	for (struct TraceRing* ring = rings; ring != NULL && trace != NULL; ring = ring->_next_ring)
+	{
+		size_t kept_events = (ring->_among_of_recorded < ring->_capacity) ? ring->_among_of_recorded : ring->_capacity;
+		dropped_events += ring->_among_of_recorded - kept_events;
+
+		fprintf(trace, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s %zu\"}}",
+				is_first_event ? "" : ",\n", ring->_thread_number, ring->_thread_number == 1 ? "main" : "reader", ring->_thread_number);
+		is_first_event = false;
+
+		for (size_t at_event = ring->_among_of_recorded - kept_events; at_event < ring->_among_of_recorded; at_event += 1)
+		{
+			fputs(",\n", trace);
+			WriteEvent(trace, ring, &ring->_events[at_event % ring->_capacity]);
+		}
+	}
+
+	bool trace_was_written = false;
+
+	if (trace != NULL)
+	{
+		fprintf(trace, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%llu}}\n", dropped_events);
+		trace_was_written = (ferror(trace) == 0);
+		trace_was_written = (fclose(trace) == 0) && trace_was_written;
+	}
+
+
+
+	while (rings != NULL)
+	{
+		struct TraceRing* next_ring = rings->_next_ring;
+		free(rings->_events);
+		free(rings);
+		rings = next_ring;
+	}
+
+	return trace_was_written;
+	#else
+	(void)trace_path;
+	return false;
+	#endif
+}
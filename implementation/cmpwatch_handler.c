@@ -0,0 +1,507 @@
+/*!
+ *	Source file, implementing the functionality for watching the compared files for changes,
+ *	and comparing them again as soon as they change.
+ *
+ *	\file				cmpwatch_handler.c
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+
+#define _GNU_SOURCE	//	For the inotify and signal handling functions.
+
+
+
+#include "cmpfiles_handler.h"
+#include "cmpwatch_handler.h"
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#endif
+
+
+
+const unsigned int DEFAULT_WATCH_DELAY = 200;
+
+
+
+#ifdef __linux__
+
+/*!
+ * 	The events of a watched file, after which it is compared again.
+ * */
+#define FILE_EVENTS	(IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF)
+
+/*!
+ * 	The events of the directory of a watched file, after which the file is reopened (it was replaced by another one).
+ * */
+#define DIRECTORY_EVENTS	(IN_CREATE | IN_MOVED_TO)
+
+/*!
+ * 	How many times the delay, at most, the comparing can be postponed by a burst of changes.
+ * */
+#define MAXIMUM_DELAY_FACTOR	4
+
+/*!
+ * 	Marks a empty bucket of the watch tables.
+ * */
+#define NO_WATCHED_FILE	SIZE_MAX
+
+
+
+/*!
+ * 	Set by the signal handler, once the watching should stop.
+ * */
+static volatile sig_atomic_t watching_is_stopped = 0;
+
+
+
+/*!
+ * 	The inotify state of the files of a handler.
+ * */
+struct FileWatches
+{
+	/*!
+	 * 	The inotify instance.
+	 * */
+	int _inotify_descriptor;
+	/*!
+	 * 	Per file: its watch descriptor, or -1, if it isn't watched (for example, while it doesn't exist).
+	 * */
+	int* _file_watches;
+	/*!
+	 * 	Per file: the watch descriptor of its directory.
+	 * */
+	int* _directory_watches;
+	/*!
+	 * 	Per file: if set, the file has changed since it was last compared.
+	 * */
+	bool* _changed_files;
+	/*!
+	 * 	Per file: if set, the file has to be reopened by its filepath, before it is compared again.
+	 * */
+	bool* _reopened_files;
+	/*!
+	 * 	Hash tables (with linear probing) of the files, by their watch descriptor, and by the watch descriptor of their directory together with their name,
+	 * 	so that each event only looks at the files, that it concerns. Each bucket holds the index of a file, or NO_WATCHED_FILE.
+	 * 	They have at least twice as many buckets as there are files, so a empty bucket is always found.
+	 * */
+	size_t* _file_buckets;
+	size_t* _directory_buckets;
+	size_t _number_of_buckets;
+};
+
+
+
+/* Static functions. */
+
+static void StopWatching(int signal_number)
+{
+	(void)signal_number;
+	watching_is_stopped = 1;
+}
+
+static long long MonotonicMilliseconds(void)
+{
+	struct timespec current_time;
+	clock_gettime(CLOCK_MONOTONIC, &current_time);
+
+	return (long long)current_time.tv_sec * 1000 + current_time.tv_nsec / 1000000;
+}
+
+/*!
+ * 	When the pending changes are to be compared: after the delay since the last change,
+ * 	but no later than the maximum delay since the first change of the burst.
+ * */
+static long long RecompareTime(long long first_change_time, long long last_change_time, unsigned int delay_milliseconds)
+{
+	long long recompare_time = last_change_time + delay_milliseconds;
+	long long latest_recompare_time = first_change_time + (long long)MAXIMUM_DELAY_FACTOR * delay_milliseconds;
+
+	return latest_recompare_time < recompare_time ? latest_recompare_time : recompare_time;
+}
+
+/*!
+ * 	Returns the last component of the filepath.
+ * */
+static const char* FilepathBasename(const char* filepath)
+{
+	const char* last_separator = strrchr(filepath, '/');
+
+	return last_separator == NULL ? filepath : last_separator + 1;
+}
+
+/*!
+ * 	Adds a watch for the directory, that contains the file.
+ * */
+static int WatchDirectory(int inotify_descriptor, const char* filepath)
+{
+	const char* last_separator = strrchr(filepath, '/');
+	if (last_separator == NULL) return inotify_add_watch(inotify_descriptor, ".", DIRECTORY_EVENTS);
+	else if (last_separator == filepath) return inotify_add_watch(inotify_descriptor, "/", DIRECTORY_EVENTS);
+
+
+
+	size_t directory_length = (size_t)(last_separator - filepath);
+	char* directory = calloc(directory_length + 1, sizeof(char));
+	if (directory == NULL) return -1;
+
+	memcpy(directory, filepath, directory_length);
+	int directory_watch = inotify_add_watch(inotify_descriptor, directory, DIRECTORY_EVENTS);
+	free(directory);
+
+	return directory_watch;
+}
+
+
+
+/*!
+ * 	Finds the first bucket of a watch descriptor (and of the name of a file in its directory, if it isn't NULL).
+ * */
+static size_t WatchBucket(const struct FileWatches* watches, int watch_descriptor, const char* name)
+{
+	uint64_t hash = (uint64_t)(unsigned int)watch_descriptor * 0x9E3779B97F4A7C15ULL;
+
+	//	FNV-1a over the name.
+	for (const char* character = name; character != NULL && *character != '\0'; character += 1) hash = (hash ^ (unsigned char)*character) * 0x100000001B3ULL;
+
+	return (size_t)(hash ^ (hash >> 32)) & (watches->_number_of_buckets - 1);
+}
+
+/*!
+ * 	Puts every watched file into the table of the file watches. Is called again, whenever the file watches change.
+ * */
+static void MapFileWatches(struct FileWatches* watches, struct FilesToCompare* handler)
+{
+	const size_t BUCKET_MASK = watches->_number_of_buckets - 1;
+
+	for (size_t at_bucket = 0; at_bucket < watches->_number_of_buckets; at_bucket += 1) watches->_file_buckets[at_bucket] = NO_WATCHED_FILE;
+
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (watches->_file_watches[at_index] < 0) continue;
+
+		size_t at_bucket = WatchBucket(watches, watches->_file_watches[at_index], NULL);
+		while (watches->_file_buckets[at_bucket] != NO_WATCHED_FILE) at_bucket = (at_bucket + 1) & BUCKET_MASK;
+
+		watches->_file_buckets[at_bucket] = at_index;
+	}
+}
+
+/*!
+ * 	Puts every file into the table of the directory watches, by the watch of its directory and its name.
+ * */
+static void MapDirectoryWatches(struct FileWatches* watches, struct FilesToCompare* handler)
+{
+	const size_t BUCKET_MASK = watches->_number_of_buckets - 1;
+
+	for (size_t at_bucket = 0; at_bucket < watches->_number_of_buckets; at_bucket += 1) watches->_directory_buckets[at_bucket] = NO_WATCHED_FILE;
+
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		size_t at_bucket = WatchBucket(watches, watches->_directory_watches[at_index], FilepathBasename(handler->_filepaths[at_index]));
+		while (watches->_directory_buckets[at_bucket] != NO_WATCHED_FILE) at_bucket = (at_bucket + 1) & BUCKET_MASK;
+
+		watches->_directory_buckets[at_bucket] = at_index;
+	}
+}
+
+
+
+static void FreeWatches(struct FileWatches* watches)
+{
+	if (watches->_inotify_descriptor >= 0) close(watches->_inotify_descriptor);
+	free(watches->_file_watches);
+	free(watches->_directory_watches);
+	free(watches->_changed_files);
+	free(watches->_reopened_files);
+	free(watches->_file_buckets);
+	free(watches->_directory_buckets);
+}
+
+/*!
+ * 	Creates the inotify instance, and adds the watches of every file and its directory.
+ *
+ * 	\return	If succesfull, returns true. Otherwise, any allocated resources are freed, and false is returned.
+ * */
+static bool AddWatches(struct FileWatches* watches, struct FilesToCompare* handler)
+{
+	const size_t FILES_AMONG = handler->_number_of_filestreams;
+
+	watches->_inotify_descriptor = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	watches->_file_watches = malloc(sizeof(int) * FILES_AMONG);
+	watches->_directory_watches = malloc(sizeof(int) * FILES_AMONG);
+	watches->_changed_files = calloc(FILES_AMONG, sizeof(bool));
+	watches->_reopened_files = calloc(FILES_AMONG, sizeof(bool));
+
+	watches->_number_of_buckets = 1;
+	while (watches->_number_of_buckets < 2 * FILES_AMONG) watches->_number_of_buckets *= 2;
+
+	watches->_file_buckets = malloc(sizeof(size_t) * watches->_number_of_buckets);
+	watches->_directory_buckets = malloc(sizeof(size_t) * watches->_number_of_buckets);
+
+	if (watches->_inotify_descriptor < 0 || watches->_file_watches == NULL || watches->_directory_watches == NULL || watches->_changed_files == NULL || watches->_reopened_files == NULL || 
+		watches->_file_buckets == NULL || watches->_directory_buckets == NULL)
+	{
+		fputs("Error in AddWatches: Couldn't allocate the needed resources!\n", stderr);
+		FreeWatches(watches);
+		return false;
+	}
+
+
+
+	for (size_t at_index = 0; at_index < FILES_AMONG; at_index += 1)
+	{
+		watches->_file_watches[at_index] = inotify_add_watch(watches->_inotify_descriptor, handler->_filepaths[at_index], FILE_EVENTS);
+		watches->_directory_watches[at_index] = WatchDirectory(watches->_inotify_descriptor, handler->_filepaths[at_index]);
+
+		if (watches->_file_watches[at_index] < 0 || watches->_directory_watches[at_index] < 0)
+		{
+			fprintf(stderr, "Error in AddWatches: Couldn't watch the file %s!\n", handler->_filepaths[at_index]);
+			FreeWatches(watches);
+			return false;
+		}
+	}
+
+	MapFileWatches(watches, handler);
+	MapDirectoryWatches(watches, handler);
+
+	return true;
+}
+
+
+
+/*!
+ * 	Marks a file as changed by a event, and as reopened, if it was replaced, moved or deleted.
+ * */
+static void MarkChangedFile(struct FileWatches* watches, size_t file_index, const struct inotify_event* event, bool is_directory_event)
+{
+	watches->_changed_files[file_index] = true;
+
+	if (is_directory_event || (event->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) != 0) watches->_reopened_files[file_index] = true;
+	if (!is_directory_event && (event->mask & IN_IGNORED) != 0) watches->_file_watches[file_index] = -1;
+}
+
+/*!
+ * 	Reads all pending inotify events, and marks the files, that they concern.
+ * 	The files of each event are looked up in the watch tables, so only they are looked at.
+ *
+ * 	\return	If any file was marked as changed, returns true.
+ * */
+static bool ReadEvents(struct FileWatches* watches, struct FilesToCompare* handler)
+{
+	char event_buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	const size_t BUCKET_MASK = watches->_number_of_buckets - 1;
+	bool any_file_changed = false;
+
+	while (true)
+	{
+		ssize_t bytes_read = read(watches->_inotify_descriptor, event_buffer, sizeof(event_buffer));
+		if (bytes_read <= 0) break;
+
+
+
+		for (char* at_event = event_buffer; at_event < event_buffer + bytes_read; )
+		{
+			const struct inotify_event* event = (const struct inotify_event*)at_event;
+			at_event += sizeof(struct inotify_event) + event->len;
+
+			//	A file, whose watch was just removed (IN_IGNORED), stays in its bucket till the file watches are mapped again, so the descriptor is checked.
+			for (size_t at_bucket = WatchBucket(watches, event->wd, NULL); watches->_file_buckets[at_bucket] != NO_WATCHED_FILE; at_bucket = (at_bucket + 1) & BUCKET_MASK)
+			{
+				size_t file_index = watches->_file_buckets[at_bucket];
+				if (watches->_file_watches[file_index] != event->wd) continue;
+
+				MarkChangedFile(watches, file_index, event, false);
+				any_file_changed = true;
+			}
+
+			if (event->len == 0) continue;
+
+			for (size_t at_bucket = WatchBucket(watches, event->wd, event->name); watches->_directory_buckets[at_bucket] != NO_WATCHED_FILE; at_bucket = (at_bucket + 1) & BUCKET_MASK)
+			{
+				size_t file_index = watches->_directory_buckets[at_bucket];
+				if (watches->_directory_watches[file_index] != event->wd || strcmp(event->name, FilepathBasename(handler->_filepaths[file_index])) != 0) continue;
+
+				MarkChangedFile(watches, file_index, event, true);
+				any_file_changed = true;
+			}
+		}
+	}
+
+	return any_file_changed;
+}
+
+/*!
+ * 	Checks, if the filepath no longer leads to the open file (for example, because it was deleted, while still being open).
+ * */
+static bool FileWasReplaced(struct FilesToCompare* handler, size_t file_index)
+{
+	struct stat open_file_status, filepath_status;
+
+	if (handler->_files[file_index] == NULL) return true;
+	else if (fstat(handler->_files[file_index]->_descriptor, &open_file_status) != 0) return true;
+	else if (stat(handler->_filepaths[file_index], &filepath_status) != 0) return true;
+
+	return (open_file_status.st_dev != filepath_status.st_dev) || (open_file_status.st_ino != filepath_status.st_ino);
+}
+
+/*!
+ * 	Reopens the files, that were replaced or moved, and moves their watch to the file, that is now at their filepath.
+ * */
+static void ReopenFiles(struct FileWatches* watches, struct FilesToCompare* handler)
+{
+	bool any_file_was_reopened = false;
+
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (watches->_changed_files[at_index] && FileWasReplaced(handler, at_index)) watches->_reopened_files[at_index] = true;
+
+		if (!watches->_reopened_files[at_index]) continue;
+
+		watches->_reopened_files[at_index] = false;
+		any_file_was_reopened = true;
+		CmpFiles_ReopenFile(handler, at_index);
+
+		int file_watch = inotify_add_watch(watches->_inotify_descriptor, handler->_filepaths[at_index], FILE_EVENTS);
+
+		if (watches->_file_watches[at_index] >= 0 && watches->_file_watches[at_index] != file_watch)
+		{
+			inotify_rm_watch(watches->_inotify_descriptor, watches->_file_watches[at_index]);
+		}
+
+		watches->_file_watches[at_index] = file_watch;
+	}
+
+	if (any_file_was_reopened) MapFileWatches(watches, handler);
+}
+
+#endif
+
+
+
+
+
+
+/* Implemented functions. */
+
+bool CmpWatch_IsSupported(void)
+{
+	#ifdef __linux__
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+
+
+/*!
+ * 	The files are watched with inotify, together with their directories, so that files replaced by a rename are noticed as well.
+ * 	The wait for further changes is done with poll, whose timeout ends at whichever comes first:
+ * 	the delay after the last change, or the maximum delay after the first change of the burst.
+ * */
+bool CmpWatch_WatchFiles(struct FilesToCompare* handler, unsigned int delay_milliseconds, void (*on_recompared)(struct FilesToCompare* handler, bool all_matched, void* context), void* context)
+{
+	if (handler == NULL || on_recompared == NULL) return false;
+
+	for (size_t at_index = 0; at_index < handler->_number_of_filestreams; at_index += 1)
+	{
+		if (handler->_files[at_index] != NULL && handler->_files[at_index]->_is_stdin) return false;
+	}
+
+
+
+	#ifdef __linux__
+	struct FileWatches watches;
+	if (!AddWatches(&watches, handler)) return false;
+
+	struct sigaction stop_action, previous_interrupt_action, previous_terminate_action;
+	memset(&stop_action, 0, sizeof(stop_action));
+	stop_action.sa_handler = StopWatching;
+	sigemptyset(&stop_action.sa_mask);
+
+	watching_is_stopped = 0;
+	sigaction(SIGINT, &stop_action, &previous_interrupt_action);
+	sigaction(SIGTERM, &stop_action, &previous_terminate_action);
+
+
+
+	bool watching_failed = false;
+	bool changes_are_pending = false;
+	long long first_change_time = 0, last_change_time = 0;
+
+	while (!watching_is_stopped)
+	{
+		int timeout = -1;
+
+		if (changes_are_pending)
+		{
+			long long time_left = RecompareTime(first_change_time, last_change_time, delay_milliseconds) - MonotonicMilliseconds();
+			timeout = time_left > 0 ? (int)time_left : 0;
+		}
+
+		struct pollfd inotify_poll = {watches._inotify_descriptor, POLLIN, 0};
+		int poll_result = poll(&inotify_poll, 1, timeout);
+
+		if (poll_result < 0 && errno == EINTR) continue;
+		else if (poll_result < 0)
+		{
+			watching_failed = true;
+			break;
+		}
+
+
+
+		long long current_time = MonotonicMilliseconds();
+
+		if (poll_result > 0 && ReadEvents(&watches, handler))
+		{
+			if (!changes_are_pending) first_change_time = current_time;
+			last_change_time = current_time;
+			changes_are_pending = true;
+		}
+
+		if (!changes_are_pending) continue;
+		else if (current_time < RecompareTime(first_change_time, last_change_time, delay_milliseconds)) continue;
+
+
+
+		ReopenFiles(&watches, handler);
+
+		bool all_matched = CmpFiles_RecompareFiles(handler, watches._changed_files);
+		on_recompared(handler, all_matched, context);
+
+		memset(watches._changed_files, 0, sizeof(bool) * handler->_number_of_filestreams);
+		changes_are_pending = false;
+	}
+
+
+
+	sigaction(SIGINT, &previous_interrupt_action, NULL);
+	sigaction(SIGTERM, &previous_terminate_action, NULL);
+	FreeWatches(&watches);
+
+	return !watching_failed;
+	#else
+	(void)delay_milliseconds;
+	(void)context;
+	return false;
+	#endif
+}
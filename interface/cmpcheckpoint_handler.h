@@ -0,0 +1,62 @@
+/*!
+ *	Interface file for storing the progress of the file comparing into a checkpoint file,
+ *	and for resuming the comparing from it.
+ *
+ *	\file				cmpcheckpoint_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPCHECKPOINT_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPCHECKPOINT_HANDLER__
+#define CMPCHECKPOINT_HANDLER__
+
+
+
+#include <stdbool.h>
+#include "cmpfiles_handler.h"
+
+
+
+/*!
+ * The default number of compared bytes per file, after which a new checkpoint is written.
+ * */
+extern const long long DEFAULT_CHECKPOINT_INTERVAL;
+
+
+
+/*!
+ *	\brief 	Writes the progress of the file comparing into a checkpoint file, replacing the previous one atomically.
+ *
+ * 	The checkpoint holds the block offset, the groups and states of the files, their mismatch offsets,
+ * 	and the identity of each file (its device, inode, size and modification time), so that changed files can be detected when resuming.
+ * 	It is written into a temporary file first, which is synchronized to the disk, and then renamed over the previous checkpoint.
+ *
+ * 	\param	handler				The handler, whose files are being compared (between two blocks).
+ * 	\param	checkpoint_path	The filepath of the checkpoint file.
+ *
+ * 	\return	If the checkpoint was written, returns true.
+ * 				In case of a invalid argument value being provided (like stdin, which can't be resumed), or a IO error happing, false is returned instead.
+ */
+bool CmpCheckpoint_Write(struct FilesToCompare* handler, const char* checkpoint_path);
+
+/*!
+ *	\brief 	Restores the progress of the file comparing from a checkpoint file, if the files didn't change since it was written.
+ *
+ * 	\param	handler				The handler, whose files weren't compared yet.
+ * 	\param	checkpoint_path	The filepath of the checkpoint file.
+ * 	\param	was_resumed			Where it is stored, if the progress was restored. If there is no checkpoint file, it is set to false.
+ *
+ * 	\return	If the progress was restored, or there was no checkpoint file, returns true.
+ * 				In case of a invalid argument value being provided, a malformed checkpoint, files that don't match the checkpoint, or a IO error happing, false is returned instead.
+ */
+bool CmpCheckpoint_Resume(struct FilesToCompare* handler, const char* checkpoint_path, bool* was_resumed);
+
+
+
+#endif
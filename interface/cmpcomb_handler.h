@@ -19,7 +19,7 @@
 
 
 #include <stdlib.h>
-#include <stdbool.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 
@@ -47,33 +47,33 @@ enum MatchState
 };
 
 
-/*!	
+/*!
  *	Holds the necessary data for
  *	performing comparing sequences
  *  with multiple elements.
+ *
+ * 	The element indexes of a combination pair are not stored,
+ * 	but are calculated from its position (the pairs are ordered like the upper triangle of a matrix, row by row).
+ * 	The match states are packed into two bitsets, so that each combination pair only uses 2 bits of memory.
  * */
 struct CompareCombinations
 {
-	/*!	
-	 * 	Array of indexes, for which elements to compare. 
-	 * */
-	size_t* _compare_indexes;
-	/*!	
-	 * 	Array of indexes, for which elements to compare with. 
+	/*!
+	 * 	Bitset, in which every set bit marks a combination pair,
+	 * 	that had its match state decided.
 	 * */
-	size_t* _compare_with_indexes;
-	/*!	
-	 * 	The data matching state of the combination pairs.
+	uint64_t* _decided_states;
+	/*!
+	 * 	Bitset, in which every set bit marks a decided combination pair,
+	 * 	whose elements data is matched.
 	 * */
-	enum MatchState* _match_states;
-	/*!	
+	uint64_t* _matched_states;
+	/*!
 	 * 	The number of combination pairs.
-	 * 	The first half is in the member _compare_indexes,
-	 * 	and the second half in the member _compare_with_indexes. 
 	 * */
 	size_t _among_of_combinations;
-	/*!	
-	 *	The number of elements, 
+	/*!
+	 *	The number of elements,
 	 *	that need to be compared with each other.
 	 * */
 	size_t _among_of_elements;
@@ -83,9 +83,9 @@ struct CompareCombinations
 
 /*!
  *	\brief 	Calculate and return the among of combinations, from the number of elements.
- *	
+ *
  *	\param number_of_elements	The among of elements, that are to be compared with each other.
- *	
+ *
  *	\return	The number of combinations, for that among of elements.
  */
 size_t CmpComb_NumberOfCombinations(size_t number_of_elements);
@@ -94,7 +94,7 @@ size_t CmpComb_NumberOfCombinations(size_t number_of_elements);
 
 /*!
  *	\brief 	Free's the allocated resources of the struct.
- *	
+ *
  *	\param handler	The struct to free.
  */
 void CmpComb_Terminate(struct CompareCombinations* handler);
@@ -103,8 +103,8 @@ void CmpComb_Terminate(struct CompareCombinations* handler);
  *	\brief 	Allocated the needed resources for the struct, and initialized them.
  *
  *	\param number_of_elements	The among of elements, that are to be compared with each other.
- * 
- * 	\return	If succesfull, it returns the dynamically allocated handler of the compare combinations. 
+ *
+ * 	\return	If succesfull, it returns the dynamically allocated handler of the compare combinations.
  * 				In case of a logic or memory allocation error, any remaining allocated resources inside the function are freed, and NULL is returned.
  */
 struct CompareCombinations* CmpComb_Initialize(const size_t number_of_elements);
@@ -113,38 +113,63 @@ struct CompareCombinations* CmpComb_Initialize(const size_t number_of_elements);
 
 /*!
  *	\brief	Obtain a combination pair from the handler.
- * 
+ *
  * 	\param	handler							Holds the necessary data for handling combinations pairs, which are used to compare elements with each other.
  * 	\param	from_position				From which index position it fetched the combination pair.
  * 	\param	compare_index				The index position of the first element to compare.
  * 	\param	compare_with_index		The index position of the second element to compare with.
- * 
- * 	\return	If succesfull, returns true. 
+ *
+ * 	\return	If succesfull, returns true.
  * 				In case of a invalid argument value being provided, false is returned instead.
  * */
 bool CmpComb_GetCombination(struct CompareCombinations* handler, const size_t from_position, size_t* compare_index, size_t* compare_with_index);
 
 /*!
- *	\brief	Set a compare combination pair in the handler.
- * 
+ *	\brief	Obtain the position of a combination pair inside the handler.
+ *
  * 	\param	handler							Holds the necessary data for handling combinations pairs, which are used to compare elements with each other.
- * 	\param	from_position				From which index position it sets the combination pair.
  * 	\param	compare_index				The index position of the first element to compare.
  * 	\param	compare_with_index		The index position of the second element to compare with.
- * 
- * 	\return	If succesfull, returns true. 
+ * 	\param	at_position					Where the position of the combination pair is written to.
+ *
+ * 	\return	If succesfull, returns true.
+ * 				In case of a invalid argument value being provided (including both indexes being the same), false is returned instead.
+ * */
+bool CmpComb_GetPosition(struct CompareCombinations* handler, size_t compare_index, size_t compare_with_index, size_t* at_position);
+
+
+
+/*!
+ *	\brief	Obtain the match state of a combination pair.
+ *
+ * 	\param	handler				Holds the necessary data for handling combinations pairs, which are used to compare elements with each other.
+ * 	\param	from_position	From which index position it fetches the match state.
+ *
+ * 	\return	The match state of the combination pair.
+ * 				In case of a invalid argument value being provided, UNKNOWN is returned instead.
+ * */
+enum MatchState CmpComb_GetMatchState(struct CompareCombinations* handler, const size_t from_position);
+
+/*!
+ *	\brief	Set the match state of a combination pair.
+ *
+ * 	\param	handler				Holds the necessary data for handling combinations pairs, which are used to compare elements with each other.
+ * 	\param	from_position	At which index position it sets the match state.
+ * 	\param	match_state		The new match state of the combination pair.
+ *
+ * 	\return	If succesfull, returns true.
  * 				In case of a invalid argument value being provided, false is returned instead.
  * */
-bool CmpComb_SetCombination(struct CompareCombinations* handler, const size_t from_position, size_t compare_index, size_t compare_with_index);
+bool CmpComb_SetMatchState(struct CompareCombinations* handler, const size_t from_position, enum MatchState match_state);
 
 
 /*!
- *	\brief 	Assigns the compare combinations pair into a initialized struct.
- *	
+ *	\brief 	Resets the match states of all compare combination pairs to UNKNOWN.
+ *
  *	\param handler	Holds the necessary data for handling combinations pairs, which are used to compare elements with each other.
- *	
- * 	\return	If succesfull, returns true. 
- * 				In case of a invalid argument value being provided, or a memory allocation error happing, false is returned instead.
+ *
+ * 	\return	If succesfull, returns true.
+ * 				In case of a invalid argument value being provided, false is returned instead.
 */
 bool CmpComb_PrepareCombinations(struct CompareCombinations* handler);
 
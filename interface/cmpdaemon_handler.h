@@ -0,0 +1,141 @@
+/*!
+ *	Interface file for the resident daemon, that serves file comparing jobs over a Unix domain socket,
+ *	and for the client, that sends a job to it.
+ *
+ *	\file				cmpdaemon_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPDAEMON_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPDAEMON_HANDLER__
+#define CMPDAEMON_HANDLER__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "cmpoutput_handler.h"
+#include "cmpthrottle_handler.h"
+
+
+
+/*!
+ * The default number of worker threads, that compare the files of the jobs.
+ * */
+extern const size_t DEFAULT_DAEMON_WORKERS;
+
+/*!
+ * The default among of jobs, that can wait in the queue, before new ones are refused as busy.
+ * */
+extern const size_t DEFAULT_DAEMON_QUEUED_JOBS;
+
+/*!
+ * The default among of jobs of a single client, that can be compared at the same time.
+ * */
+extern const size_t DEFAULT_DAEMON_CLIENT_JOBS;
+
+/*!
+ * The default among of files, that a single job can contain.
+ * */
+extern const size_t DEFAULT_DAEMON_JOB_FILES;
+
+
+
+/*!
+ * 	The limits and options, that the daemon serves the jobs with.
+ * */
+struct DaemonSettings
+{
+	/*!
+	 * 	The number of worker threads. Each one has its own buffers allocated up front.
+	 * */
+	size_t _number_of_workers;
+
+	/*!
+	 * 	The among of jobs (of all clients together), that can wait for a worker.
+	 * 	A single client can fill at most half of the queue.
+	 * */
+	size_t _max_queued_jobs;
+
+	/*!
+	 * 	The among of jobs of a single client, that are compared at the same time,
+	 * 	so that a client with many heavy jobs can't take over all workers.
+	 * */
+	size_t _max_client_jobs;
+
+	/*!
+	 * 	The among of files, that a single job can contain.
+	 * */
+	size_t _max_job_files;
+
+	/*!
+	 * 	The number of bytes, that a buffer of one file can store.
+	 * */
+	size_t _compare_buffer_size;
+
+	/*!
+	 * 	If set, the groups are split by the fingerprints of their blocks.
+	 * */
+	bool _use_fingerprints;
+	
+	/*!
+	 * 	The limits of the reading, shared by all workers, or NULL, if the reading isn't limited.
+	 * */
+	struct IoThrottle* _throttle;
+};
+
+
+
+/*!
+ *	\brief 	Checks, if the daemon and its client are supported on this system.
+ *
+ *	\return	If they are supported (only on Linux), returns true.
+ */
+bool CmpDaemon_IsSupported(void);
+
+/*!
+ *	\brief 	Listens on a Unix domain socket, and compares the files of the received jobs, until the process receives SIGINT or SIGTERM.
+ *
+ * 	The socket is only accessible by the user, that started the daemon, and is removed once the daemon stops.
+ * 	A job is sent as the line "COMPARE <tag> <number of files> <text|json|csv> <all|matched> <groups|pairs> <paths|descriptors>",
+ * 	followed by one line per file: its filepath, or its name, with its open file descriptor passed along the line.
+ * 	Each job is answered with "RESULT <tag> <0 if all files matched, otherwise 1> <length>" and the results of that length,
+ * 	or with "BUSY <tag>" (the job wasn't accepted) or "ERROR <tag> <message>" lines.
+ *
+ * 	\param	socket_path		The filepath of the socket. A stale socket at this filepath is replaced.
+ * 	\param	settings			The limits and options, that the jobs are served with.
+ *
+ * 	\return	If the daemon was stopped by a signal, returns true.
+ * 				In case of a invalid argument value being provided, a memory allocation error or a socket error, false is returned instead.
+ */
+bool CmpDaemon_Serve(const char* socket_path, const struct DaemonSettings* settings);
+
+/*!
+ *	\brief 	Sends a job to the daemon, waits for its results, and writes them to the output.
+ *
+ * 	\param	output					Where the results are written to.
+ * 	\param	socket_path			The filepath of the daemons socket.
+ * 	\param	filepaths				A array of strings, containing the filepaths of the files, that are to be compared.
+ * 	\param	number_of_files		The among of files.
+ * 	\param	send_filepaths		If set, the absolute filepaths are sent, and the daemon opens the files itself.
+ * 											Otherwise, the files are opened here, and their file descriptors are passed to the daemon (stdin included).
+ * 	\param	output_format		In which format the results are written.
+ * 	\param	output_level			Which results are written.
+ * 	\param	show_combinations	If set, the results are written pair by pair.
+ * 	\param	all_matched				Where it is stored, if all files had matched data.
+ *
+ * 	\return	If the results were received, returns true.
+ * 				In case of a invalid argument value being provided, the daemon being busy or failing the job, or a socket error, false is returned instead.
+ */
+bool CmpDaemon_Request(FILE* output, const char* socket_path, char** filepaths, size_t number_of_files, bool send_filepaths, enum OutputFormat output_format, enum OutputLevel output_level, bool show_combinations, bool* all_matched);
+
+
+
+#endif
@@ -0,0 +1,58 @@
+/*!
+ *	Interface file for measuring, how much the data of the compared files differs,
+ *	by counting the differing bytes, blocks and bits of each pair of files.
+ *
+ *	\file				cmpdamage_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPDAMAGE_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPDAMAGE_HANDLER__
+#define CMPDAMAGE_HANDLER__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "cmpio_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmpthrottle_handler.h"
+
+
+
+/*!
+ *	\brief 	Reads all files block by block in a single pass, counts, in how many bytes and blocks (and optionally bits) each pair of them differs,
+ * 			and writes the counts of each pair, with the similarity of its files.
+ *
+ * 	Unlike the comparing, the files aren't left alone after their first difference, but are read till their end,
+ * 	or till every pair, that they are in, reached the threshold. The bytes, by which one file of a pair is longer, differ in all of their bits.
+ * 	The similarity of a pair is the share of the bytes of its longer file, that don't differ.
+ *
+ * 	\param	output						Where the results are written to.
+ * 	\param	filepaths					The filepaths of the files (one of them can be stdin).
+ * 	\param	number_of_files			The number of files (at least 2).
+ * 	\param	compare_buffer_size		The size of the block, that is read from each file at a time.
+ * 	\param	io_backend					The backend, through which the files are opened and read, or NULL for the default one.
+ * 	\param	throttle						The limits of the reading, or NULL.
+ * 	\param	compare_with_first		If set, only the pairs with the first file (the reference file) are counted.
+ * 	\param	threshold					After how many differing bytes the counting of a pair stops, or 0 to count all of them.
+ * 	\param	count_bits					If set, the differing bits are counted as well.
+ * 	\param	output_format				In which format the results are written.
+ * 	\param	all_matched				Where it is stored, if the files of every counted pair matched.
+ *
+ * 	\return	If the differences were counted and the results written, returns true.
+ * 				In case of a invalid argument value being provided, a file, that couldn't be opened, a memory allocation error or a IO error happing, false is returned instead.
+ */
+bool CmpDamage_CountDifferences(FILE* output, char** filepaths, size_t number_of_files, size_t compare_buffer_size, const struct IoBackend* io_backend, struct IoThrottle* throttle,
+												bool compare_with_first, long long threshold, bool count_bits, enum OutputFormat output_format, bool* all_matched);
+
+
+
+#endif
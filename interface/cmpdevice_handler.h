@@ -0,0 +1,145 @@
+/*!
+ *	Interface file for scheduling the reads of the compared files by the devices, that they are stored on,
+ *	so that files on the same rotational disk are read in long bursts, and files on different devices at the same time.
+ *
+ *	\file				cmpdevice_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPDEVICE_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPDEVICE_HANDLER__
+#define CMPDEVICE_HANDLER__
+
+
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "cmpthrottle_handler.h"
+
+
+
+/*!
+ * The number of bytes, that a burst of a file on a rotational device grows by, for each file on the same device.
+ * */
+extern const size_t DEVICE_BURST_SIZE;
+
+/*!
+ * The biggest number of bytes, that a single burst can have.
+ * */
+extern const size_t MAXIMUM_BURST_SIZE;
+
+
+
+/*!
+ * 	The reads of the files, grouped by their devices, and the bursts, that were read ahead.
+ * 	Its content is only accessed through the functions below.
+ * */
+struct DeviceScheduler;
+
+
+
+/*!
+ *	\brief 	Groups the files by their devices, and starts a reader thread for each device after the first one.
+ *
+ * 	Only regular files are scheduled (they are read at explicit offsets), the rest is read as before.
+ * 	A file on a rotational device, that it shares with other files, is read in bursts of DEVICE_BURST_SIZE times the among of those files.
+ * 	The other files are read a block at a time.
+ *
+ * 	\param	file_descriptors		The file descriptors of the files, or -1 for files, that aren't open.
+ * 	\param	number_of_files		The among of files.
+ * 	\param	block_size				The number of bytes of a compared block.
+ *
+ *	\return	If succesfull, returns the scheduler.
+ * 				In case of a invalid argument value being provided, a memory allocation error, or if the threads couldn't be started, NULL is returned instead.
+ */
+struct DeviceScheduler* CmpDevice_Initialize(const int* file_descriptors, size_t number_of_files, size_t block_size);
+
+/*!
+ *	\brief 	Stops the reader threads, and free's the allocated resources of the scheduler.
+ *
+ *	\param scheduler		The scheduler to free.
+ */
+void CmpDevice_Terminate(struct DeviceScheduler* scheduler);
+
+/*!
+ *	\brief 	Sets the limits, that every read burst waits for.
+ *
+ * 	\param	scheduler		The scheduler.
+ * 	\param	throttle		The limits, or NULL for no limits.
+ */
+void CmpDevice_SetThrottle(struct DeviceScheduler* scheduler, struct IoThrottle* throttle);
+
+/*!
+ *	\brief 	Checks, if a file is read through the scheduler.
+ *
+ * 	\param	scheduler		The scheduler.
+ * 	\param	file_index		The index of the file.
+ *
+ *	\return	If the file is scheduled, returns true.
+ */
+bool CmpDevice_IsScheduled(const struct DeviceScheduler* scheduler, size_t file_index);
+
+/*!
+ *	\brief 	Marks the block of a file, that is read next, so that CmpDevice_Prefetch reads it ahead (together with the rest of its burst).
+ *
+ * 	\param	scheduler		The scheduler.
+ * 	\param	file_index		The index of the scheduled file.
+ * 	\param	offset			The offset of the block.
+ */
+void CmpDevice_RequestBlock(struct DeviceScheduler* scheduler, size_t file_index, long long offset);
+
+/*!
+ *	\brief 	Reads the bursts of the requested blocks, that weren't read yet, with the reads of different devices at the same time.
+ *
+ * 	\param	scheduler		The scheduler.
+ */
+void CmpDevice_Prefetch(struct DeviceScheduler* scheduler);
+
+/*!
+ *	\brief 	Copies a block of a file from its burst, and reads the burst first, if it doesn't contain the block.
+ *
+ * 	\param	scheduler		The scheduler.
+ * 	\param	file_index		The index of the scheduled file.
+ * 	\param	offset			The offset of the block.
+ * 	\param	buffer			Where the block is copied to.
+ * 	\param	block_length	The number of bytes of a block.
+ * 	\param	bytes_read		Where the number of copied bytes is stored (less than block_length at the end of the file).
+ *
+ *	\return	If no IO error occured, returns true.
+ */
+bool CmpDevice_ReadBlock(struct DeviceScheduler* scheduler, size_t file_index, long long offset, unsigned char* buffer, size_t block_length, size_t* bytes_read);
+
+/*!
+ *	\brief 	Forgets the read bursts, since the files could have changed since then.
+ *
+ * 	\param	scheduler		The scheduler.
+ */
+void CmpDevice_DiscardBursts(struct DeviceScheduler* scheduler);
+
+/*!
+ *	\brief 	Sets the offset, that no burst of a file reads past, and forgets its burst.
+ *
+ * 	\param	scheduler		The scheduler.
+ * 	\param	file_index		The index of the file.
+ * 	\param	read_end		The offset, where the reading of the file stops (like the end of its compared region), or -1, to read it till its end.
+ */
+void CmpDevice_LimitFile(struct DeviceScheduler* scheduler, size_t file_index, long long read_end);
+
+/*!
+ *	\brief 	Sets the new file descriptor of a reopened file, and forgets its burst.
+ *
+ * 	\param	scheduler				The scheduler.
+ * 	\param	file_index				The index of the file.
+ * 	\param	file_descriptor		The new file descriptor, or -1, if the file couldn't be opened.
+ */
+void CmpDevice_ReplaceFile(struct DeviceScheduler* scheduler, size_t file_index, int file_descriptor);
+
+
+
+#endif
@@ -0,0 +1,97 @@
+/*!
+ *	Interface file for writing a manifest with the digests of the blocks of the compared files,
+ *	while they are compared (so that a single copy can be checked later, without the others).
+ *
+ *	\file				cmpdigest_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPDIGEST_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPDIGEST_HANDLER__
+#define CMPDIGEST_HANDLER__
+
+
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "cmpfiles_handler.h"
+
+
+
+/*!
+ * A set of constants for defining the algorithm, by which the blocks are digested.
+ * */
+enum DigestAlgorithm
+{
+	/*!
+	 * The 64 bit xxHash (XXH64, with the seed 0), which is fast, but not cryptographic.
+	 * */
+	DIGEST_XXH64,
+	/*!
+	 * SHA-256, which is cryptographic, but several times slower.
+	 * */
+	DIGEST_SHA256
+};
+
+/*!
+ * 	Holds the open manifest, the blocks that wait to be digested, and the thread that digests them.
+ * */
+struct DigestManifest;
+
+
+
+/*!
+ *	\brief 	Parses the name of a digest algorithm: xxh64 or sha256.
+ *
+ * 	\param	name				The parsed name.
+ * 	\param	algorithm		Where the algorithm is stored.
+ *
+ * 	\return	If the name is known, returns true.
+ */
+bool CmpDigest_ParseAlgorithm(const char* name, enum DigestAlgorithm* algorithm);
+
+/*!
+ *	\brief 	Calculates the digest of a data block, and writes it as lowercase hexadecimal text (in the byte order, that xxhsum and sha256sum show it in).
+ *
+ * 	\param	algorithm		The used algorithm.
+ * 	\param	data				The digested data.
+ * 	\param	length			The among of bytes of the data.
+ * 	\param	digest_text		Where the text is written to (at least 65 characters long, with the ending NUL).
+ */
+void CmpDigest_Calculate(enum DigestAlgorithm algorithm, const unsigned char* data, size_t length, char* digest_text);
+
+/*!
+ *	\brief 	Creates the manifest, and starts following the compared blocks of the handler (which can't share its buffers, as with a memory budget).
+ *
+ * 	After each compared block, the files with the same data so far (the classes) have the block of one of them copied,
+ * 	and digested by a separate thread (only on Linux, otherwise right away), so that the digesting overlaps with the reading of the next block.
+ * 	The manifest is a text file, which lists the files and, whenever they change, the classes of the files, and then a line per block with a digest per class.
+ *
+ * 	\param	manifest_path	The filepath of the manifest, which is replaced, if it exists.
+ * 	\param	algorithm			The algorithm, by which the blocks are digested.
+ * 	\param	handler				The handler, whose files weren't compared yet.
+ *
+ * 	\return	The manifest, or NULL, in case of a invalid argument value being provided, a memory allocation error, or a IO error happing.
+ */
+struct DigestManifest* CmpDigest_Start(const char* manifest_path, enum DigestAlgorithm algorithm, struct FilesToCompare* handler);
+
+/*!
+ *	\brief 	Waits for the remaining blocks to be digested, stops following the handler, finishes the manifest, and releases its resources.
+ *
+ * 	\param	manifest		The manifest, or NULL.
+ *
+ * 	\return	If the whole manifest was written, returns true.
+ * 				In case of a invalid argument value being provided, or a IO error happing, false is returned instead.
+ */
+bool CmpDigest_Finish(struct DigestManifest* manifest);
+
+
+
+#endif
@@ -19,7 +19,12 @@
 
 
 #include <stdio.h>
+#include <stdint.h>
 #include "cmpcomb_handler.h"
+#include "cmpthrottle_handler.h"
+#include "cmpdevice_handler.h"
+#include "cmppool_handler.h"
+#include "cmpio_handler.h"
 
 
 
@@ -29,6 +34,75 @@
  * */
 extern const char* STDIN_FILEPATH_MARK;
 
+/*!
+ * The smallest size of a buffer, that a memory budget can shrink the buffers to.
+ * */
+extern const size_t MINIMUM_BUFFER_SIZE;
+
+
+
+/*!
+ * 	Constants for indicating the comparing state of each file.
+ * */
+enum FileState
+{
+	/*!
+	 * 	The file is still being read,
+	 * 	since there are other files in its group, whose data was matched so far.
+	 * */
+	FILE_COMPARING,
+	/*!
+	 * 	The file was read till its end,
+	 * 	and its data is matched with every other file in its group.
+	 * */
+	FILE_FINISHED,
+	/*!
+	 * 	The files data is not matched with any other file,
+	 * 	so it is no longer read.
+	 * */
+	FILE_UNIQUE,
+	/*!
+	 * 	A IO error occured while reading the file,
+	 * 	so it is no longer read.
+	 * */
+	FILE_FAILED,
+	/*!
+	 * 	The file can't be in a group of the quorum size anymore (or the quorum was reached without it),
+	 * 	so it is no longer read. Whether it matches the other abandoned files, isn't known.
+	 * */
+	FILE_ABANDONED
+};
+
+
+
+/*!
+ * 	The known layout of a file: its size, and where its next data and hole regions are.
+ * 	Holes are regions of sparse files, that are not stored on the disk and read as zeros.
+ * */
+struct FileExtents
+{
+	/*!
+	 * 	The size of the file (or of its compared region) in bytes, or -1, if it is not known in advance (like for a pipe).
+	 * */
+	long long _file_size;
+	
+	/*!
+	 * 	If set, the data and hole regions of the file can be queried,
+	 * 	and the file is read at explicit offsets.
+	 * */
+	bool _can_seek_holes;
+	
+	/*!
+	 * 	The offset of the first data byte at or after the current block, or -1, if it wasn't queried yet.
+	 * */
+	long long _next_data_offset;
+	
+	/*!
+	 * 	The offset of the first hole byte after _next_data_offset (the end of the file counts as a hole).
+	 * */
+	long long _next_hole_offset;
+};
+
 
 
 /*!
@@ -53,10 +127,15 @@ struct FilesToCompare
 	char** _filepaths;
 	
 	/*!
-	*	Contains the open (or closed, if NULL) filestreams of the files, 
-	* 	that need to be compared with each other.
+	*	Contains the open (or closed, if NULL) files, that need to be compared with each other,
+	* 	opened through the IO backend.
 	* */
-	FILE** _filestreams;
+	struct IoFile** _files;
+	
+	/*!
+	* 	The backend, through which the files are opened and read.
+	* */
+	const struct IoBackend* _io_backend;
 	
 	/*!
 	* 	Contains the pointers to the buffers, 
@@ -64,13 +143,320 @@ struct FilesToCompare
 	* */
 	unsigned char** _compare_buffers;
 	
+	/*!
+	* 	If set, the buffers were provided by the caller, so they are not freed together with the handler.
+	* */
+	bool _buffers_are_borrowed;
+	
 	/*!
 	* 	The among of bytes each buffer has stored at the moment.
 	* */
 	size_t* _buffers_byte_among;
 	
 	/*!
-	* 	The struct, that is used for handling the file comparing logic.
+	* 	Per file: if set, the current block lies in a hole, 
+	* 	so it consists of only zeros and was not read into the buffer.
+	* */
+	bool* _zero_blocks;
+	
+	/*!
+	* 	The size and the data and hole regions of each file.
+	* */
+	struct FileExtents* _file_extents;
+	
+	/*!
+	* 	The offset of the current block, which is the same for all files, that are still compared.
+	* */
+	long long _block_offset;
+	
+	/*!
+	* 	The identifier of the group each file belongs to.
+	* 	Files in the same group have their data matched so far.
+	* */
+	size_t* _group_ids;
+	
+	/*!
+	* 	The number of group identifiers, that are in use.
+	* 	Never bigger than the number of filestreams.
+	* */
+	size_t _number_of_groups;
+	
+	/*!
+	* 	The number of files each group contains, indexed by the group identifier.
+	* */
+	size_t* _group_sizes;
+	
+	/*!
+	* 	The comparing state of each file.
+	* */
+	enum FileState* _file_states;
+	
+	/*!
+	* 	Per group: the first file, that was compared in the current block (the groups representative).
+	* 	Only used while comparing.
+	* */
+	size_t* _block_representatives;
+	
+	/*!
+	* 	Per file: the representative of the next group, that was split off in the current block.
+	* 	Only used while comparing.
+	* */
+	size_t* _next_representatives;
+	
+	/*!
+	* 	The files, that are split into classes by the tiled kernel in the current block, in their order.
+	* 	Only used while comparing.
+	* */
+	size_t* _split_files;
+	
+	/*!
+	* 	Per file: the representative of its class in the current block, and, for the files that split off,
+	* 	the offset of the first byte, in which they differ. Also room for 3 indexes per file, used by the kernel.
+	* 	Only used while comparing.
+	* */
+	size_t* _split_representatives;
+	size_t* _split_offsets;
+	size_t* _split_scratch;
+	
+	/*!
+	* 	If set, the files are routed to the representatives of their groups by the fingerprints of their blocks,
+	* 	instead of being compared with each representative in turn.
+	* */
+	bool _use_fingerprints;
+	
+	/*!
+	* 	The fingerprint of the current block of each file.
+	* 	Is NULL, unless fingerprints are used.
+	* */
+	uint64_t* _block_fingerprints;
+	
+	/*!
+	* 	A buffer of zeros, that blocks, that lie in a hole, are fingerprinted and told apart from other blocks with.
+	* */
+	unsigned char* _zero_buffer;
+	
+	/*!
+	* 	The fingerprint of a whole block of zeros.
+	* */
+	uint64_t _zero_fingerprint;
+	
+	/*!
+	* 	The number of buckets in the fingerprint table (always a power of two).
+	* */
+	size_t _number_of_buckets;
+	
+	/*!
+	* 	Per bucket: the group representative, whose block fingerprint was put in the bucket.
+	* */
+	size_t* _bucket_representatives;
+	
+	/*!
+	* 	Per bucket: the identifier of the group, that the representative was in before the current block.
+	* */
+	size_t* _bucket_group_ids;
+	
+	/*!
+	* 	Per bucket: the block, in which the bucket was filled. Buckets from earlier blocks count as empty.
+	* */
+	size_t* _bucket_blocks;
+	
+	/*!
+	* 	The number of blocks, that were compared so far.
+	* */
+	size_t _block_number;
+	
+	/*!
+	* 	The index of the reference file, that every other file is only compared with,
+	* 	or SIZE_MAX, if the files are compared with each other.
+	* */
+	size_t _reference_index;
+	
+	/*!
+	* 	The among of files, that need to be matched till their end, before the comparing stops, or 0, if every file is compared.
+	* */
+	size_t _quorum;
+	
+	/*!
+	* 	The indexes of the files, whose current block is compared with the block of the reference file.
+	* 	Is NULL, unless a reference file is set.
+	* */
+	size_t* _reference_candidates;
+	
+	/*!
+	* 	Per candidate: if its current block matched the block of the reference file.
+	* 	Is NULL, unless a reference file is set.
+	* */
+	bool* _candidate_matches;
+	
+	/*!
+	* 	Per file: the offset of the first byte, in which it stopped matching the rest of its group, or -1, if it never did.
+	* 	Only a block, that couldn't be read again into a slot, has the offset of the block instead.
+	* */
+	long long* _mismatch_offsets;
+	
+	/*!
+	* 	Called every _progress_interval bytes of compared blocks, once all files have compared the same block.
+	* 	Is NULL, if the progress isn't followed.
+	* */
+	void (*_on_progress)(struct FilesToCompare* handler, void* context);
+	
+	/*!
+	* 	Passed to _on_progress as it is.
+	* */
+	void* _progress_context;
+	
+	/*!
+	* 	The number of bytes of compared blocks, after which _on_progress is called again.
+	* */
+	long long _progress_interval;
+	
+	/*!
+	* 	The block offset, at which _on_progress is called next.
+	* */
+	long long _next_progress_offset;
+	
+	/*!
+	* 	Called after each compared block (before the states of the files are updated), or NULL.
+	* */
+	void (*_on_block)(struct FilesToCompare* handler, void* context);
+	
+	/*!
+	* 	Passed to _on_block as it is.
+	* */
+	void* _block_context;
+	
+	/*!
+	* 	Called as soon as a decision about a file is made, or NULL.
+	* */
+	void (*_on_decision)(struct FilesToCompare* handler, size_t file_index, long long offset, void* context);
+	
+	/*!
+	* 	Passed to _on_decision as it is.
+	* */
+	void* _decision_context;
+	
+	/*!
+	* 	The limits of the reading, which can be shared with other handlers.
+	* 	Is NULL, if the reading isn't limited.
+	* */
+	struct IoThrottle* _throttle;
+	
+	/*!
+	* 	Per file: the device (st_dev), that it is read from.
+	* 	Is NULL, unless the reading or the open files are limited.
+	* */
+	unsigned long long* _file_devices;
+	
+	/*!
+	* 	The most files, that are kept open at the same time, or 0, if every file stays open.
+	* 	Files, that can't be opened again (like stdin or pipes), always stay open, and aren't counted.
+	* */
+	size_t _max_open_files;
+	
+	/*!
+	* 	The number of pooled files, that are open at the moment.
+	* */
+	size_t _among_of_open_files;
+	
+	/*!
+	* 	Per file: if set, the file is read at explicit offsets, so it can be closed and opened again by its filepath, once it is needed.
+	* 	Is NULL, unless the open files are limited.
+	* */
+	bool* _pooled_files;
+	
+	/*!
+	* 	Per file: the inode (st_ino), by which a pooled file is recognized, when it is opened again.
+	* 	Is NULL, unless the open files are limited.
+	* */
+	unsigned long long* _file_inodes;
+	
+	/*!
+	* 	The file, from which on the next open pooled file is searched for, when one has to be closed (so they are closed in turn).
+	* */
+	size_t _pool_hand;
+	
+	/*!
+	* 	The number of buffers, that the files share, or 0, if every file has a buffer of its own.
+	* 	Is set, when the memory budget doesn't allow a buffer per file.
+	* */
+	size_t _among_of_slots;
+	
+	/*!
+	* 	The shared buffers. A file, that has a slot, has its _compare_buffers entry pointed to it, and NULL otherwise.
+	* */
+	unsigned char** _slot_buffers;
+	
+	/*!
+	* 	Per slot: the file, whose current block it holds, or SIZE_MAX, if it is free.
+	* */
+	size_t* _slot_files;
+	
+	/*!
+	* 	Per file: the slot, that holds its current block, or SIZE_MAX, if its block isn't held by any.
+	* */
+	size_t* _file_slots;
+	
+	/*!
+	* 	The slots, that are free, used as a stack.
+	* */
+	size_t* _free_slots;
+	size_t _among_of_free_slots;
+	
+	/*!
+	* 	The slot, from which on the next slot is searched for, when a held one has to be taken over.
+	* */
+	size_t _slot_hand;
+	
+	/*!
+	* 	Reads the files grouped by their devices: in bursts on shared rotational devices, and on different devices at the same time.
+	* 	Is NULL, unless the device scheduling was enabled.
+	* */
+	struct DeviceScheduler* _device_scheduler;
+	
+	/*!
+	* 	The compare threads, that the comparing of the current blocks is split among.
+	* 	Is NULL, unless the compare threads were enabled.
+	* */
+	struct ComparePool* _compare_pool;
+	
+	/*!
+	* 	Per checked pair: the file, whose block the block of the other file is checked against, and the other file.
+	* 	Both blocks of a pair have the same length. Are NULL, unless the compare threads were enabled.
+	* */
+	size_t* _pair_firsts;
+	size_t* _pair_seconds;
+	size_t _among_of_pairs;
+	
+	/*!
+	* 	Per part of a checked pair: if the blocks of the pair match in the range of the part.
+	* 	The parts are ordered by their range first, so that each thread handles the same range of the blocks after another.
+	* 	After the checking, the first _among_of_pairs of them hold, if the whole blocks of each pair match. Is NULL, unless the compare threads were enabled.
+	* */
+	bool* _part_matches;
+	size_t _parts_per_pair;
+	size_t _part_size;
+	
+	/*!
+	* 	Per group: if any of its files doesn't match the first file of the group in the current block.
+	* 	Is NULL, unless the compare threads were enabled.
+	* */
+	bool* _split_groups;
+	
+	/*!
+	* 	Per file: the offset in the file, where its compared region starts. Block offsets (and so the mismatch offsets) are relative to it.
+	* 	Is NULL, unless the regions were set.
+	* */
+	long long* _region_offsets;
+	
+	/*!
+	* 	Per file: the number of bytes of its compared region, or -1, if the region lasts till the end of the file.
+	* 	Is NULL, unless the regions were set.
+	* */
+	long long* _region_lengths;
+	
+	/*!
+	* 	The match states of every file pair.
+	* 	Is NULL, until it gets resolved by CmpFiles_ResolveCombinations.
 	* */
 	struct CompareCombinations* _combinations_handler;
 };
@@ -96,14 +482,260 @@ void CmpFiles_Terminate(struct FilesToCompare* handler);
  */
 struct FilesToCompare* CmpFiles_Initialize(char** filepaths, size_t number_of_files, size_t compare_buffer_size);
 
+/*!
+ *	\brief 	Allocated the needed resources for the struct, and initialized them, with already open filestreams or already allocated buffers.
+ *
+ * 	Useful, when the files were opened by someone else (like passed file descriptors), or when the buffers are reused between handlers.
+ *
+ *	\param filepaths					A array of strings, containing the filepaths (used only as names, if the filestreams are provided).
+ * 	\param filestreams				The open filestreams of the files, which the handler takes over (and closes). If NULL, the filepaths are opened.
+ * 	\param number_of_files			The among of files, that are to be compared with each other.
+ * 	\param compare_buffer_size	The number of bytes, that a buffer of one filestream can store.
+ * 	\param compare_buffers		Per file: a buffer of compare_buffer_size bytes, which stays owned by the caller. If NULL, the buffers are allocated.
+ * 
+ * 	\return	If succesfull, it returns the dynamically allocated handler for the file comparing.
+ * 				In case of a logic or memory allocation error, any remaining allocated resources inside the function are freed, and NULL is returned.
+ */
+struct FilesToCompare* CmpFiles_InitializeWithResources(char** filepaths, FILE** filestreams, size_t number_of_files, size_t compare_buffer_size, unsigned char** compare_buffers);
+
+/*!
+ *	\brief 	Allocated the needed resources for the struct, and initialized them, within limits of the open files and the memory,
+ * 			that don't depend on the number of files.
+ *
+ * 	Files, that are read at explicit offsets, are opened as they are needed, and the one, that was opened the longest ago, is closed,
+ * 	once max_open_files of them are open. A file, that is opened again, continues at its block offset (and has to be the same file).
+ * 	The buffers are shrunk (down to MINIMUM_BUFFER_SIZE), so that a buffer per file fits into max_memory.
+ * 	If even that doesn't fit, the files share as many buffers as fit, and are compared one after another, 
+ * 	with the blocks of the group representatives read again, if their buffer was taken over.
+ *
+ *	\param filepaths					A array of strings, containing the filepaths.
+ * 	\param number_of_files			The among of files, that are to be compared with each other.
+ * 	\param compare_buffer_size	The number of bytes, that a buffer of one filestream can store (at most).
+ * 	\param max_open_files			The most files, that are open at the same time (not counting stdin and pipes), or 0 for no limit.
+ * 	\param max_memory				The most bytes, that the buffers use together, or 0 for no limit.
+ * 	\param io_backend				The backend, through which the files are opened and read, or NULL for the default one.
+ * 
+ * 	\return	If succesfull, it returns the dynamically allocated handler for the file comparing.
+ * 				In case of a logic or memory allocation error, or if the memory budget is too small, any remaining allocated resources inside the function are freed, and NULL is returned.
+ */
+struct FilesToCompare* CmpFiles_InitializeWithLimits(char** filepaths, size_t number_of_files, size_t compare_buffer_size, size_t max_open_files, size_t max_memory, 
+																	const struct IoBackend* io_backend);
+
+/*!
+ * 	\brief	Enables the routing of files to their group representatives by block fingerprints.
+ * 
+ * 	Useful, when many files have the same size, but differing data, since a file then doesn't need to be compared with every representative.
+ * 	The fingerprints are only a hint: every file is still compared byte by byte with the representative it is routed to.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, or a memory allocation error happing, false is returned instead.
+ * */
+bool CmpFiles_EnableFingerprints(struct FilesToCompare* handler);
+
+/*!
+ * 	\brief	Sets the reference file, that every other file is compared with, instead of with each other.
+ * 
+ * 	The reference file is read once per block, and a file stops being read, as soon as it doesn't match it.
+ * 	Files, that don't match the reference file, are shown as not matched, even if they match each other.
+ * 	Has to be set before the files are compared.
+ * 
+ * 	\param	handler			The handler, whose files weren't compared yet.
+ * 	\param	file_index		The index of the reference file.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, or a memory allocation error happing, false is returned instead.
+ * */
+bool CmpFiles_SetReference(struct FilesToCompare* handler, size_t file_index);
+
+/*!
+ * 	\brief	Restricts the comparing of each file to a region of it, which can start at a different offset in each file.
+ * 
+ * 	No byte outside of the regions is read: files, that can be read at explicit offsets, are read from the start of their region,
+ * 	while other seekable files are moved there. The bytes before the region of a file, that can't seek (like a pipe), are read and discarded.
+ * 	The groups are seeded again, by the sizes of the regions. Has to be set before the files are compared.
+ * 
+ * 	\param	handler				The handler, whose files weren't compared yet.
+ * 	\param	region_offsets		Per file: the offset, where its region starts.
+ * 	\param	region_lengths		Per file: the number of bytes of its region, or -1, if it lasts till the end of the file.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, a memory allocation error, or if a file couldn't be moved to its region, false is returned instead.
+ * */
+bool CmpFiles_SetRegions(struct FilesToCompare* handler, const long long* region_offsets, const long long* region_lengths);
+
 /*!
  * 	\brief	Compares the files data contents with each other, and marks the results in the handler.
  * 
- * 	\return	If all files have matched data (byte by byte), returns true. 
+ * 	The files are split into groups, whose data is matched so far, block by block.
+ * 	A file, that is left alone in its group, is no longer read.
+ * 	Blocks, that lie in a hole of a sparse file, are not read, but compared as zeros,
+ * 	and ranges where every compared file has a hole are skipped entirely.
+ * 
+ * 	\return	If all files have matched data (byte by byte), returns true. With a quorum, returns true, once enough files have matched data. 
  * 				In case of a invalid argument value being provided, or that one or several files byte data is not matched, false is returned instead.
  * */
 bool CmpFiles_CompareFiles(struct FilesToCompare* handler);
 
+/*!
+ * 	\brief	Closes and opens the file again by its filepath, for example after it was replaced or moved.
+ * 
+ * 	\param	handler			The handler, that contains the file.
+ * 	\param	file_index	The index of the file to reopen.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided (stdin can't be reopened), or if the file couldn't be opened, false is returned instead.
+ * 				The file is then marked as failed, when it gets recompared.
+ * */
+bool CmpFiles_ReopenFile(struct FilesToCompare* handler, size_t file_index);
+
+/*!
+ * 	\brief	Sets the function, that is called periodically, while the files are compared.
+ * 
+ * 	The function is called between two blocks, when every file, that is still compared, has compared the same block,
+ * 	so the state of the handler is consistent (and can be stored, to resume the comparing later).
+ * 
+ * 	\param	handler				The handler, whose files are to be compared.
+ * 	\param	interval_bytes		After how many bytes of compared blocks the function is called.
+ * 	\param	on_progress			The called function, or NULL, if nothing should be called.
+ * 	\param	context				Passed to on_progress as it is.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, false is returned instead.
+ * */
+bool CmpFiles_SetProgressCallback(struct FilesToCompare* handler, long long interval_bytes, void (*on_progress)(struct FilesToCompare* handler, void* context), void* context);
+
+/*!
+ * 	\brief	Sets the function, that is called after each block, that was compared by the files, that are still compared.
+ * 
+ * 	When the function is called, _block_offset is the offset of the compared block, and each file, whose state is still FILE_COMPARING,
+ * 	has its block in its buffer (or in a hole, if its _zero_blocks value is true), and its group includes the block.
+ * 	Blocks, that are skipped, since all compared files have holes there, aren't passed to the function.
+ * 
+ * 	\param	handler		The handler, whose files are to be compared, without a memory budget (so that each file has its own buffer).
+ * 	\param	on_block		The called function, or NULL, if nothing should be called.
+ * 	\param	context		Passed to on_block as it is.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, or the files sharing their buffers, false is returned instead.
+ * */
+bool CmpFiles_SetBlockCallback(struct FilesToCompare* handler, void (*on_block)(struct FilesToCompare* handler, void* context), void* context);
+
+/*!
+ * 	\brief	Sets the function, that is called as soon as a decision about a file is made, while the files are compared.
+ * 
+ * 	The function is called, when the state of a file is decided (FILE_UNIQUE, FILE_FINISHED, FILE_FAILED or FILE_ABANDONED), 
+ * 	and when a file stops matching some of the files of its group (its state is then still FILE_COMPARING), so that the pairs of the file with them are NOT_MATCHED.
+ * 	Once a file is FILE_FINISHED, its group (and so every pair of the files in it) is decided as matched, and no longer changes.
+ * 	The offset is the block offset, up to which the file was compared, or for a mismatch the offset of its first differing byte, and for a finished file its end
+ * 	(all relative to the region of the file). The files, that were already decided, when CmpFiles_CompareFiles starts, are passed to the function first.
+ * 
+ * 	\param	handler			The handler, whose files are to be compared.
+ * 	\param	on_decision		The called function, or NULL, if nothing should be called.
+ * 	\param	context			Passed to on_decision as it is.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, false is returned instead.
+ * */
+bool CmpFiles_SetDecisionCallback(struct FilesToCompare* handler, void (*on_decision)(struct FilesToCompare* handler, size_t file_index, long long offset, void* context), void* context);
+
+/*!
+ * 	\brief	Limits the reading of the files, by waiting for the limits before each read block.
+ * 
+ * 	Blocks in holes of sparse files aren't read, so they aren't limited either.
+ * 
+ * 	\param	handler		The handler, whose files are to be compared.
+ * 	\param	throttle		The limits, which stay owned by the caller (and have to outlive the handler), or NULL, to stop limiting.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, or a memory allocation error, false is returned instead.
+ * */
+bool CmpFiles_SetThrottle(struct FilesToCompare* handler, struct IoThrottle* throttle);
+
+/*!
+ * 	\brief	Schedules the reading of the regular files by the devices, that they are stored on.
+ * 
+ * 	Files, that share a rotational device, are read in long sequential bursts (longer, the more files share the device),
+ * 	so that the disk doesn't seek between the files on every block. Files on different devices are read at the same time,
+ * 	by a reader thread per device.
+ * 
+ * 	\param	handler		The handler, whose files are to be compared.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, a memory allocation error, if it isn't supported (only on Linux),
+ * 				or if the open files or the memory are limited, false is returned instead.
+ * */
+bool CmpFiles_EnableDeviceScheduling(struct FilesToCompare* handler);
+
+/*!
+ * 	\brief	Splits the comparing of each block among several compare threads.
+ * 
+ * 	The blocks of the files, that are still compared, are checked against the first file of their group (or the reference file) at the same time,
+ * 	each thread with its own files and range of the blocks, and the fingerprints of the blocks are calculated by their files.
+ * 	Only the groups, in which a file didn't match, are split afterwards, as without the threads, so the results are the same for any number of threads.
+ * 	Blocks with holes, and blocks, that share a few buffers (when the memory is limited), are still compared by a single thread.
+ * 
+ * 	\param	handler					The handler.
+ * 	\param	number_of_threads		The among of compare threads (at least 2, including the calling thread).
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, a memory allocation error, or if the threads couldn't be started, false is returned instead.
+ * */
+bool CmpFiles_EnableCompareThreads(struct FilesToCompare* handler, size_t number_of_threads);
+
+/*!
+ * 	\brief	Stops the comparing, as soon as a group of at least quorum files was read till its end.
+ * 
+ * 	A file, whose group gets smaller than the quorum, is no longer read (it becomes FILE_ABANDONED), since it can't be in such a group anymore.
+ * 	Once a group reaches the quorum, the files, that are still compared, are abandoned as well.
+ * 
+ * 	\param	handler		The handler, whose files are to be compared.
+ * 	\param	quorum		The among of files, that need to have matched data (at least 2, and at most the number of files), or 0, to compare every file.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, false is returned instead.
+ * */
+bool CmpFiles_SetQuorum(struct FilesToCompare* handler, size_t quorum);
+
+/*!
+ * 	\brief	Continues the comparing from a stored block offset, once the groups, the file states and the mismatch offsets were restored.
+ * 
+ * 	The group sizes are counted again from the group identifiers, and the files, that are still compared, are moved to the block offset.
+ * 	Afterwards, CmpFiles_CompareFiles continues the comparing from there.
+ * 
+ * 	\param	handler			The handler, whose group identifiers, file states and mismatch offsets were restored.
+ * 	\param	block_offset		The offset of the next compared block.
+ * 	\param	block_number		The number of blocks, that were compared till then.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided (like a invalid group identifier, or stdin, which can't be moved), or a IO error happing, false is returned instead.
+ * */
+bool CmpFiles_RestoreProgress(struct FilesToCompare* handler, long long block_offset, size_t block_number);
+
+/*!
+ * 	\brief	Compares the files, whose data has changed, again, after the handler already compared all files.
+ * 
+ * 	Only the changed files, and one file from each group, that they could be matched with, are read again.
+ * 	The open filestreams and buffers of the handler are reused.
+ * 
+ * 	\param	handler				The handler, whose files were already compared.
+ * 	\param	changed_files		Per file: if set, the files data has changed since it was compared.
+ * 
+ * 	\return	If all files have matched data (byte by byte), returns true. 
+ * 				In case of a invalid argument value being provided, a memory allocation error happing, or that one or several files byte data is not matched, false is returned instead.
+ * */
+bool CmpFiles_RecompareFiles(struct FilesToCompare* handler, const bool* changed_files);
+
+/*!
+ * 	\brief	Fills the match states of every file pair, from the groups of the compared files.
+ * 
+ * 	Two files are matched, if they were both read till their end, in the same group.
+ * 	Since this takes 2 bits per file pair, it should only be called, when the results are needed pair by pair.
+ * 
+ * 	\return	If succesfull, returns true. 
+ * 				In case of a invalid argument value being provided, or a memory allocation error happing, false is returned instead.
+ * */
+bool CmpFiles_ResolveCombinations(struct FilesToCompare* handler);
+
 
 
 #endif
@@ -0,0 +1,218 @@
+/*!
+ *	Interface file for the backends, through which the compared files are opened and read,
+ *	so that the comparing doesn't depend on a single way of reading them.
+ *
+ *	\file				cmpio_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPIO_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPIO_HANDLER__
+#define CMPIO_HANDLER__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+
+/*!
+ * Passed as the offset of a read, for reading from the current position of the file (for files, that can't seek).
+ * */
+extern const long long IO_CURRENT_OFFSET;
+
+
+
+/*!
+ * A set of flags, which describe, what a open file supports with its backend.
+ * */
+enum IoCapability
+{
+	/*!
+	 * The file can be read at explicit offsets.
+	 * */
+	IO_SEEKABLE = 1,
+	/*!
+	 * The file can be mapped into the memory (it is a regular file).
+	 * */
+	IO_MAPPABLE = 2,
+	/*!
+	 * The file can be opened for direct IO, bypassing the page cache (only on Linux).
+	 * */
+	IO_DIRECT = 4
+};
+
+/*!
+ * A set of constants for telling the system, how the data of a file will be read.
+ * */
+enum IoAdvice
+{
+	/*!
+	 * The data is read from the start to the end, so it can be read ahead aggressively.
+	 * */
+	IO_ADVICE_SEQUENTIAL,
+	/*!
+	 * The data will be read soon.
+	 * */
+	IO_ADVICE_WILL_NEED,
+	/*!
+	 * The data won't be read again, so it can be dropped from the page cache.
+	 * */
+	IO_ADVICE_DONT_NEED
+};
+
+struct IoFile;
+
+/*!
+ * 	A way of opening and reading files. Every backend implements all of the functions.
+ * */
+struct IoBackend
+{
+	/*!
+	 * The name, that the backend is selected by.
+	 * */
+	const char* _name;
+
+	/*!
+	 * Opens the file at the filepath for reading, and fills in the descriptor and the filestream of the file.
+	 * */
+	bool (*_open)(struct IoFile* file, const char* filepath);
+
+	/*!
+	 * Takes over a already open filestream, and fills in the descriptor of the file.
+	 * */
+	bool (*_adopt)(struct IoFile* file, FILE* filestream);
+
+	/*!
+	 * Reads up to length bytes at the offset (or IO_CURRENT_OFFSET), and returns the among of read bytes (fewer only at the end of the file), or -1 on a IO error.
+	 * */
+	long long (*_read_at)(struct IoFile* file, unsigned char* buffer, size_t length, long long offset);
+
+	/*!
+	 * Stores the size of the file, if it is known in advance.
+	 * */
+	bool (*_size_hint)(struct IoFile* file, long long* file_size);
+
+	/*!
+	 * Tells the system, how a range of the file will be read (a length of 0 means till the end of the file). Only a hint, so it can't fail.
+	 * */
+	void (*_advise)(struct IoFile* file, long long offset, long long length, enum IoAdvice advice);
+
+	/*!
+	 * Closes the file (but never stdin).
+	 * */
+	void (*_close)(struct IoFile* file);
+};
+
+/*!
+ * 	A file, that was opened through a backend.
+ * */
+struct IoFile
+{
+	const struct IoBackend* _backend;
+
+	/*!
+	 * The file descriptor of the file, which the file can be queried through (like with fstat or lseek).
+	 * */
+	int _descriptor;
+
+	/*!
+	 * The filestream of the file, if the backend reads through one, or if it was adopted (and is closed with the file). Otherwise NULL.
+	 * */
+	FILE* _filestream;
+
+	/*!
+	 * The IoCapability flags of the file.
+	 * */
+	unsigned int _capabilities;
+
+	bool _is_stdin;
+
+	/*!
+	 * Where the file was, when it was adopted (stdin can be redirected from the middle of a regular file), so that it is compared from there.
+	 * 0 for the files, that can't seek, and for the opened ones.
+	 * */
+	long long _start_offset;
+};
+
+
+
+/*!
+ *	\brief 	Finds a backend by its name: posix (the default, which reads through read and pread) or stdio (unbuffered filestreams).
+ *
+ * 	\param	name		The name of the backend, or NULL for the default one.
+ *
+ * 	\return	The backend, or NULL, if no backend has the name (or it isn't supported on this system).
+ */
+const struct IoBackend* CmpIo_FindBackend(const char* name);
+
+/*!
+ *	\brief 	Opens a file for reading through a backend, and detects its capabilities.
+ *
+ * 	\param	backend		The backend, or NULL for the default one.
+ * 	\param	filepath		The filepath of the file.
+ *
+ * 	\return	The open file, or NULL, in case of a invalid argument value being provided, a memory allocation error, or the file not being openable.
+ */
+struct IoFile* CmpIo_Open(const struct IoBackend* backend, const char* filepath);
+
+/*!
+ *	\brief 	Takes over a open filestream (like stdin, or a passed file descriptor), so that it is read through a backend.
+ *
+ * 	\param	backend		The backend, or NULL for the default one.
+ * 	\param	filestream	The filestream, which is closed with the file (unless it is stdin). It is also closed, if it can't be taken over.
+ *
+ * 	\return	The open file, or NULL, in case of a invalid argument value being provided, or a memory allocation error happening.
+ */
+struct IoFile* CmpIo_Adopt(const struct IoBackend* backend, FILE* filestream);
+
+/*!
+ *	\brief 	Reads a range of a file into a buffer, retrying short reads till the range is read, or the file ends.
+ *
+ * 	\param	file			The file.
+ * 	\param	buffer		Where the data is read to.
+ * 	\param	length		The among of bytes to read.
+ * 	\param	offset		Where in the file the range starts, or IO_CURRENT_OFFSET for reading from the current position.
+ *
+ * 	\return	The among of read bytes, or -1, if a IO error occured (or the file can't be read at explicit offsets).
+ */
+long long CmpIo_ReadAt(struct IoFile* file, unsigned char* buffer, size_t length, long long offset);
+
+/*!
+ *	\brief 	Fetches the size of a file, but only if it is a regular file (the size of pipes and terminals is not known in advance).
+ *
+ * 	\param	file			The file.
+ * 	\param	file_size	Where the size of the file in bytes is stored.
+ *
+ * 	\return	If the size of the file is known, returns true.
+ */
+bool CmpIo_SizeHint(struct IoFile* file, long long* file_size);
+
+/*!
+ *	\brief 	Tells the system, how a range of a file will be read. It is only a hint, which backends without the support for it ignore.
+ *
+ * 	\param	file			The file.
+ * 	\param	offset		Where the range starts.
+ * 	\param	length		The among of bytes of the range, or 0 for till the end of the file.
+ * 	\param	advice		How the range will be read.
+ */
+void CmpIo_Advise(struct IoFile* file, long long offset, long long length, enum IoAdvice advice);
+
+/*!
+ *	\brief 	Closes a file, and releases its resources.
+ *
+ * 	\param	file			The file, or NULL.
+ */
+void CmpIo_Close(struct IoFile* file);
+
+
+
+#endif
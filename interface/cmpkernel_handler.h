@@ -0,0 +1,132 @@
+/*!
+ *	Interface file, containing the kernels that work on the data blocks of the compared files.
+ *
+ *	\file				cmpkernel_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPKERNEL_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPKERNEL_HANDLER__
+#define CMPKERNEL_HANDLER__
+
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+
+/*!
+ *	\brief 	Calculates a fast, non-cryptographic fingerprint of a data block.
+ *
+ * 	The fingerprint is only a hint: blocks with differing fingerprints have differing data,
+ * 	but blocks with the same fingerprint still need to be compared byte by byte.
+ *
+ *	\param data		The data block.
+ *	\param length	The number of bytes in the data block.
+ *
+ *	\return	The 64-bit fingerprint of the data block.
+ */
+uint64_t CmpKernel_Fingerprint(const unsigned char* data, size_t length);
+
+/*!
+ *	\brief 	Checks, if every byte of a data block is zero.
+ *
+ *	\param data		The data block.
+ *	\param length	The number of bytes in the data block.
+ *
+ *	\return	If all bytes are zero (or the block is empty), returns true.
+ */
+bool CmpKernel_IsZero(const unsigned char* data, size_t length);
+
+/*!
+ *	\brief 	Compares a reference data block with the data blocks of several candidates at once.
+ *
+ * 	The blocks are compared tile by tile, so that each tile of the reference block stays in the cache,
+ * 	while it is compared with the same tile of every candidate, that still matches it.
+ *
+ *	\param reference				The reference data block.
+ *	\param length					The number of bytes in the reference data block, and in each candidate data block.
+ *	\param blocks					The data blocks, from which the candidates are taken.
+ *	\param candidate_indexes	The indexes of the candidates data blocks in blocks.
+ *	\param among					The among of candidates.
+ *	\param matches				Per candidate: where it is stored, if its data block matches the reference data block.
+ *
+ *	\return	The among of candidates, whose data blocks match the reference data block.
+ */
+size_t CmpKernel_MatchReference(const unsigned char* reference, size_t length, unsigned char* const* blocks, const size_t* candidate_indexes, size_t among, bool* matches);
+
+/*!
+ *	\brief 	Finds the first byte, in which two data blocks differ.
+ *
+ *	\param first		The first data block.
+ *	\param second	The second data block.
+ *	\param length	The number of bytes in each data block.
+ *
+ *	\return	The offset of the first differing byte, or length, if the data blocks match.
+ */
+size_t CmpKernel_FindDifference(const unsigned char* first, const unsigned char* second, size_t length);
+
+/*!
+ *	\brief 	Splits the data blocks of several classes into classes of matching data blocks, all at once.
+ *
+ * 	The blocks are walked tile by tile, and each tile of every member is compared with the same tile of the representative of its class,
+ * 	before moving on, so that the tiles of the representatives stay in the cache, and each byte is loaded from the memory about once.
+ * 	A member, that differs from its representative, is compared with the representatives, that were split off from it in the same tile,
+ * 	and if none matches, it becomes the representative of a new class.
+ * 	Each class ends up with its first member (in the order of the members) as its representative.
+ *
+ *	\param blocks							The data blocks, indexed by the members.
+ *	\param lengths						The number of bytes in each data block, indexed by the members.
+ *	\param members						The indexes of the members, in a ascending order.
+ *	\param among							The among of members.
+ *	\param representatives			Per member: the representative of its class, which is the first member of the class,
+ *												and its own representative. Updated to the representatives of the new classes.
+ *	\param difference_offsets		Per member: where the offset of its first byte, that differs from the representative, that it started with, is stored
+ *												(only meaningful for the new representatives), the same as comparing it with that representative alone would find.
+ *	\param scratch						Room for 3 indexes per member, used while splitting.
+ *
+ *	\return	The among of new classes.
+ */
+size_t CmpKernel_SplitClasses(unsigned char* const* blocks, const size_t* lengths, const size_t* members, size_t among, 
+												size_t* representatives, size_t* difference_offsets, size_t* scratch);
+
+/*!
+ *	\brief 	Votes on each byte of several data blocks, and writes the byte, that enough of them have, into the output.
+ *
+ * 	The blocks are voted on a word at a time, and only the words, that don't get enough votes as a whole, are voted on byte by byte.
+ * 	A byte without enough votes gets the value, that the most blocks have (the one of the earliest of them, if several values have as many).
+ *
+ *	\param blocks				The data blocks, each of which is a vote.
+ *	\param among				The among of data blocks.
+ *	\param length				The number of bytes in each data block, and in the output.
+ *	\param needed_votes		The among of data blocks, that need to have the same byte, for the byte to be decided.
+ *	\param output				Where the voted bytes are written to.
+ *	\param undecided			Per byte: where it is stored, if the byte didn't get enough votes.
+ *
+ *	\return	The among of undecided bytes.
+ */
+size_t CmpKernel_VoteMajority(const unsigned char* const* blocks, size_t among, size_t length, size_t needed_votes, unsigned char* output, bool* undecided);
+
+/*!
+ *	\brief 	Counts the bytes, and optionally the bits, in which two data blocks differ.
+ *
+ *	\param first					The first data block.
+ *	\param second				The second data block.
+ *	\param length				The number of bytes in each data block.
+ *	\param differing_bits		Where the among of differing bits is added to, or NULL, if the bits aren't counted.
+ *
+ *	\return	The among of differing bytes.
+ */
+size_t CmpKernel_CountDifferences(const unsigned char* first, const unsigned char* second, size_t length, unsigned long long* differing_bits);
+
+
+
+#endif
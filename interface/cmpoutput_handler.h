@@ -0,0 +1,165 @@
+/*!
+ *	Interface file for showing the results of the file comparing,
+ *	either as groups of matched files, or pair by pair.
+ *
+ *	\file				cmpoutput_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPOUTPUT_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPOUTPUT_HANDLER__
+#define CMPOUTPUT_HANDLER__
+
+
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "cmpfiles_handler.h"
+
+
+
+/*!
+ * A set of constants for defining the among and
+ * type of output, shown on the terminal.
+ * */
+enum OutputLevel
+{
+	/*!
+	 * Shows everything on the terminal.
+	 * */
+	SHOW_ALL,
+	/*!
+	 * Show only the files, that have matched data.
+	 * */
+	SHOW_ONLY_MATCHED
+};
+
+/*!
+ * A set of constants for defining the format,
+ * in which the results are written.
+ * */
+enum OutputFormat
+{
+	/*!
+	 * Human-readable text.
+	 * */
+	OUTPUT_TEXT,
+	/*!
+	 * A single compact JSON object.
+	 * */
+	OUTPUT_JSON,
+	/*!
+	 * Comma-separated values, with a header line.
+	 * */
+	OUTPUT_CSV
+};
+
+/*!
+ * The files, with their groups and states, as they are shown.
+ * */
+struct GroupListing
+{
+	size_t _number_of_files;
+	char** _filepaths;
+	/*!
+	 * Per file: the identifier of its group (smaller than the number of files).
+	 * */
+	size_t* _group_ids;
+	/*!
+	 * Per group identifier: the among of files in the group.
+	 * */
+	size_t* _group_sizes;
+	enum FileState* _file_states;
+	/*!
+	 * The among of files, that needed to be matched, or 0, if every file was compared.
+	 * With a quorum, the files outside of the group, that reached it, are shown as outliers.
+	 * */
+	size_t _quorum;
+};
+
+
+
+/*!
+ *	\brief 	Writes a string as a JSON string, with the needed characters escaped.
+ *
+ * 	\param	output		Where the string is written to.
+ * 	\param	text			The written string.
+ */
+void CmpOutput_WriteJsonString(FILE* output, const char* text);
+
+/*!
+ *	\brief 	Writes a string as a CSV field, which is only quoted, if it contains a comma, a quote or a line break.
+ *
+ * 	\param	output		Where the field is written to.
+ * 	\param	text			The written string.
+ */
+void CmpOutput_WriteCsvField(FILE* output, const char* text);
+
+/*!
+ *	\brief 	Writes the groups of files with matched data, and the files that didn't match any other.
+ *
+ * 	\param	output				Where the results are written to.
+ * 	\param	handler				The handler, whose files were already compared.
+ * 	\param	output_format	In which format the results are written.
+ * 	\param	output_level		Which results are written.
+ *
+ * 	\return	If succesfull, returns true.
+ * 				In case of a invalid argument value being provided, a memory allocation error or a IO error happing, false is returned instead.
+ */
+bool CmpOutput_ShowGroups(FILE* output, struct FilesToCompare* handler, enum OutputFormat output_format, enum OutputLevel output_level);
+
+/*!
+ *	\brief 	Writes the groups of files with matched data, and the files that didn't match any other, of a listing
+ * 			(like the merged results of several shards), in the same way as CmpOutput_ShowGroups does.
+ *
+ * 	\param	output				Where the results are written to.
+ * 	\param	listing				The files, with their groups and states.
+ * 	\param	output_format	In which format the results are written.
+ * 	\param	output_level		Which results are written.
+ *
+ * 	\return	If succesfull, returns true.
+ * 				In case of a invalid argument value being provided, a memory allocation error or a IO error happing, false is returned instead.
+ */
+bool CmpOutput_ShowListing(FILE* output, const struct GroupListing* listing, enum OutputFormat output_format, enum OutputLevel output_level);
+
+/*!
+ *	\brief 	Writes the match state of every file pair.
+ *
+ * 	The match states need to be resolved beforehand, with CmpFiles_ResolveCombinations.
+ *
+ * 	\param	output				Where the results are written to.
+ * 	\param	handler				The handler, whose files were already compared.
+ * 	\param	output_format	In which format the results are written.
+ * 	\param	output_level		Which results are written.
+ *
+ * 	\return	If succesfull, returns true.
+ * 				In case of a invalid argument value being provided, or a IO error happing, false is returned instead.
+ */
+bool CmpOutput_ShowCombinations(FILE* output, struct FilesToCompare* handler, enum OutputFormat output_format, enum OutputLevel output_level);
+
+/*!
+ *	\brief 	Writes a decision about a file (see CmpFiles_SetDecisionCallback) as a single line with a JSON object, and flushes it right away.
+ *
+ * 	The decision is "mismatch" (the file stopped matching some of the files of its group), "matched" (with the identifier and the size of its group,
+ * 	which is the same for every file, that it matched), "not_matched" or "failed".
+ *
+ * 	\param	output				Where the decision is written to.
+ * 	\param	handler				The handler, whose files are being compared.
+ * 	\param	file_index		The index of the file, that the decision is about.
+ * 	\param	offset				The offset, at which the decision was made.
+ * 	\param	elapsed_time		The seconds since the comparing started.
+ *
+ * 	\return	If succesfull, returns true.
+ * 				In case of a invalid argument value being provided, or a IO error happing, false is returned instead.
+ */
+bool CmpOutput_WriteDecision(FILE* output, struct FilesToCompare* handler, size_t file_index, long long offset, double elapsed_time);
+
+
+
+#endif
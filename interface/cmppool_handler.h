@@ -0,0 +1,79 @@
+/*!
+ *	Interface file for a pool of compare threads, that split the comparing of a block into disjoint parts,
+ *	and work on them at the same time.
+ *
+ *	\file				cmppool_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPPOOL_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPPOOL_HANDLER__
+#define CMPPOOL_HANDLER__
+
+
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+
+/*!
+ * 	The compare threads, and the work, that they were handed.
+ * 	Its content is only accessed through the functions below.
+ * */
+struct ComparePool;
+
+
+
+/*!
+ *	\brief 	Starts the compare threads.
+ *
+ * 	The calling thread is one of the compare threads, so one thread less is started.
+ *
+ * 	\param	number_of_threads		The among of compare threads (at least 2).
+ *
+ *	\return	If succesfull, returns the pool.
+ * 				In case of a invalid argument value being provided, a memory allocation error, or if the threads couldn't be started (they aren't supported on Windows),
+ * 				NULL is returned instead.
+ */
+struct ComparePool* CmpPool_Initialize(size_t number_of_threads);
+
+/*!
+ *	\brief 	Stops the compare threads, and free's the allocated resources of the pool.
+ *
+ *	\param pool		The pool to free.
+ */
+void CmpPool_Terminate(struct ComparePool* pool);
+
+/*!
+ *	\brief 	Fetches the among of compare threads (including the calling thread).
+ *
+ *	\param pool		The pool, or NULL.
+ *
+ *	\return	The among of compare threads, or 1, if the pool is NULL.
+ */
+size_t CmpPool_GetThreads(const struct ComparePool* pool);
+
+/*!
+ *	\brief 	Splits the work items into a contiguous range per compare thread, and returns once all of them were handled.
+ *
+ * 	The ranges only depend on the among of items and threads, and the calling thread handles the first one.
+ * 	If the pool is NULL, or there is only a single item, the calling thread handles all of them.
+ *
+ *	\param pool				The pool, or NULL.
+ *	\param task				Handles the items from first_item (including) to last_item (excluding). Each item has to be handled on its own
+ * 								(writing only its own results), so that the results don't depend on which thread handled it.
+ *	\param context			Passed to the task as it is.
+ *	\param among_of_items	The among of work items.
+ */
+void CmpPool_Run(struct ComparePool* pool, void (*task)(void* context, size_t first_item, size_t last_item), void* context, size_t among_of_items);
+
+
+
+#endif
@@ -0,0 +1,56 @@
+/*!
+ *	Interface file for repairing damaged replicas of the same file, by reconstructing a copy,
+ *	in which each byte has the value, that the majority of the replicas has.
+ *
+ *	\file				cmprepair_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPREPAIR_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPREPAIR_HANDLER__
+#define CMPREPAIR_HANDLER__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "cmpio_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmpthrottle_handler.h"
+
+
+
+/*!
+ *	\brief 	Reads all replicas block by block in a single pass, and writes a repaired file, in which each byte has the value of the majority of the replicas.
+ *
+ * 	A byte is decided, if more than half of all replicas have the same value in it (a replica, that already ended, votes against every value).
+ * 	The repaired file is as long as more than half of the replicas are, and each of its blocks is written with a single unbuffered write.
+ * 	Every region of bytes without a clear majority is written into the results, and gets the value, that the most replicas have.
+ * 	Unlike the comparing, every replica is read till its end, even after it stopped matching all of the others.
+ *
+ * 	\param	output					Where the results are written to.
+ * 	\param	repaired_path			The filepath of the repaired file, which is replaced, if it exists (but can't be one of the replicas).
+ * 	\param	filepaths				The filepaths of the replicas (one of them can be stdin).
+ * 	\param	number_of_files		The number of replicas (at least 3).
+ * 	\param	compare_buffer_size	The size of the block, that is read from each replica at a time.
+ * 	\param	io_backend				The backend, through which the replicas are opened and read, or NULL for the default one.
+ * 	\param	throttle					The limits of the reading, or NULL.
+ * 	\param	output_format			In which format the results are written.
+ * 	\param	all_decided				Where it is stored, if every byte had a clear majority.
+ *
+ * 	\return	If the repaired file and the results were written, returns true.
+ * 				In case of a invalid argument value being provided, a replica, that couldn't be opened, a memory allocation error or a IO error happing, false is returned instead.
+ */
+bool CmpRepair_RepairFiles(FILE* output, const char* repaired_path, char** filepaths, size_t number_of_files, size_t compare_buffer_size,
+										const struct IoBackend* io_backend, struct IoThrottle* throttle, enum OutputFormat output_format, bool* all_decided);
+
+
+
+#endif
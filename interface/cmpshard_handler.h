@@ -0,0 +1,107 @@
+/*!
+ *	Interface file for splitting a large comparing job deterministically among several independent processes (shards),
+ *	and for merging their partial results into the final groups.
+ *
+ *	\file				cmpshard_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPSHARD_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPSHARD_HANDLER__
+#define CMPSHARD_HANDLER__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "cmpfiles_handler.h"
+#include "cmpoutput_handler.h"
+
+
+
+/*!
+ *	\brief 	Reads a list of filepaths, one per line (empty lines and the carriage returns at the line ends are skipped).
+ *
+ * 	\param	list_path				The filepath of the list, or STDIN_FILEPATH_MARK to read it from stdin.
+ * 	\param	number_of_files		Where the among of the listed filepaths is stored.
+ *
+ * 	\return	The listed filepaths, which are freed together with a single call to free.
+ * 				In case of a invalid argument value being provided, a list, that couldn't be read, a empty list or a memory allocation error happing, NULL is returned instead.
+ */
+char** CmpShard_ReadFileList(const char* list_path, size_t* number_of_files);
+
+/*!
+ *	\brief 	Parses a shard, written as INDEX/COUNT (with the index from 1 to the count).
+ *
+ * 	\param	text				The written shard.
+ * 	\param	shard_index		Where the index of the shard is stored (from 0 on).
+ * 	\param	shard_count		Where the among of all shards is stored.
+ *
+ * 	\return	If the shard is valid, returns true.
+ */
+bool CmpShard_ParseShard(const char* text, size_t* shard_index, size_t* shard_count);
+
+/*!
+ *	\brief 	Selects the files of a shard, by the sizes of the files.
+ *
+ * 	Files can only match, if they have the same size, so all files of the same size are put into the same shard,
+ * 	which is chosen by a hash of their size. Every process, that is given the same list, selects the same files for a shard,
+ * 	without any coordination among them. Only regular files can be sharded, since the size of other files isn't known up front.
+ *
+ * 	\param	filepaths				The filepaths of all files of the job.
+ * 	\param	number_of_files		The number of all files.
+ * 	\param	shard_index			The index of the shard (from 0 on).
+ * 	\param	shard_count			The among of all shards.
+ * 	\param	selected_indexes		Where the indexes of the files of the shard are stored, in the order of the list (at least number_of_files of them).
+ * 	\param	number_of_selected	Where the among of the selected files is stored.
+ *
+ * 	\return	If the size of every file was found, returns true.
+ * 				In case of a invalid argument value being provided, or a file, that isn't a regular file (or doesn't exist), false is returned instead.
+ */
+bool CmpShard_SelectFiles(char** filepaths, size_t number_of_files, size_t shard_index, size_t shard_count, size_t* selected_indexes, size_t* number_of_selected);
+
+/*!
+ *	\brief 	Writes the partial results of a shard, whose files were compared by the handler, replacing the previous ones atomically.
+ *
+ * 	Each file is written with its index in the list, its state, and the index in the list of the first file of its group,
+ * 	so that the merged results show the groups in the same order, as a single process comparing the whole list would.
+ *
+ * 	\param	partial_path				Where the partial results are written to.
+ * 	\param	handler						The handler, whose files were compared, or NULL, if the shard has no files.
+ * 	\param	selected_indexes			Per file of the handler: its index in the list.
+ * 	\param	number_of_listed_files	The number of all files of the job.
+ * 	\param	shard_index				The index of the shard (from 0 on).
+ * 	\param	shard_count				The among of all shards.
+ *
+ * 	\return	If the partial results were written, returns true.
+ * 				In case of a invalid argument value being provided, a memory allocation error or a IO error happing, false is returned instead.
+ */
+bool CmpShard_WritePartial(const char* partial_path, struct FilesToCompare* handler, const size_t* selected_indexes, size_t number_of_listed_files, size_t shard_index, size_t shard_count);
+
+/*!
+ *	\brief 	Merges the partial results of all shards of a job, and writes the final groups.
+ *
+ * 	Every shard needs to be given exactly once, and all of them need to come from the same list.
+ *
+ * 	\param	output					Where the results are written to.
+ * 	\param	partial_paths			The filepaths of the partial results (in any order).
+ * 	\param	number_of_partials	The number of partial results.
+ * 	\param	output_format			In which format the results are written.
+ * 	\param	output_level				Which results are written.
+ * 	\param	all_matched			Where it is stored, if all files of the job matched.
+ *
+ * 	\return	If the partial results were merged and written, returns true.
+ * 				In case of a invalid argument value being provided, a malformed or missing shard, a memory allocation error or a IO error happing, false is returned instead.
+ */
+bool CmpShard_MergePartials(FILE* output, char** partial_paths, size_t number_of_partials, enum OutputFormat output_format, enum OutputLevel output_level, bool* all_matched);
+
+
+
+#endif
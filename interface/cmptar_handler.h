@@ -0,0 +1,113 @@
+/*!
+ *	Interface file for comparing the members of tar archives (and the files of unpacked trees) with each other,
+ *	directly from their byte ranges inside the archives, without extracting them.
+ *
+ *	\file				cmptar_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPTAR_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPTAR_HANDLER__
+#define CMPTAR_HANDLER__
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "cmpoutput_handler.h"
+#include "cmpthrottle_handler.h"
+
+
+
+/*!
+ * 	A regular file inside a tar archive, or inside a unpacked tree.
+ * */
+struct TarMember
+{
+	/*!
+	 * The path of the member, relative to the root of the archive or tree (without a leading "./" or "/").
+	 * */
+	char* _path;
+	/*!
+	 * Where the data of the member starts inside the archive (always 0 for the files of a tree).
+	 * */
+	long long _data_offset;
+	/*!
+	 * The among of bytes of the data of the member.
+	 * */
+	long long _size;
+};
+
+/*!
+ * 	The regular files of a tar archive or a unpacked tree, sorted by their paths.
+ * */
+struct MemberList
+{
+	/*!
+	 * The filepath of the archive, or of the root directory of the tree.
+	 * */
+	char* _input_path;
+	bool _is_directory;
+
+	struct TarMember* _members;
+	size_t _among_of_members;
+	/*!
+	 * The among of members, that the array has room for.
+	 * */
+	size_t _capacity;
+};
+
+
+
+/*!
+ *	\brief 	Lists the regular files of a tar archive (if the input is a file) or of a unpacked tree (if it is a directory).
+ *
+ * 	Only the headers of a archive are read, its data is skipped. The ustar, GNU (long names and base-256 sizes) and pax (path and size records) headers are supported.
+ * 	If a archive contains the same path several times, the last member wins (as when it is extracted).
+ * 	Other types of members (like directories, links and sparse files) are skipped, and so are symbolic links of a tree.
+ *
+ * 	\param	input_path		The filepath of the archive, or of the root directory of the tree.
+ *
+ * 	\return	The listed members, or NULL, in case of a invalid argument value being provided,
+ * 				a file, that isn't a (seekable) tar archive, a memory allocation error or a IO error happing.
+ */
+struct MemberList* CmpTar_ListMembers(const char* input_path);
+
+/*!
+ *	\brief 	Releases the resources of a member list.
+ *
+ * 	\param	member_list		The released list, or NULL.
+ */
+void CmpTar_Terminate(struct MemberList* member_list);
+
+/*!
+ *	\brief 	Matches the members of the inputs by their paths, compares the data of each member across the inputs, and writes the results per member.
+ *
+ * 	The data of each member is read once, at its byte range inside its archive, as a region of the archive (like with CmpFiles_SetRegions).
+ * 	A member is matched, if it is present in all inputs, and its data is the same in all of them.
+ *
+ * 	\param	output					Where the results are written to.
+ * 	\param	input_paths			The filepaths of the archives and the root directories of the trees.
+ * 	\param	number_of_inputs	The number of inputs (at least 2).
+ * 	\param	compare_buffer_size	The size of the buffer of each input.
+ * 	\param	throttle				The limits of the reading, or NULL.
+ * 	\param	output_format		In which format the results are written.
+ * 	\param	output_level			Which results are written.
+ * 	\param	all_matched			Where it is stored, if all members were matched.
+ *
+ * 	\return	If the members were compared and the results written, returns true.
+ * 				In case of a invalid argument value being provided, a input, that couldn't be listed, a memory allocation error or a IO error happing, false is returned instead.
+ */
+bool CmpTar_CompareMembers(FILE* output, char** input_paths, size_t number_of_inputs, size_t compare_buffer_size, struct IoThrottle* throttle,
+											enum OutputFormat output_format, enum OutputLevel output_level, bool* all_matched);
+
+
+
+#endif
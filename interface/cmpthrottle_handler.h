@@ -0,0 +1,106 @@
+/*!
+ *	Interface file for limiting the bandwidth and the IO operations of the file reading,
+ *	so that the comparing can run next to other traffic on the same devices.
+ *
+ *	\file				cmpthrottle_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPTHROTTLE_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPTHROTTLE_HANDLER__
+#define CMPTHROTTLE_HANDLER__
+
+
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+
+/*!
+ * 	The limits of the reading, shared by every handler (and thread) that it is passed to.
+ * 	Its content is only accessed through the functions below.
+ * */
+struct IoThrottle;
+
+
+
+/*!
+ *	\brief 	Checks, if the limiting of the reading is supported on this system.
+ *
+ *	\return	If it is supported (only on Linux), returns true.
+ */
+bool CmpThrottle_IsSupported(void);
+
+/*!
+ *	\brief 	Parses a number of bytes or operations per second, with a optional K, M or G suffix (powers of 1024).
+ *
+ * 	\param	text		The text to parse.
+ * 	\param	rate		Where the parsed number is stored.
+ *
+ *	\return	If the text is a positive whole number (with a valid suffix), returns true.
+ */
+bool CmpThrottle_ParseRate(const char* text, unsigned long long* rate);
+
+/*!
+ *	\brief 	Allocates the limits, with the given limits for all devices together.
+ *
+ * 	\param	bytes_per_second			The bandwidth of all reads together, or 0 for no limit.
+ * 	\param	operations_per_second	The among of reads per second, or 0 for no limit.
+ *
+ *	\return	If succesfull, returns the allocated limits.
+ * 				In case of a memory allocation error, or if limiting isn't supported, NULL is returned instead.
+ */
+struct IoThrottle* CmpThrottle_Initialize(unsigned long long bytes_per_second, unsigned long long operations_per_second);
+
+/*!
+ *	\brief 	Free's the allocated resources of the limits.
+ *
+ *	\param throttle		The limits to free.
+ */
+void CmpThrottle_Terminate(struct IoThrottle* throttle);
+
+/*!
+ *	\brief 	Sets the limits from a control file, and loads it again each time the process receives SIGHUP.
+ *
+ * 	Each line of the control file is empty, a comment (starting with #), or one of:
+ * 	"bandwidth <rate>", "iops <rate>" (the limits of all devices together, overriding the ones of CmpThrottle_Initialize),
+ * 	and "device <path> [bandwidth <rate>] [iops <rate>]" (the limits of the device of a block device, or of any file on it, whose path has no spaces).
+ * 	A control file, that can't be loaded again, leaves the previous limits in place.
+ *
+ * 	\param	throttle			The limits.
+ * 	\param	control_path		The filepath of the control file.
+ *
+ *	\return	If the control file was loaded, returns true.
+ * 				In case of a invalid argument value being provided, a malformed control file or a memory allocation error, false is returned instead.
+ */
+bool CmpThrottle_UseControlFile(struct IoThrottle* throttle, const char* control_path);
+
+/*!
+ *	\brief 	Waits, until a read of the given size from the given device is within the limits.
+ *
+ * 	\param	throttle		The limits, or NULL for no limits.
+ * 	\param	device			The device (st_dev), that is read from.
+ * 	\param	among_bytes	The size of the read.
+ */
+void CmpThrottle_Acquire(struct IoThrottle* throttle, unsigned long long device, size_t among_bytes);
+
+/*!
+ *	\brief 	Sets the IO scheduling class and priority of the calling thread, and of the threads it creates afterwards.
+ *
+ * 	\param	priority		"idle", or "best-effort" or "realtime", with a optional ":<level>" from 0 (the highest) to 7 (4 by default).
+ *
+ *	\return	If succesfull, returns true.
+ * 				In case of a invalid argument value being provided, or if the priority couldn't be set (realtime needs privileges), false is returned instead.
+ */
+bool CmpThrottle_SetIoPriority(const char* priority);
+
+
+
+#endif
@@ -0,0 +1,86 @@
+/*!
+ *	Interface file for recording a timeline of the opening, reading and comparing of the files,
+ *	and writing it as a Chrome trace (which Perfetto and chrome://tracing can open).
+ *
+ *	\file				cmptrace_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPTRACE_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPTRACE_HANDLER__
+#define CMPTRACE_HANDLER__
+
+
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+
+/*!
+ * The default among of events, that each thread keeps. Once a thread has recorded more, its oldest events are overwritten.
+ * */
+extern const size_t DEFAULT_TRACE_EVENTS;
+
+
+
+/*!
+ *	\brief 	Starts recording events. Each thread records into its own ring buffer, without any locking.
+ *
+ * 	\param	events_per_thread		The among of events, that each thread keeps.
+ *
+ *	\return	If the recording was started, returns true.
+ * 				In case of a invalid argument value being provided, or if tracing isn't supported (only on Linux), false is returned instead.
+ */
+bool CmpTrace_Start(size_t events_per_thread);
+
+/*!
+ *	\brief 	Starts a span.
+ *
+ *	\return	The current time in nanoseconds, or -1, if nothing is recorded.
+ */
+long long CmpTrace_Begin(void);
+
+/*!
+ *	\brief 	Ends a span, that was started by CmpTrace_Begin, and records it.
+ *
+ * 	\param	name				The name of the span (has to stay valid, until the trace is written, like a string literal).
+ * 	\param	category			The category of the span (the same as for the name applies).
+ * 	\param	begin_time		What CmpTrace_Begin returned. Nothing is recorded, if it is negative.
+ * 	\param	file_index		The index of the file, that the span belongs to, or -1.
+ * 	\param	block_offset		The offset of the block, that the span belongs to, or -1.
+ * 	\param	detail				Additional text (like a filepath), or NULL (the same as for the name applies).
+ */
+void CmpTrace_End(const char* name, const char* category, long long begin_time, long long file_index, long long block_offset, const char* detail);
+
+/*!
+ *	\brief 	Records a single point in time, like a decision, that was made.
+ *
+ * 	\param	name				The name of the event (has to stay valid, until the trace is written, like a string literal).
+ * 	\param	category			The category of the event (the same as for the name applies).
+ * 	\param	file_index		The index of the file, that the event belongs to, or -1.
+ * 	\param	block_offset		The offset of the block, that the event belongs to, or -1.
+ */
+void CmpTrace_Mark(const char* name, const char* category, long long file_index, long long block_offset);
+
+/*!
+ *	\brief 	Stops the recording, writes the recorded events of all threads in the Chrome trace event format, and free's them.
+ *
+ * 	Has to be called, once no other thread records any events.
+ *
+ * 	\param	trace_path		The filepath of the written trace.
+ *
+ *	\return	If the trace was written, returns true.
+ * 				In case of a invalid argument value being provided, if nothing was recorded, or a IO error, false is returned instead.
+ */
+bool CmpTrace_Finish(const char* trace_path);
+
+
+
+#endif
@@ -0,0 +1,60 @@
+/*!
+ *	Interface file for watching the compared files for changes,
+ *	and comparing them again as soon as they change.
+ *
+ *	\file				cmpwatch_handler.h
+ *	\author 		Žan Šadl-Ferš
+ *	\version   	1.0-stable
+ *	\date			2021
+ *	\copyright	MIT
+ * */
+
+
+/*!
+ * \def	CMPWATCH_HANDLER__		Used to prevent including this more then one time.
+ * */
+#ifndef CMPWATCH_HANDLER__
+#define CMPWATCH_HANDLER__
+
+
+
+#include <stdbool.h>
+#include "cmpfiles_handler.h"
+
+
+
+/*!
+ * The default number of milliseconds, that need to pass without any new change,
+ * before the changed files are compared again.
+ * */
+extern const unsigned int DEFAULT_WATCH_DELAY;
+
+
+
+/*!
+ *	\brief 	Checks, if watching files for changes is supported on this system.
+ *
+ *	\return	If it is supported (only on Linux, with inotify), returns true.
+ */
+bool CmpWatch_IsSupported(void);
+
+/*!
+ *	\brief 	Watches the files of the handler for changes, and compares the changed ones again, until the process receives SIGINT or SIGTERM.
+ *
+ * 	Bursts of changes are merged together: the files are compared again, once no new change happened for delay_milliseconds,
+ * 	but never later than 4 times that delay after the first change of the burst.
+ * 	Files that are replaced or moved are reopened by their filepath.
+ *
+ * 	\param	handler					The handler, whose files were already compared.
+ * 	\param	delay_milliseconds	How long to wait for further changes, before comparing the files again.
+ * 	\param	on_recompared			Called after each time the files were compared again, with the result of CmpFiles_RecompareFiles.
+ * 	\param	context					Passed to on_recompared as it is.
+ *
+ * 	\return	If the watching was stopped by a signal, returns true.
+ * 				In case of a invalid argument value being provided (like stdin, which can't be watched), or a error while watching, false is returned instead.
+ */
+bool CmpWatch_WatchFiles(struct FilesToCompare* handler, unsigned int delay_milliseconds, void (*on_recompared)(struct FilesToCompare* handler, bool all_matched, void* context), void* context);
+
+
+
+#endif
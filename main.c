@@ -8,18 +8,39 @@
 	Implements main.h, and executes the programs main logic.
 */
 
+#define _GNU_SOURCE	//	For clock_gettime.
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
 
 #include "cmpfiles_handler.h"
+#include "cmpoutput_handler.h"
+#include "cmpwatch_handler.h"
+#include "cmpdaemon_handler.h"
+#include "cmpcheckpoint_handler.h"
+#include "cmpthrottle_handler.h"
+#include "cmptrace_handler.h"
+#include "cmptar_handler.h"
+#include "cmpdigest_handler.h"
+#include "cmprepair_handler.h"
+#include "cmpdamage_handler.h"
+#include "cmpshard_handler.h"
 #include "main.h"
 
 
 const size_t DEFAULT_BUFFER_SIZE = 16384;
 const int INDEX_NOT_SELECTED = -1;
+const size_t RESERVED_FILE_DESCRIPTORS = 64;
+const char* STDOUT_FILEPATH_MARK = "stdout";
 
 /*	Static functions, exclusive to the main.c source file.*/
 
@@ -103,6 +124,345 @@ static int Main_ShowMessage(const char* type, const char* short_argument, const
 
 
 
+static bool Main_ParseCount(const char* text, unsigned long maximum, size_t* count)
+{
+	/*!
+	 * \brief	Parses the value of a argument, that has to be a positive whole number.
+	 * 
+	 * \param	text			The value of the argument.
+	 * \param	maximum		The biggest allowed number.
+	 * \param	count			Where the parsed number is stored.
+	 * 
+	 * \return	If the value is a number between 1 and maximum, returns true.
+	 * */
+	
+	char* value_end;
+	unsigned long parsed_count = strtoul(text, &value_end, 10);
+	
+	if (*value_end != '\0' || value_end == text || text[0] == '-' || parsed_count == 0 || parsed_count > maximum)
+	{
+		return false;
+	}
+	
+	*count = (size_t)parsed_count;
+	return true;
+}
+
+
+
+static bool Main_ParseRegions(const char* text, size_t number_of_files, long long* region_offsets, long long* region_lengths)
+{
+	/*!
+	 * \brief	Parses the value of -rg: a OFFSET[:LENGTH] entry per file (in the order of the files), separated by commas.
+	 * 			A single entry is used for every file.
+	 * 
+	 * \param	text					The value of the argument.
+	 * \param	number_of_files		The among of compared files.
+	 * \param	region_offsets		Where the offset of each region is stored.
+	 * \param	region_lengths		Where the length of each region is stored (-1, if it has none).
+	 * 
+	 * \return	If every entry is valid (with a length bigger than 0), and there is either one entry, or one per file, returns true.
+	 * */
+	
+	size_t among_of_entries = 0;
+	const char* at_text = text;
+	
+	while (true)
+	{
+		char* value_end;
+		long long region_offset, region_length = -1;
+		
+		if (*at_text < '0' || *at_text > '9') return false;
+		
+		region_offset = strtoll(at_text, &value_end, 10);
+		if (region_offset == LLONG_MAX) return false;
+		
+		if (*value_end == ':')
+		{
+			at_text = value_end + 1;
+			if (*at_text < '0' || *at_text > '9') return false;
+			
+			region_length = strtoll(at_text, &value_end, 10);
+			if (region_length == 0 || region_length == LLONG_MAX) return false;
+		}
+		
+		if (among_of_entries >= number_of_files) return false;
+		
+		region_offsets[among_of_entries] = region_offset;
+		region_lengths[among_of_entries] = region_length;
+		among_of_entries += 1;
+		
+		if (*value_end == '\0') break;
+		else if (*value_end != ',') return false;
+		
+		at_text = value_end + 1;
+	}
+	
+	if (among_of_entries == 1)
+	{
+		for (size_t at_index = 1; at_index < number_of_files; at_index += 1)
+		{
+			region_offsets[at_index] = region_offsets[0];
+			region_lengths[at_index] = region_lengths[0];
+		}
+		
+		return true;
+	}
+	
+	return among_of_entries == number_of_files;
+}
+
+
+
+/*!
+ * 	The options, that decide how the results are shown,
+ * 	and the last shown result.
+ * */
+struct ShownResults
+{
+	enum OutputFormat _output_format;
+	enum OutputLevel _output_level;
+	bool _show_combinations;
+	/*!
+	 * If all files had matched data, the last time they were compared.
+	 * */
+	bool _all_matched;
+};
+
+static bool Main_ShowResults(struct FilesToCompare* handler, bool all_matched, const struct ShownResults* shown_results)
+{
+	/*!
+	 * \brief	Shows the results of the file comparing on the terminal.
+	 * 
+	 * \param	handler				The handler, whose files were compared.
+	 * \param	all_matched			If all files had matched data.
+	 * \param	shown_results		In which format and detail the results are shown.
+	 * 
+	 * \return	If the results were shown, returns true.
+	 * */
+	
+	bool results_were_shown;
+	
+	if (all_matched && shown_results->_output_format == OUTPUT_TEXT)
+	{
+		results_were_shown = CmpOutput_ShowGroups(stdout, handler, shown_results->_output_format, shown_results->_output_level);
+	}
+	else if (shown_results->_show_combinations)
+	{
+		results_were_shown = CmpFiles_ResolveCombinations(handler) && CmpOutput_ShowCombinations(stdout, handler, shown_results->_output_format, shown_results->_output_level);
+	}
+	else
+	{
+		results_were_shown = CmpOutput_ShowGroups(stdout, handler, shown_results->_output_format, shown_results->_output_level);
+	}
+	
+	if (!results_were_shown)
+	{
+		Main_ShowMessage("Error", NULL, NULL, "Couldn't show the results of the file comparing!");
+	}
+	
+	fflush(stdout);
+	
+	return results_were_shown;
+}
+
+static void Main_ShowRecomparedResults(struct FilesToCompare* handler, bool all_matched, void* context)
+{
+	/*!
+	 * \brief	Shows the results, each time the watched files were compared again.
+	 * 
+	 * \param	handler		The handler, whose files were compared again.
+	 * \param	all_matched	If all files had matched data.
+	 * \param	context		The options, that decide how the results are shown.
+	 * */
+	
+	struct ShownResults* shown_results = context;
+	shown_results->_all_matched = all_matched;
+	
+	if (shown_results->_output_format == OUTPUT_TEXT)
+	{
+		puts("\nThe files have changed, and were compared again:");
+	}
+	
+	Main_ShowResults(handler, all_matched, shown_results);
+}
+
+
+
+static void Main_WriteCheckpoint(struct FilesToCompare* handler, void* context)
+{
+	/*!
+	 * \brief	Writes a checkpoint, each time the files were compared further by the checkpoint interval.
+	 * 
+	 * \param	handler		The handler, whose files are being compared.
+	 * \param	context		The filepath of the checkpoint file.
+	 * */
+	
+	if (!CmpCheckpoint_Write(handler, context))
+	{
+		Main_ShowMessage("Warning", "-ck", "--checkpoint", "couldn't write the checkpoint, the comparing continues without it!");
+	}
+}
+
+
+
+/*!
+ * 	Where the decisions about the files are written, while they are compared.
+ * */
+struct DecisionEvents
+{
+	FILE* _stream;
+	/*!
+	 * When the comparing started, in seconds.
+	 * */
+	double _start_time;
+};
+
+static double Main_CurrentTime(void)
+{
+	/*!
+	 * \brief	Fetches the time of a clock, that never goes back, in seconds.
+	 * */
+	
+	#ifdef _WIN32
+	return (double)clock() / CLOCKS_PER_SEC;
+	#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+	#endif
+}
+
+static void Main_WriteDecision(struct FilesToCompare* handler, size_t file_index, long long offset, void* context)
+{
+	/*!
+	 * \brief	Writes a decision about a file, as soon as it is made.
+	 * 
+	 * \param	handler			The handler, whose files are being compared.
+	 * \param	file_index		The index of the file, that the decision is about.
+	 * \param	offset			The offset, at which the decision was made.
+	 * \param	context			The stream of the decisions.
+	 * */
+	
+	struct DecisionEvents* decision_events = context;
+	
+	if (!CmpOutput_WriteDecision(decision_events->_stream, handler, file_index, offset, Main_CurrentTime() - decision_events->_start_time))
+	{
+		Main_ShowMessage("Warning", "-ev", "--events", "couldn't write a decision, the comparing continues!");
+	}
+}
+
+
+
+static size_t Main_DefaultOpenFiles(size_t number_of_files)
+{
+	/*!
+	 * \brief	Derives the limit of the open files, when none was provided, from the limit of the process.
+	 * 
+	 * \param	number_of_files		The number of compared files.
+	 * 
+	 * \return	The among of files, that can be open at the same time, or 0, if all of them fit under the limit of the process.
+	 * */
+	
+	#ifndef _WIN32
+	struct rlimit descriptor_limit;
+	
+	if (getrlimit(RLIMIT_NOFILE, &descriptor_limit) != 0 || descriptor_limit.rlim_cur == RLIM_INFINITY)
+	{
+		return 0;
+	}
+	else if ((rlim_t)(number_of_files + RESERVED_FILE_DESCRIPTORS) <= descriptor_limit.rlim_cur)
+	{
+		return 0;
+	}
+	else if (descriptor_limit.rlim_cur <= (rlim_t)RESERVED_FILE_DESCRIPTORS)
+	{
+		return 1;
+	}
+	
+	return (size_t)descriptor_limit.rlim_cur - RESERVED_FILE_DESCRIPTORS;
+	#else
+	(void)number_of_files;
+	return 0;
+	#endif
+}
+
+
+
+static bool Main_IsSameFile(const char* filepath, const char* other_filepath)
+{
+	/*!
+	 * \brief	Checks, if both filepaths lead to the same file (by the same filepath, or by the same device and inode).
+	 * 
+	 * \param	filepath				The first filepath.
+	 * \param	other_filepath		The second filepath.
+	 * 
+	 * \return	If they lead to the same file, returns true. Files, that can't be found, are only told apart by their filepaths.
+	 * */
+	
+	if (strcmp(filepath, other_filepath) == 0) return true;
+	
+	#ifndef _WIN32
+	struct stat file_status, other_file_status;
+	
+	if (stat(filepath, &file_status) != 0 || stat(other_filepath, &other_file_status) != 0) return false;
+	
+	return (file_status.st_dev == other_file_status.st_dev) && (file_status.st_ino == other_file_status.st_ino);
+	#else
+	return false;
+	#endif
+}
+
+
+
+static bool Main_LimitReading(unsigned long long bandwidth_limit, unsigned long long operations_limit, const char* throttle_path, const char* io_priority, struct IoThrottle** throttle)
+{
+	/*!
+	 * \brief	Sets the IO priority, and creates the limits of the reading, if any were requested.
+	 * 
+	 * \param	bandwidth_limit		The bytes per second of all reads together, or 0 for no limit.
+	 * \param	operations_limit		The reads per second, or 0 for no limit.
+	 * \param	throttle_path			The control file of the limits, or NULL.
+	 * \param	io_priority				The IO scheduling class and priority, or NULL to keep the current one.
+	 * \param	throttle					Where the created limits are stored (NULL, if none were requested).
+	 * 
+	 * \return	If everything requested was set, returns true.
+	 * */
+	
+	*throttle = NULL;
+	
+	if (io_priority != NULL && !CmpThrottle_SetIoPriority(io_priority))
+	{
+		Main_ShowMessage("Error", "-ip", "--io-priority", "couldn't be set (use idle, best-effort or realtime, with a optional :0 to :7)!");
+		return false;
+	}
+	
+	if (bandwidth_limit == 0 && operations_limit == 0 && throttle_path == NULL)
+	{
+		return true;
+	}
+	
+	*throttle = CmpThrottle_Initialize(bandwidth_limit, operations_limit);
+	if (*throttle == NULL)
+	{
+		Main_ShowMessage("Error", NULL, NULL, "Couldn't create the limits of the reading (they are only supported on Linux)!");
+		return false;
+	}
+	
+	if (throttle_path != NULL && !CmpThrottle_UseControlFile(*throttle, throttle_path))
+	{
+		Main_ShowMessage("Error", "-tf", "--throttle-file", "couldn't be loaded!");
+		CmpThrottle_Terminate(*throttle);
+		*throttle = NULL;
+		return false;
+	}
+	
+	return true;
+}
+
+
+
 int main(int argument_count, char **passed_arguments)
 {
 	/*!
@@ -132,6 +492,50 @@ int main(int argument_count, char **passed_arguments)
 	int files_start_index = INDEX_NOT_SELECTED, files_end_index = INDEX_NOT_SELECTED;
 	size_t buffer_size = DEFAULT_BUFFER_SIZE;
 	enum OutputLevel output_level = SHOW_ALL;
+	enum OutputFormat output_format = OUTPUT_TEXT;
+	bool show_combinations = false;
+	bool use_fingerprints = false;
+	bool schedule_devices = false;
+	size_t compare_threads = 1;
+	size_t quorum = 0;
+	bool watch_files = false;
+	unsigned int watch_delay = DEFAULT_WATCH_DELAY;
+	char* reference_filepath = NULL;
+	char* checkpoint_path = NULL;
+	size_t checkpoint_interval = (size_t)DEFAULT_CHECKPOINT_INTERVAL;
+	bool resume_comparing = false;
+	const char* daemon_socket = NULL;
+	const char* client_socket = NULL;
+	bool send_filepaths = false;
+	struct DaemonSettings daemon_settings = {DEFAULT_DAEMON_WORKERS, DEFAULT_DAEMON_QUEUED_JOBS, DEFAULT_DAEMON_CLIENT_JOBS, DEFAULT_DAEMON_JOB_FILES, DEFAULT_BUFFER_SIZE, false, NULL};
+	unsigned long long bandwidth_limit = 0, operations_limit = 0;
+	const char* throttle_path = NULL;
+	const char* io_priority = NULL;
+	struct IoThrottle* throttle = NULL;
+	const char* trace_path = NULL;
+	const char* region_list = NULL;
+	long long* region_offsets = NULL;
+	long long* region_lengths = NULL;
+	size_t max_open_files = 0;
+	unsigned long long max_memory = 0;
+	bool compare_members = false;
+	const char* manifest_path = NULL;
+	enum DigestAlgorithm digest_algorithm = DIGEST_XXH64;
+	const struct IoBackend* io_backend = NULL;
+	const char* repaired_path = NULL;
+	const char* events_path = NULL;
+	FILE* events_stream = NULL;
+	bool report_damage = false;
+	unsigned long long damage_threshold = 0;
+	bool count_bits = false;
+	const char* file_list_path = NULL;
+	char** listed_filepaths = NULL;
+	size_t number_of_listed_files = 0;
+	size_t shard_index = 0, shard_count = 0;
+	const char* partial_path = NULL;
+	size_t* sharded_indexes = NULL;
+	char** sharded_filepaths = NULL;
+	bool merge_partials = false;
 	
 	if (argument_count <= 1)
 	{
@@ -178,6 +582,159 @@ int main(int argument_count, char **passed_arguments)
 			puts("-om --only-matching");
 			puts("\tOnly shows the files, that have matched data.\n");
 
+			puts("-of --output-format");
+			puts("\tSet the format of the results: text (by default), json or csv.\n");
+
+			puts("-pw --pairwise");
+			puts("\tShow the results pair by pair, instead of as groups of matched files.\n");
+
+			puts("-fp --fingerprints");
+			puts("\tRoute the files of each group by the fingerprints of their blocks, before comparing them byte by byte.\n"
+					"\tSpeeds up the comparing of many files with the same size, but differing data.\n");
+
+			puts("-ds --device-scheduling");
+			puts("\tRead the files grouped by their devices: files sharing a rotational disk in long bursts (instead of seeking on every block),\n"
+					"\tand files on different devices at the same time.\n");
+
+			puts("-ct --compare-threads");
+			puts("\tSet the number of threads, that each block of the files is compared with (by default 1). The threads check the blocks\n"
+					"\tof different files, and different ranges of the same blocks, at the same time. The results are the same for any number of them.\n");
+
+			puts("-qr --quorum");
+			puts("\tStop comparing, as soon as the provided number of files were matched till their end, and name them and the outliers.\n"
+					"\tFiles, that can't be matched with enough others anymore, are no longer read. Exits with success, if the quorum was reached.\n");
+
+			puts("-rf --reference");
+			puts("\tCompare every file only with the provided reference file, instead of with each other.\n"
+					"\tThe reference file is read once per block, and a file stops being read, as soon as it doesn't match it.\n"
+					"\tThe reference file can't also be one of the compared files.\n");
+
+			puts("-rg --region");
+			puts("\tOnly compare a region of each file, as OFFSET[:LENGTH] in bytes (till the end of the file, without a length).\n"
+					"\tProvide one region for all files, or one per file separated by commas (with the reference file of -rf first).\n"
+					"\tNo byte outside of the regions is read, and the offsets of the differences are relative to them.\n");
+
+			puts("-mo --max-open");
+			printf("\tSet how many of the files can be open at the same time (by default all of them, if the limit of the process\n"
+					"\tallows it, or else that limit minus %zu). The others are closed in turn, and opened again when needed.\n\n", 
+						RESERVED_FILE_DESCRIPTORS);
+
+			puts("-mm --max-memory");
+			puts("\tLimit the memory of the buffers of all files together, with a optional K, M or G suffix.\n"
+					"\tThe buffers are shrunk first, and if that isn't enough, the files share fewer buffers, and some blocks are read again.\n");
+
+			puts("-tm --tar-members");
+			puts("\tTreat the filepaths as tar archives (or directories of unpacked trees), and compare their members, matched by their paths,\n"
+					"\tdirectly from the archives (without extracting them). The results are shown per member.\n");
+
+			puts("-ev --events");
+			puts("\tWrite each decision about a file into the provided file (or stdout), as soon as it is made, while the files are compared,\n"
+					"\tas a line with a JSON object: when and at which offset the file stopped matching some files, matched its group, or was left alone.\n"
+					"\tThe offset of a mismatch is of its first differing byte, unless its block couldn't be read again into a shared buffer of -mm (then it is of the block).\n");
+
+			puts("-rp --repair");
+			puts("\tInstead of comparing the files, treat them as 3 or more damaged replicas, and write a repaired copy into the provided file,\n"
+					"\tin which each byte has the value of the majority of the replicas. The regions without a clear majority are shown.\n");
+
+			puts("-dr --damage-report");
+			puts("\tInstead of grouping the files, count in how many bytes and blocks each pair of them differs (reading the files till their end),\n"
+					"\tand show the counts with the similarity of the files. With -rf, only the pairs with the reference file are counted.\n");
+
+			puts("-dt --damage-threshold");
+			puts("\tStop counting the differences of a pair of -dr after the provided among of differing bytes, with a optional K, M or G suffix.\n");
+
+			puts("-db --damage-bits");
+			puts("\tAlso count the differing bits of -dr.\n");
+
+			puts("-fl --file-list");
+			printf("\tRead the filepaths from the provided file, one per line (or from stdin, with \"%s\"), instead of from the arguments.\n\n", 
+						STDIN_FILEPATH_MARK);
+
+			puts("-sh --shard");
+			puts("\tOnly compare the files of a shard of the job, provided as INDEX/COUNT (like 2/8), and write its partial results into the file of -so.\n"
+					"\tThe files are split among the shards by their sizes, so every process, that is given the same files, can compare its shard on its own.\n");
+
+			puts("-so --shard-output");
+			puts("\tSet the file, into which the partial results of -sh are written (replaced atomically).\n");
+
+			puts("-ms --merge-shards");
+			puts("\tTreat the filepaths as the partial results of all shards of a job, and show the merged results,\n"
+					"\tin the same way as if all files were compared by a single process.\n");
+
+			puts("-ck --checkpoint");
+			puts("\tPeriodically store the progress of the comparing into the provided file (replaced atomically),\n"
+					"\twhich is removed once the comparing is done.\n");
+
+			puts("-ci --checkpoint-interval");
+			printf("\tSet after how many compared bytes per file a new checkpoint is written (by default %lld).\n\n", 
+						DEFAULT_CHECKPOINT_INTERVAL);
+
+			puts("-rs --resume");
+			puts("\tContinue the comparing from the checkpoint of -ck, if the files didn't change since it was written.\n");
+
+			puts("-mf --manifest");
+			puts("\tWrite the digest of each compared block into the provided manifest, while the files are compared,\n"
+					"\twith a digest per group of files, that still had the same data (so a single copy can be checked later).\n");
+
+			puts("-da --digest");
+			puts("\tSet the algorithm of the digests of -mf: xxh64 (by default) or sha256.\n");
+
+			puts("-bl --bandwidth-limit");
+			puts("\tLimit the bytes read per second from all files together, with a optional K, M or G suffix.\n");
+
+			puts("-il --iops-limit");
+			puts("\tLimit the reads per second from all files together.\n");
+
+			puts("-tf --throttle-file");
+			puts("\tLoad the limits from a control file with \"bandwidth <rate>\", \"iops <rate>\" and\n"
+					"\t\"device <path> [bandwidth <rate>] [iops <rate>]\" lines, which is loaded again on SIGHUP.\n");
+
+			puts("-ib --io-backend");
+			puts("\tSet how the files are read: posix (by default, with read and pread) or stdio (with unbuffered filestreams).\n");
+
+			puts("-ip --io-priority");
+			puts("\tSet the IO scheduling class of the reading: idle, best-effort or realtime, with a optional :0 to :7 priority.\n");
+
+			puts("-tr --trace");
+			puts("\tRecord a timeline of the opening, reading and comparing of the files, and write it into the provided file\n"
+					"\tas a Chrome trace (which Perfetto or chrome://tracing can open).\n");
+
+			puts("-w --watch");
+			puts("\tKeep watching the files after comparing them, and compare the changed ones again, till interrupted (only on Linux).\n");
+
+			puts("-wd --watch-delay");
+			printf("\tSet how many milliseconds need to pass without further changes, before the watched files\n"
+					"\tare compared again (by default %u).\n\n", 
+						DEFAULT_WATCH_DELAY);
+
+			puts("-dm --daemon");
+			puts("\tInstead of comparing files, serve the comparing jobs of clients on the provided Unix socket, till interrupted (only on Linux).\n"
+					"\tThe -bs and -fp arguments apply to every served job.\n");
+
+			puts("-wt --workers");
+			printf("\tSet the number of threads, that the daemon compares the jobs with (by default %zu).\n\n", 
+						DEFAULT_DAEMON_WORKERS);
+
+			puts("-mq --max-queued");
+			printf("\tSet how many jobs can wait for the daemon, before new ones are refused as busy (by default %zu).\n"
+					"\tA single client can fill at most half of them.\n\n", 
+						DEFAULT_DAEMON_QUEUED_JOBS);
+
+			puts("-cj --client-jobs");
+			printf("\tSet how many jobs of a single client the daemon compares at the same time (by default %zu).\n\n", 
+						DEFAULT_DAEMON_CLIENT_JOBS);
+
+			puts("-jf --job-files");
+			printf("\tSet how many files a single job of the daemon can contain (by default %zu).\n"
+					"\tThe daemon allocates this many buffers per worker up front.\n\n", 
+						DEFAULT_DAEMON_JOB_FILES);
+
+			puts("-cl --client");
+			puts("\tLet the daemon listening on the provided Unix socket compare the files, and show its results.\n");
+
+			puts("-sp --send-paths");
+			puts("\tSend the filepaths to the daemon, instead of the open files (which also works for files, that the daemon can't access).\n");
+
 			puts("-cf --compare-files");
 			printf("\tAny filepath entered after this (till the end of the arguments or the next console argument)\n"
 					"\twill have its files data compared with each other, byte by byte.\n"
@@ -198,7 +755,29 @@ int main(int argument_count, char **passed_arguments)
 			printf("%s file1.txt file2.txt file3.bin -om\n", passed_arguments[0]);
 			printf("%s file1.txt file2.txt file3.bin -bs 65536\n", passed_arguments[0]);
 			printf("%s -bs 65536 -om -cf file1.txt file2.txt\n", passed_arguments[0]);
+			printf("%s file1.txt file2.txt file3.bin -of json\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img -rf master.img\n", passed_arguments[0]);
+			printf("%s copy1.bin copy2.bin -rg 512,4096\n", passed_arguments[0]);
+			printf("%s disk1.img disk2.img -rg 1048576:536870912\n", passed_arguments[0]);
+			printf("%s disk1.img disk2.img -ck compare.checkpoint -rs\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img -mf replicas.manifest -da sha256\n", passed_arguments[0]);
+			printf("%s backups/*.tar -mo 1000 -mm 256M\n", passed_arguments[0]);
+			printf("%s release.tar mirror/release.tar build/tree -tm\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img -ev stdout -of json\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img -rp repaired.img\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img -dr -db -dt 16M\n", passed_arguments[0]);
+			printf("%s -fl files.txt -sh 1/4 -so shard1.partial\n", passed_arguments[0]);
+			printf("%s shard1.partial shard2.partial shard3.partial shard4.partial -ms\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img -bl 200M -ip idle\n", passed_arguments[0]);
+			printf("%s file1.bin file2.bin -ib stdio\n", passed_arguments[0]);
+			printf("%s /mnt/hdd/copy1.img /mnt/hdd/copy2.img /mnt/ssd/copy3.img -ds\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img replica4.img -bs 16777216 -ct 8\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img replica4.img replica5.img -qr 3\n", passed_arguments[0]);
+			printf("%s replica1.img replica2.img replica3.img -tr compare.trace.json\n", passed_arguments[0]);
+			printf("%s replica1.conf replica2.conf -w -wd 500\n", passed_arguments[0]);
 			printf("%s stdin file.bin -bs 65536 < file.txt\n", passed_arguments[0]);
+			printf("%s -dm /tmp/cmpfiles.socket -wt 8 -cj 2\n", passed_arguments[0]);
+			printf("%s file1.txt file2.txt -cl /tmp/cmpfiles.socket -of json\n", passed_arguments[0]);
 			
 			
 			
@@ -238,64 +817,690 @@ int main(int argument_count, char **passed_arguments)
 			argument_was_provided = true;
         }
         
-		//	Check which input files the user wants to compare.
-        else if (strcmp(passed_arguments[argument_position], "-cf") == 0 || strcmp(passed_arguments[argument_position], "--check-files") == 0)
+		//	Check in which format the user wants to see the results.
+        else if (strcmp(passed_arguments[argument_position], "-of") == 0 || strcmp(passed_arguments[argument_position], "--output-format") == 0) 
 		{
-			//	Go to the argument, containing (possibly) the needed values.
+			//	Go to the argument, containing (possibly) needed value.
 			++argument_position;
 			
-			//	Validity check.
-			if (files_start_index >= 0 || files_end_index >= 0)
+			if (argument_position >= argument_count)
 			{
-				Main_ShowMessage("Error", "-cf", "--check-files", "cannot be used, since the filenames have already been defined!");
+				Main_ShowMessage("Error", "-of", "--output-format", "has no defined value!");
 				return EXIT_FAILURE;
 			}
-			
-			
-			
-			if (argument_position < argument_count)
-			{
-				files_start_index = argument_position;
-				files_end_index = argument_position + 1;
-			}
-			else
+			else if (strcmp(passed_arguments[argument_position], "text") == 0)
 			{
-				Main_ShowMessage("Error", "-cf", "--check-files", "has no defined filepaths!");
-				return EXIT_FAILURE;
+				output_format = OUTPUT_TEXT;
 			}
-			
-			argument_was_provided = false;	//	Is not set. Otherwise, it will cause -cf to only read one filepath!
-        }
-        
-        //	Used when defining the input filepaths. 
-        else 
-        {
-			if (files_start_index < 0)
+			else if (strcmp(passed_arguments[argument_position], "json") == 0)
 			{
-				files_start_index = argument_position;
-				files_end_index = argument_position + 1;
+				output_format = OUTPUT_JSON;
 			}
-			else if (!argument_was_provided)
+			else if (strcmp(passed_arguments[argument_position], "csv") == 0)
 			{
-				files_end_index = argument_position + 1;
+				output_format = OUTPUT_CSV;
 			}
 			else
 			{
-				Main_ShowMessage("Error", NULL, NULL, "Cannot process any more filenames, after one or several arguments!");
+				Main_ShowMessage("Error", "-of", "--output-format", "was provided with an unsupported format (supported are text, json and csv)!");
 				return EXIT_FAILURE;
 			}
-		}
-	}
-
-	
-	
-	/*	
-	 * Since everything is set and ready, time to get its hands dirty.
-	 */
-	//	Only used in combination with goto.
-	int return_code = EXIT_SUCCESS;	
-	
-	if (files_start_index == INDEX_NOT_SELECTED)
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to see the results of every file pair.
+        else if (strcmp(passed_arguments[argument_position], "-pw") == 0 || strcmp(passed_arguments[argument_position], "--pairwise") == 0) 
+		{
+			show_combinations = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants the groups to be split by block fingerprints.
+        else if (strcmp(passed_arguments[argument_position], "-fp") == 0 || strcmp(passed_arguments[argument_position], "--fingerprints") == 0) 
+		{
+			use_fingerprints = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants the files to be read by their devices.
+        else if (strcmp(passed_arguments[argument_position], "-ds") == 0 || strcmp(passed_arguments[argument_position], "--device-scheduling") == 0) 
+		{
+			schedule_devices = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check how many threads the user wants each block to be compared with.
+        else if (strcmp(passed_arguments[argument_position], "-ct") == 0 || strcmp(passed_arguments[argument_position], "--compare-threads") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-ct", "--compare-threads", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!Main_ParseCount(passed_arguments[argument_position], 1024, &compare_threads))
+			{
+				Main_ShowMessage("Error", "-ct", "--compare-threads", "was provided with an invalid value (which is either not a number, zero or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check how many matched files the user needs, before the comparing stops.
+        else if (strcmp(passed_arguments[argument_position], "-qr") == 0 || strcmp(passed_arguments[argument_position], "--quorum") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-qr", "--quorum", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!Main_ParseCount(passed_arguments[argument_position], INT_MAX, &quorum) || quorum < 2)
+			{
+				Main_ShowMessage("Error", "-qr", "--quorum", "was provided with an invalid value (which is either not a number, smaller than 2 or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to compare the files only with a reference file.
+        else if (strcmp(passed_arguments[argument_position], "-rf") == 0 || strcmp(passed_arguments[argument_position], "--reference") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-rf", "--reference", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			reference_filepath = passed_arguments[argument_position];
+			argument_was_provided = true;
+        }
+        
+		//	Check which region of each file the user wants to compare.
+        else if (strcmp(passed_arguments[argument_position], "-rg") == 0 || strcmp(passed_arguments[argument_position], "--region") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-rg", "--region", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			
+			region_list = passed_arguments[argument_position];
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to compare the members of tar archives.
+        else if (strcmp(passed_arguments[argument_position], "-tm") == 0 || strcmp(passed_arguments[argument_position], "--tar-members") == 0) 
+		{
+			compare_members = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check how many files the user allows to be open at the same time.
+        else if (strcmp(passed_arguments[argument_position], "-mo") == 0 || strcmp(passed_arguments[argument_position], "--max-open") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-mo", "--max-open", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!Main_ParseCount(passed_arguments[argument_position], INT_MAX, &max_open_files))
+			{
+				Main_ShowMessage("Error", "-mo", "--max-open", "was provided with an invalid value (which is either not a number, zero or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check how much memory the user allows the buffers to take.
+        else if (strcmp(passed_arguments[argument_position], "-mm") == 0 || strcmp(passed_arguments[argument_position], "--max-memory") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-mm", "--max-memory", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!CmpThrottle_ParseRate(passed_arguments[argument_position], &max_memory) || max_memory > SIZE_MAX)
+			{
+				Main_ShowMessage("Error", "-mm", "--max-memory", "was provided with an invalid value (which is either not a number, zero or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants the differences of the files to be counted.
+        else if (strcmp(passed_arguments[argument_position], "-dr") == 0 || strcmp(passed_arguments[argument_position], "--damage-report") == 0) 
+		{
+			report_damage = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check after how many differing bytes the user wants the counting to stop.
+        else if (strcmp(passed_arguments[argument_position], "-dt") == 0 || strcmp(passed_arguments[argument_position], "--damage-threshold") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-dt", "--damage-threshold", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!CmpThrottle_ParseRate(passed_arguments[argument_position], &damage_threshold) || damage_threshold > LLONG_MAX)
+			{
+				Main_ShowMessage("Error", "-dt", "--damage-threshold", "was provided with an invalid value (which is either not a number, zero or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants the differing bits to be counted.
+        else if (strcmp(passed_arguments[argument_position], "-db") == 0 || strcmp(passed_arguments[argument_position], "--damage-bits") == 0) 
+		{
+			count_bits = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check where the user wants the progress to be stored.
+        else if (strcmp(passed_arguments[argument_position], "-ck") == 0 || strcmp(passed_arguments[argument_position], "--checkpoint") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-ck", "--checkpoint", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			checkpoint_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+        }
+        
+		//	Check how often the user wants the progress to be stored.
+        else if (strcmp(passed_arguments[argument_position], "-ci") == 0 || strcmp(passed_arguments[argument_position], "--checkpoint-interval") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-ci", "--checkpoint-interval", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!Main_ParseCount(passed_arguments[argument_position], LONG_MAX, &checkpoint_interval))
+			{
+				Main_ShowMessage("Error", "-ci", "--checkpoint-interval", "was provided with an invalid value (which is either not a number, zero or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check where the user wants the digests of the blocks to be written.
+        else if (strcmp(passed_arguments[argument_position], "-mf") == 0 || strcmp(passed_arguments[argument_position], "--manifest") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-mf", "--manifest", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			manifest_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+		}
+        
+		//	Check where the user wants the decisions to be written, as soon as they are made.
+        else if (strcmp(passed_arguments[argument_position], "-ev") == 0 || strcmp(passed_arguments[argument_position], "--events") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-ev", "--events", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			events_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+		}
+        
+		//	Check where the user wants the repaired copy of the replicas to be written.
+        else if (strcmp(passed_arguments[argument_position], "-rp") == 0 || strcmp(passed_arguments[argument_position], "--repair") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-rp", "--repair", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			repaired_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+		}
+        
+		//	Check from which file the user wants the filepaths to be read.
+        else if (strcmp(passed_arguments[argument_position], "-fl") == 0 || strcmp(passed_arguments[argument_position], "--file-list") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-fl", "--file-list", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			file_list_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+		}
+        
+		//	Check which shard of the files the user wants to compare.
+        else if (strcmp(passed_arguments[argument_position], "-sh") == 0 || strcmp(passed_arguments[argument_position], "--shard") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-sh", "--shard", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!CmpShard_ParseShard(passed_arguments[argument_position], &shard_index, &shard_count))
+			{
+				Main_ShowMessage("Error", "-sh", "--shard", "was provided with an invalid value (which needs to be INDEX/COUNT, with the index from 1 to the count)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+		}
+        
+		//	Check where the user wants the partial results of the shard to be written.
+        else if (strcmp(passed_arguments[argument_position], "-so") == 0 || strcmp(passed_arguments[argument_position], "--shard-output") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-so", "--shard-output", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			partial_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+		}
+        
+		//	Check if the user wants the partial results of the shards to be merged.
+        else if (strcmp(passed_arguments[argument_position], "-ms") == 0 || strcmp(passed_arguments[argument_position], "--merge-shards") == 0) 
+		{
+			merge_partials = true;
+			argument_was_provided = true;
+		}
+        
+		//	Check by which algorithm the user wants the blocks to be digested.
+        else if (strcmp(passed_arguments[argument_position], "-da") == 0 || strcmp(passed_arguments[argument_position], "--digest") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-da", "--digest", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!CmpDigest_ParseAlgorithm(passed_arguments[argument_position], &digest_algorithm))
+			{
+				Main_ShowMessage("Error", "-da", "--digest", "was provided with an invalid value (which is neither xxh64 nor sha256)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check through which backend the user wants the files to be read.
+        else if (strcmp(passed_arguments[argument_position], "-ib") == 0 || strcmp(passed_arguments[argument_position], "--io-backend") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-ib", "--io-backend", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if ((io_backend = CmpIo_FindBackend(passed_arguments[argument_position])) == NULL)
+			{
+				Main_ShowMessage("Error", "-ib", "--io-backend", "was provided with an invalid value (which is neither posix nor stdio, or isn't supported on this system)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to continue from the stored progress.
+        else if (strcmp(passed_arguments[argument_position], "-rs") == 0 || strcmp(passed_arguments[argument_position], "--resume") == 0) 
+		{
+			resume_comparing = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check how fast the user allows the files to be read.
+        else if (strcmp(passed_arguments[argument_position], "-bl") == 0 || strcmp(passed_arguments[argument_position], "--bandwidth-limit") == 0
+				|| strcmp(passed_arguments[argument_position], "-il") == 0 || strcmp(passed_arguments[argument_position], "--iops-limit") == 0) 
+		{
+			bool is_bandwidth = strcmp(passed_arguments[argument_position], "-bl") == 0 || strcmp(passed_arguments[argument_position], "--bandwidth-limit") == 0;
+			const char* short_argument = is_bandwidth ? "-bl" : "-il";
+			const char* long_argument = is_bandwidth ? "--bandwidth-limit" : "--iops-limit";
+			
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", short_argument, long_argument, "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!CmpThrottle_ParseRate(passed_arguments[argument_position], is_bandwidth ? &bandwidth_limit : &operations_limit))
+			{
+				Main_ShowMessage("Error", short_argument, long_argument, "was provided with an invalid value (which is either not a number, zero or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check where the user keeps the limits, that can be changed while reading.
+        else if (strcmp(passed_arguments[argument_position], "-tf") == 0 || strcmp(passed_arguments[argument_position], "--throttle-file") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-tf", "--throttle-file", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			throttle_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+        }
+        
+		//	Check with which IO priority the user wants the files to be read.
+        else if (strcmp(passed_arguments[argument_position], "-ip") == 0 || strcmp(passed_arguments[argument_position], "--io-priority") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-ip", "--io-priority", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			
+			io_priority = passed_arguments[argument_position];
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants a timeline of the comparing.
+        else if (strcmp(passed_arguments[argument_position], "-tr") == 0 || strcmp(passed_arguments[argument_position], "--trace") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", "-tr", "--trace", "has no defined filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			trace_path = passed_arguments[argument_position];
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to keep watching the files for changes.
+        else if (strcmp(passed_arguments[argument_position], "-w") == 0 || strcmp(passed_arguments[argument_position], "--watch") == 0) 
+		{
+			if (!CmpWatch_IsSupported())
+			{
+				Main_ShowMessage("Error", "-w", "--watch", "is not supported on this system!");
+				return EXIT_FAILURE;
+			}
+			
+			watch_files = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check how long the user wants to wait for further changes of the watched files.
+        else if (strcmp(passed_arguments[argument_position], "-wd") == 0 || strcmp(passed_arguments[argument_position], "--watch-delay") == 0) 
+		{
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position < argument_count)
+			{
+				char* value_end;
+				unsigned long parsed_delay = strtoul(passed_arguments[argument_position], &value_end, 10);
+				
+				if (*value_end != '\0' || value_end == passed_arguments[argument_position] || parsed_delay > 3600000)
+				{
+					Main_ShowMessage("Error", "-wd", "--watch-delay", "was provided with an invalid value (which is either not a number, or bigger than an hour)!");
+					return EXIT_FAILURE;
+				}
+				
+				watch_delay = (unsigned int)parsed_delay;
+			}
+			else
+			{
+				Main_ShowMessage("Error", "-wd", "--watch-delay", "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to serve the jobs of clients, or be one.
+        else if (strcmp(passed_arguments[argument_position], "-dm") == 0 || strcmp(passed_arguments[argument_position], "--daemon") == 0
+				|| strcmp(passed_arguments[argument_position], "-cl") == 0 || strcmp(passed_arguments[argument_position], "--client") == 0) 
+		{
+			bool is_daemon = strcmp(passed_arguments[argument_position], "-dm") == 0 || strcmp(passed_arguments[argument_position], "--daemon") == 0;
+			const char* short_argument = is_daemon ? "-dm" : "-cl";
+			const char* long_argument = is_daemon ? "--daemon" : "--client";
+			
+			if (!CmpDaemon_IsSupported())
+			{
+				Main_ShowMessage("Error", short_argument, long_argument, "is not supported on this system!");
+				return EXIT_FAILURE;
+			}
+			
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", short_argument, long_argument, "has no defined socket filepath!");
+				return EXIT_FAILURE;
+			}
+			
+			if (is_daemon) daemon_socket = passed_arguments[argument_position];
+			else client_socket = passed_arguments[argument_position];
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to set one of the limits of the daemon.
+        else if (strcmp(passed_arguments[argument_position], "-wt") == 0 || strcmp(passed_arguments[argument_position], "--workers") == 0
+				|| strcmp(passed_arguments[argument_position], "-mq") == 0 || strcmp(passed_arguments[argument_position], "--max-queued") == 0
+				|| strcmp(passed_arguments[argument_position], "-cj") == 0 || strcmp(passed_arguments[argument_position], "--client-jobs") == 0
+				|| strcmp(passed_arguments[argument_position], "-jf") == 0 || strcmp(passed_arguments[argument_position], "--job-files") == 0) 
+		{
+			const char* SHORT_ARGUMENTS[] = {"-wt", "-mq", "-cj", "-jf"};
+			const char* LONG_ARGUMENTS[] = {"--workers", "--max-queued", "--client-jobs", "--job-files"};
+			size_t* LIMITS[] = {&daemon_settings._number_of_workers, &daemon_settings._max_queued_jobs, &daemon_settings._max_client_jobs, &daemon_settings._max_job_files};
+			const unsigned long MAXIMUMS[] = {1024, 1048576, 1024, 1048576};
+			
+			size_t limit_index = 0;
+			while (strcmp(passed_arguments[argument_position], SHORT_ARGUMENTS[limit_index]) != 0 && strcmp(passed_arguments[argument_position], LONG_ARGUMENTS[limit_index]) != 0)
+			{
+				limit_index += 1;
+			}
+			
+			//	Go to the argument, containing (possibly) needed value.
+			++argument_position;
+			
+			if (argument_position >= argument_count)
+			{
+				Main_ShowMessage("Error", SHORT_ARGUMENTS[limit_index], LONG_ARGUMENTS[limit_index], "has no defined value!");
+				return EXIT_FAILURE;
+			}
+			else if (!Main_ParseCount(passed_arguments[argument_position], MAXIMUMS[limit_index], LIMITS[limit_index]))
+			{
+				Main_ShowMessage("Error", SHORT_ARGUMENTS[limit_index], LONG_ARGUMENTS[limit_index], "was provided with an invalid value (which is either not a number, zero or to big)!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = true;
+        }
+        
+		//	Check if the user wants to send the filepaths to the daemon, instead of the open files.
+        else if (strcmp(passed_arguments[argument_position], "-sp") == 0 || strcmp(passed_arguments[argument_position], "--send-paths") == 0) 
+		{
+			send_filepaths = true;
+			argument_was_provided = true;
+        }
+        
+		//	Check which input files the user wants to compare.
+        else if (strcmp(passed_arguments[argument_position], "-cf") == 0 || strcmp(passed_arguments[argument_position], "--check-files") == 0)
+		{
+			//	Go to the argument, containing (possibly) the needed values.
+			++argument_position;
+			
+			//	Validity check.
+			if (files_start_index >= 0 || files_end_index >= 0)
+			{
+				Main_ShowMessage("Error", "-cf", "--check-files", "cannot be used, since the filenames have already been defined!");
+				return EXIT_FAILURE;
+			}
+			
+			
+			
+			if (argument_position < argument_count)
+			{
+				files_start_index = argument_position;
+				files_end_index = argument_position + 1;
+			}
+			else
+			{
+				Main_ShowMessage("Error", "-cf", "--check-files", "has no defined filepaths!");
+				return EXIT_FAILURE;
+			}
+			
+			argument_was_provided = false;	//	Is not set. Otherwise, it will cause -cf to only read one filepath!
+        }
+        
+        //	Used when defining the input filepaths. 
+        else 
+        {
+			if (files_start_index < 0)
+			{
+				files_start_index = argument_position;
+				files_end_index = argument_position + 1;
+			}
+			else if (!argument_was_provided)
+			{
+				files_end_index = argument_position + 1;
+			}
+			else
+			{
+				Main_ShowMessage("Error", NULL, NULL, "Cannot process any more filenames, after one or several arguments!");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	
+	
+	/*	
+	 * Since everything is set and ready, time to get its hands dirty.
+	 */
+	//	Only used in combination with goto.
+	int return_code = EXIT_SUCCESS;	
+	
+	if (daemon_socket != NULL)
+	{
+		if (files_start_index != INDEX_NOT_SELECTED || client_socket != NULL || watch_files || trace_path != NULL || region_list != NULL || max_open_files != 0 || max_memory != 0 || compare_members || manifest_path != NULL || io_backend != NULL || repaired_path != NULL || report_damage || events_path != NULL || 
+			file_list_path != NULL || shard_count != 0 || merge_partials || compare_threads > 1 || quorum != 0)
+		{
+			Main_ShowMessage("Error", "-dm", "--daemon", "cannot be used together with filepaths, -cl, -w, -tr, -rg, -mo, -mm, -tm, -mf, -ib, -rp, -dr, -ev, -fl, -sh, -ms, -ct or -qr!");
+			return EXIT_FAILURE;
+		}
+		
+		//	The worker threads inherit the IO priority, and share the limits.
+		if (!Main_LimitReading(bandwidth_limit, operations_limit, throttle_path, io_priority, &throttle))
+		{
+			return EXIT_FAILURE;
+		}
+		
+		daemon_settings._compare_buffer_size = buffer_size;
+		daemon_settings._use_fingerprints = use_fingerprints;
+		daemon_settings._throttle = throttle;
+		
+		bool daemon_was_served = CmpDaemon_Serve(daemon_socket, &daemon_settings);
+		CmpThrottle_Terminate(throttle);
+		
+		if (!daemon_was_served)
+		{
+			Main_ShowMessage("Error", "-dm", "--daemon", "couldn't serve on the socket!");
+			return EXIT_FAILURE;
+		}
+		
+		return EXIT_SUCCESS;
+	}
+	
+	if (file_list_path != NULL && files_start_index != INDEX_NOT_SELECTED)
+	{
+		Main_ShowMessage("Error", "-fl", "--file-list", "cannot be used, since the filenames have already been defined!");
+		return EXIT_FAILURE;
+	}
+	else if (file_list_path != NULL)
+	{
+		listed_filepaths = CmpShard_ReadFileList(file_list_path, &number_of_listed_files);
+		
+		if (listed_filepaths == NULL)
+		{
+			Main_ShowMessage("Error", "-fl", "--file-list", "couldn't read the filepaths from the list!");
+			return EXIT_FAILURE;
+		}
+	}
+	else if (files_start_index == INDEX_NOT_SELECTED)
 	{
 		Main_ShowMessage("Error", NULL, NULL, "No filepaths were defined!");
 		return EXIT_FAILURE;
@@ -306,14 +1511,378 @@ int main(int argument_count, char **passed_arguments)
 		return EXIT_FAILURE;
 	}
 	
-	size_t number_of_files_to_compare = files_end_index - files_start_index;
+	size_t number_of_files_to_compare = (listed_filepaths != NULL) ? number_of_listed_files : (size_t)(files_end_index - files_start_index);
+	char** filepaths = (listed_filepaths != NULL) ? listed_filepaths : passed_arguments + files_start_index;
+	char** referenced_filepaths = NULL;
+	
+	//	The partial results were already compared, so only the way they are shown can be set.
+	if (merge_partials)
+	{
+		if (shard_count != 0 || partial_path != NULL || reference_filepath != NULL || region_list != NULL || checkpoint_path != NULL || watch_files || client_socket != NULL)
+		{
+			Main_ShowMessage("Error", "-ms", "--merge-shards", "cannot be used together with -sh, -so, -rf, -rg, -ck, -w or -cl!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		else if (compare_members || repaired_path != NULL || report_damage || manifest_path != NULL || events_path != NULL || trace_path != NULL || show_combinations || quorum != 0)
+		{
+			Main_ShowMessage("Error", "-ms", "--merge-shards", "cannot be used together with -tm, -rp, -dr, -mf, -ev, -tr, -pw or -qr!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		bool all_matched = false;
+		bool partials_were_merged = CmpShard_MergePartials(stdout, filepaths, number_of_files_to_compare, output_format, output_level, &all_matched);
+		free(listed_filepaths);
+		
+		if (!partials_were_merged)
+		{
+			Main_ShowMessage("Error", "-ms", "--merge-shards", "couldn't merge the partial results of the shards!");
+			return EXIT_FAILURE;
+		}
+		
+		return all_matched ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	
+	if ((shard_count != 0) != (partial_path != NULL))
+	{
+		Main_ShowMessage("Error", "-sh", "--shard", "and -so need to be used together!");
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	else if (shard_count != 0 && (reference_filepath != NULL || region_list != NULL || watch_files || client_socket != NULL || compare_members || repaired_path != NULL || report_damage || show_combinations))
+	{
+		//	The shards are split by the sizes of the whole files, and their results are merged as groups.
+		Main_ShowMessage("Error", "-sh", "--shard", "cannot be used together with -rf, -rg, -w, -cl, -tm, -rp, -dr or -pw!");
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	
+	//	The decisions are only made by the comparing of the files themselves.
+	if (events_path != NULL && (watch_files || client_socket != NULL || compare_members || repaired_path != NULL || report_damage))
+	{
+		Main_ShowMessage("Error", "-ev", "--events", "cannot be used together with -w, -cl, -tm, -rp or -dr!");
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	
+	//	The abandoned files aren't known to match or not, so only the groups of the files, that were compared, can be shown.
+	if (quorum != 0 && (watch_files || client_socket != NULL || compare_members || repaired_path != NULL || report_damage || shard_count != 0 || show_combinations || manifest_path != NULL))
+	{
+		Main_ShowMessage("Error", "-qr", "--quorum", "cannot be used together with -w, -cl, -tm, -rp, -dr, -sh, -pw or -mf!");
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	
+	//	The replicas are read till their ends, instead of being compared.
+	if (repaired_path != NULL)
+	{
+		if (reference_filepath != NULL || region_list != NULL || checkpoint_path != NULL || watch_files || client_socket != NULL || trace_path != NULL || compare_members || report_damage)
+		{
+			Main_ShowMessage("Error", "-rp", "--repair", "cannot be used together with -rf, -rg, -ck, -w, -cl, -tr, -tm or -dr!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		else if (show_combinations || use_fingerprints || schedule_devices || max_open_files != 0 || max_memory != 0 || manifest_path != NULL || compare_threads > 1)
+		{
+			Main_ShowMessage("Error", "-rp", "--repair", "cannot be used together with -pw, -fp, -ds, -mo, -mm, -mf or -ct!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		else if (number_of_files_to_compare < 3)
+		{
+			Main_ShowMessage("Error", "-rp", "--repair", "needs at least 3 replicas, so that a majority can be found!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		if (!Main_LimitReading(bandwidth_limit, operations_limit, throttle_path, io_priority, &throttle))
+		{
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		bool all_decided = false;
+		bool files_were_repaired = CmpRepair_RepairFiles(stdout, repaired_path, filepaths, number_of_files_to_compare, buffer_size, io_backend, throttle, output_format, &all_decided);
+		CmpThrottle_Terminate(throttle);
+		free(listed_filepaths);
+		
+		if (!files_were_repaired)
+		{
+			Main_ShowMessage("Error", "-rp", "--repair", "couldn't repair the replicas!");
+			return EXIT_FAILURE;
+		}
+		
+		return all_decided ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	
+	//	The reference file is put in front of the other files.
+	if (reference_filepath != NULL)
+	{
+		if (client_socket != NULL)
+		{
+			Main_ShowMessage("Error", "-rf", "--reference", "cannot be used together with -cl!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		//	Otherwise the reference file would be compared with itself, and always be matched.
+		for (size_t at_file = 0; at_file < number_of_files_to_compare; at_file += 1)
+		{
+			if (!Main_IsSameFile(reference_filepath, filepaths[at_file])) continue;
+			
+			Main_ShowMessage("Error", "-rf", "--reference", "cannot also be one of the compared files!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		referenced_filepaths = malloc(sizeof(char*) * (number_of_files_to_compare + 1));
+		if (referenced_filepaths == NULL)
+		{
+			Main_ShowMessage("Error", "-rf", "--reference", "couldn't allocate the list of filepaths!");
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		referenced_filepaths[0] = reference_filepath;
+		memcpy(referenced_filepaths + 1, filepaths, sizeof(char*) * number_of_files_to_compare);
+		
+		filepaths = referenced_filepaths;
+		number_of_files_to_compare += 1;
+	}
+	
 	if (number_of_files_to_compare < 2)
 	{
 		Main_ShowMessage("Error", NULL, NULL, "At least 2 files need to be defined (use -h --help for more information)!");
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	else if (quorum > number_of_files_to_compare)
+	{
+		Main_ShowMessage("Error", "-qr", "--quorum", "needs more files, than were defined!");
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	
+	if (resume_comparing && checkpoint_path == NULL)
+	{
+		Main_ShowMessage("Error", "-rs", "--resume", "needs the checkpoint file to be defined with -ck!");
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	else if (checkpoint_path != NULL && (watch_files || client_socket != NULL))
+	{
+		Main_ShowMessage("Error", "-ck", "--checkpoint", "cannot be used together with -w or -cl!");
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	
+	//	The manifest needs every block to pass through a buffer of its own, during a single comparing.
+	if (manifest_path != NULL && (resume_comparing || watch_files || max_memory != 0 || client_socket != NULL || compare_members))
+	{
+		Main_ShowMessage("Error", "-mf", "--manifest", "cannot be used together with -rs, -w, -mm, -cl or -tm!");
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	
+	if ((damage_threshold != 0 || count_bits) && !report_damage)
+	{
+		Main_ShowMessage("Error", "-dt", "--damage-threshold", "and -db can only be used together with -dr!");
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	else if (report_damage)
+	{
+		if (region_list != NULL || checkpoint_path != NULL || watch_files || client_socket != NULL || trace_path != NULL || compare_members || manifest_path != NULL)
+		{
+			Main_ShowMessage("Error", "-dr", "--damage-report", "cannot be used together with -rg, -ck, -w, -cl, -tr, -tm or -mf!");
+			free(referenced_filepaths);
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		else if (show_combinations || use_fingerprints || schedule_devices || max_open_files != 0 || max_memory != 0 || compare_threads > 1)
+		{
+			Main_ShowMessage("Error", "-dr", "--damage-report", "cannot be used together with -pw, -fp, -ds, -mo, -mm or -ct!");
+			free(referenced_filepaths);
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		if (!Main_LimitReading(bandwidth_limit, operations_limit, throttle_path, io_priority, &throttle))
+		{
+			free(referenced_filepaths);
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		
+		bool all_matched = false;
+		bool differences_were_counted = CmpDamage_CountDifferences(stdout, filepaths, number_of_files_to_compare, buffer_size, io_backend, throttle, 
+																							reference_filepath != NULL, (long long)damage_threshold, count_bits, output_format, &all_matched);
+		CmpThrottle_Terminate(throttle);
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		
+		if (!differences_were_counted)
+		{
+			Main_ShowMessage("Error", "-dr", "--damage-report", "couldn't count the differences of the files!");
+			return EXIT_FAILURE;
+		}
+		
+		return all_matched ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	
+	if (client_socket != NULL)
+	{
+		if (watch_files || use_fingerprints || schedule_devices || trace_path != NULL || region_list != NULL || max_open_files != 0 || max_memory != 0 || io_backend != NULL || compare_threads > 1)
+		{
+			Main_ShowMessage("Error", "-cl", "--client", "cannot be used together with -w, -fp, -ds, -tr, -rg, -mo, -mm, -ib or -ct (the daemon decides, how it compares the files)!");
+			return EXIT_FAILURE;
+		}
+		else if (bandwidth_limit != 0 || operations_limit != 0 || throttle_path != NULL || io_priority != NULL)
+		{
+			Main_ShowMessage("Error", "-cl", "--client", "cannot be used together with -bl, -il, -tf or -ip (the daemon limits its reading itself)!");
+			return EXIT_FAILURE;
+		}
+		
+		bool all_matched = false;
+		bool results_were_received = CmpDaemon_Request(stdout, client_socket, filepaths, number_of_files_to_compare, 
+																	send_filepaths, output_format, output_level, show_combinations, &all_matched);
+		free(listed_filepaths);
+		
+		return (results_were_received && all_matched) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	
+	if (compare_members)
+	{
+		if (reference_filepath != NULL || region_list != NULL || checkpoint_path != NULL || watch_files || client_socket != NULL || trace_path != NULL)
+		{
+			Main_ShowMessage("Error", "-tm", "--tar-members", "cannot be used together with -rf, -rg, -ck, -w, -cl or -tr!");
+			free(referenced_filepaths);
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+		else if (show_combinations || use_fingerprints || schedule_devices || max_open_files != 0 || max_memory != 0 || io_backend != NULL || compare_threads > 1)
+		{
+			Main_ShowMessage("Error", "-tm", "--tar-members", "cannot be used together with -pw, -fp, -ds, -mo, -mm, -ib or -ct!");
+			return EXIT_FAILURE;
+		}
+		
+		if (!Main_LimitReading(bandwidth_limit, operations_limit, throttle_path, io_priority, &throttle))
+		{
+			return EXIT_FAILURE;
+		}
+		
+		bool all_matched = false;
+		bool members_were_compared = CmpTar_CompareMembers(stdout, filepaths, number_of_files_to_compare, buffer_size, throttle, output_format, output_level, &all_matched);
+		CmpThrottle_Terminate(throttle);
+		free(listed_filepaths);
+		
+		if (!members_were_compared)
+		{
+			Main_ShowMessage("Error", "-tm", "--tar-members", "couldn't compare the members of the archives!");
+			return EXIT_FAILURE;
+		}
+		
+		return all_matched ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	
+	struct FilesToCompare* handler = NULL;
+	
+	//	Only the files of the shard are compared, and the list is kept for their indexes.
+	if (shard_count != 0)
+	{
+		sharded_indexes = malloc(sizeof(size_t) * number_of_files_to_compare);
+		sharded_filepaths = malloc(sizeof(char*) * number_of_files_to_compare);
+		
+		size_t number_of_sharded_files = 0;
+		
+		if (sharded_indexes == NULL || sharded_filepaths == NULL || 
+			!CmpShard_SelectFiles(filepaths, number_of_files_to_compare, shard_index, shard_count, sharded_indexes, &number_of_sharded_files))
+		{
+			Main_ShowMessage("Error", "-sh", "--shard", "couldn't select the files of the shard!");
+			return_code = EXIT_FAILURE;
+			goto __Main_FreeResources;
+		}
+		
+		for (size_t at_index = 0; at_index < number_of_sharded_files; at_index += 1)
+		{
+			sharded_filepaths[at_index] = filepaths[sharded_indexes[at_index]];
+		}
+		
+		number_of_listed_files = number_of_files_to_compare;
+		filepaths = sharded_filepaths;
+		number_of_files_to_compare = number_of_sharded_files;
+		
+		//	A shard without any files still needs its partial results, so that the merge knows, that it is done.
+		if (number_of_files_to_compare == 0)
+		{
+			if (!CmpShard_WritePartial(partial_path, NULL, NULL, number_of_listed_files, shard_index, shard_count))
+			{
+				Main_ShowMessage("Error", "-so", "--shard-output", "couldn't write the partial results of the shard!");
+				return_code = EXIT_FAILURE;
+			}
+			
+			goto __Main_FreeResources;
+		}
+	}
+	
+	if (schedule_devices && (max_open_files != 0 || max_memory != 0))
+	{
+		Main_ShowMessage("Error", "-ds", "--device-scheduling", "cannot be used together with -mo or -mm (the reader threads keep every file open, and a buffer per file)!");
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	else if (max_open_files == 0 && !schedule_devices)
+	{
+		max_open_files = Main_DefaultOpenFiles(number_of_files_to_compare);
+	}
+	
+	if (region_list != NULL)
+	{
+		region_offsets = malloc(sizeof(long long) * number_of_files_to_compare);
+		region_lengths = malloc(sizeof(long long) * number_of_files_to_compare);
+		
+		bool regions_are_valid = region_offsets != NULL && region_lengths != NULL && Main_ParseRegions(region_list, number_of_files_to_compare, region_offsets, region_lengths);
+		
+		if (!regions_are_valid)
+		{
+			Main_ShowMessage("Error", "-rg", "--region", "was provided with an invalid value (which needs a OFFSET[:LENGTH] for all files, or one per file)!");
+			free(region_offsets);
+			free(region_lengths);
+			free(referenced_filepaths);
+			free(listed_filepaths);
+			return EXIT_FAILURE;
+		}
+	}
+	
+	if (!Main_LimitReading(bandwidth_limit, operations_limit, throttle_path, io_priority, &throttle))
+	{
+		free(region_offsets);
+		free(region_lengths);
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		return EXIT_FAILURE;
+	}
+	
+	if (trace_path != NULL && !CmpTrace_Start(DEFAULT_TRACE_EVENTS))
+	{
+		Main_ShowMessage("Error", "-tr", "--trace", "couldn't start the recording (it is only supported on Linux)!");
+		CmpThrottle_Terminate(throttle);
+		free(region_offsets);
+		free(region_lengths);
+		free(referenced_filepaths);
+		free(listed_filepaths);
 		return EXIT_FAILURE;
 	}
 	
-	struct FilesToCompare* handler = CmpFiles_Initialize(passed_arguments + files_start_index, number_of_files_to_compare, buffer_size);
+	handler = CmpFiles_InitializeWithLimits(filepaths, number_of_files_to_compare, buffer_size, max_open_files, (size_t)max_memory, io_backend);
 	if (handler == NULL)
 	{
 		Main_ShowMessage("Error", NULL, NULL, "Couldn't allocate the resources for the file comparing handler!");
@@ -321,40 +1890,170 @@ int main(int argument_count, char **passed_arguments)
 		goto __Main_FreeResources;
 	}
 	
+	if (use_fingerprints && !CmpFiles_EnableFingerprints(handler))
+	{
+		Main_ShowMessage("Error", "-fp", "--fingerprints", "couldn't allocate the fingerprint table!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (schedule_devices && !CmpFiles_EnableDeviceScheduling(handler))
+	{
+		Main_ShowMessage("Error", "-ds", "--device-scheduling", "couldn't start the reading by devices (it is only supported on Linux)!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (quorum != 0 && !CmpFiles_SetQuorum(handler, quorum))
+	{
+		Main_ShowMessage("Error", "-qr", "--quorum", "couldn't be set!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (compare_threads > 1 && !CmpFiles_EnableCompareThreads(handler, compare_threads))
+	{
+		Main_ShowMessage("Error", "-ct", "--compare-threads", "couldn't start the compare threads!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (!CmpFiles_SetThrottle(handler, throttle))
+	{
+		Main_ShowMessage("Error", NULL, NULL, "Couldn't allocate the resources for limiting the reading!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (region_list != NULL && !CmpFiles_SetRegions(handler, region_offsets, region_lengths))
+	{
+		Main_ShowMessage("Error", "-rg", "--region", "couldn't move the files to their regions!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (reference_filepath != NULL && !CmpFiles_SetReference(handler, 0))
+	{
+		Main_ShowMessage("Error", "-rf", "--reference", "couldn't allocate the reference comparing resources!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (checkpoint_path != NULL)
+	{
+		bool was_resumed = false;
+		
+		if (resume_comparing && !CmpCheckpoint_Resume(handler, checkpoint_path, &was_resumed))
+		{
+			Main_ShowMessage("Error", "-rs", "--resume", "couldn't continue from the checkpoint (remove it, to compare the files from the start)!");
+			return_code = EXIT_FAILURE;
+			goto __Main_FreeResources;
+		}
+		else if (resume_comparing && !was_resumed)
+		{
+			Main_ShowMessage("Note", NULL, NULL, "No checkpoint was found, so the files are compared from the start.");
+		}
+		
+		CmpFiles_SetProgressCallback(handler, (long long)checkpoint_interval, Main_WriteCheckpoint, checkpoint_path);
+	}
+	
+	struct DecisionEvents decision_events = {NULL, Main_CurrentTime()};
+	
+	if (events_path != NULL)
+	{
+		events_stream = (strcmp(events_path, STDOUT_FILEPATH_MARK) == 0) ? stdout : fopen(events_path, "w");
+		
+		//	Each decision is flushed on its own, so that it can be acted on right away.
+		if (events_stream == NULL || setvbuf(events_stream, NULL, _IOLBF, BUFSIZ) != 0)
+		{
+			Main_ShowMessage("Error", "-ev", "--events", "couldn't open the file for the decisions!");
+			return_code = EXIT_FAILURE;
+			goto __Main_FreeResources;
+		}
+		
+		decision_events._stream = events_stream;
+		CmpFiles_SetDecisionCallback(handler, Main_WriteDecision, &decision_events);
+	}
+	
+	struct DigestManifest* manifest = NULL;
+	
+	if (manifest_path != NULL && (manifest = CmpDigest_Start(manifest_path, digest_algorithm, handler)) == NULL)
+	{
+		Main_ShowMessage("Error", "-mf", "--manifest", "couldn't create the manifest!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
 	bool all_matched = CmpFiles_CompareFiles(handler);	
 	
-	if (all_matched)
+	if (manifest != NULL && !CmpDigest_Finish(manifest))
 	{
-		puts("All files data content is matched, byte by byte!");
+		Main_ShowMessage("Error", "-mf", "--manifest", "couldn't write the whole manifest!");
+		return_code = EXIT_FAILURE;
 	}
-	else
+	
+	struct ShownResults shown_results = {output_format, output_level, show_combinations, all_matched};
+	
+	//	The comparing is done, so there is nothing left to resume.
+	if (checkpoint_path != NULL)
+	{
+		remove(checkpoint_path);
+	}
+	
+	//	The results of a shard are only shown, once all shards are merged.
+	if (shard_count != 0)
 	{
-		for (size_t index = 0; index < handler->_combinations_handler->_among_of_combinations; index += 1)
+		if (!CmpShard_WritePartial(partial_path, handler, sharded_indexes, number_of_listed_files, shard_index, shard_count))
 		{
-			size_t compare_index = handler->_combinations_handler->_compare_indexes[index];
-			size_t compare_with_index = handler->_combinations_handler->_compare_with_indexes[index];
-			
-			if (handler->_combinations_handler->_match_states[index] == MATCHED)
-			{
-				printf("%s and %s match!\n", handler->_filepaths[compare_index], handler->_filepaths[compare_with_index]);
-			}
-			else if (handler->_combinations_handler->_match_states[index] == NOT_MATCHED)
-			{
-				if (output_level == SHOW_ONLY_MATCHED) continue;
-				printf("%s and %s do not match!\n", handler->_filepaths[compare_index], handler->_filepaths[compare_with_index]);
-			}
-			else
-			{
-				printf("%s and %s matching state is unknown!\n", handler->_filepaths[compare_index], handler->_filepaths[compare_with_index]);
-			}
+			Main_ShowMessage("Error", "-so", "--shard-output", "couldn't write the partial results of the shard!");
+			return_code = EXIT_FAILURE;
 		}
 		
+		goto __Main_FreeResources;
+	}
+	
+	if (!Main_ShowResults(handler, all_matched, &shown_results))
+	{
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	
+	
+	if (watch_files && !CmpWatch_WatchFiles(handler, watch_delay, Main_ShowRecomparedResults, &shown_results))
+	{
+		Main_ShowMessage("Error", "-w", "--watch", "couldn't watch the files (stdin can't be watched)!");
+		return_code = EXIT_FAILURE;
+		goto __Main_FreeResources;
+	}
+	
+	if (watch_files)
+	{
+		all_matched = shown_results._all_matched;
+	}
+	
+	if (!all_matched)
+	{
 		return_code = EXIT_FAILURE;
 	}
 	
 
 	__Main_FreeResources:
+		if (trace_path != NULL && !CmpTrace_Finish(trace_path))
+		{
+			Main_ShowMessage("Warning", "-tr", "--trace", "couldn't write the trace!");
+		}
+		
+		if (events_stream != NULL && events_stream != stdout) fclose(events_stream);
+		
 		CmpFiles_Terminate(handler);
+		CmpThrottle_Terminate(throttle);
+		free(region_offsets);
+		free(region_lengths);
+		free(referenced_filepaths);
+		free(listed_filepaths);
+		free(sharded_indexes);
+		free(sharded_filepaths);
 
 	return return_code;
 }
@@ -19,19 +19,11 @@ extern const size_t DEFAULT_BUFFER_SIZE;
  * Determines, if a variable had its index value set.
  * */
 extern const int INDEX_NOT_SELECTED;
-
 /*!
- * A set of constants for defining the among and
- * type of output, shown on the terminal.
+ * The among of file descriptors, that are kept free for everything else, when the open files are limited by default.
+ * */
+extern const size_t RESERVED_FILE_DESCRIPTORS;
+/*!
+ * The filepath, which stands for stdout, when the decisions are written with -ev.
  * */
-enum OutputLevel
-{
-	/*!
-	 * Shows everything on the terminal.
-	 * */
-	SHOW_ALL,
-	/*!
-	 * Show only the files, that have matched data.
-	 * */
-	SHOW_ONLY_MATCHED
-};
+extern const char* STDOUT_FILEPATH_MARK;
@@ -0,0 +1,113 @@
+#!/bin/sh
+#	Checks, that the offset of the first differing byte of each file, written by -ev, is the same on every comparing path
+#	(the tiled kernel, the fingerprints, the compare threads, the shared buffers of -mm, and the holes of sparse files).
+#
+#	Usage: tests/mismatch_offsets.sh EXECUTABLE
+
+EXECUTABLE="$1"
+WORK_DIRECTORY=$(mktemp -d)
+FAILURES=0
+
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+#	Writes a file of the repeated pattern, with an X at each of the provided offsets.
+make_file()
+{
+	FILEPATH="$1"; SIZE="$2"; shift 2
+	yes "0123456789abcdef" | head -c "$SIZE" > "$FILEPATH"
+	for OFFSET in "$@"; do printf 'X' | dd of="$FILEPATH" bs=1 seek="$OFFSET" conv=notrunc status=none; done
+}
+
+#	Writes a sparse file, that is a hole except for an X at each of the provided offsets.
+make_sparse_file()
+{
+	FILEPATH="$1"; SIZE="$2"; shift 2
+	rm -f "$FILEPATH"; truncate -s "$SIZE" "$FILEPATH"
+	for OFFSET in "$@"; do printf 'X' | dd of="$FILEPATH" bs=1 seek="$OFFSET" conv=notrunc status=none; done
+}
+
+#	Keeps the first mismatch of each file, without the times.
+first_mismatches()
+{
+	grep '"decision":"mismatch"' "$1" | sed 's/"time":[0-9.]*,//' | awk -F'"index":' '!seen[$2 + 0]++' | sort
+}
+
+#	Compares the offsets of the default path with the ones of every other path, at the same block size.
+#	The shared buffers of -mm are only used, once the blocks are shrunk to 4096 bytes, so the files are also compared at that size.
+check_paths()
+{
+	NAME="$1"; BLOCK_SIZE="$2"; shift 2
+	"$EXECUTABLE" "$@" -bs "$BLOCK_SIZE" -ev "$WORK_DIRECTORY/expected" > /dev/null
+	first_mismatches "$WORK_DIRECTORY/expected" > "$WORK_DIRECTORY/expected_mismatches"
+
+	OPTION_SETS="-fp|-ct 3|-fp -ct 3"
+	if [ "$BLOCK_SIZE" -eq 4096 ]; then OPTION_SETS="$OPTION_SETS|-mm 12K|-mo 2 -mm 12K|-fp -mm 12K"; fi
+
+	IFS='|'; set -f
+	for OPTIONS in $OPTION_SETS; do
+		IFS=' '
+		"$EXECUTABLE" "$@" -bs "$BLOCK_SIZE" $OPTIONS -ev "$WORK_DIRECTORY/actual" > /dev/null
+		first_mismatches "$WORK_DIRECTORY/actual" > "$WORK_DIRECTORY/actual_mismatches"
+
+		if ! cmp -s "$WORK_DIRECTORY/expected_mismatches" "$WORK_DIRECTORY/actual_mismatches"; then
+			echo "FAILED: $NAME with $OPTIONS"
+			diff "$WORK_DIRECTORY/expected_mismatches" "$WORK_DIRECTORY/actual_mismatches"
+			FAILURES=$((FAILURES + 1))
+		fi
+		IFS='|'
+	done
+	IFS=' '; set +f
+
+	if ! grep -q '"offset":[1-9]' "$WORK_DIRECTORY/expected_mismatches"; then
+		echo "FAILED: $NAME has no mismatch inside of a block"
+		FAILURES=$((FAILURES + 1))
+	fi
+}
+
+
+
+#	A file, that differs from the first file, follows a class split off from it, and is split off from that class in a later tile of the same block.
+make_file "$WORK_DIRECTORY/e0" 300000 153979
+make_file "$WORK_DIRECTORY/e1" 300000
+make_file "$WORK_DIRECTORY/e2" 300000 160945
+make_file "$WORK_DIRECTORY/e3" 300000
+make_file "$WORK_DIRECTORY/e4" 300000 153979
+check_paths "split classes" 16384 "$WORK_DIRECTORY/e0" "$WORK_DIRECTORY/e1" "$WORK_DIRECTORY/e2" "$WORK_DIRECTORY/e3" "$WORK_DIRECTORY/e4"
+
+#	Blocks from holes, compared with blocks, that were read.
+make_sparse_file "$WORK_DIRECTORY/s0" 1000000 900000
+make_sparse_file "$WORK_DIRECTORY/s1" 1000000 900000
+make_sparse_file "$WORK_DIRECTORY/s2" 1000000 1000 900000
+make_sparse_file "$WORK_DIRECTORY/s3" 1000000 20000 900000
+make_sparse_file "$WORK_DIRECTORY/s4" 1000000 900000 900001
+check_paths "holes" 16384 "$WORK_DIRECTORY/s0" "$WORK_DIRECTORY/s1" "$WORK_DIRECTORY/s2" "$WORK_DIRECTORY/s3" "$WORK_DIRECTORY/s4"
+#	The same files at the block size of the shared buffers, and a file, that only differs inside of its first block.
+make_file "$WORK_DIRECTORY/e2" 300000 155000
+check_paths "split classes in slots" 4096 "$WORK_DIRECTORY/e0" "$WORK_DIRECTORY/e1" "$WORK_DIRECTORY/e2" "$WORK_DIRECTORY/e3" "$WORK_DIRECTORY/e4"
+check_paths "holes in slots" 4096 "$WORK_DIRECTORY/s0" "$WORK_DIRECTORY/s1" "$WORK_DIRECTORY/s2" "$WORK_DIRECTORY/s3" "$WORK_DIRECTORY/s4"
+
+make_file "$WORK_DIRECTORY/r0" 50000
+make_file "$WORK_DIRECTORY/r1" 50000
+make_file "$WORK_DIRECTORY/r2" 50000 1000
+check_paths "first block" 4096 "$WORK_DIRECTORY/r0" "$WORK_DIRECTORY/r1" "$WORK_DIRECTORY/r2"
+
+if ! grep -q '"index":2,"offset":1000}' "$WORK_DIRECTORY/actual_mismatches"; then
+	echo "FAILED: the difference of r2 wasn't reported at 1000"
+	FAILURES=$((FAILURES + 1))
+fi
+
+#	Files, that are left alone, are decided at the start of the block, in which they stopped matching (never past their end).
+printf 'hello world' > "$WORK_DIRECTORY/h1"
+printf 'hello worlX' > "$WORK_DIRECTORY/h2"
+for OPTIONS in "" "-fp" "-mm 12K"; do
+	"$EXECUTABLE" "$WORK_DIRECTORY/h1" "$WORK_DIRECTORY/h2" $OPTIONS -ev "$WORK_DIRECTORY/actual" > /dev/null
+
+	if [ "$(grep -c '"decision":"not_matched",.*"offset":0}' "$WORK_DIRECTORY/actual")" -ne 2 ]; then
+		echo "FAILED: the 11 byte files with '$OPTIONS' weren't left alone at 0"
+		cat "$WORK_DIRECTORY/actual"
+		FAILURES=$((FAILURES + 1))
+	fi
+done
+
+if [ "$FAILURES" -ne 0 ]; then exit 1; fi
+echo "mismatch_offsets: passed"
@@ -0,0 +1,66 @@
+#!/bin/sh
+#	Checks, that with a quorum, every file outside of the group, that reached it, is listed as a outlier
+#	(whether it wasn't matched, was left early, or is in a smaller group).
+#
+#	Usage: tests/quorum_outliers.sh EXECUTABLE
+
+EXECUTABLE=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+WORK_DIRECTORY=$(mktemp -d)
+FAILURES=0
+
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+cd "$WORK_DIRECTORY" || exit 1
+
+#	Writes a file of the repeated pattern, with an X at each of the provided offsets.
+make_file()
+{
+	FILEPATH="$1"; SIZE="$2"; shift 2
+	yes "0123456789abcdef" | head -c "$SIZE" > "$FILEPATH"
+	for OFFSET in "$@"; do printf 'X' | dd of="$FILEPATH" bs=1 seek="$OFFSET" conv=notrunc status=none; done
+}
+
+#	Compares the written results with the expected ones.
+check_output()
+{
+	NAME="$1"; EXPECTED="$2"; shift 2
+	ACTUAL=$("$EXECUTABLE" "$@")
+
+	if [ "$ACTUAL" != "$EXPECTED" ]; then
+		echo "FAILED: $NAME"
+		echo "expected: $EXPECTED"
+		echo "actual:   $ACTUAL"
+		FAILURES=$((FAILURES + 1))
+	fi
+}
+
+
+
+make_file r1 5000000
+make_file r2 5000000
+make_file r3 5000000
+
+#	2 of 5 replicas are broken differently, one of them at the end, so it is read till its end.
+make_file r4 5000000 100
+make_file r5 5000000 4999000
+check_output "5 replicas, 2 broken, quorum of 3" \
+	'{"all_matched":false,"quorum":3,"quorum_reached":true,"groups":[["r1","r2","r3"]],"not_matched":[],"failed":[],"outliers":["r4","r5"]}' \
+	r1 r2 r3 r4 r5 -qr 3 -of json
+
+check_output "5 replicas, 2 broken, quorum of 3 in CSV" \
+	"$(printf 'group,state,filepath\n1,matched,r1\n1,matched,r2\n1,matched,r3\n,outlier,r4\n,outlier,r5')" \
+	r1 r2 r3 r4 r5 -qr 3 -of csv
+
+#	2 of 5 replicas are broken the same way, so they are matched with each other, but not with the quorum.
+make_file r4 5000000 4999000
+check_output "5 replicas, 2 broken the same way, quorum of 3" \
+	'{"all_matched":false,"quorum":3,"quorum_reached":true,"groups":[["r1","r2","r3"],["r4","r5"]],"not_matched":[],"failed":[],"outliers":["r4","r5"]}' \
+	r1 r2 r3 r4 r5 -qr 3 -of json
+
+#	Without a quorum, the files are listed by their state.
+make_file r4 5000000 100
+check_output "5 replicas, 2 broken, without a quorum" \
+	'{"all_matched":false,"groups":[["r1","r2","r3"]],"not_matched":["r4","r5"],"failed":[]}' \
+	r1 r2 r3 r4 r5 -of json
+
+if [ "$FAILURES" -ne 0 ]; then exit 1; fi
+echo "quorum_outliers: passed"